@@ -0,0 +1,615 @@
+#include "core/gas_container.h"
+#include "core/checkpoint.h"
+#include "core/domain_simulation.h"
+#include "core/domain_transport.h"
+#include "core/gas_observables.h"
+#include "core/precise_gas_container.h"
+#include "core/trajectory.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using idealgas::AddGroupDescription;
+using idealgas::BoundaryMode;
+using idealgas::CheckpointWriter;
+using idealgas::CollisionMode;
+using idealgas::DomainSimulation;
+using idealgas::FixedPoint32Precision;
+using idealgas::Float64Precision;
+using idealgas::GasContainer;
+using idealgas::MappedCheckpoint;
+using idealgas::ObservableSample;
+using idealgas::Particle;
+using idealgas::ParticleGroup;
+using idealgas::PreciseGasContainer;
+using idealgas::SocketTransport;
+using idealgas::SteppingMode;
+using idealgas::TrajectoryWriter;
+using idealgas::UpdateProfiler;
+using std::map;
+using std::size_t;
+using std::string;
+using std::vector;
+
+namespace {
+
+/**
+ * Number types particle state can be stepped in.
+ */
+enum class PrecisionMode {
+  kFloat,     //a gas container, w/ particles in floats
+  kDouble,    //a precise gas container in double precision
+  kFixedPoint //a precise gas container in 32 bit fixed point, same bits on
+              //every platform
+};
+
+/**
+ * Settings for one headless run, read from the command line.
+ */
+struct RunSettings {
+  map<Particle, size_t> particle_information;
+  size_t container_width = 600;
+  size_t container_height = 800;
+  size_t step_count = 1000;
+  double step_time = 1.0;
+  uint64_t seed = 0;
+  size_t thread_count = 1;
+  CollisionMode collision_mode = CollisionMode::kUniformGrid;
+  SteppingMode stepping_mode = SteppingMode::kFixedStep;
+  BoundaryMode boundary_mode = BoundaryMode::kReflecting;
+  PrecisionMode precision_mode = PrecisionMode::kFloat;
+  double verlet_skin = 4.0;
+  size_t sort_interval = 0;
+  size_t domain_count = 1;
+  string checkpoint_path;
+  size_t checkpoint_interval = 0;
+  string resume_path;
+  string trajectory_path;
+  size_t trajectory_interval = 1;
+  string profile_path;
+  size_t profile_interval = 0;
+  string observables_path;
+  size_t observables_interval = 100;
+};
+
+void PrintUsage(const char* program) {
+  std::cerr << "usage: " << program << " [options]\n"
+            << "  --group COUNT:MASS:RADIUS  add a group of particles "
+               "(repeatable, default is the visualizer's 3 groups)\n"
+            << "  --width PIXELS             container width (default 600)\n"
+            << "  --height PIXELS            container height (default 800)\n"
+            << "  --steps COUNT              number of updates (default 1000)\n"
+            << "  --time DURATION            time each update moves particles "
+               "by, other than 1\n"
+            << "                             only w/ --stepper event "
+               "(default 1)\n"
+            << "  --seed SEED                random seed (default 0)\n"
+            << "  --threads COUNT            collision threads (default 1)\n"
+            << "  --mode MODE                collision mode, grid, all-pairs, "
+               "verlet,\n"
+            << "                             hierarchical or sweep (default "
+               "grid)\n"
+            << "  --skin PIXELS              Verlet list skin distance "
+               "(default 4)\n"
+            << "  --stepper fixed|event      stepping mode (default fixed)\n"
+            << "  --boundary walls|periodic  container edges (default walls)\n"
+            << "  --precision float|double|fixed\n"
+            << "                             number type particles are "
+               "stepped in, fixed point\n"
+            << "                             replays the same everywhere, "
+               "double and fixed only\n"
+            << "                             w/ fixed steps, walls, the default "
+               "--mode on one\n"
+            << "                             thread\n"
+            << "                             (default float)\n"
+            << "  --sort-every COUNT         steps between reordering "
+               "particles in memory\n"
+            << "                             (default never)\n"
+            << "  --domains COUNT            processes to split the container "
+               "into strips for,\n"
+            << "                             only w/ fixed steps and walls, "
+               "not w/ --sort-every,\n"
+            << "                             --checkpoint, --resume, "
+               "--trajectory, --profile,\n"
+            << "                             --observables or --precision "
+               "(default 1)\n"
+            << "  --checkpoint PATH          file to save checkpoints to\n"
+            << "  --checkpoint-every COUNT   steps between checkpoints "
+               "(default only at the end)\n"
+            << "  --resume PATH              continue from a checkpoint, "
+               "--steps is the total\n"
+            << "  --trajectory PATH          file to record frames to\n"
+            << "  --trajectory-every COUNT   steps between recorded frames "
+               "(default 1)\n"
+            << "  --profile PATH             file to write update phase times "
+               "and counts to,\n"
+            << "                             JSON lines if it ends in .json, "
+               "else CSV\n"
+            << "  --profile-every COUNT      steps per profile row (default "
+               "one row at the end)\n"
+            << "  --observables PATH         CSV file to write energy, "
+               "pressure and collision\n"
+            << "                             rates of all particles to\n"
+            << "  --observe-every COUNT      steps per observables row "
+               "(default 100)\n";
+}
+
+/**
+ * Reads the settings for this run from the command line arguments.
+ *
+ * @return true if all arguments could be read, else false.
+ */
+bool ReadSettings(int argc, char** argv, RunSettings& settings) {
+  for (int index = 1; index < argc; index++) {
+    string option = argv[index];
+    if (index + 1 >= argc) {
+      return false;
+    }
+    const char* value = argv[++index];
+
+    if (option == "--group") {
+      if (!AddGroupDescription(value, settings.particle_information)) {
+        return false;
+      }
+    } else if (option == "--width") {
+      settings.container_width = std::strtoul(value, nullptr, 10);
+    } else if (option == "--height") {
+      settings.container_height = std::strtoul(value, nullptr, 10);
+    } else if (option == "--steps") {
+      settings.step_count = std::strtoul(value, nullptr, 10);
+    } else if (option == "--time") {
+      settings.step_time = std::strtod(value, nullptr);
+    } else if (option == "--seed") {
+      settings.seed = std::strtoull(value, nullptr, 10);
+    } else if (option == "--threads") {
+      settings.thread_count = std::strtoul(value, nullptr, 10);
+    } else if (option == "--mode" && string(value) == "grid") {
+      settings.collision_mode = CollisionMode::kUniformGrid;
+    } else if (option == "--mode" && string(value) == "all-pairs") {
+      settings.collision_mode = CollisionMode::kAllPairs;
+    } else if (option == "--mode" && string(value) == "verlet") {
+      settings.collision_mode = CollisionMode::kVerletList;
+    } else if (option == "--mode" && string(value) == "hierarchical") {
+      settings.collision_mode = CollisionMode::kHierarchicalGrid;
+    } else if (option == "--mode" && string(value) == "sweep") {
+      settings.collision_mode = CollisionMode::kSweepAndPrune;
+    } else if (option == "--skin") {
+      settings.verlet_skin = std::strtod(value, nullptr);
+    } else if (option == "--stepper" && string(value) == "fixed") {
+      settings.stepping_mode = SteppingMode::kFixedStep;
+    } else if (option == "--stepper" && string(value) == "event") {
+      settings.stepping_mode = SteppingMode::kEventDriven;
+    } else if (option == "--boundary" && string(value) == "walls") {
+      settings.boundary_mode = BoundaryMode::kReflecting;
+    } else if (option == "--boundary" && string(value) == "periodic") {
+      settings.boundary_mode = BoundaryMode::kPeriodic;
+    } else if (option == "--precision" && string(value) == "float") {
+      settings.precision_mode = PrecisionMode::kFloat;
+    } else if (option == "--precision" && string(value) == "double") {
+      settings.precision_mode = PrecisionMode::kDouble;
+    } else if (option == "--precision" && string(value) == "fixed") {
+      settings.precision_mode = PrecisionMode::kFixedPoint;
+    } else if (option == "--sort-every") {
+      settings.sort_interval = std::strtoul(value, nullptr, 10);
+    } else if (option == "--domains") {
+      settings.domain_count = std::strtoul(value, nullptr, 10);
+    } else if (option == "--checkpoint") {
+      settings.checkpoint_path = value;
+    } else if (option == "--checkpoint-every") {
+      settings.checkpoint_interval = std::strtoul(value, nullptr, 10);
+    } else if (option == "--resume") {
+      settings.resume_path = value;
+    } else if (option == "--trajectory") {
+      settings.trajectory_path = value;
+    } else if (option == "--trajectory-every") {
+      settings.trajectory_interval = std::strtoul(value, nullptr, 10);
+    } else if (option == "--profile") {
+      settings.profile_path = value;
+    } else if (option == "--profile-every") {
+      settings.profile_interval = std::strtoul(value, nullptr, 10);
+    } else if (option == "--observables") {
+      settings.observables_path = value;
+    } else if (option == "--observe-every") {
+      settings.observables_interval = std::strtoul(value, nullptr, 10);
+    } else {
+      return false;
+    }
+  }
+
+  if (settings.particle_information.empty()) {
+    //same small, mid and big particles as the visualizer
+    AddGroupDescription("200:2:5", settings.particle_information);
+    AddGroupDescription("75:5:10", settings.particle_information);
+    AddGroupDescription("30:15:15", settings.particle_information);
+  }
+
+  //fixed steps always move particles by one unit of time
+  if (!(settings.step_time > 0) ||
+      (settings.step_time != 1.0 &&
+       settings.stepping_mode != SteppingMode::kEventDriven)) {
+    return false;
+  }
+
+  //domains only trade particles, everything else needs the whole container
+  if (settings.domain_count == 0) {
+    return false;
+  } else if (settings.domain_count > 1 &&
+             (settings.stepping_mode != SteppingMode::kFixedStep ||
+              settings.boundary_mode != BoundaryMode::kReflecting ||
+              settings.sort_interval > 0 || !settings.checkpoint_path.empty() ||
+              !settings.resume_path.empty() ||
+              !settings.trajectory_path.empty() ||
+              !settings.profile_path.empty() ||
+              !settings.observables_path.empty())) {
+    return false;
+  } else if (!settings.observables_path.empty() &&
+             settings.observables_interval == 0) {
+    return false;
+  }
+
+  //precise containers only step particles, like a gas container w/ walls,
+  //on one thread w/ their own broad phase
+  if (settings.precision_mode != PrecisionMode::kFloat &&
+      (settings.domain_count > 1 || settings.thread_count > 1 ||
+       settings.collision_mode != CollisionMode::kUniformGrid ||
+       settings.stepping_mode != SteppingMode::kFixedStep ||
+       settings.boundary_mode != BoundaryMode::kReflecting ||
+       settings.sort_interval > 0 || !settings.checkpoint_path.empty() ||
+       !settings.resume_path.empty() || !settings.trajectory_path.empty() ||
+       !settings.profile_path.empty() || !settings.observables_path.empty())) {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Checks if a path ends in the given suffix.
+ */
+bool EndsWith(const string& path, const string& suffix) {
+  return path.size() >= suffix.size() &&
+         path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ * Writes everything the profiler recorded since its last reset as one row of
+ * the profile file, then resets it for the next row.
+ */
+void WriteProfileRow(std::FILE* file, bool as_json, UpdateProfiler& profiler,
+                     size_t step) {
+  if (as_json) {
+    profiler.WriteJsonLine(file, step);
+  } else {
+    profiler.WriteCsvRow(file, step);
+  }
+  profiler.Reset();
+}
+
+/**
+ * Writes the totals of every pulled sample as rows of the observables file.
+ * Pressures are left empty for containers w/o walls.
+ */
+void WriteObservableRows(std::FILE* file,
+                         const vector<ObservableSample>& samples) {
+  for (const ObservableSample& sample: samples) {
+    std::fprintf(file, "%llu,%zu,%.9g,%.9g,%.9g,%.9g,%.9g,",
+                 (unsigned long long) sample.update,
+                 sample.total.particle_count, sample.total.kinetic_energy,
+                 sample.total.temperature, sample.total.x_momentum,
+                 sample.total.y_momentum, sample.total.mean_speed);
+    if (sample.has_pressure) {
+      std::fprintf(file, "%.9g", sample.pressure);
+    }
+    std::fprintf(file, ",%.9g,%.9g\n", sample.collision_rate,
+                 sample.mean_free_path);
+  }
+}
+
+/**
+ * Prints how long the run took and the mean speed of each group.
+ */
+void PrintSummary(const vector<ParticleGroup*>& groups, size_t steps_run,
+                  double seconds) {
+  size_t particle_count = 0;
+  for (ParticleGroup* group: groups) {
+    particle_count += group->GetGroupSize();
+  }
+  std::cout << "particles " << particle_count << "\n"
+            << "steps " << steps_run << "\n"
+            << "seconds " << seconds << "\n"
+            << "steps_per_second " << steps_run / seconds
+            << "\n";
+
+  for (ParticleGroup* group: groups) {
+    double total_speed = 0;
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      total_speed += glm::length(group->GetVelocityAt(index));
+    }
+    double mean_speed = group->GetGroupSize() == 0 ? 0 :
+                        total_speed / group->GetGroupSize();
+    std::cout << "group mass=" << group->GetParticleMass() << " radius="
+              << group->GetParticleRadius() << " count="
+              << group->GetGroupSize() << " mean_speed=" << mean_speed << "\n";
+  }
+}
+
+/**
+ * Runs the simulation split into strips, one forked process per strip.
+ * Particles are gathered into the first process at the end for the summary.
+ *
+ * @return the exit code of the run.
+ */
+int RunInDomains(const RunSettings& settings) {
+#if defined(_WIN32)
+  std::cerr << "--domains needs Unix sockets and fork\n";
+  return 1;
+#else
+  vector<std::unique_ptr<SocketTransport>> transports;
+  if (!SocketTransport::CreateLocal(settings.domain_count, transports)) {
+    std::cerr << "could not connect " << settings.domain_count
+              << " domains\n";
+    return 1;
+  }
+
+  size_t rank = 0;
+  vector<pid_t> children;
+  for (size_t domain = 1; domain < settings.domain_count; domain++) {
+    pid_t child = fork();
+    if (child < 0) {
+      std::cerr << "could not start domain " << domain << "\n";
+      return 1;
+    } else if (child == 0) {
+      rank = domain;
+      children.clear();
+      break;
+    }
+    children.push_back(child);
+  }
+  //every process only keeps its own sockets open, so a domain that exits
+  //early is noticed by the others instead of leaving them waiting
+  for (size_t domain = 0; domain < transports.size(); domain++) {
+    if (domain != rank) {
+      transports[domain].reset();
+    }
+  }
+
+  DomainSimulation simulation(settings.particle_information,
+                              settings.container_width,
+                              settings.container_height, settings.seed,
+                              transports[rank].get(), settings.thread_count);
+  simulation.SetCollisionMode(settings.collision_mode);
+
+  bool succeeded = true;
+  auto start_time = std::chrono::steady_clock::now();
+  for (size_t step = 0; step < settings.step_count && succeeded; step++) {
+    succeeded = simulation.Update();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start_time;
+  vector<ParticleGroup*> groups;
+  succeeded = succeeded && simulation.GatherParticleGroups(groups);
+  if (rank != 0) {
+    return succeeded ? 0 : 1;
+  }
+
+  for (pid_t child: children) {
+    int status = 0;
+    succeeded = waitpid(child, &status, 0) == child && WIFEXITED(status) &&
+                WEXITSTATUS(status) == 0 && succeeded;
+  }
+  if (!succeeded) {
+    std::cerr << "domains lost contact w/ each other\n";
+    return 1;
+  }
+  PrintSummary(groups, settings.step_count, elapsed.count());
+  std::cout << "domains " << settings.domain_count << "\n"
+            << "halo_retries " << simulation.GetHaloRetryCount() << "\n";
+  for (ParticleGroup* group: groups) {
+    delete group;
+  }
+  return 0;
+#endif
+}
+
+/**
+ * Runs the simulation w/ particle state in the number type of a precision
+ * policy, then copies the particles back into floats for the summary.
+ *
+ * @return the exit code of the run.
+ */
+template <typename Precision>
+int RunWithPrecision(const RunSettings& settings) {
+  GasContainer container(settings.particle_information,
+                         settings.container_width, settings.container_height,
+                         settings.seed, settings.thread_count);
+  PreciseGasContainer<Precision> precise_container(
+      container.GetParticleGroups());
+
+  auto start_time = std::chrono::steady_clock::now();
+  for (size_t step = 0; step < settings.step_count; step++) {
+    precise_container.Update();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start_time;
+
+  precise_container.StoreInGroups(container.GetParticleGroups());
+  PrintSummary(container.GetParticleGroups(), settings.step_count,
+               elapsed.count());
+  return 0;
+}
+
+} // namespace
+
+/**
+ * Runs a simulation without a window as fast as possible, then prints how
+ * long it took and the mean speed of each group.
+ */
+int main(int argc, char** argv) {
+  RunSettings settings;
+  if (!ReadSettings(argc, argv, settings)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  if (settings.domain_count > 1) {
+    return RunInDomains(settings);
+  } else if (settings.precision_mode == PrecisionMode::kDouble) {
+    return RunWithPrecision<Float64Precision>(settings);
+  } else if (settings.precision_mode == PrecisionMode::kFixedPoint) {
+    return RunWithPrecision<FixedPoint32Precision>(settings);
+  }
+
+  GasContainer container;
+  size_t first_step = 0;
+  if (settings.resume_path.empty()) {
+    container = GasContainer(settings.particle_information,
+                             settings.container_width,
+                             settings.container_height, settings.seed,
+                             settings.thread_count);
+  } else {
+    MappedCheckpoint checkpoint;
+    if (!checkpoint.Open(settings.resume_path)) {
+      std::cerr << "could not read checkpoint " << settings.resume_path
+                << "\n";
+      return 1;
+    }
+    container = GasContainer(checkpoint.CreateGroups(),
+                             checkpoint.GetHeader().container_width,
+                             checkpoint.GetHeader().container_height);
+    first_step = checkpoint.GetHeader().step_count;
+  }
+  container.SetCollisionMode(settings.collision_mode);
+  container.SetVerletSkin(settings.verlet_skin);
+  container.SetThreadCount(settings.thread_count);
+  container.SetSteppingMode(settings.stepping_mode);
+  container.SetBoundaryMode(settings.boundary_mode);
+  container.SetSortInterval(settings.sort_interval);
+
+  //frames are dropped rather than slowing stepping if writing falls behind
+  TrajectoryWriter trajectory_writer;
+  if (!settings.trajectory_path.empty() &&
+      !trajectory_writer.Open(settings.trajectory_path, container,
+                              settings.trajectory_interval, 64)) {
+    std::cerr << "could not create trajectory " << settings.trajectory_path
+              << "\n";
+    return 1;
+  }
+
+  std::FILE* profile_file = nullptr;
+  bool profile_as_json = EndsWith(settings.profile_path, ".json");
+  if (!settings.profile_path.empty()) {
+    profile_file = std::fopen(settings.profile_path.c_str(), "w");
+    if (profile_file == nullptr) {
+      std::cerr << "could not create profile " << settings.profile_path
+                << "\n";
+      return 1;
+    }
+    if (!profile_as_json) {
+      UpdateProfiler::WriteCsvHeader(profile_file);
+    }
+  }
+  UpdateProfiler& profiler = container.GetProfiler();
+  profiler.Reset();
+
+  std::FILE* observables_file = nullptr;
+  vector<ObservableSample> samples;
+  if (!settings.observables_path.empty()) {
+    observables_file = std::fopen(settings.observables_path.c_str(), "w");
+    if (observables_file == nullptr) {
+      std::cerr << "could not create observables "
+                << settings.observables_path << "\n";
+      return 1;
+    }
+    std::fprintf(observables_file, "update,particles,kinetic_energy,"
+                 "temperature,x_momentum,y_momentum,mean_speed,pressure,"
+                 "collision_rate,mean_free_path\n");
+    container.GetObservables().SetSampleInterval(
+        settings.observables_interval);
+  }
+
+  CheckpointWriter checkpoint_writer;
+  auto start_time = std::chrono::steady_clock::now();
+  for (size_t step = first_step; step < settings.step_count; step++) {
+    container.Advance(settings.step_time);
+    if (profile_file != nullptr && settings.profile_interval > 0 &&
+        (step + 1) % settings.profile_interval == 0) {
+      WriteProfileRow(profile_file, profile_as_json, profiler, step + 1);
+    }
+    if (observables_file != nullptr &&
+        container.GetObservables().PullSamples(samples) > 0) {
+      WriteObservableRows(observables_file, samples);
+      samples.clear();
+    }
+    trajectory_writer.RecordStep(container, step + 1);
+    if (!settings.checkpoint_path.empty() &&
+        settings.checkpoint_interval > 0 &&
+        (step + 1) % settings.checkpoint_interval == 0) {
+      checkpoint_writer.SaveAsync(container, step + 1,
+                                  settings.checkpoint_path);
+    }
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start_time;
+
+  if (profile_file != nullptr) {
+    if (profiler.GetUpdateCount() > 0) {
+      WriteProfileRow(profile_file, profile_as_json, profiler,
+                      std::max(first_step, settings.step_count));
+    }
+    if (std::fclose(profile_file) != 0) {
+      std::cerr << "could not write profile " << settings.profile_path
+                << "\n";
+      return 1;
+    }
+  }
+
+  if (observables_file != nullptr && std::fclose(observables_file) != 0) {
+    std::cerr << "could not write observables " << settings.observables_path
+              << "\n";
+    return 1;
+  }
+
+  if (!settings.checkpoint_path.empty()) {
+    size_t last_step = std::max(first_step, settings.step_count);
+    if (settings.checkpoint_interval == 0 ||
+        last_step % settings.checkpoint_interval != 0) {
+      checkpoint_writer.SaveAsync(container, last_step,
+                                  settings.checkpoint_path);
+    }
+    if (!checkpoint_writer.Wait()) {
+      std::cerr << "could not write checkpoint " << settings.checkpoint_path
+                << "\n";
+      return 1;
+    }
+    if (checkpoint_writer.GetReplacedSaveCount() > 0) {
+      std::cerr << "skipped " << checkpoint_writer.GetReplacedSaveCount()
+                << " checkpoints while earlier ones were written\n";
+    }
+  }
+
+  if (!trajectory_writer.Close()) {
+    std::cerr << "could not write trajectory " << settings.trajectory_path
+              << "\n";
+    return 1;
+  }
+  if (trajectory_writer.GetDroppedFrameCount() > 0) {
+    std::cerr << "dropped " << trajectory_writer.GetDroppedFrameCount()
+              << " trajectory frames\n";
+  }
+
+  size_t steps_run = settings.step_count > first_step ?
+                     settings.step_count - first_step : 0;
+  PrintSummary(container.GetParticleGroups(), steps_run, elapsed.count());
+  return 0;
+}
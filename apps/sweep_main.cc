@@ -0,0 +1,198 @@
+#include "core/ensemble_runner.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using idealgas::AddGroupDescription;
+using idealgas::CollisionMode;
+using idealgas::EnsembleRunner;
+using idealgas::EnsembleSettings;
+using idealgas::EnsembleSummary;
+using idealgas::GroupSummary;
+using idealgas::SteppingMode;
+using std::size_t;
+using std::string;
+using std::vector;
+
+namespace {
+
+/**
+ * Settings for one sweep, read from the command line.
+ */
+struct SweepSettings {
+  vector<string> ensemble_descriptions;
+  size_t replica_count = 1;
+  size_t container_width = 600;
+  size_t container_height = 800;
+  size_t step_count = 1000;
+  uint64_t seed = 0;
+  size_t thread_count = 1;
+  CollisionMode collision_mode = CollisionMode::kUniformGrid;
+  SteppingMode stepping_mode = SteppingMode::kFixedStep;
+};
+
+void PrintUsage(const char* program) {
+  std::cerr << "usage: " << program << " [options]\n"
+            << "  --ensemble GROUP[,GROUP...]  add an ensemble of groups, "
+               "each COUNT:MASS:RADIUS\n"
+            << "                               (repeatable, default sweeps "
+               "the visualizer's small particles)\n"
+            << "  --replicas COUNT             runs of every ensemble "
+               "(default 1)\n"
+            << "  --width PIXELS               container width (default 600)\n"
+            << "  --height PIXELS              container height (default "
+               "800)\n"
+            << "  --steps COUNT                updates per ensemble (default "
+               "1000)\n"
+            << "  --seed SEED                  random seed (default 0)\n"
+            << "  --threads COUNT              threads running ensembles "
+               "(default 1)\n"
+            << "  --mode MODE                  collision mode, grid, "
+               "all-pairs, verlet,\n"
+            << "                               hierarchical or sweep (default "
+               "grid)\n"
+            << "  --stepper fixed|event        stepping mode (default "
+               "fixed)\n";
+}
+
+/**
+ * Adds the groups of an ensemble described as COUNT:MASS:RADIUS groups
+ * separated by commas to the ensemble settings.
+ *
+ * @return true if the description could be read, else false.
+ */
+bool ReadEnsemble(const string& description, EnsembleSettings& settings) {
+  size_t start = 0;
+  while (start <= description.size()) {
+    size_t end = description.find(',', start);
+    if (end == string::npos) {
+      end = description.size();
+    }
+    if (!AddGroupDescription(description.substr(start, end - start),
+                             settings.particle_information)) {
+      return false;
+    }
+    start = end + 1;
+  }
+  return true;
+}
+
+/**
+ * Reads the settings for this sweep from the command line arguments.
+ *
+ * @return true if all arguments could be read, else false.
+ */
+bool ReadSettings(int argc, char** argv, SweepSettings& settings) {
+  for (int index = 1; index < argc; index++) {
+    string option = argv[index];
+    if (index + 1 >= argc) {
+      return false;
+    }
+    const char* value = argv[++index];
+
+    if (option == "--ensemble") {
+      settings.ensemble_descriptions.push_back(value);
+    } else if (option == "--replicas") {
+      settings.replica_count = std::strtoul(value, nullptr, 10);
+    } else if (option == "--width") {
+      settings.container_width = std::strtoul(value, nullptr, 10);
+    } else if (option == "--height") {
+      settings.container_height = std::strtoul(value, nullptr, 10);
+    } else if (option == "--steps") {
+      settings.step_count = std::strtoul(value, nullptr, 10);
+    } else if (option == "--seed") {
+      settings.seed = std::strtoull(value, nullptr, 10);
+    } else if (option == "--threads") {
+      settings.thread_count = std::strtoul(value, nullptr, 10);
+    } else if (option == "--mode" && string(value) == "grid") {
+      settings.collision_mode = CollisionMode::kUniformGrid;
+    } else if (option == "--mode" && string(value) == "all-pairs") {
+      settings.collision_mode = CollisionMode::kAllPairs;
+    } else if (option == "--mode" && string(value) == "verlet") {
+      settings.collision_mode = CollisionMode::kVerletList;
+    } else if (option == "--mode" && string(value) == "hierarchical") {
+      settings.collision_mode = CollisionMode::kHierarchicalGrid;
+    } else if (option == "--mode" && string(value) == "sweep") {
+      settings.collision_mode = CollisionMode::kSweepAndPrune;
+    } else if (option == "--stepper" && string(value) == "fixed") {
+      settings.stepping_mode = SteppingMode::kFixedStep;
+    } else if (option == "--stepper" && string(value) == "event") {
+      settings.stepping_mode = SteppingMode::kEventDriven;
+    } else {
+      return false;
+    }
+  }
+
+  if (settings.ensemble_descriptions.empty()) {
+    //the visualizer's mid and big particles, w/ a range of small masses
+    for (size_t small_mass = 1; small_mass <= 8; small_mass++) {
+      settings.ensemble_descriptions.push_back(
+          "200:" + std::to_string(small_mass) + ":5,75:5:10,30:15:15");
+    }
+  }
+  return true;
+}
+
+/**
+ * Prints one line w/ the summary of a finished ensemble.
+ */
+void PrintSummary(const EnsembleSummary& summary) {
+  std::cout << "ensemble " << summary.ensemble << " steps "
+            << summary.step_count << " seconds " << summary.seconds;
+  for (const GroupSummary& group: summary.groups) {
+    std::cout << " group mass=" << group.particle_mass << " radius="
+              << group.particle_radius << " count=" << group.particle_count
+              << " mean_speed=" << group.mean_speed << " kinetic_energy="
+              << group.kinetic_energy;
+  }
+  std::cout << std::endl;
+}
+
+} // namespace
+
+/**
+ * Runs many independent simulations spread over all threads, printing the
+ * summary of each one as soon as it finishes, then the total throughput.
+ */
+int main(int argc, char** argv) {
+  SweepSettings settings;
+  if (!ReadSettings(argc, argv, settings)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  EnsembleRunner runner(settings.thread_count);
+  for (size_t replica = 0; replica < settings.replica_count; replica++) {
+    for (const string& description: settings.ensemble_descriptions) {
+      EnsembleSettings ensemble;
+      if (!ReadEnsemble(description, ensemble)) {
+        PrintUsage(argv[0]);
+        return 1;
+      }
+      ensemble.container_width = settings.container_width;
+      ensemble.container_height = settings.container_height;
+      ensemble.step_count = settings.step_count;
+      ensemble.collision_mode = settings.collision_mode;
+      ensemble.stepping_mode = settings.stepping_mode;
+      //every ensemble of the sweep gets its own seed
+      ensemble.seed = (settings.seed << 32) + runner.GetEnsembleCount();
+      runner.AddEnsemble(ensemble);
+    }
+  }
+
+  size_t ensemble_count = runner.GetEnsembleCount();
+  auto start_time = std::chrono::steady_clock::now();
+  runner.Run(PrintSummary);
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start_time;
+
+  std::cout << "ensembles " << ensemble_count << "\n"
+            << "seconds " << elapsed.count() << "\n"
+            << "ensembles_per_second " << ensemble_count / elapsed.count()
+            << "\n";
+  return 0;
+}
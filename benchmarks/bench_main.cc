@@ -0,0 +1,560 @@
+#include <benchmark/benchmark.h>
+#include "core/gas_container.h"
+#include "core/ideal_gas_histogram.h"
+#include "core/particle_kernels.h"
+#include "core/particle_utils.h"
+#include "core/philox.h"
+#include "core/precise_gas_container.h"
+#include "core/precise_particle.h"
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+using idealgas::CollisionMode;
+using idealgas::FindNamedColor;
+using idealgas::FixedPoint32Precision;
+using idealgas::Float32Precision;
+using idealgas::Float64Precision;
+using idealgas::GasContainer;
+using idealgas::IdealGasHistogram;
+using idealgas::Particle;
+using idealgas::ParticleGroup;
+using idealgas::PreciseGasContainer;
+using idealgas::PreciseParticle;
+using idealgas::SteppingMode;
+using std::map;
+using std::size_t;
+using std::vector;
+
+namespace {
+
+/**
+ * Particle types to fill benchmark containers with.
+ */
+enum ParticleMix {
+  kPresetMix = 0,   //same small/mid/big ratio as the visualizer
+  kSmallOnly = 1,   //only the visualizer's small particles
+  kPolydisperse = 2 //radii of 1, 10 and 100, mostly small particles
+};
+
+/**
+ * How crowded benchmark containers are.
+ */
+enum Density {
+  kDilute = 0, //same area per particle as the visualizer
+  kDense = 1   //a tenth of the visualizer's area per particle
+};
+
+//the visualizer's container has 600 * 800 pixels for 305 particles
+const double kDiluteAreaPerParticle = 600.0 * 800.0 / 305.0;
+const double kDenseAreaPerParticle = kDiluteAreaPerParticle / 10.0;
+
+/**
+ * Makes a square container with the given number of particles, using the
+ * mix and density from a benchmark's arguments.
+ */
+GasContainer MakeContainer(size_t particle_count, int64_t mix,
+                           int64_t density) {
+  double area_per_particle = density == kDense ? kDenseAreaPerParticle :
+                                                 kDiluteAreaPerParticle;
+  size_t side = (size_t) std::sqrt(particle_count * area_per_particle);
+
+  map<Particle, size_t> particle_information;
+  Particle small_particle(glm::vec2(0,0), glm::vec2(0,0), 2, 5, FindNamedColor("yellow"));
+  Particle mid_particle(glm::vec2(0,0), glm::vec2(0,0), 5, 10, FindNamedColor("magenta"));
+  Particle big_particle(glm::vec2(0,0), glm::vec2(0,0), 15, 15, FindNamedColor("cyan"));
+  if (mix == kSmallOnly) {
+    particle_information[small_particle] = particle_count;
+  } else if (mix == kPolydisperse) {
+    //every size moves 1 pixel per update at most
+    Particle tiny_particle(glm::vec2(0,0), glm::vec2(0,0), 1, 1, FindNamedColor("white"));
+    Particle medium_particle(glm::vec2(0,0), glm::vec2(0,0), 10, 10, FindNamedColor("blue"));
+    Particle huge_particle(glm::vec2(0,0), glm::vec2(0,0), 100, 100, FindNamedColor("red"));
+    size_t medium_count = particle_count / 20;
+    size_t huge_count = particle_count / 1000;
+    particle_information[tiny_particle] = particle_count - medium_count -
+                                          huge_count;
+    particle_information[medium_particle] = medium_count;
+    particle_information[huge_particle] = huge_count;
+  } else {
+    size_t mid_count = particle_count * 75 / 305;
+    size_t big_count = particle_count * 30 / 305;
+    particle_information[small_particle] = particle_count - mid_count -
+                                           big_count;
+    particle_information[mid_particle] = mid_count;
+    particle_information[big_particle] = big_count;
+  }
+  return GasContainer(particle_information, side, side);
+}
+
+/**
+ * Frees the particle groups of a benchmark container, which the container
+ * doesn't own.
+ */
+void DeleteGroups(GasContainer& container) {
+  for (ParticleGroup* group: container.GetParticleGroups()) {
+    delete group;
+  }
+}
+
+/**
+ * Runs every benchmark over all particle counts, mixes and densities.
+ */
+void SweepArguments(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"particles", "mix", "dense"});
+  for (int64_t count = 100; count <= 1000000; count *= 10) {
+    for (int64_t mix: {kPresetMix, kSmallOnly, kPolydisperse}) {
+      for (int64_t density: {kDilute, kDense}) {
+        bench->Args({count, mix, density});
+      }
+    }
+  }
+  bench->Unit(benchmark::kMicrosecond);
+}
+
+void BM_HandleAllParticleCollisions(benchmark::State& state) {
+  GasContainer container = MakeContainer(state.range(0), state.range(1),
+                                         state.range(2));
+  for (auto _: state) {
+    container.HandleAllParticleCollisions();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  DeleteGroups(container);
+}
+BENCHMARK(BM_HandleAllParticleCollisions)->Apply(SweepArguments);
+
+void BM_UpdateWithGrid(benchmark::State& state) {
+  GasContainer container = MakeContainer(state.range(0), state.range(1),
+                                         state.range(2));
+  for (auto _: state) {
+    container.Update();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  DeleteGroups(container);
+}
+BENCHMARK(BM_UpdateWithGrid)->Apply(SweepArguments);
+
+void BM_UpdateWithVerletList(benchmark::State& state) {
+  GasContainer container = MakeContainer(state.range(0), state.range(1),
+                                         state.range(2));
+  container.SetCollisionMode(CollisionMode::kVerletList);
+  for (auto _: state) {
+    container.Update();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  DeleteGroups(container);
+}
+BENCHMARK(BM_UpdateWithVerletList)->Apply(SweepArguments);
+
+void BM_UpdateWithHierarchicalGrid(benchmark::State& state) {
+  GasContainer container = MakeContainer(state.range(0), state.range(1),
+                                         state.range(2));
+  container.SetCollisionMode(CollisionMode::kHierarchicalGrid);
+  for (auto _: state) {
+    container.Update();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  DeleteGroups(container);
+}
+BENCHMARK(BM_UpdateWithHierarchicalGrid)->Apply(SweepArguments);
+
+void BM_UpdateWithSortedGrid(benchmark::State& state) {
+  GasContainer container = MakeContainer(state.range(0), state.range(1),
+                                         state.range(2));
+  //particles move about a diameter in this many updates
+  container.SetSortInterval(10);
+  for (auto _: state) {
+    container.Update();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  DeleteGroups(container);
+}
+BENCHMARK(BM_UpdateWithSortedGrid)->Apply(SweepArguments);
+
+void BM_SortParticles(benchmark::State& state) {
+  GasContainer container = MakeContainer(state.range(0), state.range(1),
+                                         state.range(2));
+  for (auto _: state) {
+    container.SortParticles();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  DeleteGroups(container);
+}
+BENCHMARK(BM_SortParticles)->Apply(SweepArguments);
+
+void BM_AdvanceEventDriven(benchmark::State& state) {
+  GasContainer container = MakeContainer(state.range(0), kSmallOnly, kDilute);
+  container.SetSteppingMode(SteppingMode::kEventDriven);
+  //every iteration moves particles by the same time, in calls of the given
+  //length, so longer calls only save loading and predicting per call
+  const double kIterationTime = 64.0;
+  double call_time = (double) state.range(1);
+  for (auto _: state) {
+    for (double time = 0; time < kIterationTime; time += call_time) {
+      container.Advance(call_time);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  DeleteGroups(container);
+}
+BENCHMARK(BM_AdvanceEventDriven)->Apply(
+    [](benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"particles", "time"});
+  for (int64_t count = 1000; count <= 100000; count *= 10) {
+    for (int64_t time: {1, 8, 64}) {
+      bench->Args({count, time});
+    }
+  }
+  bench->Unit(benchmark::kMillisecond);
+});
+
+/**
+ * Makes a container 100 times longer than it is tall w/ the visualizer's
+ * particle mix and the same area per particle.
+ */
+GasContainer MakeThinContainer(size_t particle_count) {
+  size_t height = (size_t) std::sqrt(particle_count * kDiluteAreaPerParticle /
+                                     100.0);
+  map<Particle, size_t> particle_information;
+  size_t mid_count = particle_count * 75 / 305;
+  size_t big_count = particle_count * 30 / 305;
+  particle_information[Particle(glm::vec2(0,0), glm::vec2(0,0), 2, 5,
+                                FindNamedColor("yellow"))] = particle_count - mid_count -
+                                             big_count;
+  particle_information[Particle(glm::vec2(0,0), glm::vec2(0,0), 5, 10,
+                                FindNamedColor("magenta"))] = mid_count;
+  particle_information[Particle(glm::vec2(0,0), glm::vec2(0,0), 15, 15,
+                                FindNamedColor("cyan"))] = big_count;
+  return GasContainer(particle_information, height * 100, height);
+}
+
+void BM_UpdateThinContainer(benchmark::State& state) {
+  GasContainer container = MakeThinContainer(state.range(0));
+  container.SetCollisionMode((CollisionMode) state.range(1));
+  for (auto _: state) {
+    container.Update();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  DeleteGroups(container);
+}
+BENCHMARK(BM_UpdateThinContainer)->Apply(
+    [](benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"particles", "mode"});
+  for (int64_t count = 1000; count <= 1000000; count *= 10) {
+    for (CollisionMode mode: {CollisionMode::kUniformGrid,
+                              CollisionMode::kHierarchicalGrid,
+                              CollisionMode::kSweepAndPrune}) {
+      bench->Args({count, (int64_t) mode});
+    }
+  }
+  bench->Unit(benchmark::kMicrosecond);
+});
+
+void BM_UpdatePositions(benchmark::State& state) {
+  GasContainer container = MakeContainer(state.range(0), state.range(1),
+                                         state.range(2));
+  for (auto _: state) {
+    for (ParticleGroup* group: container.GetParticleGroups()) {
+      group->UpdatePositions();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  DeleteGroups(container);
+}
+BENCHMARK(BM_UpdatePositions)->Apply(SweepArguments);
+
+void BM_HandlePossibleWallCollisions(benchmark::State& state) {
+  GasContainer container = MakeContainer(state.range(0), state.range(1),
+                                         state.range(2));
+  for (auto _: state) {
+    for (ParticleGroup* group: container.GetParticleGroups()) {
+      group->HandlePossibleWallCollisions();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  DeleteGroups(container);
+}
+BENCHMARK(BM_HandlePossibleWallCollisions)->Apply(SweepArguments);
+
+void BM_AdvanceWithWallCollisions(benchmark::State& state) {
+  GasContainer container = MakeContainer(state.range(0), state.range(1),
+                                         state.range(2));
+  for (auto _: state) {
+    for (ParticleGroup* group: container.GetParticleGroups()) {
+      group->AdvanceWithWallCollisions();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  DeleteGroups(container);
+}
+BENCHMARK(BM_AdvanceWithWallCollisions)->Apply(SweepArguments);
+
+void BM_HistogramConstruction(benchmark::State& state) {
+  GasContainer container = MakeContainer(state.range(0), state.range(1),
+                                         state.range(2));
+  for (auto _: state) {
+    for (ParticleGroup* group: container.GetParticleGroups()) {
+      IdealGasHistogram histogram(group, 10);
+      benchmark::DoNotOptimize(histogram.GetNumberParticlesAt(0));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  DeleteGroups(container);
+}
+BENCHMARK(BM_HistogramConstruction)->Apply(SweepArguments);
+
+void BM_HistogramUpdate(benchmark::State& state) {
+  GasContainer container = MakeContainer(state.range(0), state.range(1),
+                                         state.range(2));
+  vector<IdealGasHistogram> histograms;
+  for (ParticleGroup* group: container.GetParticleGroups()) {
+    histograms.push_back(IdealGasHistogram(group, 10));
+  }
+  for (auto _: state) {
+    for (IdealGasHistogram& histogram: histograms) {
+      histogram.Update();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  DeleteGroups(container);
+}
+BENCHMARK(BM_HistogramUpdate)->Apply(SweepArguments);
+
+void BM_ListAllParticles(benchmark::State& state) {
+  GasContainer container = MakeContainer(state.range(0), state.range(1),
+                                         state.range(2));
+  for (auto _: state) {
+    const vector<size_t>& all_particles = container.ListAllParticles();
+    benchmark::DoNotOptimize(all_particles.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  DeleteGroups(container);
+}
+BENCHMARK(BM_ListAllParticles)->Apply(SweepArguments);
+
+/**
+ * Makes pairs of particles at random angles and distances up to the given
+ * distance, w/ the visualizer's mid and small particle types, stored one pair
+ * after another. Pairs closer than 15 touch.
+ */
+vector<Particle> MakeNearbyPairs(size_t pair_count, double max_distance) {
+  vector<Particle> particles;
+  uint32_t random_block[4];
+  for (size_t pair = 0; pair < pair_count; pair++) {
+    idealgas::philox::GenerateBlock(0, pair, 0, random_block);
+    double angle = 6.28 * idealgas::philox::ToUnitInterval(random_block[0]);
+    double distance = max_distance *
+                      idealgas::philox::ToUnitInterval(random_block[1]);
+    glm::vec2 center(100.0 + (double) (pair % 100) * 40.0,
+                     100.0 + (double) (pair / 100 % 100) * 40.0);
+    glm::vec2 offset(distance * std::cos(angle), distance * std::sin(angle));
+    particles.push_back(Particle(center, glm::vec2(1.5,-0.5), 5, 10,
+                                 FindNamedColor("magenta")));
+    particles.push_back(Particle(center + offset, glm::vec2(-0.25,2.0), 2, 5,
+                                 FindNamedColor("yellow")));
+  }
+  return particles;
+}
+
+/**
+ * Runs precision benchmarks over a range of particle counts.
+ */
+void PrecisionArguments(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"particles"});
+  for (int64_t count = 1000; count <= 1000000; count *= 10) {
+    bench->Arg(count);
+  }
+  bench->Unit(benchmark::kMicrosecond);
+}
+
+//float particles w/ size_t mass and radius, as collided by the simulator
+void BM_ResolveParticleCollisions(benchmark::State& state) {
+  vector<Particle> particles = MakeNearbyPairs(state.range(0) / 2, 15.0);
+  for (auto _: state) {
+    for (size_t index = 0; index + 1 < particles.size(); index += 2) {
+      bool colliding = idealgas::particleutils::ParticleCollisionExists(
+          particles[index], particles[index + 1]);
+      benchmark::DoNotOptimize(colliding);
+      idealgas::particleutils::ResolveParticleCollision(particles[index],
+                                                        particles[index + 1]);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["bytes_per_particle"] = sizeof(Particle);
+}
+BENCHMARK(BM_ResolveParticleCollisions)->Apply(PrecisionArguments);
+
+void BM_CollideParticles(benchmark::State& state) {
+  vector<Particle> particles = MakeNearbyPairs(state.range(0) / 2, 15.0);
+  for (auto _: state) {
+    for (size_t index = 0; index + 1 < particles.size(); index += 2) {
+      bool colliding = idealgas::particleutils::CollideParticles(
+          particles[index], particles[index + 1]);
+      benchmark::DoNotOptimize(colliding);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CollideParticles)->Apply(PrecisionArguments);
+
+void BM_CollidePairs(benchmark::State& state) {
+  using idealgas::particlekernels::KernelLevel;
+  KernelLevel level = (KernelLevel) state.range(1);
+  if (level == KernelLevel::kAvx2 &&
+      idealgas::particlekernels::FindBestKernelLevel() != KernelLevel::kAvx2) {
+    state.SkipWithError("AVX2 not supported");
+    return;
+  }
+
+  //about as many candidate pairs touch as for grid neighbors
+  vector<Particle> particles = MakeNearbyPairs(state.range(0) / 2, 45.0);
+  vector<float> x_positions, y_positions, x_velocities, y_velocities;
+  vector<float> masses, radii;
+  vector<size_t> first_particles, second_particles;
+  for (size_t index = 0; index < particles.size(); index++) {
+    x_positions.push_back(particles[index].position.x);
+    y_positions.push_back(particles[index].position.y);
+    x_velocities.push_back(particles[index].velocity.x);
+    y_velocities.push_back(particles[index].velocity.y);
+    masses.push_back((float) particles[index].mass);
+    radii.push_back((float) particles[index].radius);
+    if (index % 2 == 1) {
+      first_particles.push_back(index - 1);
+      second_particles.push_back(index);
+    }
+  }
+  idealgas::particlekernels::CollisionArrays arrays = {
+      x_positions.data(), y_positions.data(), x_velocities.data(),
+      y_velocities.data(), masses.data(), radii.data()};
+
+  for (auto _: state) {
+    size_t collision_count = idealgas::particlekernels::CollidePairs(
+        level, arrays, first_particles.data(), second_particles.data(),
+        first_particles.size());
+    benchmark::DoNotOptimize(collision_count);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CollidePairs)->Apply([](benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"particles", "level"});
+  for (int64_t count = 1000; count <= 1000000; count *= 10) {
+    for (int64_t level = 0; level <= 2; level++) {
+      bench->Args({count, level});
+    }
+  }
+  bench->Unit(benchmark::kMicrosecond);
+});
+
+template <typename Precision>
+void BM_ResolvePreciseCollisions(benchmark::State& state) {
+  vector<Particle> pairs = MakeNearbyPairs(state.range(0) / 2, 15.0);
+  vector<PreciseParticle<Precision>> particles;
+  for (const Particle& particle: pairs) {
+    particles.push_back(PreciseParticle<Precision>::FromParticle(particle));
+  }
+  for (auto _: state) {
+    for (size_t index = 0; index + 1 < particles.size(); index += 2) {
+      bool colliding = idealgas::particleutils::ParticleCollisionExists(
+          particles[index], particles[index + 1]);
+      benchmark::DoNotOptimize(colliding);
+      idealgas::particleutils::ResolveParticleCollision(particles[index],
+                                                        particles[index + 1]);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["bytes_per_particle"] = sizeof(PreciseParticle<Precision>);
+}
+BENCHMARK_TEMPLATE(BM_ResolvePreciseCollisions, Float32Precision)
+    ->Apply(PrecisionArguments);
+BENCHMARK_TEMPLATE(BM_ResolvePreciseCollisions, Float64Precision)
+    ->Apply(PrecisionArguments);
+BENCHMARK_TEMPLATE(BM_ResolvePreciseCollisions, FixedPoint32Precision)
+    ->Apply(PrecisionArguments);
+
+template <typename Precision>
+void BM_ReflectAndAdvancePrecise(benchmark::State& state) {
+  vector<Particle> pairs = MakeNearbyPairs(state.range(0) / 2, 15.0);
+  vector<PreciseParticle<Precision>> particles;
+  for (const Particle& particle: pairs) {
+    particles.push_back(PreciseParticle<Precision>::FromParticle(particle));
+  }
+  typename Precision::Scalar wall = Precision::FromDouble(4100.0);
+  for (auto _: state) {
+    idealgas::particleutils::ReflectAndAdvance(particles.data(),
+                                               particles.size(), wall, wall);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["bytes_per_particle"] = sizeof(PreciseParticle<Precision>);
+}
+BENCHMARK_TEMPLATE(BM_ReflectAndAdvancePrecise, Float32Precision)
+    ->Apply(PrecisionArguments);
+BENCHMARK_TEMPLATE(BM_ReflectAndAdvancePrecise, Float64Precision)
+    ->Apply(PrecisionArguments);
+BENCHMARK_TEMPLATE(BM_ReflectAndAdvancePrecise, FixedPoint32Precision)
+    ->Apply(PrecisionArguments);
+
+/**
+ * Runs precise container benchmarks over particle counts whose dilute
+ * containers still fit in the 32768 pixels fixed point numbers reach.
+ */
+void PreciseContainerArguments(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"particles"});
+  for (int64_t count = 1000; count <= 100000; count *= 10) {
+    bench->Arg(count);
+  }
+  bench->Unit(benchmark::kMicrosecond);
+}
+
+//whole updates, to compare against the float container's fixed steps
+template <typename Precision>
+void BM_UpdatePreciseContainer(benchmark::State& state) {
+  GasContainer container = MakeContainer(state.range(0), kPresetMix, kDilute);
+  PreciseGasContainer<Precision> precise_container(
+      container.GetParticleGroups());
+  for (auto _: state) {
+    precise_container.Update();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["bytes_per_particle"] = sizeof(PreciseParticle<Precision>);
+  DeleteGroups(container);
+}
+BENCHMARK_TEMPLATE(BM_UpdatePreciseContainer, Float32Precision)
+    ->Apply(PreciseContainerArguments);
+BENCHMARK_TEMPLATE(BM_UpdatePreciseContainer, Float64Precision)
+    ->Apply(PreciseContainerArguments);
+BENCHMARK_TEMPLATE(BM_UpdatePreciseContainer, FixedPoint32Precision)
+    ->Apply(PreciseContainerArguments);
+
+} // namespace
+
+/**
+ * Runs all benchmarks, printing JSON results unless another format is given.
+ */
+int main(int argc, char** argv) {
+  vector<char*> arguments(argv, argv + argc);
+  bool format_given = false;
+  for (int index = 1; index < argc; index++) {
+    format_given |= std::strncmp(argv[index], "--benchmark_format", 18) == 0;
+  }
+  char json_format[] = "--benchmark_format=json";
+  if (!format_given) {
+    arguments.push_back(json_format);
+  }
+
+  int argument_count = (int) arguments.size();
+  benchmark::Initialize(&argument_count, arguments.data());
+  if (benchmark::ReportUnrecognizedArguments(argument_count,
+                                             arguments.data())) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
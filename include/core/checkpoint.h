@@ -0,0 +1,221 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/gas_container.h"
+#include "core/particle_group.h"
+
+namespace idealgas {
+
+using std::string;
+using std::vector;
+
+/**
+ * Start of a checkpoint file.
+ *
+ * A checkpoint file is the header, then one CheckpointGroup per particle
+ * group, then the particle arrays of every group. Each group's arrays are its
+ * x positions, y positions, x velocities and y velocities as floats, one
+ * after the other, starting at a multiple of kCheckpointAlignment. Numbers
+ * are stored in the byte order of the machine that wrote the file.
+ */
+struct CheckpointHeader {
+  char magic[8];            //always kCheckpointMagic
+  uint32_t version;         //kCheckpointVersion when written
+  uint32_t byte_order;      //kCheckpointByteOrder as written
+  uint64_t group_count;
+  uint64_t container_width;
+  uint64_t container_height;
+  uint64_t step_count;      //number of updates done before saving
+  uint64_t file_size;
+  uint64_t reserved;
+};
+
+/**
+ * Description of one particle group in a checkpoint file.
+ */
+struct CheckpointGroup {
+  uint64_t particle_count;
+  uint64_t particle_mass;
+  uint64_t particle_radius;
+  float color[4];           //red, green, blue, unused
+  double max_x_position;
+  double max_y_position;
+  uint64_t arrays_offset;   //where the group's arrays start in the file
+};
+
+static_assert(sizeof(CheckpointHeader) == 64, "header layout changed");
+static_assert(sizeof(CheckpointGroup) == 64, "group layout changed");
+
+const char kCheckpointMagic[8] = {'I', 'G', 'A', 'S', 'C', 'K', 'P', 'T'};
+const uint32_t kCheckpointVersion = 1;
+const uint32_t kCheckpointByteOrder = 0x01020304;
+const size_t kCheckpointAlignment = 64;
+
+/**
+ * Saves checkpoints of a gas container on a background thread. Saving only
+ * stops the caller for as long as it takes to copy the particle arrays, so
+ * stepping can continue while the file is written.
+ *
+ * Files are first written under a temporary name, then renamed, so an
+ * interrupted save never replaces the last complete checkpoint.
+ */
+class CheckpointWriter {
+  public:
+    /**
+     * Default constructor for a Checkpoint Writer.
+     */
+    CheckpointWriter() = default;
+
+    /**
+     * Destructor for a Checkpoint Writer, waits for any save to finish and
+     * stops the write thread.
+     */
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    /**
+     * Copies the current state of the container, then writes it to the given
+     * file in the background. Never waits for an earlier save: if one is
+     * still being written, this save is queued behind it, replacing any
+     * queued save that hasn't started yet.
+     *
+     * @param container     the container to save.
+     * @param step_count    the number of updates done so far.
+     * @param path          the file to write the checkpoint to.
+     */
+    void SaveAsync(const GasContainer& container, uint64_t step_count,
+                   const string& path);
+
+    /**
+     * Waits for the last save to finish.
+     *
+     * @return true if every save so far was written successfully, else false.
+     */
+    bool Wait();
+
+    /**
+     * Fetches the number of queued saves replaced by a newer save before
+     * they were written.
+     *
+     * @return the number of replaced saves.
+     */
+    size_t GetReplacedSaveCount();
+
+  private:
+    vector<char> next_contents_;    //image being filled by SaveAsync
+
+    //state shared w/ the write thread, guarded by the mutex
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    vector<char> queued_contents_;  //image waiting to be written
+    string queued_path_;
+    bool save_queued_ = false;
+    bool writing_ = false;
+    bool stopping_ = false;
+    bool write_succeeded_ = true;
+    size_t replaced_save_count_ = 0;
+    std::thread write_thread_;
+
+    //state only used by the write thread
+    vector<char> file_contents_;    //image of the file being written
+
+    /**
+     * Writes queued saves until the writer is destroyed.
+     */
+    void RunWriter();
+
+    /**
+     * Writes the file contents under a temporary name, flushes them to disk,
+     * then renames the file over the given path.
+     *
+     * @return true if the file was written and renamed, else false.
+     */
+    bool WriteFile(const string& path);
+};
+
+/**
+ * A checkpoint file mapped into memory. Header, groups and particle arrays
+ * are read straight from the mapping w/o any parsing.
+ */
+class MappedCheckpoint {
+  public:
+    /**
+     * Default constructor for a Mapped Checkpoint w/ no file open.
+     */
+    MappedCheckpoint() = default;
+
+    /**
+     * Destructor for a Mapped Checkpoint, unmaps the file.
+     */
+    ~MappedCheckpoint();
+
+    MappedCheckpoint(const MappedCheckpoint&) = delete;
+    MappedCheckpoint& operator=(const MappedCheckpoint&) = delete;
+
+    /**
+     * Maps the given checkpoint file, replacing any file already open.
+     *
+     * @param path  the checkpoint file to open.
+     *
+     * @return true if the file is a complete checkpoint of a supported
+     *         version, else false.
+     */
+    bool Open(const string& path);
+
+    /**
+     * Unmaps the open file, if any.
+     */
+    void Close();
+
+    /**
+     * Fetches the header of the open file.
+     *
+     * @return the checkpoint header.
+     */
+    const CheckpointHeader& GetHeader() const;
+
+    /**
+     * Fetches the description of a group in the open file.
+     *
+     * @param index the index of the group.
+     *
+     * @return the group description.
+     */
+    const CheckpointGroup& GetGroup(size_t index) const;
+
+    /**
+     * Fetches one of the particle arrays of a group in the open file.
+     *
+     * @param index the index of the group.
+     * @param array 0 for x positions, 1 for y positions, 2 for x velocities
+     *              or 3 for y velocities.
+     *
+     * @return the first value of the array.
+     */
+    const float* GetGroupArray(size_t index, size_t array) const;
+
+    /**
+     * Creates new particle groups holding the particles of the open file.
+     *
+     * @return the restored groups, owned by the caller.
+     */
+    vector<ParticleGroup*> CreateGroups() const;
+
+  private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+
+    /**
+     * Checks that the mapped data is a complete checkpoint.
+     */
+    bool IsValid() const;
+};
+
+} // namespace idealgas
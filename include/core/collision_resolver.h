@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vector>
+#include "core/particle.h"
+#include "core/worker_pool.h"
+
+namespace idealgas {
+
+using std::vector;
+using idealgas::Particle;
+
+/**
+ * Two positions in a particle list whose particles are touching. The first
+ * index always comes after the other index in the list.
+ */
+struct ContactPair {
+  size_t index;
+  size_t other_index;
+};
+
+/**
+ * Resolves collisions between touching particles, possibly in parallel.
+ *
+ * Collisions are resolved in the order of the contact list, which matters
+ * when a particle touches several others. Contacts are split into chains that
+ * share no particles with each other; each chain is resolved in order on one
+ * thread, while separate chains are resolved in parallel. This gives exactly
+ * the same result as resolving every contact in order on one thread.
+ *
+ * In containers w/ walls, the particles of all contacts are copied into
+ * arrays and every batch of chains goes through the batched pair kernel,
+ * particlekernels::CollidePairs, which checks several pairs at once.
+ */
+class CollisionResolver {
+  public:
+    /**
+     * Default constructor for a Collision Resolver.
+     */
+    CollisionResolver() = default;
+
+    /**
+     * Resolves every contact whose particles are moving towards each other.
+     *
+     * @param contacts      touching pairs, sorted by index then other index.
+     * @param particles     storage of all particles.
+     * @param particle_list storage index of every position in the list. The
+     *                      same particle may appear more than once.
+     * @param pool          the threads to resolve chains of contacts with.
+     * @param period        the distances after which x and y positions
+     *                      repeat in a container whose edges wrap around, 0
+     *                      on axes w/ walls.
+     */
+    void ResolveContacts(const vector<ContactPair>& contacts,
+                         vector<Particle>& particles,
+                         const vector<size_t>& particle_list,
+                         WorkerPool& pool, const vec2& period = vec2(0, 0));
+
+    /**
+     * Fetches the number of contacts resolved by the last call to
+     * ResolveContacts, ie. whose particles were moving towards each other.
+     *
+     * @return the number of resolved collisions.
+     */
+    size_t GetResolvedCount() const;
+
+  private:
+    //fewest contacts worth splitting into chains for multiple threads
+    static const size_t kMinParallelContacts = 256;
+    //number of batches of chains to make per thread, for load balancing
+    static const size_t kBatchesPerThread = 4;
+
+    vector<size_t> chain_parents_;     //union-find parent of each particle
+    vector<size_t> chain_numbers_;     //chain number of each chain's root
+    vector<size_t> contact_chains_;    //chain number of each contact
+    vector<size_t> chain_starts_;      //where each chain begins in the order
+    vector<size_t> next_slots_;        //next free slot of each chain
+    vector<size_t> ordered_contacts_;  //contact indices grouped by chain
+    vector<size_t> batch_starts_;      //first chain of each batch of chains
+    vector<size_t> batch_resolved_counts_;  //collisions resolved per batch
+    size_t resolved_count_ = 0;
+
+    //arguments of the current ResolveContacts call, for parallel tasks
+    const vector<ContactPair>* contacts_ = nullptr;
+    vector<Particle>* particles_ = nullptr;
+    const vector<size_t>* particle_list_ = nullptr;
+    vec2 period_ = vec2(0, 0);
+    bool batched_ = false;  //if contacts go through the pair kernel
+
+    //state of touching particles by storage index, and the storage indices
+    //of every contact's particles in resolving order, for the pair kernel
+    vector<float> x_positions_;
+    vector<float> y_positions_;
+    vector<float> x_velocities_;
+    vector<float> y_velocities_;
+    vector<float> masses_;
+    vector<float> radii_;
+    vector<size_t> first_particles_;
+    vector<size_t> second_particles_;
+
+    /**
+     * Resolves the contacts in a range of slots of ordered_contacts_, in
+     * order.
+     *
+     * @return the number of contacts resolved.
+     */
+    size_t ResolveSlots(size_t first_slot, size_t last_slot);
+
+    /**
+     * Copies the particles of every contact into the pair kernel's arrays
+     * and lists the contacts' particles in the order of ordered_contacts_.
+     */
+    void GatherContactParticles(const vector<ContactPair>& contacts,
+                                const vector<Particle>& particles,
+                                const vector<size_t>& particle_list);
+
+    /**
+     * Copies the velocities of every contact's particles back from the
+     * pair kernel's arrays.
+     */
+    void StoreContactVelocities(vector<Particle>& particles);
+
+    /**
+     * Finds the root particle of the chain containing the given particle.
+     */
+    size_t FindChainRoot(size_t particle);
+
+    /**
+     * Splits contacts into chains that share no particles, and chains into
+     * batches with roughly equal numbers of contacts.
+     */
+    void BuildChains(const vector<ContactPair>& contacts, size_t particle_count,
+                     const vector<size_t>& particle_list, size_t batch_count);
+};
+
+} // namespace idealgas
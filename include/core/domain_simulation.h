@@ -0,0 +1,279 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "core/domain_transport.h"
+#include "core/gas_container.h"
+#include "core/particle.h"
+#include "core/particle_group.h"
+#include "core/uniform_grid.h"
+
+namespace idealgas {
+
+using std::map;
+using std::vector;
+
+/**
+ * One particle as kept and sent between domains, w/ the position it has in
+ * the particle list of the whole container, so domains can order their
+ * particles the same way a single container does.
+ */
+struct DomainParticle {
+  uint32_t id;              //list position in the whole container
+  uint32_t group_index;
+  float x_position;
+  float y_position;
+  float x_velocity;
+  float y_velocity;
+};
+
+static_assert(sizeof(DomainParticle) == 24, "domain particle layout changed");
+
+/**
+ * The part of a gas container owned by one domain of a simulation split
+ * across processes. The container is cut into equal strips along its longer
+ * axis, and every domain owns the particles in its strip.
+ *
+ * Each update, domains trade halos, copies of their particles close enough
+ * to another strip to touch its particles, then update their own particles
+ * together w/ the copies. A collision can change a particle several touches
+ * away through a chain of touching particles, so the halo is made deeper
+ * and the update retried while any chain reaching an owned particle might
+ * go past the halo. Touching pairs are then resolved in the same order as
+ * in a single container, and results are identical. Particles that left
+ * their strip are sent to their new owner afterwards.
+ */
+class DomainSimulation {
+  public:
+    /**
+     * Constructor for the domain of the transport's rank. Particles are
+     * placed the same way a Gas Container places them for the same seed,
+     * one at a time, and only the ones in this domain's strip are kept.
+     *
+     * @param particle_information  map w/ particle info + count
+     *
+     * @param container_width       the width in pixels of the container.
+     * @param container_height      the height in pixels of the container.
+     *
+     * @param seed                  the seed for placing particles.
+     * @param transport             the transport to the other domains, must
+     *                              outlive this domain.
+     * @param thread_count          the number of threads to handle
+     *                              collisions w/.
+     */
+    DomainSimulation(const map<Particle, size_t>& particle_information,
+                     size_t container_width, size_t container_height,
+                     uint64_t seed, DomainTransport* transport,
+                     size_t thread_count = 1);
+
+    /**
+     * Destructor for a Domain Simulation.
+     */
+    ~DomainSimulation();
+
+    DomainSimulation(const DomainSimulation&) = delete;
+    DomainSimulation& operator=(const DomainSimulation&) = delete;
+
+    /**
+     * Updates the particles' movement after one unit of time. Every domain
+     * must update together.
+     *
+     * @return true if all messages were traded, else false.
+     */
+    bool Update();
+
+    /**
+     * Sets how pairs of possibly colliding particles are found. The particles
+     * of a domain change every update, so Verlet lists would be rebuilt
+     * every time, and the uniform grid is used instead.
+     *
+     * @param mode the collision mode to use for following updates.
+     */
+    void SetCollisionMode(CollisionMode mode);
+
+    /**
+     * Sets how many threads handle particle collisions in this domain.
+     *
+     * @param thread_count  the number of threads to use, including the thread
+     *                      calling Update.
+     */
+    void SetThreadCount(size_t thread_count);
+
+    /**
+     * Collects the particles of every domain into groups like the ones of a
+     * single container, w/ particles in the same order. Every domain must
+     * gather together, and only rank 0 gets the groups.
+     *
+     * @param groups  the vector to fill w/ new groups on rank 0, to be
+     *                deleted by the caller. Left empty on other ranks.
+     *
+     * @return true if all messages were traded, else false.
+     */
+    bool GatherParticleGroups(vector<ParticleGroup*>& groups);
+
+    /**
+     * Fetches the particles this domain owns.
+     *
+     * @return the owned particles, ordered by id.
+     */
+    const vector<DomainParticle>& GetOwnedParticles() const;
+
+    /**
+     * Fetches the number of times an update was retried w/ a deeper halo.
+     *
+     * @return the retry count, the same on every domain.
+     */
+    size_t GetHaloRetryCount() const;
+
+    /**
+     * Fetches the number of particles this domain sent to other domains
+     * after they left its strip.
+     *
+     * @return the migration count.
+     */
+    size_t GetMigrationCount() const;
+
+  private:
+    //halo depth of the first try, in largest distances between colliding
+    //particles
+    static const size_t kHaloContactDistances = 4;
+
+    DomainTransport* transport_;
+    size_t rank_ = 0;
+    size_t domain_count_ = 1;
+
+    size_t container_width_ = 0;
+    size_t container_height_ = 0;
+    bool splits_along_y_ = false;
+    double strip_length_ = 0;
+    double contact_distance_ = 0;   //largest distance of colliding particles
+
+    size_t halo_retry_count_ = 0;
+    size_t migration_count_ = 0;
+
+    //empty groups w/ each group's attributes, filled w/ the local particles
+    //to update them
+    vector<ParticleGroup*> local_groups_;
+    GasContainer local_container_;
+
+    vector<DomainParticle> owned_particles_;      //ordered by id
+    vector<DomainParticle> halo_particles_;       //ordered by id
+    vector<DomainParticle> local_particles_;      //owned and halo, by id
+    vector<bool> local_owned_;                    //if owned, by local index
+
+    //scratch kept between updates, so a steady update doesn't allocate
+    vector<vector<unsigned char>> outgoing_messages_;   //by rank
+    vector<vector<unsigned char>> incoming_messages_;   //by rank
+    vector<float> group_x_positions_;
+    vector<float> group_y_positions_;
+    vector<float> group_x_velocities_;
+    vector<float> group_y_velocities_;
+    vector<size_t> group_cursors_;
+    vector<Particle> chain_particles_;
+    vector<size_t> chain_list_;
+    vector<size_t> chain_roots_;
+    vector<bool> chain_owned_;
+    vector<bool> chain_frontier_;
+    vector<bool> frontier_roots_;
+    vector<size_t> neighbors_;
+    UniformGrid chain_grid_;
+
+    /**
+     * Sends every other domain the owned particles within the halo width of
+     * its strip, then lists the particles received together w/ the owned
+     * particles in local_particles_.
+     *
+     * @param halo_width  the distance from a strip to send particles within.
+     *
+     * @return true if all messages were traded, else false.
+     */
+    bool ExchangeHalos(double halo_width);
+
+    /**
+     * Checks if every chain of touching particles reaching an owned particle
+     * is known to this domain. A chain might go past the halo if it reaches
+     * a halo particle close enough to the halo's edge to touch particles
+     * outside of it. Owned particles only join a chain from past the halo
+     * through halo particles, so only particles near the strip's edges are
+     * checked.
+     *
+     * @param halo_width  the width of the received halo.
+     *
+     * @return true if all chains are known, else false.
+     */
+    bool ContactChainsComplete(double halo_width);
+
+    /**
+     * Tells every domain if this domain could update, and finds out if all
+     * domains could.
+     *
+     * @param complete      if this domain could update.
+     * @param all_complete  set to whether every domain could update.
+     *
+     * @return true if all messages were traded, else false.
+     */
+    bool AgreeOnAll(bool complete, bool& all_complete);
+
+    /**
+     * Updates the owned and halo particles together, then keeps the new
+     * state of the owned particles.
+     */
+    void UpdateLocalParticles();
+
+    /**
+     * Sends owned particles that left this domain's strip to their new
+     * owners and takes in the ones that entered it.
+     *
+     * @return true if all messages were traded, else false.
+     */
+    bool MigrateParticles();
+
+    /**
+     * Sends outgoing_messages_ to every other domain and fills
+     * incoming_messages_ w/ their messages. Pairs of domains trade in order
+     * of their lower then higher rank, w/ the lower rank sending first, so
+     * no two domains ever wait on each other.
+     *
+     * @return true if all messages were traded, else false.
+     */
+    bool ExchangeWithAllDomains();
+
+    /**
+     * Finds the rank of the domain whose strip holds a particle. Particles
+     * outside of the container belong to the closest strip.
+     */
+    size_t FindOwner(const DomainParticle& particle) const;
+
+    /**
+     * Finds how far a particle is from a domain's strip, 0 if in it.
+     */
+    double FindDistanceToStrip(const DomainParticle& particle,
+                               size_t domain) const;
+
+    /**
+     * Finds how far an owned particle is from the closest edge of this
+     * domain's strip shared w/ another strip.
+     */
+    double FindDistanceToStripEdge(const DomainParticle& particle) const;
+
+    /**
+     * Finds the position of a particle along the axis the container is cut
+     * along.
+     */
+    double FindSplitCoordinate(const DomainParticle& particle) const;
+
+    /**
+     * Adds the bytes of every particle in a range to a message.
+     */
+    static void AppendParticles(const DomainParticle* particles, size_t count,
+                                vector<unsigned char>& message);
+
+    /**
+     * Adds the particles in a message to the end of a vector.
+     */
+    static void ReadParticles(const vector<unsigned char>& message,
+                              vector<DomainParticle>& particles);
+};
+
+} // namespace idealgas
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+namespace idealgas {
+
+using std::vector;
+
+/**
+ * Carries messages between the domains of a simulation split across
+ * processes. Every domain has a rank, and messages between two ranks arrive
+ * in the order they were sent.
+ */
+class DomainTransport {
+  public:
+    virtual ~DomainTransport() = default;
+
+    /**
+     * Fetches the rank of the domain using this transport.
+     *
+     * @return the rank, from 0 to the domain count.
+     */
+    virtual size_t GetRank() const = 0;
+
+    /**
+     * Fetches the number of domains connected by this transport.
+     *
+     * @return the domain count.
+     */
+    virtual size_t GetDomainCount() const = 0;
+
+    /**
+     * Sends a message to another domain. May wait until the other domain
+     * starts receiving it.
+     *
+     * @param peer    the rank of the domain to send to.
+     * @param message the bytes to send, may be empty.
+     *
+     * @return true if the message was sent, else false.
+     */
+    virtual bool Send(size_t peer, const vector<unsigned char>& message) = 0;
+
+    /**
+     * Waits for the next message from another domain.
+     *
+     * @param peer    the rank of the domain to receive from.
+     * @param message the vector to fill w/ the received bytes.
+     *
+     * @return true if a whole message was received, else false.
+     */
+    virtual bool Receive(size_t peer, vector<unsigned char>& message) = 0;
+};
+
+/**
+ * Transport between domains on one machine over pairs of connected Unix
+ * sockets. All transports are made together before starting the domains,
+ * either on threads of one process or in processes forked afterwards.
+ */
+class SocketTransport : public DomainTransport {
+  public:
+    /**
+     * Makes a connected transport for every domain.
+     *
+     * @param domain_count  the number of domains to connect.
+     * @param transports    the vector to fill w/ one transport per rank.
+     *
+     * @return true if all sockets could be made, else false.
+     */
+    static bool CreateLocal(size_t domain_count,
+                            vector<std::unique_ptr<SocketTransport>>&
+                                transports);
+
+    /**
+     * Destructor for a Socket Transport, closes its sockets.
+     */
+    ~SocketTransport() override;
+
+    SocketTransport(const SocketTransport&) = delete;
+    SocketTransport& operator=(const SocketTransport&) = delete;
+
+    size_t GetRank() const override;
+    size_t GetDomainCount() const override;
+    bool Send(size_t peer, const vector<unsigned char>& message) override;
+    bool Receive(size_t peer, vector<unsigned char>& message) override;
+
+  private:
+    size_t rank_;
+    vector<int> peer_sockets_;  //socket to each rank, -1 for this rank
+
+    /**
+     * Constructor for a Socket Transport w/o any sockets yet.
+     */
+    SocketTransport(size_t rank, size_t domain_count);
+};
+
+} // namespace idealgas
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "core/gas_container.h"
+#include "core/worker_pool.h"
+
+namespace idealgas {
+
+using std::map;
+using std::vector;
+
+/**
+ * Settings of one independent simulation run by an Ensemble Runner.
+ */
+struct EnsembleSettings {
+  map<Particle, size_t> particle_information;  //group particle -> count
+  size_t container_width = 600;
+  size_t container_height = 800;
+  size_t step_count = 1000;
+  CollisionMode collision_mode = CollisionMode::kUniformGrid;
+  SteppingMode stepping_mode = SteppingMode::kFixedStep;
+  uint64_t seed = 0;                           //seed for placing particles
+};
+
+/**
+ * Statistics of one particle group at the end of an ensemble.
+ */
+struct GroupSummary {
+  size_t particle_mass;
+  size_t particle_radius;
+  size_t particle_count;
+  double mean_speed;
+  double kinetic_energy;
+};
+
+/**
+ * Statistics of one ensemble, reported once it has finished.
+ */
+struct EnsembleSummary {
+  size_t ensemble;        //index the ensemble was added at
+  size_t step_count;
+  double seconds;         //time spent stepping this ensemble
+  vector<GroupSummary> groups;
+};
+
+/**
+ * Runs many small independent simulations in one process.
+ *
+ * Every thread has its own queue of ensembles to run, and a thread that runs
+ * out of work steals from the back of another thread's queue, so threads stay
+ * busy even when ensembles take very different amounts of time. Each ensemble
+ * is stepped on one thread, so its results don't depend on the thread count.
+ */
+class EnsembleRunner {
+  public:
+    /**
+     * Constructor for an Ensemble Runner.
+     *
+     * @param thread_count  the number of threads to run ensembles on,
+     *                      including the thread calling Run.
+     */
+    explicit EnsembleRunner(size_t thread_count);
+
+    EnsembleRunner(const EnsembleRunner&) = delete;
+    EnsembleRunner& operator=(const EnsembleRunner&) = delete;
+
+    /**
+     * Adds an ensemble to run. Its particles are only placed once it starts
+     * running, by the thread that runs it.
+     *
+     * @param settings  the settings of the ensemble.
+     *
+     * @return the index of the ensemble, used in its summary.
+     */
+    size_t AddEnsemble(const EnsembleSettings& settings);
+
+    /**
+     * Runs all added ensembles and removes them from this runner. The
+     * callback is called once per ensemble as soon as it finishes, never by
+     * two threads at once, so ensembles are reported in finishing order.
+     *
+     * @param on_finished   called w/ the summary of every finished ensemble.
+     */
+    void Run(const std::function<void(const EnsembleSummary&)>& on_finished);
+
+    /**
+     * Fetches the number of ensembles waiting to be run.
+     *
+     * @return the number of added ensembles.
+     */
+    size_t GetEnsembleCount() const;
+
+  private:
+    /**
+     * Ensembles waiting to run on one thread, also taken from by others.
+     */
+    struct WorkQueue {
+      std::mutex mutex;
+      std::deque<size_t> ensembles;
+    };
+
+    WorkerPool worker_pool_;
+    vector<EnsembleSettings> ensembles_;
+    vector<std::unique_ptr<WorkQueue>> work_queues_;
+
+    //callback of the current Run, only called while holding report_mutex_
+    const std::function<void(const EnsembleSummary&)>* on_finished_ = nullptr;
+    std::mutex report_mutex_;
+
+    /**
+     * Runs ensembles from the given thread's queue, then steals from the
+     * other queues until every queue is empty.
+     *
+     * @param worker    the index of the thread's own queue.
+     */
+    void RunQueues(size_t worker);
+
+    /**
+     * Takes the next ensemble for the given thread.
+     *
+     * @param worker    the index of the thread's own queue.
+     * @param ensemble  set to the index of the taken ensemble.
+     *
+     * @return true if an ensemble was taken, else false if all are taken.
+     */
+    bool TakeEnsemble(size_t worker, size_t& ensemble);
+
+    /**
+     * Creates one ensemble, steps it to the end, reports it and deletes its
+     * groups.
+     *
+     * @param ensemble  the index of the ensemble to run.
+     */
+    void RunEnsemble(size_t ensemble);
+};
+
+} // namespace idealgas
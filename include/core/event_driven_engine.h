@@ -0,0 +1,265 @@
+#pragma once
+
+#include <vector>
+#include "core/particle_group.h"
+
+namespace idealgas {
+
+using std::vector;
+using idealgas::ParticleGroup;
+
+/**
+ * Kinds of events the event driven engine schedules.
+ */
+enum class EventType {
+  kParticleCollision,  //two particles touch while moving towards each other
+  kVerticalWall,       //a particle reaches the left or right wall
+  kHorizontalWall,     //a particle reaches the top or bottom wall
+  kColumnCrossing,     //a particle moves into the next grid column
+  kRowCrossing         //a particle moves into the next grid row
+};
+
+/**
+ * A predicted event, only valid while the collision counts of its particles
+ * are still the same as when it was predicted.
+ */
+struct CollisionEvent {
+  double time;
+  size_t sequence;        //order of prediction, breaks ties in time
+  EventType type;
+  size_t particle;
+  size_t other_particle;  //only used for particle collisions
+  size_t particle_collisions;
+  size_t other_collisions;
+};
+
+/**
+ * Orders events so the earliest one is at the top of a priority queue.
+ */
+struct LaterEvent {
+  bool operator()(const CollisionEvent& lhs, const CollisionEvent& rhs) const;
+};
+
+/**
+ * Moves particles by predicting the exact times of particle and wall
+ * collisions and jumping straight from one collision to the next, so fast
+ * particles can never pass through each other between steps.
+ *
+ * Predicted events are kept in a priority queue. Instead of removing events
+ * made invalid by a collision, every particle counts its collisions and an
+ * event is skipped if a count changed since it was predicted. Particles are
+ * only checked against particles in neighboring cells of a grid, and moving
+ * into a new cell is an event of its own. In a container whose edges wrap
+ * around, there are no wall events, and particles crossing out of a cell on
+ * one edge move into the cell on the opposite edge.
+ */
+class EventDrivenEngine {
+  public:
+    /**
+     * Default constructor for an Event Driven Engine.
+     */
+    EventDrivenEngine() = default;
+
+    /**
+     * Moves all particles of the given groups forward by the given time,
+     * handling every collision at the moment it happens. A group listed more
+     * than once is only moved once.
+     *
+     * @param groups            the groups of particles to move.
+     * @param container_width   the width in pixels of the container.
+     * @param container_height  the height in pixels of the container.
+     * @param duration          the amount of time to move particles forward.
+     * @param wraps             if the edges of the container wrap around
+     *                          instead of being walls.
+     */
+    void Advance(const vector<ParticleGroup*>& groups, size_t container_width,
+                 size_t container_height, double duration,
+                 bool wraps = false);
+
+    /**
+     * Fetches the number of collisions handled by the last call to Advance.
+     *
+     * @return the number of particle and wall collisions.
+     */
+    size_t GetCollisionCount() const;
+
+    /**
+     * Fetches the number of collisions between two particles handled by the
+     * last call to Advance.
+     *
+     * @return the number of particle collisions.
+     */
+    size_t GetParticleCollisionCount() const;
+
+    /**
+     * Fetches the total impulse walls gave particles in the last call to
+     * Advance.
+     *
+     * @return the summed size of the momentum changes at walls.
+     */
+    double GetWallImpulse() const;
+
+  private:
+    //state of every particle, positions are at each particle's own time
+    vector<double> x_positions_;
+    vector<double> y_positions_;
+    vector<double> x_velocities_;
+    vector<double> y_velocities_;
+    vector<double> particle_times_;
+    vector<double> masses_;
+    vector<double> radii_;
+    vector<double> max_x_positions_;
+    vector<double> max_y_positions_;
+    vector<size_t> collision_counts_;
+    //time of every particle's next cell crossing, which makes all its later
+    //predictions stale, infinite if it never crosses
+    vector<double> crossing_times_;
+
+    //where every particle came from, to store results back into its group
+    vector<ParticleGroup*> source_groups_;
+    vector<size_t> source_indices_;
+
+    //marks the end of a cell's list of particles
+    static const size_t kNoParticle = static_cast<size_t>(-1);
+
+    //container size if its edges wrap around, else 0
+    double x_period_ = 0;
+    double y_period_ = 0;
+
+    //grid cells of every particle and the particles in every cell, cells
+    //are stretched to split a wrapping container evenly
+    double cell_width_ = 1.0;
+    double cell_height_ = 1.0;
+    size_t column_count_ = 0;
+    size_t row_count_ = 0;
+    vector<size_t> particle_columns_;
+    vector<size_t> particle_rows_;
+    //particles of every cell as linked lists, so moves never allocate
+    vector<size_t> cell_heads_;          //first particle of each cell
+    vector<size_t> next_in_cell_;        //next particle in the same cell
+    vector<size_t> previous_in_cell_;    //previous particle in the same cell
+
+    //heap ordered by LaterEvent, kept between advances to reuse its storage
+    vector<CollisionEvent> events_;
+    size_t next_sequence_ = 0;
+    double current_time_ = 0;
+    double end_time_ = 0;               //events after it are never handled
+    //most events per particle before stale events are dropped from the heap
+    static const size_t kEventsPerParticle = 8;
+    size_t collision_count_ = 0;
+    size_t particle_collision_count_ = 0;
+    double wall_impulse_ = 0;
+
+    /**
+     * Copies the particles of every group into the engine's state.
+     */
+    void LoadParticles(const vector<ParticleGroup*>& groups);
+
+    /**
+     * Copies positions and velocities at the current time back into groups.
+     */
+    void StoreParticles();
+
+    /**
+     * Adds a particle to the front of the list of the given cell.
+     */
+    void AddToCell(size_t particle, size_t column, size_t row);
+
+    /**
+     * Places every particle into the grid cell containing its position.
+     */
+    void BuildGrid(size_t container_width, size_t container_height);
+
+    /**
+     * Moves a particle into the given grid cell.
+     */
+    void MoveToCell(size_t particle, size_t column, size_t row);
+
+    /**
+     * Moves a particle's position forward to the current time.
+     */
+    void MoveToCurrentTime(size_t particle);
+
+    /**
+     * Predicts the next wall collision and cell crossing of a particle, and
+     * its collisions with particles in neighboring cells.
+     *
+     * @param particle          the particle to predict events for.
+     * @param only_earlier      if true, only particles with smaller indices
+     *                          are checked, so pairs aren't predicted twice.
+     */
+    void PredictEvents(size_t particle, bool only_earlier);
+
+    /**
+     * Predicts when two particles will collide, if they do before either
+     * moves into another cell.
+     */
+    void PredictParticleCollision(size_t particle, size_t other_particle);
+
+    /**
+     * Finds when a particle will reach a wall along one axis.
+     *
+     * @return the time of reaching the wall, infinite if it never does.
+     */
+    double FindWallTime(double position, double velocity,
+                        double max_position) const;
+
+    /**
+     * Finds when a particle will move into a new cell along one axis,
+     * including moving out of the container on that axis if it wraps.
+     *
+     * @return the time of the crossing, infinite if there is none.
+     */
+    double FindCrossingTime(double position, double velocity, size_t cell,
+                            size_t cell_count, double cell_length,
+                            bool wraps) const;
+
+    /**
+     * Moves a particle into the next cell along one axis, bringing it back in
+     * from the opposite edge if it left the container.
+     *
+     * @param position      the particle's position on the axis.
+     * @param velocity      the particle's velocity on the axis.
+     * @param cell          the particle's column or row, set to the new one.
+     * @param cell_count    the number of columns or rows.
+     * @param period        the container size on the axis.
+     */
+    static void CrossCell(double& position, double velocity, size_t& cell,
+                          size_t cell_count, double period);
+
+    /**
+     * Changes the offset between two particles to the offset to the closest
+     * copy of the other particle, if the container wraps around.
+     */
+    void WrapDistance(double& x_distance, double& y_distance) const;
+
+    /**
+     * Adds a newly predicted event to the queue, unless it happens after the
+     * end of the current advance.
+     */
+    void ScheduleEvent(double time, EventType type, size_t particle,
+                       size_t other_particle);
+
+    /**
+     * Checks that no particle of an event collided since it was predicted.
+     */
+    bool IsEventValid(const CollisionEvent& event) const;
+
+    /**
+     * Removes every event made stale by a later event of its particles from
+     * the heap. Events keep their order, so results don't change.
+     */
+    void DropInvalidEvents();
+
+    /**
+     * Updates particles involved in an event and predicts their next events.
+     */
+    void HandleEvent(const CollisionEvent& event);
+
+    /**
+     * Updates velocities of two touching particles in an elastic collision.
+     */
+    void ResolveParticleCollision(size_t particle, size_t other_particle);
+};
+
+} // namespace idealgas
@@ -0,0 +1,500 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+#include "core/particle.h"
+#include "core/particle_group.h"
+#include "core/hierarchical_grid.h"
+#include "core/morton_order.h"
+#include "core/sweep_and_prune.h"
+#include "core/uniform_grid.h"
+#include "core/verlet_list.h"
+#include "core/collision_resolver.h"
+#include "core/worker_pool.h"
+#include "core/event_driven_engine.h"
+#include "core/gas_observables.h"
+#include "core/update_profiler.h"
+
+namespace idealgas {
+
+using std::vector;
+using std::map;
+
+/**
+ * Ways of finding which pairs of particles need to be checked for collisions.
+ */
+enum class CollisionMode {
+  kAllPairs,   //checks every pair of particles, used as a reference
+  kUniformGrid, //only checks particles in neighboring cells of a uniform grid
+  kVerletList,  //only checks cached lists of nearby particles, see VerletList
+  kHierarchicalGrid, //checks neighboring cells in a grid level per radius,
+                     //for mixes of very different radii
+  kSweepAndPrune     //checks overlapping extents along the longer axis,
+                     //sorted incrementally between updates
+};
+
+/**
+ * Ways of moving particles forward in time.
+ */
+enum class SteppingMode {
+  kFixedStep,   //resolves touching particles, then moves by one velocity
+  kEventDriven  //jumps between exactly predicted collision times
+};
+
+/**
+ * What happens to particles at the edges of the container.
+ */
+enum class BoundaryMode {
+  kReflecting,  //edges are walls particles bounce off
+  kPeriodic     //edges wrap around to the opposite edge, so the container
+                //is a tile of an endless gas w/o walls
+};
+
+/**
+ * A rectangular container of ideal gas particles that moves the particles
+ * over time. Has no display code, so it can be stepped without a window.
+ */
+class GasContainer {
+  public:
+    /**
+     * Default constructor for an empty Gas Container.
+     */
+    GasContainer() = default;
+
+    /**
+     * Constructor for a Gas Container with multiple particle types. Groups
+     * are numbered in map order, so the same seed always gives the same
+     * particles, however many threads place them.
+     *
+     * @param particle_information  map w/ particle info + count
+     *
+     * @param container_width       the width in pixels of the container.
+     * @param container_height      the height in pixels of the container.
+     *
+     * @param seed                  the seed for placing particles.
+     * @param thread_count          the number of threads to place particles
+     *                              and handle collisions w/.
+     */
+    GasContainer(const map<Particle, size_t>& particle_information,
+                 size_t container_width, size_t container_height,
+                 uint64_t seed = 0, size_t thread_count = 1);
+
+    /**
+     * Secondary constructor for a Gas Container with multiple particle types,
+     * given particle groups to simulate.
+     *
+     * @param groups                vector list of groups to simulate.
+     *
+     * @param container_width       the width in pixels of the container.
+     * @param container_height      the height in pixels of the container.
+     */
+    GasContainer(const vector<ParticleGroup*>& groups, size_t container_width,
+                 size_t container_height);
+
+    //copies would share the worker pool, profiler and observables, which
+    //can't be used from two threads at once, so containers are only moved
+    GasContainer(GasContainer&&) = default;
+    GasContainer& operator=(GasContainer&&) = default;
+    GasContainer(const GasContainer&) = delete;
+    GasContainer& operator=(const GasContainer&) = delete;
+
+    /**
+     * Makes one group of particles the way the map constructor does, so the
+     * same particle type and group number always give the same walls,
+     * velocities and placements. The caller owns the new group.
+     *
+     * @param particle_type     the mass, radius and color of the particles.
+     * @param num_particles     the number of particles to place.
+     *
+     * @param container_width   the width in pixels of the container.
+     * @param container_height  the height in pixels of the container.
+     *
+     * @param seed              the seed for placing particles.
+     * @param group_number      the position of the type in the map.
+     * @param pool              threads to place particles w/, or nullptr.
+     *
+     * @return the new group.
+     */
+    static ParticleGroup* CreateParticleGroup(const Particle& particle_type,
+                                              size_t num_particles,
+                                              size_t container_width,
+                                              size_t container_height,
+                                              uint64_t seed,
+                                              uint64_t group_number,
+                                              WorkerPool* pool = nullptr);
+
+    /**
+     * Updates the particles' movement after one unit of time.
+     */
+    void Update();
+
+    /**
+     * Moves the particles forward by the given time. Event driven stepping
+     * loads particles and predicts their events once per call, so advancing
+     * a dilute gas by a long time in one call skips most of the work of
+     * many unit updates. Fixed stepping moves particles in unit updates, and
+     * rounds the time to the closest whole number of them.
+     *
+     * @param duration  the time to move particles forward by.
+     */
+    void Advance(double duration);
+
+    /**
+     * Sets how pairs of possibly colliding particles are found. All modes
+     * produce identical collision results.
+     *
+     * @param mode the collision mode to use for following updates.
+     */
+    void SetCollisionMode(CollisionMode mode);
+
+    /**
+     * Sets the skin distance of the Verlet lists used in the Verlet list
+     * collision mode. A larger skin rebuilds the lists less often, but lists
+     * more pairs to check every update.
+     *
+     * @param skin  the extra distance in pixels to list nearby pairs within.
+     */
+    void SetVerletSkin(double skin);
+
+    /**
+     * Sets how particles are moved forward in time. Both modes move particles
+     * by one unit of time per update, and event driven stepping can also
+     * advance any time at once.
+     *
+     * @param mode the stepping mode to use for following updates.
+     */
+    void SetSteppingMode(SteppingMode mode);
+
+    /**
+     * Sets what happens to particles at the edges of the container. In the
+     * periodic mode, positions wrap around and particles collide w/ the
+     * closest copy of each other, so the container must be at least twice
+     * as wide and high as the largest distance between colliding particles.
+     * There are no walls to take impulses then, so observed samples have no
+     * pressure.
+     *
+     * @param mode the boundary mode to use for following updates.
+     */
+    void SetBoundaryMode(BoundaryMode mode);
+
+    /**
+     * Sets how many threads handle particle collisions. Results are identical
+     * for any number of threads.
+     *
+     * @param thread_count  the number of threads to use, including the thread
+     *                      calling Update.
+     */
+    void SetThreadCount(size_t thread_count);
+
+    /**
+     * Sets how often particles are reordered along a space filling curve, so
+     * particles near each other in the container stay near each other in
+     * memory as they move. Reordering changes which index each particle has,
+     * see GetParticleIds.
+     *
+     * @param update_count  the number of updates between reorders, or 0 to
+     *                      never reorder.
+     */
+    void SetSortInterval(size_t update_count);
+
+    /**
+     * Reorders the particles of every group along a space filling curve now.
+     */
+    void SortParticles();
+
+    /**
+     * Fetches the number of times particles were reordered.
+     *
+     * @return the sort count.
+     */
+    size_t GetSortCount() const;
+
+    /**
+     * Fetches where the particles of a group were before the last reorder,
+     * so anything holding particle indices can follow them.
+     *
+     * @param group_index   the index of the group in GetParticleGroups.
+     *
+     * @return the previous index of the particle at each index, empty if
+     *         particles were never reordered.
+     */
+    const vector<uint32_t>& GetLastSortOrder(size_t group_index) const;
+
+    /**
+     * Fetches the id of every particle in a group, which is its index before
+     * the first reorder. Ids follow particles through every reorder, so
+     * anything looking at particles less often than they are reordered can
+     * still tell them apart.
+     *
+     * @param group_index   the index of the group in GetParticleGroups.
+     *
+     * @return the id of the particle at each index, empty if particles were
+     *         never reordered.
+     */
+    const vector<uint32_t>& GetParticleIds(size_t group_index) const;
+
+    /**
+     * Fetches all groups of particles in this container.
+     *
+     * @return a vector list of all particle groups.
+     */
+    const vector<ParticleGroup*>& GetParticleGroups() const;
+
+    /**
+     * Fetches the width of this container.
+     *
+     * @return the container width in pixels.
+     */
+    size_t GetContainerWidth() const;
+
+    /**
+     * Fetches the height of this container.
+     *
+     * @return the container height in pixels.
+     */
+    size_t GetContainerHeight() const;
+
+    /**
+     * Fetches the profiler that updates record their phase times and work
+     * counts into. Only records anything in builds w/ IDEALGAS_PROFILING.
+     *
+     * @return the profiler of this container.
+     */
+    UpdateProfiler& GetProfiler() const;
+
+    /**
+     * Fetches the observables that updates feed their energies, momenta,
+     * wall impulses and collision counts into. Nothing is sampled until a
+     * sample interval is set.
+     *
+     * @return the observables of this container.
+     */
+    GasObservables& GetObservables() const;
+
+    /**
+     * Updates velocities of all particles in all groups based on collisions
+     * between touching particles, without moving any particle. This is the
+     * first half of a fixed step update.
+     */
+    void HandleAllParticleCollisions();
+
+    /**
+     * Lists all particles from all groups in this container, in group order,
+     * as indices into the copies particle collisions are found between. A
+     * group listed more than once points to the same copies each time.
+     *
+     * @return the copy index of every particle.
+     */
+    const vector<size_t>& ListAllParticles();
+
+  private:
+    size_t container_width_ = 0;
+    size_t container_height_ = 0;
+
+    vector<ParticleGroup*> particle_groups_;
+
+    //number of particles each parallel task finds contacts for
+    static const size_t kParticlesPerContactTask = 1024;
+    //skin used until SetVerletSkin is called, a few updates of movement
+    static constexpr double kDefaultVerletSkin = 4.0;
+
+    SteppingMode stepping_mode_ = SteppingMode::kFixedStep;
+    BoundaryMode boundary_mode_ = BoundaryMode::kReflecting;
+    EventDrivenEngine event_engine_;
+
+    CollisionMode collision_mode_ = CollisionMode::kUniformGrid;
+    UniformGrid collision_grid_;
+    HierarchicalGrid hierarchical_grid_;
+    SweepAndPrune sweep_and_prune_;
+    VerletList verlet_list_;
+    double verlet_skin_ = kDefaultVerletSkin;
+    CollisionResolver collision_resolver_;
+    MortonSorter particle_sorter_;
+    size_t sort_interval_ = 0;
+    size_t updates_since_sort_ = 0;
+    size_t sort_count_ = 0;
+    vector<vector<uint32_t>> sort_orders_;        //last order of each group
+    vector<vector<uint32_t>> particle_ids_;       //ids by index of each group
+    vector<uint32_t> sorted_ids_;                 //scratch for new ids
+    std::unique_ptr<WorkerPool> worker_pool_ =
+        std::unique_ptr<WorkerPool>(new WorkerPool(1));
+    std::unique_ptr<UpdateProfiler> profiler_ =
+        std::unique_ptr<UpdateProfiler>(new UpdateProfiler());
+    std::unique_ptr<GasObservables> observables_ =
+        std::unique_ptr<GasObservables>(new GasObservables());
+    size_t collision_count_ = 0;                  //in the last update
+
+    //scratch lists kept between updates, so a steady update doesn't allocate
+    vector<Particle> particle_copies_;            //copies of all particles
+    vector<size_t> all_particles_;                //copy index of each particle
+    vector<size_t> group_offsets_;                //first copy of each group
+    vector<bool> updated_particles_;              //used by all pairs
+    vector<ContactPair> contacts_;                //touching pairs in order
+    vector<vector<ContactPair>> task_contacts_;   //touching pairs per task
+    vector<vector<size_t>> task_neighbors_;       //grid neighbors per task
+    vector<size_t> task_pair_counts_;             //pairs tested per task
+
+    /**
+     * Reorders particles in memory if the sort interval has passed since the
+     * last reordering.
+     */
+    void SortIfDue();
+
+    /**
+     * Moves particles forward by the given time w/ the event driven engine.
+     */
+    void AdvanceEventDriven(double duration);
+
+    /**
+     * Handles collisions by checking every particle against every particle
+     * that comes before it in the list.
+     */
+    void HandleCollisionsWithAllPairs();
+
+    /**
+     * Handles collisions by only checking each particle against the earlier
+     * particles in its neighboring grid cells. Pairs are checked in the same
+     * order as with all pairs, so results are identical.
+     */
+    void HandleCollisionsWithGrid();
+
+    /**
+     * Finds all pairs of touching particles in neighboring grid cells, in
+     * parallel, and stores them in order in contacts_.
+     */
+    void FindGridContacts();
+
+    /**
+     * Handles collisions by only checking the pairs in the Verlet lists,
+     * rebuilding the lists first if particles moved too far. Pairs are
+     * checked in the same order as with all pairs, so results are identical.
+     */
+    void HandleCollisionsWithVerletList();
+
+    /**
+     * Finds all pairs of touching particles in the Verlet lists, in
+     * parallel, and stores them in order in contacts_.
+     */
+    void FindVerletContacts();
+
+    /**
+     * Handles collisions by only checking particles in neighboring cells of
+     * a hierarchical grid, where each group's level fits its radius. Pairs
+     * are resolved in the same order as with all pairs, so results are
+     * identical.
+     */
+    void HandleCollisionsWithHierarchicalGrid();
+
+    /**
+     * Finds all pairs of touching particles in neighboring cells of the
+     * hierarchical grid, in parallel, and stores them in order in contacts_.
+     */
+    void FindHierarchicalContacts();
+
+    /**
+     * Handles collisions by only checking particles whose extents overlap,
+     * found by sweeping along the longer axis in an order kept between
+     * updates. Pairs are resolved in the same order as with all pairs, so
+     * results are identical.
+     */
+    void HandleCollisionsWithSweepAndPrune();
+
+    /**
+     * Finds all pairs of touching particles w/ overlapping extents, in
+     * parallel, and stores them in order in contacts_.
+     */
+    void FindSweepContacts();
+
+    /**
+     * Finds all pairs of touching particles among candidates, in parallel
+     * tasks over ranges of slots, and joins them in order into contacts_.
+     * Broad phases only supply which candidates to check.
+     *
+     * @param list_candidates   called w/ a slot and a vector to fill w/ the
+     *                          indices of candidates for a particle, returns
+     *                          the index of that particle.
+     * @param sort_contacts     true if candidates may come after their
+     *                          particle or slots aren't in particle order, so
+     *                          pairs are put in all pairs order afterwards.
+     */
+    template <typename CandidateLister>
+    void FindContacts(const CandidateLister& list_candidates,
+                      bool sort_contacts);
+
+    /**
+     * Resolves the touching pairs in contacts_, in order.
+     */
+    void ResolveAllContacts();
+
+    /**
+     * Finds the grid cell size needed so that colliding particles are always
+     * in the same or neighboring cells.
+     *
+     * @return the side length of a grid cell.
+     */
+    double CalculateGridCellSize() const;
+
+    /**
+     * Finds the distances after which positions repeat.
+     *
+     * @return the container's size if its edges wrap around, else 0.
+     */
+    vec2 FindPeriod() const;
+
+    /**
+     * Finds the total length of the container's four walls.
+     *
+     * @return the perimeter of the container, 0 w/ periodic edges.
+     */
+    double CalculateWallLength() const;
+
+    /**
+     * Finds the largest radius of any particle in this container.
+     *
+     * @return the largest particle radius.
+     */
+    size_t FindMaxRadius() const;
+
+    /**
+     * Counts the particles in all groups in this container.
+     *
+     * @return the total number of particles.
+     */
+    size_t CountAllParticles() const;
+
+    /**
+     * Copies the particles of every group out of the groups' arrays into
+     * particle_copies_, at the offsets found by ListAllParticles. A group
+     * listed more than once in this simulator is only copied once.
+     */
+    void CopyAllParticles();
+
+    /**
+     * Copies the velocities of the particle copies back into their groups.
+     */
+    void StoreAllVelocities();
+
+    /**
+     * Finds where the particles of each group start in the particle copies
+     * and stores them in group_offsets_, in the same order as the groups.
+     */
+    void FindGroupOffsets();
+};
+
+/**
+ * Adds a group of particles described as COUNT:MASS:RADIUS to the particle
+ * information a container is made from. Groups w/ the same mass and radius
+ * add up their counts.
+ *
+ * @param description           the description of the group.
+ * @param particle_information  the particle types and counts to add to.
+ *
+ * @return true if the description could be read, else false.
+ */
+bool AddGroupDescription(const std::string& description,
+                         map<Particle, size_t>& particle_information);
+
+} // namespace idealgas
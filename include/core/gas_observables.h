@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "core/particle_group.h"
+#include "core/worker_pool.h"
+
+namespace idealgas {
+
+using std::vector;
+
+/**
+ * Thermodynamic state of a set of particles. Temperatures use 2 degrees of
+ * freedom per particle and a Boltzmann constant of 1, so a temperature is
+ * the mean kinetic energy of a particle.
+ */
+struct ParticleObservables {
+  size_t particle_count = 0;
+  double kinetic_energy = 0;
+  double temperature = 0;
+  double x_momentum = 0;
+  double y_momentum = 0;
+  double mean_speed = 0;
+};
+
+/**
+ * Thermodynamic state of a container at one sampled update. Rates are
+ * averaged over the updates since the previous sample.
+ */
+struct ObservableSample {
+  uint64_t update = 0;                  //number of updates when sampled
+  vector<ParticleObservables> groups;   //in the same order as the groups
+  ParticleObservables total;            //all particles, repeated groups once
+  bool has_pressure = false;    //false w/o walls, eg. w/ periodic edges
+  double pressure = 0;          //wall impulse per unit of wall length and time
+  double collision_rate = 0;    //particle collisions per unit of time
+  double mean_free_path = 0;    //mean distance between collisions, 0 if no
+                                //particles collided
+};
+
+/**
+ * Measures the thermodynamic state of a container while it updates, so
+ * observables don't need full dumps of the particles.
+ *
+ * Wall impulses and collision counts come from every update for free, as
+ * the wall pass and collision resolving already find them. Every sample
+ * interval, the velocities of all particles are summed in parallel, each
+ * task into its own sums that are added up afterwards, and a sample is
+ * queued. Samples are pulled from the queue, and the sample interval set,
+ * possibly from another thread.
+ */
+class GasObservables {
+  public:
+    /**
+     * Default constructor for Gas Observables that never sample.
+     */
+    GasObservables() = default;
+
+    /**
+     * Sets how often samples are taken, starting w/ the next recorded update.
+     * Safe to call while another thread updates the container.
+     *
+     * @param update_count  the number of updates between samples, or 0 to
+     *                      never sample.
+     */
+    void SetSampleInterval(size_t update_count);
+
+    /**
+     * Fetches how often samples are taken, including an interval that was
+     * set but not used by an update yet.
+     *
+     * @return the number of updates between samples, 0 if never.
+     */
+    size_t GetSampleInterval() const;
+
+    /**
+     * Adds the wall impulses and collisions of an update, then takes a
+     * sample if one is due. Called by the container after every update.
+     *
+     * @param groups            the groups of particles after the update.
+     * @param wall_length       the total length of the container's walls,
+     *                          0 if it has none.
+     * @param wall_impulse      the impulse walls gave particles.
+     * @param collision_count   the number of particle collisions.
+     * @param pool              the threads to sum velocities w/.
+     * @param duration          the time the update moved particles by.
+     */
+    void RecordUpdate(const vector<ParticleGroup*>& groups,
+                      double wall_length, double wall_impulse,
+                      size_t collision_count, WorkerPool& pool,
+                      double duration = 1.0);
+
+    /**
+     * Moves every sample taken since the last pull to the end of a vector.
+     * Safe to call while another thread updates the container.
+     *
+     * @param samples   the vector to add samples to, oldest first.
+     *
+     * @return the number of samples added.
+     */
+    size_t PullSamples(vector<ObservableSample>& samples);
+
+    /**
+     * Fetches the number of samples dropped because the queue was full,
+     * oldest first.
+     *
+     * @return the dropped sample count.
+     */
+    size_t GetDroppedSampleCount() const;
+
+  private:
+    //most samples kept waiting to be pulled
+    static const size_t kMaxQueuedSamples = 1 << 16;
+    //number of particles each parallel task sums
+    static const size_t kParticlesPerSumTask = 4096;
+
+    size_t sample_interval_ = 0;
+    uint64_t update_count_ = 0;
+
+    //interval set by SetSampleInterval, guarded by the queue mutex, and
+    //whether updates have yet to start using it
+    size_t requested_sample_interval_ = 0;
+    std::atomic<bool> interval_requested_{false};
+
+    //totals since the last sample
+    size_t updates_since_sample_ = 0;
+    double time_since_sample_ = 0;
+    double wall_impulse_since_sample_ = 0;
+    size_t collisions_since_sample_ = 0;
+
+    //group and first particle of every summing task, and its sums
+    const vector<ParticleGroup*>* sampled_groups_ = nullptr;
+    vector<size_t> task_groups_;
+    vector<size_t> task_starts_;
+    vector<VelocitySums> task_sums_;
+
+    mutable std::mutex queue_mutex_;
+    std::deque<ObservableSample> queued_samples_;
+    size_t dropped_sample_count_ = 0;
+
+    /**
+     * Starts using the last interval set and restarts the totals since the
+     * last sample.
+     */
+    void ApplySampleInterval();
+
+    /**
+     * Sums the velocities of every group in parallel and queues a sample w/
+     * the rates since the last sample.
+     */
+    void TakeSample(const vector<ParticleGroup*>& groups, double wall_length,
+                    WorkerPool& pool);
+
+    /**
+     * Fills in the energy, temperature and mean speed of a set of particles
+     * from its count, velocity sums and particle mass.
+     */
+    static void FinishObservables(const VelocitySums& sums, double mass,
+                                  ParticleObservables& observables);
+};
+
+} // namespace idealgas
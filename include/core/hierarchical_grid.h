@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include "core/particle.h"
+
+namespace idealgas {
+
+using std::vector;
+using idealgas::Particle;
+
+/**
+ * A stack of uniform grids w/ cells doubling in size from level to level,
+ * used to find which particles are close enough to possibly collide when
+ * radii differ a lot. Every particle is placed only in the level whose cells
+ * fit its diameter, so small particles use small cells and big particles
+ * don't span many of them.
+ *
+ * Two particles can only touch if the smaller one is in one of the 9 cells
+ * around the bigger one in the bigger one's level, so every particle checks
+ * its own level and all coarser levels, and each pair is found once. In a
+ * container whose edges wrap around, cells on one edge neighbor the cells on
+ * the opposite edge.
+ */
+class HierarchicalGrid {
+  public:
+    /**
+     * Default constructor for an empty Hierarchical Grid.
+     */
+    HierarchicalGrid() = default;
+
+    /**
+     * Places every particle into the level matching its radius and the cell
+     * of that level containing its position. Only levels holding particles
+     * are kept, and levels w/ few particles for their area get bigger cells.
+     * Particles outside of the container are placed into the closest border
+     * cell.
+     *
+     * @param particles     storage of all particles.
+     * @param particle_list storage index of every particle to place into the
+     *                      grid, in list order.
+     * @param width         the width of the area covered by the grid.
+     * @param height        the height of the area covered by the grid.
+     * @param wraps         if the edges of the area wrap around. Cells are
+     *                      then stretched to split the area evenly.
+     */
+    void Rebuild(const vector<Particle>& particles,
+                 const vector<size_t>& particle_list, double width,
+                 double height, bool wraps = false);
+
+    /**
+     * Lists the list positions of every particle that could touch the given
+     * particle and is found from it: earlier particles in the same or
+     * neighboring cells of its own level, and any particles in the cells
+     * around it in coarser levels.
+     *
+     * @param index         the list position of the particle.
+     * @param candidates    the vector to fill, in no particular order.
+     */
+    void ListCandidates(size_t index, vector<size_t>& candidates) const;
+
+    /**
+     * Fetches the number of levels holding particles.
+     *
+     * @return the level count.
+     */
+    size_t GetLevelCount() const;
+
+    /**
+     * Fetches the side length of the cells of a level.
+     *
+     * @param level the level, levels are ordered from smallest cells up.
+     *
+     * @return the cell size of the level.
+     */
+    double GetCellSize(size_t level) const;
+
+  private:
+    /**
+     * One uniform grid of the stack.
+     */
+    struct GridLevel {
+      double cell_size;
+      double cell_width;              //cell_size, unless stretched to wrap
+      double cell_height;
+      size_t column_count;
+      size_t row_count;
+      vector<size_t> cell_starts;     //where each cell begins in the list
+      vector<size_t> cell_particles;  //particle indices sorted by cell
+      vector<size_t> next_slots;      //next free slot of each cell
+    };
+
+    vector<GridLevel> levels_;
+    size_t level_count_ = 0;          //levels in use, levels_ may hold more
+    bool wraps_ = false;
+
+    vector<size_t> particle_levels_;  //stores level of each particle
+    vector<size_t> particle_cells_;   //stores cell in its level of each
+    vector<float> x_positions_;       //stores position of each particle
+    vector<float> y_positions_;
+    vector<size_t> level_numbers_;    //level in use of each doubling
+};
+
+} // namespace idealgas
@@ -1,9 +1,7 @@
 #pragma once
 
-#include "cinder/gl/gl.h"
 #include "core/particle_group.h"
 
-using glm::vec2;
 using idealgas::ParticleGroup;
 
 namespace idealgas {
@@ -11,45 +9,51 @@ namespace idealgas {
 /**
  * A histogram representing the speed distribution of a certain group of ideal
  * gas particles.
+ *
+ * The histogram is kept up to date by calling Update after the particles
+ * move. Every particle remembers its bucket, so only particles whose speed
+ * moved them into another bucket change the counts, and no memory is
+ * allocated unless the group changes size. Buckets have equal widths, so a
+ * speed's bucket is found directly instead of searching the bucket limits.
  */
 class IdealGasHistogram {
   public:
     /**
-     * A histogram illustrating the speeds of a group of particles.
+     * A histogram of the speeds of a group of particles w/ adaptive bucket
+     * limits. Limits start out covering the current speeds, and are widened
+     * whenever an update finds a speed outside of them.
      *
-     * @param top_left      coordinates of the top left position of graph.
-     * @param bottom_right  coordinates of the bottom right position of graph.
-     *
-     * @param particles     the group of particles to analyze and display.
-     *
-     * @param margins       size in pixels of margins used in display.
-     * @param width         width in pixels of the histogram.
-     * @param height        height in pixels of the histogram.
-     * @param num_buckets   number of buckets in this histogram (x-axes intervals).
-     * @param y_interval_size number of pixels for each y axis interval.
+     * @param particles     the group of particles to analyze.
+     * @param num_buckets   number of buckets in this histogram (x-axes intervals),
+     *                      throws std::invalid_argument if 0.
      */
-    IdealGasHistogram(const vec2& top_left, const vec2& bottom_right,
-                      ParticleGroup* particles, size_t width,
-                      size_t height, size_t margins, size_t num_buckets,
-                      size_t y_interval_size);
+    IdealGasHistogram(ParticleGroup* particles, size_t num_buckets);
 
     /**
-     * Destructor for an ideal gas histogram.
+     * A histogram of the speeds of a group of particles w/ fixed bucket
+     * limits. Speeds outside the limits are counted in the first or last
+     * bucket.
+     *
+     * @param particles     the group of particles to analyze.
+     * @param num_buckets   number of buckets in this histogram (x-axes intervals).
+     * @param min_speed     the lowest speed covered by the first bucket.
+     * @param max_speed     the upper speed limit of the last bucket.
      */
-    ~IdealGasHistogram();
+    IdealGasHistogram(ParticleGroup* particles, size_t num_buckets,
+                      double min_speed, double max_speed);
 
     /**
-     * Draws the histogram for the current particles and their speeds.
+     * Recounts the particles per bucket from the current particle speeds.
      */
-    void DrawHistogram() const;
+    void Update();
 
     /**
-     * Fetches the particle speed at the given index in the list of particle
-     * speeds.
+     * Fetches the speed of the particle at the given index in the group, as
+     * of the last update.
      *
-     * @param index the index of the speed to retrieve.
+     * @param index the index of the particle to retrieve the speed of.
      *
-     * @return the speed at the given position.
+     * @return the speed of the particle at the given index.
      */
     double GetParticleSpeedAt(size_t index) const;
 
@@ -71,52 +75,56 @@ class IdealGasHistogram {
      */
     size_t GetNumberParticlesAt(size_t index) const;
 
+    /**
+     * Fetches the number of buckets in this histogram.
+     *
+     * @return the bucket count.
+     */
+    size_t GetBucketCount() const;
+
   private:
-    //corner positions of histogram on display
-    vec2 top_left_;
-    vec2 bottom_right_;
-
-    //histogram dimension values
-    size_t display_margin_;
-    size_t histogram_width_;
-    size_t histogram_height_;
+    //fraction of the new speed range added when adaptive limits are widened,
+    //so that slowly spreading speeds don't widen them on every update
+    static constexpr double kAdaptiveHeadroom = 0.25;
+
     size_t bucket_count_;
-    size_t y_interval_pixels_;
+    bool adaptive_limits_;
+    double min_speed_ = 0;
+    double bucket_size_ = 0;
 
     ParticleGroup* particle_group_;
 
-    vector<double> particle_speeds_;     //stores all sorted particle speeds
+    vector<double> particle_speeds_;     //stores speed of each particle
+    vector<size_t> particle_buckets_;    //stores bucket of each particle
     vector<double> bucket_speed_limits_; //stores upper speed limits of buckets
     vector<size_t> particles_per_bucket_; //stores particle count per bucket
 
     /**
-     * Draws the outline and axes of the histogram on the display.
-     */
-    void DrawHistogramBox() const;
-
-    /**
-     * Draws the bars of the histogram based on the velocities of the particles.
-     *
-     * @param bottom_left   bottom left corner position of the histogram.
-     */
-    void DrawHistogramBars(vec2 bottom_left) const;
-
-    /**
-     * Creates a vector listing all the sorted speeds of the particles.
+     * Creates a vector listing the current speeds of all particles.
      */
-    void ListSortedParticleSpeeds();
+    void ListParticleSpeeds();
 
     /**
-     * Finds the upper speed limit for each bucket of the histogram based on
-     * the speeds of all particles.
+     * Finds the upper speed limit for each bucket of the histogram, splitting
+     * the given speed range into equal buckets.
      */
-    void CalculateBucketSpeedLimits();
+    void CalculateBucketSpeedLimits(double min_speed, double max_speed);
 
     /**
      * Counts the number of particles in the group that fit in each histogram
      * bucket based on their speeds.
      */
     void CountParticlesPerBucket();
+
+    /**
+     * Finds the bucket a speed belongs in. Speeds outside of the limits are
+     * placed in the first or last bucket.
+     *
+     * @param speed the speed to find the bucket of.
+     *
+     * @return the index of the bucket.
+     */
+    size_t FindBucket(double speed) const;
 };
 
-} // namespace idealgas
\ No newline at end of file
+} // namespace idealgas
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace idealgas {
+
+namespace lzcodec {
+
+using std::vector;
+
+/**
+ * Compresses bytes w/ a small LZ77 codec in the style of the LZ4 block
+ * format. Repeated runs of 4 or more bytes within the last 64KB are replaced
+ * by references to their earlier copy.
+ *
+ * @param input         the bytes to compress.
+ * @param input_size    the number of bytes to compress.
+ * @param output        the vector to fill w/ the compressed bytes.
+ */
+void Compress(const unsigned char* input, size_t input_size,
+              vector<unsigned char>& output);
+
+/**
+ * Decompresses bytes made by Compress.
+ *
+ * @param input         the compressed bytes.
+ * @param input_size    the number of compressed bytes.
+ * @param output        the array to fill w/ the decompressed bytes.
+ * @param output_size   the exact number of decompressed bytes.
+ *
+ * @return true if the input decompressed to exactly output_size bytes, else
+ *         false if the input is damaged.
+ */
+bool Decompress(const unsigned char* input, size_t input_size,
+                unsigned char* output, size_t output_size);
+
+} // namespace lzcodec
+
+} // namespace idealgas
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "core/worker_pool.h"
+
+namespace idealgas {
+
+using std::vector;
+
+/**
+ * Finds the order of particles along a Morton (Z order) curve over the
+ * container, so particles near each other in the container can be stored
+ * near each other in memory.
+ *
+ * Positions are quantized to 16 bits per axis and interleaved into 32 bit
+ * keys, which are sorted by a stable parallel radix sort, so particles w/
+ * equal keys keep their current order for any number of threads.
+ */
+class MortonSorter {
+  public:
+    /**
+     * Default constructor for a Morton Sorter w/ no order found yet.
+     */
+    MortonSorter() = default;
+
+    /**
+     * Interleaves the bits of two 16 bit coordinates into one key, x in the
+     * even bits and y in the odd bits.
+     *
+     * @param x_cell    the quantized x coordinate.
+     * @param y_cell    the quantized y coordinate.
+     *
+     * @return the Morton key of the coordinates.
+     */
+    static uint32_t InterleaveBits(uint32_t x_cell, uint32_t y_cell);
+
+    /**
+     * Finds the order of the given particles along the curve. Positions
+     * outside of the container are treated as on its closest border.
+     *
+     * @param x_positions   x positions of the particles.
+     * @param y_positions   y positions of the particles.
+     * @param count         the number of particles.
+     * @param width         the width of the container.
+     * @param height        the height of the container.
+     * @param pool          threads to find keys and sort w/.
+     */
+    void FindOrder(const float* x_positions, const float* y_positions,
+                   size_t count, double width, double height,
+                   WorkerPool& pool);
+
+    /**
+     * Moves values into the order found by the last call to FindOrder.
+     *
+     * @param values    one value per particle, in their current order.
+     * @param pool      threads to move values w/.
+     */
+    void ApplyOrder(vector<float>& values, WorkerPool& pool);
+
+    /**
+     * Fetches the order found by the last call to FindOrder.
+     *
+     * @return the current index of the particle that belongs at each index.
+     */
+    const vector<uint32_t>& GetOrder() const;
+
+  private:
+    //number of keys each parallel task handles
+    static const size_t kKeysPerSortTask = 16384;
+    //key bits sorted per radix pass, and the buckets of one pass
+    static const int kRadixBits = 8;
+    static const size_t kRadixBuckets = (size_t) 1 << kRadixBits;
+
+    //keys and order, sorted back and forth between these and the scratch
+    vector<uint32_t> keys_;
+    vector<uint32_t> order_;
+    vector<uint32_t> key_scratch_;
+    vector<uint32_t> order_scratch_;
+    vector<float> value_scratch_;
+
+    //bucket counts of every task, then where each task writes every bucket
+    vector<size_t> task_buckets_;
+
+    //state of the call running parallel tasks, kept here so the tasks only
+    //capture this and fit in std::function w/o allocating
+    size_t task_count_ = 0;
+    const float* sorted_x_positions_ = nullptr;
+    const float* sorted_y_positions_ = nullptr;
+    double x_scale_ = 0;
+    double y_scale_ = 0;
+    int digit_shift_ = 0;
+    vector<float>* ordered_values_ = nullptr;
+
+    /**
+     * Sorts keys_ and order_ by one digit of the keys, keeping the order of
+     * equal digits.
+     *
+     * @param shift the bit position of the digit.
+     * @param pool  threads to sort w/.
+     */
+    void SortByDigit(int shift, WorkerPool& pool);
+};
+
+} // namespace idealgas
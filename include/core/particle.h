@@ -1,6 +1,8 @@
 #pragma once
 
-#include "cinder/gl/gl.h"
+#include "cinder/Color.h"
+#include "glm/glm.hpp"
+#include <string>
 
 namespace idealgas {
 
@@ -23,7 +25,7 @@ struct Particle {
     * Default mass = 1, radius = 1, color is white.
     */
   Particle() : position(0,0), velocity(0,0), mass(1), radius(1),
-               color("white") {};
+               color(1, 1, 1) {};
 
   /**
     * Constructor for a Particle object given all fields.
@@ -52,4 +54,14 @@ struct Particle {
   friend bool operator<(const Particle& lhs, const Particle& rhs);
 };
 
+/**
+ * Finds the color of an SVG color name, w/o Cinder's name table, so the core
+ * only needs Cinder's headers and not its library.
+ *
+ * @param name  the lowercase color name, like "white" or "cyan".
+ *
+ * @return the named color, black if the name isn't known.
+ */
+Color FindNamedColor(const std::string& name);
+
 } // namespace idealgas
\ No newline at end of file
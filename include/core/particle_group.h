@@ -1,21 +1,40 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include "particle.h"
-#include "cinder/gl/gl.h"
+#include "particle_view.h"
+#include "morton_order.h"
+#include "worker_pool.h"
 
 namespace idealgas {
 
 using std::vector;
 using idealgas::Particle;
+using idealgas::ParticleView;
+
+/**
+ * Sums over the velocities of a range of particles.
+ */
+struct VelocitySums {
+  double squared_speeds = 0;
+  double x_velocities = 0;
+  double y_velocities = 0;
+  double speeds = 0;
+};
 
 /**
  * Represents a group of ideal gas particles with the same characteristics.
+ * Positions and velocities are stored as separate contiguous arrays of x and
+ * y components, while mass, radius and color are stored once for the group.
  */
 class ParticleGroup {
   public:
     /**
-     * Constructor for a group of Particles.
+     * Constructor for a group of Particles placed by a counter based random
+     * generator. Every particle gets its own velocity, and its starting
+     * state only depends on the seed, the group number and its index, so
+     * groups are the same for any number of threads.
      *
      * @param num_particles the number of particles in this group.
      *
@@ -25,11 +44,18 @@ class ParticleGroup {
      *
      * @param max_x_pos     the maximum x position of particles.
      * @param max_y_pos     the maximum y position of particles.
-     * @param max_velocity  the maximum velocity magnitude of particles.
+     * @param max_velocity  the maximum velocity component of particles.
+     *
+     * @param seed          the seed of the run.
+     * @param group_number  number of this group, different for every group
+     *                      made w/ the same seed.
+     * @param pool          threads to place particles w/, or nullptr to
+     *                      place them on the calling thread.
      */
     ParticleGroup(size_t num_particles, size_t mass, size_t radius,
                   const ci::Color& color, double max_x_pos, double max_y_pos,
-                  double max_velocity);
+                  double max_velocity, uint64_t seed, uint64_t group_number,
+                  WorkerPool* pool = nullptr);
 
     /**
      * Destructor for a Particle Group.
@@ -46,6 +72,49 @@ class ParticleGroup {
      */
     void UpdatePositions();
 
+    /**
+     * Updates velocities of any particles colliding with walls, then updates
+     * all positions according to velocities. Same result as calling
+     * HandlePossibleWallCollisions then UpdatePositions, but done in a single
+     * vectorized pass over the particles.
+     *
+     * @return the total impulse the walls gave particles of this group.
+     */
+    double AdvanceWithWallCollisions();
+
+    /**
+     * Updates all positions according to velocities in a container w/o
+     * walls, where particles leaving through one side come back in through
+     * the opposite side.
+     *
+     * @param width   the width of the container, x positions repeat after it.
+     * @param height  the height of the container, y positions repeat after
+     *                it.
+     */
+    void AdvanceWithWrapping(double width, double height);
+
+    /**
+     * Reorders the particles of this group along a Morton curve over the
+     * walls of the group, so particles near each other in the container are
+     * stored near each other. Positions and velocities move together.
+     *
+     * @param sorter    sorter to find the order w/, its GetOrder holds the
+     *                  previous index of every particle afterwards.
+     * @param pool      threads to sort w/.
+     */
+    void SortAlongCurve(MortonSorter& sorter, WorkerPool& pool);
+
+    /**
+     * Sums the velocities, squared speeds and speeds of a range of particles
+     * in this group.
+     *
+     * @param begin the index of the first particle to sum.
+     * @param end   the index after the last particle to sum.
+     *
+     * @return the sums over the range.
+     */
+    VelocitySums SumVelocities(size_t begin, size_t end) const;
+
     /**
      * Fetches the size of this particle group, aka how many particles.
      *
@@ -54,22 +123,84 @@ class ParticleGroup {
     size_t GetGroupSize() const;
 
     /**
-     * Fetch a pointer to the particle at the given index in this
-     * IdealGasSimulator's vector of particles.
+     * Fetch a view of the particle at the given index in this group. The view
+     * can be used like a pointer to the particle.
      *
      * @param index the index of the particle to retrieve.
      *
-     * @return a pointer to the particle at the given index.
+     * @return a view of the particle at the given index.
+     */
+    ParticleView GetParticleAt(size_t index);
+
+    /**
+     * Fetches the position of the particle at the given index.
+     *
+     * @param index the index of the particle.
+     *
+     * @return the position of the particle.
+     */
+    vec2 GetPositionAt(size_t index) const;
+
+    /**
+     * Fetches the velocity of the particle at the given index.
+     *
+     * @param index the index of the particle.
+     *
+     * @return the velocity of the particle.
+     */
+    vec2 GetVelocityAt(size_t index) const;
+
+    /**
+     * Changes the position of the particle at the given index.
+     *
+     * @param index     the index of the particle.
+     * @param position  the new position of the particle.
+     */
+    void SetPositionAt(size_t index, const vec2& position);
+
+    /**
+     * Changes the velocity of the particle at the given index.
+     *
+     * @param index     the index of the particle.
+     * @param velocity  the new velocity of the particle.
+     */
+    void SetVelocityAt(size_t index, const vec2& velocity);
+
+    /**
+     * Copies the positions and velocities of all particles into the given
+     * arrays, which must each have room for the whole group.
+     *
+     * @param x_positions   array to fill w/ x positions.
+     * @param y_positions   array to fill w/ y positions.
+     * @param x_velocities  array to fill w/ x velocities.
+     * @param y_velocities  array to fill w/ y velocities.
      */
-    Particle* GetParticleAt(size_t index) const;
+    void CopyParticleArrays(float* x_positions, float* y_positions,
+                            float* x_velocities, float* y_velocities) const;
 
     /**
-     * Gets rid of all the particles in this IdealGasSimulator.
+     * Replaces all particles of this group w/ particles from the given
+     * arrays of positions and velocities.
+     *
+     * @param x_positions   x positions of the new particles.
+     * @param y_positions   y positions of the new particles.
+     * @param x_velocities  x velocities of the new particles.
+     * @param y_velocities  y velocities of the new particles.
+     * @param count         the number of particles in the arrays.
+     */
+    void AssignParticleArrays(const float* x_positions,
+                              const float* y_positions,
+                              const float* x_velocities,
+                              const float* y_velocities, size_t count);
+
+    /**
+     * Gets rid of all the particles in this group.
      */
     void ClearParticles();
 
     /**
-     * Adds an additional particle to the IdealGasSimulator.
+     * Adds an additional particle to this group. Only the position and
+     * velocity are kept, mass, radius and color are the group's.
      *
      * @param particle the particle to add.
      */
@@ -82,14 +213,80 @@ class ParticleGroup {
      */
     ci::Color GetGroupColor() const;
 
+    /**
+     * Fetches the mass of the particles in this group.
+     *
+     * @return the mass of this group's particles.
+     */
+    size_t GetParticleMass() const;
+
+    /**
+     * Fetches the radius of the particles in this group.
+     *
+     * @return the radius of this group's particles.
+     */
+    size_t GetParticleRadius() const;
+
+    /**
+     * Fetches the x position of the right wall for particles in this group.
+     *
+     * @return the maximum x position of particles.
+     */
+    double GetMaxXPosition() const;
+
+    /**
+     * Fetches the y position of the bottom wall for particles in this group.
+     *
+     * @return the maximum y position of particles.
+     */
+    double GetMaxYPosition() const;
+
+    /**
+     * Finds the starting state of one particle of this type, exactly as the
+     * seeded constructor places it, without storing it in the group. Lets a
+     * caller place a few particles of a large group one at a time.
+     *
+     * @param seed          the seed of the run.
+     * @param group_number  number of the group the particle belongs to.
+     * @param index         the index of the particle in that group.
+     *
+     * @return the placed particle.
+     */
+    Particle PlaceParticle(uint64_t seed, uint64_t group_number,
+                           size_t index) const;
+
   private:
-    vector<Particle>* particles_;
+    //particle positions and velocities, one entry per particle
+    vector<float> x_positions_;
+    vector<float> y_positions_;
+    vector<float> x_velocities_;
+    vector<float> y_velocities_;
+
+    //attributes shared by all particles in this group
+    size_t particle_mass_;
+    size_t particle_radius_;
     ci::Color particle_color_;
 
     //maximum values of position/velocity for particles in container:
     double max_x_position_;
     double max_y_position_;
     double max_velocity_magnitude_;
+
+    //number of particles each parallel task places
+    static const size_t kParticlesPerPlacementTask = 16384;
 };
 
+/**
+ * Finds where a group is first listed in a list of groups, so a group listed
+ * more than once is only handled at its first listing.
+ *
+ * @param groups        the list of groups.
+ * @param group_index   the position of the group to find.
+ *
+ * @return the first position of the group, less than group_index if the
+ *         group is a repeat.
+ */
+size_t FindFirstListing(const vector<ParticleGroup*>& groups,
+                        size_t group_index);
+
 } //namespace idealgas
\ No newline at end of file
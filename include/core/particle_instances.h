@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+#include "core/particle_group.h"
+
+namespace idealgas {
+
+using std::vector;
+using glm::vec2;
+
+/**
+ * A run of instances in a packed instance buffer drawn w/ one instanced draw
+ * call, holding all particles of one group.
+ */
+struct InstanceBatch {
+  size_t first_instance;
+  size_t instance_count;
+  float radius;
+  ci::Color color;
+};
+
+/**
+ * Lays out the particles of all groups as one instance per particle, so a
+ * renderer can upload them into a single vertex buffer and draw every group
+ * w/ one instanced call. Has no drawing code, so packing can be checked w/o
+ * a GPU.
+ *
+ * Instances are packed group after group in group order, each instance being
+ * the screen x and y of a particle's center.
+ */
+class ParticleInstancePacker {
+  public:
+    //number of floats packed for every particle
+    static const size_t kFloatsPerInstance = 2;
+
+    /**
+     * Default constructor for a Particle Instance Packer w/o any batches.
+     */
+    ParticleInstancePacker() = default;
+
+    /**
+     * Lays out a batch for every group.
+     *
+     * @param groups    the groups of particles to draw.
+     *
+     * @return true if any batch moved, changed size or was added or removed
+     *         since the last call, so anything pointing into the instance
+     *         buffer by batch has to be updated.
+     */
+    bool UpdateBatches(const vector<ParticleGroup*>& groups);
+
+    /**
+     * Writes the instances of all groups in the layout of the last call to
+     * UpdateBatches.
+     *
+     * @param groups    the same groups the batches were laid out for.
+     * @param offset    screen position of the container's top left corner.
+     * @param instances array w/ room for GetInstanceCount instances.
+     */
+    void Pack(const vector<ParticleGroup*>& groups, const vec2& offset,
+              float* instances) const;
+
+    /**
+     * Fetches the number of instances in all batches.
+     *
+     * @return the total instance count.
+     */
+    size_t GetInstanceCount() const;
+
+    /**
+     * Fetches the batch of every group, in group order.
+     *
+     * @return the batches.
+     */
+    const vector<InstanceBatch>& GetBatches() const;
+
+  private:
+    vector<InstanceBatch> batches_;
+    size_t instance_count_ = 0;
+};
+
+} // namespace idealgas
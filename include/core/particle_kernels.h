@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+
+namespace idealgas {
+
+namespace particlekernels {
+
+/**
+ * Instruction sets a particle kernel can be run with.
+ */
+enum class KernelLevel {
+  kScalar,  //plain loop, works everywhere
+  kSse,     //4 particles at a time
+  kAvx2     //8 particles at a time
+};
+
+/**
+ * Finds the fastest kernel level supported by the current processor.
+ *
+ * @return the best supported kernel level.
+ */
+KernelLevel FindBestKernelLevel();
+
+/**
+ * Reverses velocity components of particles moving into a wall, then moves
+ * every particle by its velocity, all in a single pass over the arrays. Uses
+ * the fastest instruction set supported by the processor. Also sums the
+ * speeds reversed by walls, so wall impulses come w/o another pass.
+ *
+ * @param x_positions   x positions of the particles.
+ * @param y_positions   y positions of the particles.
+ * @param x_velocities  x velocities of the particles.
+ * @param y_velocities  y velocities of the particles.
+ * @param count         the number of particles in the arrays.
+ * @param max_x         the x position of the right wall.
+ * @param max_y         the y position of the bottom wall.
+ *
+ * @return the sum of the sizes of all reversed velocity components.
+ */
+double ReflectAndAdvance(float* x_positions, float* y_positions,
+                         float* x_velocities, float* y_velocities,
+                         size_t count, double max_x, double max_y);
+
+/**
+ * Same as ReflectAndAdvance, but run with the given kernel level. Used to
+ * compare levels against each other.
+ *
+ * @param level the kernel level to use, must be supported by the processor.
+ */
+double ReflectAndAdvance(KernelLevel level, float* x_positions,
+                         float* y_positions, float* x_velocities,
+                         float* y_velocities, size_t count, double max_x,
+                         double max_y);
+
+/**
+ * Moves every particle by its velocity, then brings particles that left the
+ * container back in from the opposite side, for containers whose edges wrap
+ * around instead of being walls. Particles may move at most one container
+ * size per call. Uses the fastest instruction set supported by the
+ * processor.
+ *
+ * @param x_positions   x positions of the particles.
+ * @param y_positions   y positions of the particles.
+ * @param x_velocities  x velocities of the particles.
+ * @param y_velocities  y velocities of the particles.
+ * @param count         the number of particles in the arrays.
+ * @param width         the distance after which x positions repeat.
+ * @param height        the distance after which y positions repeat.
+ */
+void WrapAndAdvance(float* x_positions, float* y_positions,
+                    const float* x_velocities, const float* y_velocities,
+                    size_t count, double width, double height);
+
+/**
+ * Same as WrapAndAdvance, but run with the given kernel level. Used to
+ * compare levels against each other.
+ *
+ * @param level the kernel level to use, must be supported by the processor.
+ */
+void WrapAndAdvance(KernelLevel level, float* x_positions, float* y_positions,
+                    const float* x_velocities, const float* y_velocities,
+                    size_t count, double width, double height);
+
+/**
+ * Arrays of particle state read and written by CollidePairs, one entry per
+ * particle in each array.
+ */
+struct CollisionArrays {
+  const float* x_positions;
+  const float* y_positions;
+  float* x_velocities;
+  float* y_velocities;
+  const float* masses;
+  const float* radii;
+};
+
+/**
+ * Collides every candidate pair in order, the same as calling
+ * particleutils::CollideParticles on each pair: pairs that touch and move
+ * towards each other get the velocities of an elastic collision, all other
+ * pairs are left alone. Takes no square roots, and checks several pairs at
+ * once w/ the fastest instruction set supported by the processor. A
+ * particle may appear in any number of pairs.
+ *
+ * @param particles         the particles the pairs index into.
+ * @param first_particles   first particle of every pair.
+ * @param second_particles  second particle of every pair.
+ * @param pair_count        the number of pairs.
+ *
+ * @return the number of pairs that collided.
+ */
+size_t CollidePairs(const CollisionArrays& particles,
+                    const size_t* first_particles,
+                    const size_t* second_particles, size_t pair_count);
+
+/**
+ * Same as CollidePairs, but run with the given kernel level. Used to compare
+ * levels against each other.
+ *
+ * @param level the kernel level to use, must be supported by the processor.
+ */
+size_t CollidePairs(KernelLevel level, const CollisionArrays& particles,
+                    const size_t* first_particles,
+                    const size_t* second_particles, size_t pair_count);
+
+} // namespace particlekernels
+
+} // namespace idealgas
@@ -1,6 +1,7 @@
 #pragma once
 
-#include "cinder/gl/gl.h"
+#include "cinder/Color.h"
+#include "glm/glm.hpp"
 #include "core/particle.h"
 
 namespace idealgas {
@@ -11,33 +12,30 @@ using glm::vec2;
 using idealgas::Particle;
 
 /**
- * Generates a random double between a given min and max value.
+ * Finds the largest distance between the centers of two colliding particles,
+ * w/ an extra 1 so float rounding can't hide a contact. Grid cells this big
+ * only need to check neighboring cells.
  *
- * @param   max_value the max value to generate.
- * @param   min_value the min value to generate.
+ * @param max_radius    the radius of the largest particles.
  *
- * @return  a random double in the given range.
+ * @return the contact distance.
  */
-double GenerateRandomDouble(double max_value, double min_value);
+double FindContactDistance(double max_radius);
 
 /**
- * Generates a random velocity value under the given maximum value.
+ * Finds the velocity of a particle after an elastic collision.
  *
- * @param max_magnitude the maximum value of the generated velocity.
+ * @param v1    the velocity of the particle.
+ * @param v2    the velocity of the other particle.
+ * @param x1    the position of the particle.
+ * @param x2    the position of the other particle.
+ * @param m1    the mass of the particle.
+ * @param m2    the mass of the other particle.
  *
- * @return the generated random velocity value.
+ * @return the particle's velocity after the collision.
  */
-vec2 GenerateRandomVelocity(double max_magnitude);
-
-/**
- * Generates a random position value under the given max x and y values.
- *
- * @param max_x the maximum x value of the position.
- * @param max_y the maximum y value of the position.
- *
- * @return the generated random position value.
- */
-vec2 GenerateRandomPosition(double max_x, double max_y);
+vec2 FindCollisionVelocity(vec2 v1, vec2 v2, vec2 x1, vec2 x2, size_t m1,
+                           size_t m2);
 
 /**
  * Velocity updated accordingly for particles colliding.
@@ -58,6 +56,76 @@ void HandleParticleCollision(Particle& first, const Particle& second);
  */
 bool ParticleCollisionExists(const Particle& first, const Particle& second);
 
+/**
+ * Checks if two particles are close enough to touch, regardless of whether
+ * they are moving towards each other. Compares squared distances, so no
+ * square root is taken.
+ *
+ * @param first     the first particle to check.
+ * @param second    the second particle to check.
+ *
+ * @return  true    if the particles touch, else
+ *          false   if they are too far apart.
+ */
+bool ParticlesTouching(const Particle& first, const Particle& second);
+
+/**
+ * Same as ParticlesTouching, but in a container whose edges may wrap around,
+ * where particles touch through the closest copy of each other.
+ *
+ * @param period    the distances after which x and y positions repeat, 0 on
+ *                  axes w/ walls.
+ */
+bool ParticlesTouching(const Particle& first, const Particle& second,
+                       const vec2& period);
+
+/**
+ * Updates velocities of both particles in a collision, each based on the
+ * other particle's state from before the collision.
+ *
+ * @param first     the first colliding particle.
+ * @param second    the second colliding particle.
+ */
+void ResolveParticleCollision(Particle& first, Particle& second);
+
+/**
+ * Checks if two particles collide and, if so, updates both velocities, doing
+ * the work shared by both particles once and taking no square roots. Same
+ * result as ParticleCollisionExists followed by ResolveParticleCollision, up
+ * to float rounding.
+ *
+ * @param first     the first particle to collide.
+ * @param second    the second particle to collide.
+ *
+ * @return  true    if the particles collided, else
+ *          false   if they were left alone.
+ */
+bool CollideParticles(Particle& first, Particle& second);
+
+/**
+ * Same as CollideParticles, but in a container whose edges may wrap around,
+ * where particles collide w/ the closest copy of each other.
+ *
+ * @param period    the distances after which x and y positions repeat, 0 on
+ *                  axes w/ walls.
+ */
+bool CollideParticles(Particle& first, Particle& second, const vec2& period);
+
+/**
+ * Finds the offset from one position to another in a container whose edges
+ * may wrap around. On wrapping axes, the offset to the closest copy of the
+ * other position is found instead, following the minimum image convention.
+ *
+ * @param first     the position to find the offset to.
+ * @param second    the position to find the offset from.
+ * @param period    the distances after which x and y positions repeat, 0 on
+ *                  axes w/ walls.
+ *
+ * @return the offset, never longer than half the period on wrapping axes.
+ */
+vec2 FindWrappedOffset(const vec2& first, const vec2& second,
+                       const vec2& period);
+
 } // namespace particleutils
 
 } // namespace idealgas
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "cinder/Color.h"
+#include "glm/glm.hpp"
+#include "core/particle.h"
+
+namespace idealgas {
+
+using glm::vec2;
+using ci::Color;
+
+/**
+ * Refers to the x and y components of a vector that are stored in two
+ * separate arrays. Reads and writes go straight to the arrays.
+ */
+struct VectorRef {
+  float& x;
+  float& y;
+
+  /**
+   * Constructor for a reference to the given x and y components.
+   *
+   * @param x_ref the x component to refer to.
+   * @param y_ref the y component to refer to.
+   */
+  VectorRef(float& x_ref, float& y_ref) : x(x_ref), y(y_ref) {};
+
+  /**
+   * Copies the referred components into a vector.
+   */
+  operator vec2() const {
+    return vec2(x, y);
+  }
+
+  /**
+   * Writes the given vector into the referred components.
+   *
+   * @param value the vector to write.
+   */
+  VectorRef& operator=(const vec2& value) {
+    x = value.x;
+    y = value.y;
+    return *this;
+  }
+
+  /**
+   * Writes the components of another reference into the referred components.
+   *
+   * @param other the reference to copy values from.
+   */
+  VectorRef& operator=(const VectorRef& other) {
+    return *this = vec2(other);
+  }
+
+  /**
+   * Adds the given vector to the referred components.
+   *
+   * @param value the vector to add.
+   */
+  VectorRef& operator+=(const vec2& value) {
+    x += value.x;
+    y += value.y;
+    return *this;
+  }
+};
+
+/**
+ * Represents one particle stored inside a ParticleGroup. Position and velocity
+ * refer directly into the group's arrays, while mass, radius and color are
+ * copies of the group's values. Acts like a pointer to a Particle, so
+ * view->position and *view both work.
+ */
+struct ParticleView {
+  VectorRef position;
+  VectorRef velocity;
+  size_t mass;
+  size_t radius;
+  Color color;
+
+  /**
+   * Constructor for a view of a particle stored in separate arrays.
+   *
+   * @param x_position  the particle's x position in its group's array.
+   * @param y_position  the particle's y position in its group's array.
+   * @param x_velocity  the particle's x velocity in its group's array.
+   * @param y_velocity  the particle's y velocity in its group's array.
+   * @param m           the mass of the particle's group.
+   * @param r           the radius of the particle's group.
+   * @param c           the color of the particle's group.
+   */
+  ParticleView(float& x_position, float& y_position, float& x_velocity,
+               float& y_velocity, size_t m, size_t r, const Color& c) :
+               position(x_position, y_position),
+               velocity(x_velocity, y_velocity), mass(m), radius(r),
+               color(c) {};
+
+  ParticleView* operator->() {
+    return this;
+  }
+
+  ParticleView& operator*() {
+    return *this;
+  }
+
+  /**
+   * Copies the viewed particle into a standalone Particle.
+   */
+  operator Particle() const {
+    return Particle(position, velocity, mass, radius, color);
+  }
+};
+
+} // namespace idealgas
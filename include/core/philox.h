@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+namespace idealgas {
+
+namespace philox {
+
+/**
+ * Generates one block of random bits w/ the Philox4x32-10 counter based
+ * generator. The output is a pure function of the key and counter, so any
+ * block can be generated on any thread in any order and still be reproduced
+ * exactly.
+ *
+ * @param key           the key, usually the seed of a run.
+ * @param counter_low   the low half of the 128 bit counter.
+ * @param counter_high  the high half of the 128 bit counter.
+ * @param output        array of 4 words to fill w/ random bits.
+ */
+void GenerateBlock(uint64_t key, uint64_t counter_low, uint64_t counter_high,
+                   uint32_t output[4]);
+
+/**
+ * Turns random bits into a double that is uniformly spread over [0, 1).
+ *
+ * @param bits  32 random bits.
+ *
+ * @return a double of at least 0 and less than 1.
+ */
+double ToUnitInterval(uint32_t bits);
+
+} // namespace philox
+
+} // namespace idealgas
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "core/collision_resolver.h"
+#include "core/particle_group.h"
+#include "core/precise_particle.h"
+
+namespace idealgas {
+
+using std::vector;
+
+/**
+ * A container of ideal gas particles whose whole state is stored and stepped
+ * in the number type of a precision policy, so w/ fixed point a run can be
+ * replayed bit for bit on any platform. Steps like a gas container in fixed
+ * step mode w/ walls, but only on one thread.
+ *
+ * Touching pairs are found along the x axis, then resolved in order of
+ * their later and then earlier particle index, like a gas container
+ * resolves them, so the order never depends on the sort implementation.
+ *
+ * @tparam Precision    the policy to store and compute in, see precision.h.
+ */
+template <typename Precision>
+class PreciseGasContainer {
+  public:
+    typedef typename Precision::Scalar Scalar;
+
+    /**
+     * Converts the particles of every group into the precision of this
+     * container. A group listed more than once is only converted once.
+     *
+     * @param groups    the groups to take particles from.
+     */
+    explicit PreciseGasContainer(const vector<ParticleGroup*>& groups);
+
+    /**
+     * Resolves collisions between touching particles, then reflects
+     * particles moving into walls and moves every particle by its velocity.
+     */
+    void Update();
+
+    /**
+     * Copies positions and velocities back into the groups this container
+     * was made from, rounded to the groups' floats.
+     *
+     * @param groups    the groups this container was made from.
+     */
+    void StoreInGroups(const vector<ParticleGroup*>& groups) const;
+
+    /**
+     * Fetches the particles of all groups, in group order.
+     *
+     * @return the particles of this container.
+     */
+    const vector<PreciseParticle<Precision>>& GetParticles() const;
+
+  private:
+    vector<PreciseParticle<Precision>> particles_;
+    vector<size_t> group_ends_;       //index after the last particle of each
+    vector<Scalar> max_x_positions_;  //right wall of each group
+    vector<Scalar> max_y_positions_;  //bottom wall of each group
+    Scalar max_contact_distance_ = Scalar();
+    vector<size_t> sorted_particles_; //particle indices by x position
+    vector<ContactPair> contacts_;    //touching pairs, in resolving order
+
+    /**
+     * Resolves collisions between all touching particles moving towards each
+     * other, only checking pairs close enough along the x axis.
+     */
+    void HandleAllParticleCollisions();
+};
+
+template <typename Precision>
+PreciseGasContainer<Precision>::PreciseGasContainer(
+    const vector<ParticleGroup*>& groups) {
+  Scalar max_radius = Scalar();
+  for (size_t group_index = 0; group_index < groups.size(); group_index++) {
+    ParticleGroup* group = groups.at(group_index);
+    if (FindFirstListing(groups, group_index) < group_index) {
+      continue;
+    }
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      Particle particle(group->GetPositionAt(index),
+                        group->GetVelocityAt(index), group->GetParticleMass(),
+                        group->GetParticleRadius(), group->GetGroupColor());
+      particles_.push_back(PreciseParticle<Precision>::FromParticle(particle));
+    }
+    group_ends_.push_back(particles_.size());
+    max_x_positions_.push_back(Precision::FromDouble(group->GetMaxXPosition()));
+    max_y_positions_.push_back(Precision::FromDouble(group->GetMaxYPosition()));
+    max_radius = std::max(max_radius, Precision::FromDouble(
+                                          (double) group->GetParticleRadius()));
+  }
+  max_contact_distance_ = Precision::Add(max_radius, max_radius);
+}
+
+template <typename Precision>
+void PreciseGasContainer<Precision>::Update() {
+  HandleAllParticleCollisions();
+  size_t group_begin = 0;
+  for (size_t group_index = 0; group_index < group_ends_.size();
+       group_index++) {
+    particleutils::ReflectAndAdvance(particles_.data() + group_begin,
+                                     group_ends_[group_index] - group_begin,
+                                     max_x_positions_[group_index],
+                                     max_y_positions_[group_index]);
+    group_begin = group_ends_[group_index];
+  }
+}
+
+template <typename Precision>
+void PreciseGasContainer<Precision>::StoreInGroups(
+    const vector<ParticleGroup*>& groups) const {
+  size_t group_begin = 0;
+  size_t stored_group_count = 0;
+  for (size_t group_index = 0; group_index < groups.size() &&
+       stored_group_count < group_ends_.size(); group_index++) {
+    ParticleGroup* group = groups.at(group_index);
+    if (FindFirstListing(groups, group_index) < group_index) {
+      continue;
+    }
+    size_t group_end = group_ends_[stored_group_count++];
+    for (size_t index = group_begin; index < group_end; index++) {
+      const PreciseParticle<Precision>& particle = particles_[index];
+      group->SetPositionAt(index - group_begin, vec2(
+          Precision::ToDouble(particle.x_position),
+          Precision::ToDouble(particle.y_position)));
+      group->SetVelocityAt(index - group_begin, vec2(
+          Precision::ToDouble(particle.x_velocity),
+          Precision::ToDouble(particle.y_velocity)));
+    }
+    group_begin = group_end;
+  }
+}
+
+template <typename Precision>
+const vector<PreciseParticle<Precision>>&
+PreciseGasContainer<Precision>::GetParticles() const {
+  return particles_;
+}
+
+template <typename Precision>
+void PreciseGasContainer<Precision>::HandleAllParticleCollisions() {
+  sorted_particles_.resize(particles_.size());
+  for (size_t index = 0; index < particles_.size(); index++) {
+    sorted_particles_[index] = index;
+  }
+  const vector<PreciseParticle<Precision>>& particles = particles_;
+  std::sort(sorted_particles_.begin(), sorted_particles_.end(),
+            [&particles](size_t first, size_t second) {
+              return particles[first].x_position <
+                         particles[second].x_position ||
+                     (particles[first].x_position ==
+                          particles[second].x_position && first < second);
+            });
+
+  //positions don't change while resolving, so touching pairs are found once
+  typename Precision::Wide max_contact_distance =
+      Precision::Widen(max_contact_distance_);
+  contacts_.clear();
+  for (size_t slot = 0; slot < sorted_particles_.size(); slot++) {
+    size_t index = sorted_particles_[slot];
+    for (size_t other_slot = slot + 1; other_slot < sorted_particles_.size();
+         other_slot++) {
+      size_t other_index = sorted_particles_[other_slot];
+      //widened, so far apart positions can't overflow fixed point numbers
+      if (Precision::Widen(particles_[other_index].x_position) -
+          Precision::Widen(particles_[index].x_position) >
+          max_contact_distance) {
+        break;
+      }
+      if (particleutils::ParticlesTouching(particles_[index],
+                                           particles_[other_index])) {
+        contacts_.push_back({std::max(index, other_index),
+                             std::min(index, other_index)});
+      }
+    }
+  }
+  std::sort(contacts_.begin(), contacts_.end(),
+            [](const ContactPair& first, const ContactPair& second) {
+              return first.index < second.index ||
+                     (first.index == second.index &&
+                      first.other_index < second.other_index);
+            });
+
+  //velocities do change, so every pair is checked again as it's resolved
+  for (const ContactPair& contact: contacts_) {
+    PreciseParticle<Precision>& first = particles_[contact.index];
+    PreciseParticle<Precision>& second = particles_[contact.other_index];
+    if (particleutils::ParticleCollisionExists(first, second)) {
+      particleutils::ResolveParticleCollision(first, second);
+    }
+  }
+}
+
+} // namespace idealgas
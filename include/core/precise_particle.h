@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cstddef>
+#include "core/particle.h"
+#include "core/precision.h"
+
+namespace idealgas {
+
+/**
+ * The physical state of one particle, stored in the number type of a
+ * precision policy.
+ *
+ * @tparam Precision    the policy to store and compute in, see precision.h.
+ */
+template <typename Precision>
+struct PreciseParticle {
+  typedef typename Precision::Scalar Scalar;
+
+  Scalar x_position;
+  Scalar y_position;
+  Scalar x_velocity;
+  Scalar y_velocity;
+  Scalar mass;
+  Scalar radius;
+
+  /**
+   * Converts a particle into the precision of this policy.
+   *
+   * @param particle    the particle to convert.
+   *
+   * @return the converted particle state.
+   */
+  static PreciseParticle FromParticle(const Particle& particle) {
+    PreciseParticle precise;
+    precise.x_position = Precision::FromDouble(particle.position.x);
+    precise.y_position = Precision::FromDouble(particle.position.y);
+    precise.x_velocity = Precision::FromDouble(particle.velocity.x);
+    precise.y_velocity = Precision::FromDouble(particle.velocity.y);
+    precise.mass = Precision::FromDouble((double) particle.mass);
+    precise.radius = Precision::FromDouble((double) particle.radius);
+    return precise;
+  }
+};
+
+namespace particleutils {
+
+/**
+ * Checks if two particles are close enough to touch, regardless of whether
+ * they are moving towards each other. Compares exact squared distances in
+ * the policy's wide type, so no square root is taken and nothing rounds.
+ *
+ * @param first     the first particle to check.
+ * @param second    the second particle to check.
+ *
+ * @return  true    if the particles touch, else
+ *          false   if they are too far apart.
+ */
+template <typename Precision>
+bool ParticlesTouching(const PreciseParticle<Precision>& first,
+                       const PreciseParticle<Precision>& second) {
+  typedef typename Precision::Wide Wide;
+  Wide x_offset = Precision::Widen(first.x_position) -
+                  Precision::Widen(second.x_position);
+  Wide y_offset = Precision::Widen(first.y_position) -
+                  Precision::Widen(second.y_position);
+  Wide contact_distance = Precision::Widen(first.radius) +
+                          Precision::Widen(second.radius);
+
+  //far apart on either axis can't touch, checked first so squaring can't
+  //overflow fixed point numbers
+  if (x_offset > contact_distance || -x_offset > contact_distance ||
+      y_offset > contact_distance || -y_offset > contact_distance) {
+    return false;
+  }
+  return Precision::MultiplyWide(x_offset, x_offset) +
+         Precision::MultiplyWide(y_offset, y_offset) <=
+         Precision::MultiplyWide(contact_distance, contact_distance);
+}
+
+/**
+ * Checks if a collision between two particles happens, ie. they touch and
+ * are moving towards each other.
+ *
+ * @param first     the first particle to check.
+ * @param second    the second particle to check.
+ *
+ * @return  true    if a collision happens, else
+ *          false   if a collision doesn't happen.
+ */
+template <typename Precision>
+bool ParticleCollisionExists(const PreciseParticle<Precision>& first,
+                             const PreciseParticle<Precision>& second) {
+  if (!ParticlesTouching(first, second)) {
+    return false;
+  }
+  typename Precision::Scalar approach_speed = Precision::Add(
+      Precision::Multiply(
+          Precision::Subtract(first.x_velocity, second.x_velocity),
+          Precision::Subtract(first.x_position, second.x_position)),
+      Precision::Multiply(
+          Precision::Subtract(first.y_velocity, second.y_velocity),
+          Precision::Subtract(first.y_position, second.y_position)));
+  return approach_speed < typename Precision::Scalar();
+}
+
+/**
+ * Updates velocities of both particles in an elastic collision, each based
+ * on the other particle's state from before the collision. Only the squared
+ * distance is needed, so no square root is taken. It and the projection onto
+ * the offset are found in the policy's wide type, so large particles don't
+ * overflow fixed point numbers.
+ *
+ * @param first     the first colliding particle.
+ * @param second    the second colliding particle.
+ */
+template <typename Precision>
+void ResolveParticleCollision(PreciseParticle<Precision>& first,
+                              PreciseParticle<Precision>& second) {
+  typedef typename Precision::Scalar Scalar;
+  typedef typename Precision::Wide Wide;
+  Scalar x_offset = Precision::Subtract(first.x_position, second.x_position);
+  Scalar y_offset = Precision::Subtract(first.y_position, second.y_position);
+  Wide x_wide_offset = Precision::Widen(x_offset);
+  Wide y_wide_offset = Precision::Widen(y_offset);
+  Wide squared_distance =
+      Precision::MultiplyWide(x_wide_offset, x_wide_offset) +
+      Precision::MultiplyWide(y_wide_offset, y_wide_offset);
+  if (squared_distance <= Wide()) {
+    return;
+  }
+
+  //velocity change along the offset, shared by both particles
+  Wide velocity_projection =
+      Precision::MultiplyWide(
+          Precision::Widen(
+              Precision::Subtract(first.x_velocity, second.x_velocity)),
+          x_wide_offset) +
+      Precision::MultiplyWide(
+          Precision::Widen(
+              Precision::Subtract(first.y_velocity, second.y_velocity)),
+          y_wide_offset);
+  Wide projection =
+      Precision::DivideWide(velocity_projection, squared_distance);
+  Scalar total_mass = Precision::Add(first.mass, second.mass);
+  Scalar first_factor = Precision::Divide(
+      Precision::Add(second.mass, second.mass), total_mass);
+  Scalar second_factor = Precision::Divide(
+      Precision::Add(first.mass, first.mass), total_mass);
+  Scalar x_change = Precision::NarrowProduct(projection, x_offset);
+  Scalar y_change = Precision::NarrowProduct(projection, y_offset);
+
+  first.x_velocity = Precision::Subtract(
+      first.x_velocity, Precision::Multiply(first_factor, x_change));
+  first.y_velocity = Precision::Subtract(
+      first.y_velocity, Precision::Multiply(first_factor, y_change));
+  second.x_velocity = Precision::Add(
+      second.x_velocity, Precision::Multiply(second_factor, x_change));
+  second.y_velocity = Precision::Add(
+      second.y_velocity, Precision::Multiply(second_factor, y_change));
+}
+
+/**
+ * Reverses velocity components of particles moving into a wall, then moves
+ * every particle by its velocity, in one pass over the particles.
+ *
+ * @param particles the particles to move.
+ * @param count     the number of particles.
+ * @param max_x     the x position of the right wall.
+ * @param max_y     the y position of the bottom wall.
+ */
+template <typename Precision>
+void ReflectAndAdvance(PreciseParticle<Precision>* particles, size_t count,
+                       typename Precision::Scalar max_x,
+                       typename Precision::Scalar max_y) {
+  typedef typename Precision::Scalar Scalar;
+  const Scalar zero = Scalar();
+  for (size_t index = 0; index < count; index++) {
+    PreciseParticle<Precision>& particle = particles[index];
+    if ((particle.x_position <= zero && particle.x_velocity < zero) ||
+        (particle.x_position >= max_x && particle.x_velocity > zero)) {
+      particle.x_velocity = Precision::Subtract(zero, particle.x_velocity);
+    }
+    if ((particle.y_position <= zero && particle.y_velocity < zero) ||
+        (particle.y_position >= max_y && particle.y_velocity > zero)) {
+      particle.y_velocity = Precision::Subtract(zero, particle.y_velocity);
+    }
+    particle.x_position = Precision::Add(particle.x_position,
+                                        particle.x_velocity);
+    particle.y_position = Precision::Add(particle.y_position,
+                                        particle.y_velocity);
+  }
+}
+
+} // namespace particleutils
+
+} // namespace idealgas
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+namespace idealgas {
+
+/**
+ * Precision policies choose the number type particle state is stored and
+ * computed in. Every policy has a Scalar type that supports comparisons,
+ * plus static functions for all arithmetic, so kernels templated on a policy
+ * work the same for floating and fixed point. The Wide type holds
+ * differences and exact products of scalars, for comparisons and quotients
+ * that can't afford to round or overflow. DivideWide divides two wide
+ * products, and NarrowProduct multiplies that quotient by a scalar.
+ */
+
+/**
+ * Single precision floats, the precision particle groups are stored in.
+ */
+struct Float32Precision {
+  typedef float Scalar;
+  typedef float Wide;
+
+  static Scalar FromDouble(double value) {
+    return (Scalar) value;
+  }
+
+  static double ToDouble(Scalar value) {
+    return value;
+  }
+
+  static Scalar Add(Scalar first, Scalar second) {
+    return first + second;
+  }
+
+  static Scalar Subtract(Scalar first, Scalar second) {
+    return first - second;
+  }
+
+  static Scalar Multiply(Scalar first, Scalar second) {
+    return first * second;
+  }
+
+  static Scalar Divide(Scalar numerator, Scalar denominator) {
+    return numerator / denominator;
+  }
+
+  static Wide Widen(Scalar value) {
+    return value;
+  }
+
+  static Wide MultiplyWide(Wide first, Wide second) {
+    return first * second;
+  }
+
+  static Wide DivideWide(Wide numerator, Wide denominator) {
+    return numerator / denominator;
+  }
+
+  static Scalar NarrowProduct(Wide product, Scalar value) {
+    return (Scalar) (product * value);
+  }
+};
+
+/**
+ * Double precision floats, for reference results.
+ */
+struct Float64Precision {
+  typedef double Scalar;
+  typedef double Wide;
+
+  static Scalar FromDouble(double value) {
+    return value;
+  }
+
+  static double ToDouble(Scalar value) {
+    return value;
+  }
+
+  static Scalar Add(Scalar first, Scalar second) {
+    return first + second;
+  }
+
+  static Scalar Subtract(Scalar first, Scalar second) {
+    return first - second;
+  }
+
+  static Scalar Multiply(Scalar first, Scalar second) {
+    return first * second;
+  }
+
+  static Scalar Divide(Scalar numerator, Scalar denominator) {
+    return numerator / denominator;
+  }
+
+  static Wide Widen(Scalar value) {
+    return value;
+  }
+
+  static Wide MultiplyWide(Wide first, Wide second) {
+    return first * second;
+  }
+
+  static Wide DivideWide(Wide numerator, Wide denominator) {
+    return numerator / denominator;
+  }
+
+  static Scalar NarrowProduct(Wide product, Scalar value) {
+    return (Scalar) (product * value);
+  }
+};
+
+/**
+ * 32 bit fixed point numbers w/ 16 fraction bits, covering +-32768 in steps
+ * of 1/65536. Only integer operations are used and every one of them is
+ * rounded the same way on every platform and compiler, so results can be
+ * replayed bit for bit anywhere.
+ *
+ * Products and quotients are found in 64 bits, then truncated towards zero.
+ * Conversions, sums, differences, products and quotients too large to
+ * represent saturate instead of wrapping. Wide numbers are raw 64 bit
+ * values, so products of two wide numbers have 32 fraction bits. Products of
+ * wide numbers below 32768 in size, and sums of two such products, are
+ * exact. Quotients of two such products are wide numbers w/ 32 fraction bits
+ * too, and products of those w/ scalars are truncated back to scalars.
+ */
+struct FixedPoint32Precision {
+  typedef int32_t Scalar;
+  typedef int64_t Wide;
+
+  static const int kFractionBits = 16;
+  static const int64_t kOne = (int64_t) 1 << kFractionBits;
+
+  static Scalar FromDouble(double value) {
+    //compared as doubles first, converting out of range doubles is undefined
+    double scaled = value * kOne;
+    if (!(scaled == scaled)) {
+      return 0;
+    }
+    if (scaled >= std::numeric_limits<Scalar>::max()) {
+      return std::numeric_limits<Scalar>::max();
+    }
+    if (scaled <= std::numeric_limits<Scalar>::min()) {
+      return std::numeric_limits<Scalar>::min();
+    }
+    //round to nearest, so values like 0.1 don't all land below their mark
+    return (Scalar) (scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+  }
+
+  static double ToDouble(Scalar value) {
+    return (double) value / kOne;
+  }
+
+  static Scalar Add(Scalar first, Scalar second) {
+    return Saturate((int64_t) first + second);
+  }
+
+  static Scalar Subtract(Scalar first, Scalar second) {
+    return Saturate((int64_t) first - second);
+  }
+
+  static Scalar Multiply(Scalar first, Scalar second) {
+    //division, unlike shifting negative numbers, is always well defined
+    return Saturate((int64_t) first * second / kOne);
+  }
+
+  static Scalar Divide(Scalar numerator, Scalar denominator) {
+    return Saturate((int64_t) numerator * kOne / denominator);
+  }
+
+  static Wide Widen(Scalar value) {
+    return value;
+  }
+
+  static Wide MultiplyWide(Wide first, Wide second) {
+    return first * second;
+  }
+
+  static Wide DivideWide(Wide numerator, Wide denominator) {
+    //long division one fraction bit at a time, since scaling the numerator
+    //up first can overflow 64 bits
+    bool negative = (numerator < 0) != (denominator < 0);
+    Wide remainder = numerator < 0 ? -numerator : numerator;
+    Wide divisor = denominator < 0 ? -denominator : denominator;
+    Wide whole = remainder / divisor;
+    if (whole > std::numeric_limits<Wide>::max() >> (2 * kFractionBits)) {
+      return negative ? std::numeric_limits<Wide>::min()
+                      : std::numeric_limits<Wide>::max();
+    }
+    remainder %= divisor;
+    Wide quotient = whole;
+    for (int bit = 0; bit < 2 * kFractionBits; bit++) {
+      //doubling the remainder is compared w/o computing it, so it can't
+      //overflow either
+      quotient <<= 1;
+      if (remainder >= divisor - remainder) {
+        remainder -= divisor - remainder;
+        quotient |= 1;
+      } else {
+        remainder += remainder;
+      }
+    }
+    return negative ? -quotient : quotient;
+  }
+
+  static Scalar NarrowProduct(Wide product, Scalar value) {
+    //products too large for 64 bits are far too large for a scalar
+    Wide magnitude = product < 0 ? -product : product;
+    if (value != 0 && magnitude > std::numeric_limits<Wide>::max() /
+                                  (value < 0 ? -(Wide) value : value)) {
+      return ((product < 0) != (value < 0))
+             ? std::numeric_limits<Scalar>::min()
+             : std::numeric_limits<Scalar>::max();
+    }
+    return Saturate(product * value / (kOne * kOne));
+  }
+
+  /**
+   * Clamps a 64 bit result to the range of a scalar.
+   */
+  static Scalar Saturate(int64_t value) {
+    if (value > std::numeric_limits<Scalar>::max()) {
+      return std::numeric_limits<Scalar>::max();
+    }
+    if (value < std::numeric_limits<Scalar>::min()) {
+      return std::numeric_limits<Scalar>::min();
+    }
+    return (Scalar) value;
+  }
+};
+
+} // namespace idealgas
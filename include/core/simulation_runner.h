@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "core/gas_container.h"
+#include "core/snapshot_buffer.h"
+
+namespace idealgas {
+
+using std::vector;
+
+/**
+ * Steps a gas container on its own thread, independent of how often the
+ * particles are drawn, and publishes snapshots of the particles that another
+ * thread can read w/o locks.
+ *
+ * Steps are paced to a target number of steps per second, or run as fast as
+ * possible. A step that falls behind is caught up by running several steps
+ * back to back, so any number of steps can happen between two reads. While
+ * running, the container must not be used by any other thread, settings are
+ * changed by queueing changes that the stepping thread applies between
+ * steps.
+ */
+class SimulationRunner {
+  public:
+    //steps per second that means stepping as fast as possible
+    static constexpr double kUnlimitedSteps = 0;
+
+    /**
+     * Constructor for a Simulation Runner of the given container, which must
+     * outlive it. Publishes the current particles right away, so there's a
+     * snapshot to read before stepping starts.
+     *
+     * @param container the container to step.
+     */
+    explicit SimulationRunner(GasContainer* container);
+
+    /**
+     * Destructor for a Simulation Runner, stops stepping.
+     */
+    ~SimulationRunner();
+
+    SimulationRunner(const SimulationRunner&) = delete;
+    SimulationRunner& operator=(const SimulationRunner&) = delete;
+
+    /**
+     * Starts stepping the container on a new thread. Does nothing if already
+     * running.
+     *
+     * @param steps_per_second  the target step rate, kUnlimitedSteps to step
+     *                          as fast as possible.
+     */
+    void Start(double steps_per_second);
+
+    /**
+     * Stops stepping and waits for the current step to finish. The last
+     * step's particles are published, and changes still queued are made,
+     * before returning.
+     */
+    void Stop();
+
+    /**
+     * Changes the target step rate, also while running.
+     *
+     * @param steps_per_second  the target step rate, kUnlimitedSteps to step
+     *                          as fast as possible.
+     */
+    void SetStepsPerSecond(double steps_per_second);
+
+    /**
+     * Checks if the container is being stepped.
+     *
+     * @return true if running, else false.
+     */
+    bool IsRunning() const;
+
+    /**
+     * Fetches the number of steps done since this runner was made.
+     *
+     * @return the step count.
+     */
+    size_t GetStepCount() const;
+
+    /**
+     * Changes the container between two steps, eg. to set its collision
+     * mode or thread count, or to read its profiler. While running, the
+     * change is queued and made by the stepping thread before its next step,
+     * or when stopping. Else it's made right away.
+     *
+     * @param change    the function to call w/ the container.
+     */
+    void QueueChange(const std::function<void(GasContainer&)>& change);
+
+    /**
+     * Copies the latest published particles into the given groups, if new
+     * ones were published since the last read. Only one thread may read.
+     *
+     * @param groups    groups to copy particles into, in the same order and
+     *                  w/ the same types as the container's groups.
+     *
+     * @return true if new particles were copied, else false.
+     */
+    bool ReadLatest(const vector<ParticleGroup*>& groups);
+
+    /**
+     * Fetches the step of the particles last copied by ReadLatest.
+     *
+     * @return the step count of the last read snapshot.
+     */
+    size_t GetReadStep() const;
+
+  private:
+    //falling behind by more than this many seconds is given up on, instead
+    //of stepping flat out until caught up
+    static constexpr double kMaxCatchUpSeconds = 0.25;
+
+    GasContainer* container_;
+    SnapshotBuffer snapshots_;
+    std::thread step_thread_;
+    std::atomic<bool> is_running_;
+    std::atomic<bool> stop_requested_;
+    std::atomic<double> steps_per_second_;
+    std::atomic<size_t> step_count_;
+
+    //changes waiting for the stepping thread, guarded by the change mutex
+    std::mutex change_mutex_;
+    vector<std::function<void(GasContainer&)>> queued_changes_;
+    std::atomic<bool> has_queued_changes_;
+
+    /**
+     * Steps the container at the target rate until asked to stop.
+     */
+    void RunSteps();
+
+    /**
+     * Makes every queued change to the container, in the order queued.
+     * The change mutex must be held.
+     */
+    void ApplyQueuedChanges();
+};
+
+} // namespace idealgas
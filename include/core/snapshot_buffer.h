@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "core/particle_group.h"
+
+namespace idealgas {
+
+using std::vector;
+
+/**
+ * Copies of the particles of every group at one step.
+ */
+struct ParticleSnapshot {
+  size_t step = 0;
+  vector<vector<float>> x_positions;   //x positions of every group
+  vector<vector<float>> y_positions;   //y positions of every group
+  vector<vector<float>> x_velocities;  //x velocities of every group
+  vector<vector<float>> y_velocities;  //y velocities of every group
+};
+
+/**
+ * Passes snapshots of particles from one writing thread to one reading
+ * thread w/o locks, using three snapshot slots.
+ *
+ * The writer fills its own slot, then swaps it w/ the shared slot. The reader
+ * swaps its own slot w/ the shared slot only if a new snapshot was published
+ * since. Neither side ever waits for the other, and the reader always holds a
+ * whole snapshot, never one that's half written. Snapshots the reader wasn't
+ * fast enough to take are replaced by newer ones.
+ */
+class SnapshotBuffer {
+  public:
+    /**
+     * Default constructor for a Snapshot Buffer w/ nothing published.
+     */
+    SnapshotBuffer();
+
+    SnapshotBuffer(const SnapshotBuffer&) = delete;
+    SnapshotBuffer& operator=(const SnapshotBuffer&) = delete;
+
+    /**
+     * Copies the particles of all groups into a new snapshot and makes it
+     * the latest one. Only called by the writing thread. Doesn't allocate
+     * once every slot has held groups of the same sizes.
+     *
+     * @param groups    the groups to copy.
+     * @param step      the number of steps done so far.
+     */
+    void Publish(const vector<ParticleGroup*>& groups, size_t step);
+
+    /**
+     * Checks if the latest published snapshot was already taken by the
+     * reader. Only called by the writing thread.
+     *
+     * @return true if nothing new is waiting for the reader, else false.
+     */
+    bool IsLatestTaken() const;
+
+    /**
+     * Takes the latest snapshot if one was published since the last read,
+     * and copies it into the given groups. Only called by the reading thread.
+     *
+     * @param groups    groups to copy particles into, in the same order and
+     *                  w/ the same types as the published groups.
+     *
+     * @return true if a new snapshot was copied, else false.
+     */
+    bool ReadLatest(const vector<ParticleGroup*>& groups);
+
+    /**
+     * Fetches the step of the snapshot last taken by the reader. Only called
+     * by the reading thread.
+     *
+     * @return the step of the snapshot, 0 if none was taken.
+     */
+    size_t GetReadStep() const;
+
+  private:
+    static const unsigned kSlotCount = 3;
+    //set in the shared state when its slot holds an untaken snapshot
+    static const unsigned kFreshBit = 4;
+    static const unsigned kSlotMask = 3;
+
+    ParticleSnapshot slots_[kSlotCount];
+    std::atomic<unsigned> shared_state_;  //shared slot index + fresh bit
+    unsigned write_slot_;                 //only used by the writer
+    unsigned read_slot_;                  //only used by the reader
+};
+
+} // namespace idealgas
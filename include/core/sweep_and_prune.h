@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include "core/particle.h"
+
+namespace idealgas {
+
+using std::vector;
+using idealgas::Particle;
+
+/**
+ * Particles sorted by where their extent starts along the longer axis of the
+ * container, used to find which particles are close enough to possibly
+ * collide. Two particles can only touch if their extents overlap on both
+ * axes, and a particle's overlaps along the sweep axis all come right after
+ * it in the sorted order.
+ *
+ * The order is kept between updates. Particles only move a fraction of their
+ * radius per update, so it barely changes, and repairing it w/ an insertion
+ * sort takes close to linear time.
+ *
+ * In a container whose edges wrap around, extents sticking out past one edge
+ * also overlap extents at the opposite edge. Particles wrapping around jump
+ * from one end of the order to the other, which costs a pass over the order
+ * for each of them.
+ */
+class SweepAndPrune {
+  public:
+    /**
+     * Default constructor for an empty Sweep And Prune, which sorts from
+     * scratch on its first update.
+     */
+    SweepAndPrune() = default;
+
+    /**
+     * Brings the extents of every particle up to date and repairs the sorted
+     * order. The order is started over if the particle list or the sweep
+     * axis changed.
+     *
+     * @param particles     storage of all particles.
+     * @param particle_list storage index of every particle, in list order.
+     * @param width         the width of the container.
+     * @param height        the height of the container, the sweep runs
+     *                      along y if it is longer than the width.
+     * @param wraps         if the edges of the container wrap around.
+     */
+    void Update(const vector<Particle>& particles,
+                const vector<size_t>& particle_list, double width,
+                double height, bool wraps = false);
+
+    /**
+     * Forgets the order, so the next update sorts from scratch. Needed when
+     * particles trade list positions, which can scramble the order too much
+     * for an insertion sort.
+     */
+    void Clear();
+
+    /**
+     * Lists the particles after the given slot in sweep order whose extents
+     * overlap the extent of the particle in that slot on both axes. Every
+     * overlapping pair is listed from exactly one of its particles. In a
+     * container that wraps around, particles overlapping across an edge are
+     * listed too, wherever they are in the order.
+     *
+     * @param slot      the position of the particle in sweep order.
+     * @param overlaps  the vector to fill w/ list positions of particles.
+     */
+    void ListOverlaps(size_t slot, vector<size_t>& overlaps) const;
+
+    /**
+     * Fetches the list position of the particle in a slot of sweep order.
+     *
+     * @param slot  the position in sweep order.
+     *
+     * @return the list position of the particle.
+     */
+    size_t GetParticleAt(size_t slot) const;
+
+    /**
+     * Fetches the number of particles in sweep order.
+     *
+     * @return the particle count.
+     */
+    size_t GetParticleCount() const;
+
+    /**
+     * Fetches the number of places particles moved by while repairing the
+     * order in the last update.
+     *
+     * @return the swap count, 0 if the order was started over.
+     */
+    size_t GetSwapCount() const;
+
+  private:
+    bool sweeps_along_y_ = false;
+    size_t swap_count_ = 0;
+    //container size along each axis if it wraps around, else 0
+    float sweep_length_ = 0;
+    float cross_length_ = 0;
+    float max_extent_length_ = 0;   //longest extent of any particle
+
+    //list positions in sweep order, and their extents along the sweep axis
+    vector<size_t> sorted_particles_;
+    vector<float> sweep_starts_;
+    vector<float> sweep_ends_;
+    //extents on the other axis, by slot in sweep order
+    vector<float> cross_starts_;
+    vector<float> cross_ends_;
+
+    /**
+     * Finds the extents of a particle on both axes, w/ a margin for float
+     * rounding in the contact test.
+     */
+    void FindExtents(const Particle& particle, float& sweep_start,
+                     float& sweep_end, float& cross_start,
+                     float& cross_end) const;
+
+    /**
+     * Checks if the extents of two slots overlap on the cross axis, through
+     * either edge if the container wraps around.
+     */
+    bool CrossExtentsOverlap(size_t slot, size_t other_slot) const;
+};
+
+} // namespace idealgas
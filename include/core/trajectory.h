@@ -0,0 +1,281 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/gas_container.h"
+
+namespace idealgas {
+
+using std::string;
+using std::vector;
+
+/**
+ * Start of a trajectory file.
+ *
+ * A trajectory file is the header, one TrajectoryGroup per particle group,
+ * then compressed chunks of frames, then the frame index and the footer.
+ * A frame has 4 columns of values for every particle in group order: x
+ * positions, y positions, x velocities and y velocities. Particles of a
+ * group are ordered by id, so a particle stays in the same place in every
+ * frame even if the container reorders particles in memory. In a chunk, the
+ * first frame is stored as is and every other frame as the difference to
+ * the frame before it, taken between the float bit patterns so it can be
+ * undone exactly. Chunk values are split into byte planes before being
+ * compressed, so the mostly zero high bytes of differences sit together.
+ */
+struct TrajectoryHeader {
+  char magic[8];            //always kTrajectoryMagic
+  uint32_t version;         //kTrajectoryVersion when written
+  uint32_t byte_order;      //kTrajectoryByteOrder as written
+  uint64_t group_count;
+  uint64_t particle_count;  //particles in every frame, over all groups
+  uint64_t frame_interval;  //steps between recorded frames
+  uint64_t frames_per_chunk;
+};
+
+/**
+ * Description of one particle group in a trajectory file.
+ */
+struct TrajectoryGroup {
+  uint64_t particle_count;
+  uint64_t particle_mass;
+  uint64_t particle_radius;
+};
+
+/**
+ * Start of one chunk of frames in a trajectory file.
+ */
+struct TrajectoryChunk {
+  uint64_t compressed_size;
+  uint64_t frame_count;
+};
+
+/**
+ * Where to find one frame in a trajectory file.
+ */
+struct TrajectoryFrameEntry {
+  uint64_t step;            //the step the frame was recorded after
+  uint64_t chunk_offset;    //where the frame's chunk starts in the file
+  uint64_t frame_in_chunk;
+};
+
+/**
+ * End of a trajectory file, pointing to the frame index.
+ */
+struct TrajectoryFooter {
+  uint64_t index_offset;
+  uint64_t frame_count;
+  char magic[8];            //always kTrajectoryMagic
+};
+
+const char kTrajectoryMagic[8] = {'I', 'G', 'A', 'S', 'T', 'R', 'A', 'J'};
+const uint32_t kTrajectoryVersion = 1;
+const uint32_t kTrajectoryByteOrder = 0x01020304;
+
+/**
+ * Records every Nth step of a gas container into a trajectory file.
+ *
+ * Recording only copies the particles into a free slot of a bounded queue.
+ * Frames are encoded, compressed and written on a background thread, and if
+ * the queue is full the frame is dropped instead of waiting, so recording
+ * never stops stepping.
+ */
+class TrajectoryWriter {
+  public:
+    /**
+     * Default constructor for a Trajectory Writer w/ no file open.
+     */
+    TrajectoryWriter() = default;
+
+    /**
+     * Destructor for a Trajectory Writer, closes the file if still open.
+     */
+    ~TrajectoryWriter();
+
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+    /**
+     * Creates a trajectory file for the particles of the given container.
+     *
+     * @param path              the file to write.
+     * @param container         the container whose particles are recorded.
+     * @param frame_interval    record a frame every this many steps.
+     * @param queue_capacity    the most frames waiting to be written.
+     *
+     * @return true if the file could be created, else false.
+     */
+    bool Open(const string& path, const GasContainer& container,
+              size_t frame_interval, size_t queue_capacity);
+
+    /**
+     * Records the particles of the container if the step is a multiple of
+     * the frame interval. Groups must not change size while recording.
+     *
+     * @param container the container to record.
+     * @param step      the number of steps done so far.
+     */
+    void RecordStep(const GasContainer& container, uint64_t step);
+
+    /**
+     * Writes all waiting frames, the frame index and the footer, then closes
+     * the file.
+     *
+     * @return true if the whole file was written successfully, else false.
+     */
+    bool Close();
+
+    /**
+     * Fetches the number of frames dropped because the queue was full.
+     *
+     * @return the number of dropped frames.
+     */
+    size_t GetDroppedFrameCount() const;
+
+  private:
+    //number of frames compressed together, a frame is found by decoding at
+    //most this many frames
+    static const size_t kFramesPerChunk = 16;
+
+    std::FILE* file_ = nullptr;
+    bool write_failed_ = false;
+    size_t frame_interval_ = 1;
+    size_t particle_count_ = 0;
+    size_t dropped_frames_ = 0;
+
+    //ring of frame slots shared w/ the write thread
+    std::mutex mutex_;
+    std::condition_variable frame_ready_;
+    std::thread write_thread_;
+    bool closing_ = false;
+    vector<vector<float>> frame_slots_;
+    vector<uint64_t> slot_steps_;
+    size_t first_full_slot_ = 0;
+    size_t full_slot_count_ = 0;
+    vector<float> group_values_;    //a reordered group's columns by index
+
+    //state only used by the write thread
+    vector<uint32_t> previous_frame_;
+    vector<uint32_t> chunk_values_;
+    vector<unsigned char> shuffled_bytes_;
+    vector<unsigned char> compressed_bytes_;
+    size_t chunk_frame_count_ = 0;
+    vector<TrajectoryFrameEntry> frame_index_;
+
+    /**
+     * Takes frames off the queue and writes them until closing.
+     */
+    void RunWriter();
+
+    /**
+     * Adds one frame to the current chunk, writing the chunk once it's full.
+     */
+    void EncodeFrame(const vector<float>& frame, uint64_t step);
+
+    /**
+     * Compresses and writes the current chunk, if it has any frames.
+     */
+    void WriteChunk();
+};
+
+/**
+ * Reads frames from a trajectory file. Any frame can be read directly by
+ * looking it up in the frame index.
+ */
+class TrajectoryReader {
+  public:
+    /**
+     * Default constructor for a Trajectory Reader w/ no file open.
+     */
+    TrajectoryReader() = default;
+
+    /**
+     * Destructor for a Trajectory Reader, closes the file.
+     */
+    ~TrajectoryReader();
+
+    TrajectoryReader(const TrajectoryReader&) = delete;
+    TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+    /**
+     * Opens a trajectory file and reads its frame index.
+     *
+     * @param path  the file to read.
+     *
+     * @return true if the file is a complete trajectory of a supported
+     *         version, else false.
+     */
+    bool Open(const string& path);
+
+    /**
+     * Fetches the header of the open file.
+     *
+     * @return the trajectory header.
+     */
+    const TrajectoryHeader& GetHeader() const;
+
+    /**
+     * Fetches the description of a group in the open file.
+     *
+     * @param index the index of the group.
+     *
+     * @return the group description.
+     */
+    const TrajectoryGroup& GetGroup(size_t index) const;
+
+    /**
+     * Fetches the number of frames in the open file.
+     *
+     * @return the frame count.
+     */
+    size_t GetFrameCount() const;
+
+    /**
+     * Fetches the step a frame was recorded after.
+     *
+     * @param frame the index of the frame.
+     *
+     * @return the step of the frame.
+     */
+    uint64_t GetFrameStep(size_t frame) const;
+
+    /**
+     * Reads the particles of a frame.
+     *
+     * @param frame         the index of the frame to read.
+     * @param x_positions   vector to fill w/ x positions.
+     * @param y_positions   vector to fill w/ y positions.
+     * @param x_velocities  vector to fill w/ x velocities.
+     * @param y_velocities  vector to fill w/ y velocities.
+     *
+     * @return true if the frame could be read, else false.
+     */
+    bool ReadFrame(size_t frame, vector<float>& x_positions,
+                   vector<float>& y_positions, vector<float>& x_velocities,
+                   vector<float>& y_velocities);
+
+  private:
+    std::FILE* file_ = nullptr;
+    uint64_t file_size_ = 0;
+    TrajectoryHeader header_;
+    vector<TrajectoryGroup> groups_;
+    vector<TrajectoryFrameEntry> frame_index_;
+
+    //last decoded chunk, so reading frames in order decodes each chunk once
+    uint64_t cached_chunk_offset_ = 0;
+    vector<uint32_t> chunk_values_;
+    vector<unsigned char> compressed_bytes_;
+    vector<unsigned char> shuffled_bytes_;
+
+    /**
+     * Reads, decompresses and decodes the chunk at the given offset.
+     */
+    bool LoadChunk(uint64_t chunk_offset);
+};
+
+} // namespace idealgas
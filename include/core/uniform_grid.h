@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vector>
+#include "core/particle.h"
+
+namespace idealgas {
+
+using std::vector;
+using idealgas::Particle;
+
+/**
+ * A uniform grid over the container used to find which particles are close
+ * enough to each other to possibly collide. Particles only need to be checked
+ * against the particles in their own cell and the 8 cells around it. In a
+ * container whose edges wrap around, cells on one edge neighbor the cells on
+ * the opposite edge.
+ */
+class UniformGrid {
+  public:
+    /**
+     * Default constructor for an empty Uniform Grid.
+     */
+    UniformGrid() = default;
+
+    /**
+     * Places every particle into the cell containing its position. Particles
+     * outside of the container are placed into the closest border cell.
+     *
+     * @param particles     storage of all particles.
+     * @param particle_list storage index of every particle to place into the
+     *                      grid, in list order.
+     * @param width         the width of the area covered by the grid.
+     * @param height        the height of the area covered by the grid.
+     * @param cell_size     the side length of one cell, must be at least the
+     *                      largest possible distance between colliding
+     *                      particles.
+     * @param wraps         if the edges of the area wrap around. Cells are
+     *                      then stretched to split the area evenly.
+     */
+    void Rebuild(const vector<Particle>& particles,
+                 const vector<size_t>& particle_list, double width,
+                 double height, double cell_size, bool wraps = false);
+
+    /**
+     * Lists the list positions of all particles in the same or neighboring
+     * cells as the given particle that come before it in the particle list.
+     *
+     * @param index     the list position of the particle to find neighbors of.
+     * @param neighbors the vector to fill, sorted in increasing index order.
+     */
+    void ListEarlierNeighbors(size_t index, vector<size_t>& neighbors) const;
+
+    /**
+     * Finds the columns or rows next to and including the given one, each
+     * listed once.
+     *
+     * @param cell              the column or row to find the neighbors of.
+     * @param cell_count        the number of columns or rows.
+     * @param wraps             if the first and last ones are neighbors.
+     * @param neighbor_cells    filled w/ the neighbors, in no particular
+     *                          order.
+     *
+     * @return the number of neighbors found, at most 3.
+     */
+    static size_t FindNeighborCells(size_t cell, size_t cell_count,
+                                    bool wraps, size_t neighbor_cells[3]);
+
+    /**
+     * Finds the column or row of the cell containing the given coordinate.
+     *
+     * @param coordinate    the x or y coordinate to find the cell of.
+     * @param cell_length   the width or height of the cells.
+     * @param cell_count    the number of columns or rows in the grid.
+     *
+     * @return the column or row containing the coordinate.
+     */
+    static size_t FindCellCoordinate(double coordinate, double cell_length,
+                                     size_t cell_count);
+
+  private:
+    double cell_width_ = 1.0;
+    double cell_height_ = 1.0;
+    bool wraps_ = false;
+    size_t column_count_ = 0;
+    size_t row_count_ = 0;
+
+    vector<size_t> particle_cells_; //stores cell index of each particle
+    vector<size_t> cell_starts_;    //stores where each cell begins in list
+    vector<size_t> cell_particles_; //stores particle indices sorted by cell
+    vector<size_t> next_slots_;     //next free slot of each cell
+};
+
+} // namespace idealgas
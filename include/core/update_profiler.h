@@ -0,0 +1,201 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace idealgas {
+
+/**
+ * Parts of an update or frame that are timed separately.
+ */
+enum class UpdatePhase {
+  kParticleCopy,        //copying particles out of and back into groups
+  kPairDetection,       //finding touching pairs of particles
+  kCollisionResponse,   //resolving collisions between touching pairs
+  kWallsAndIntegration, //wall collisions and moving particles, one pass
+  kEventStepping,       //a whole event driven update
+  kParticleSorting,     //reordering particles along a space filling curve
+  kHistograms,          //updating speed histograms
+  kDrawing,             //drawing particles and histograms
+  kPhaseCount
+};
+
+/**
+ * Amounts of work counted during updates.
+ */
+enum class UpdateCounter {
+  kPairsTested,         //pairs of particles checked for contact
+  kCollisionsResolved,  //collisions that changed velocities, event driven
+                        //updates also count wall collisions
+  kParticlesProcessed,  //particles moved, once per particle per update
+  kCounterCount
+};
+
+/**
+ * Collects the time spent in every phase of updates and counts of the work
+ * done, summed over all updates since the last reset.
+ *
+ * Code records into a profiler through the IDEALGAS_PROFILE_* macros, which
+ * compile to nothing unless IDEALGAS_PROFILING is defined, so a build w/o
+ * profiling has no timing overhead and every query returns 0.
+ */
+class UpdateProfiler {
+  public:
+    /**
+     * Default constructor for an Update Profiler w/ nothing recorded.
+     */
+    UpdateProfiler();
+
+    /**
+     * Adds time spent in a phase.
+     *
+     * @param phase     the phase the time was spent in.
+     * @param seconds   the time spent.
+     */
+    void AddPhaseTime(UpdatePhase phase, double seconds);
+
+    /**
+     * Adds to one of the work counters.
+     *
+     * @param counter   the counter to add to.
+     * @param amount    the amount of work done.
+     */
+    void AddCount(UpdateCounter counter, size_t amount);
+
+    /**
+     * Marks the end of an update.
+     */
+    void FinishUpdate();
+
+    /**
+     * Forgets everything recorded so far.
+     */
+    void Reset();
+
+    /**
+     * Fetches the total time spent in a phase since the last reset.
+     *
+     * @param phase the phase to fetch the time of.
+     *
+     * @return the time in seconds.
+     */
+    double GetPhaseSeconds(UpdatePhase phase) const;
+
+    /**
+     * Fetches the total of a work counter since the last reset.
+     *
+     * @param counter   the counter to fetch.
+     *
+     * @return the amount of work counted.
+     */
+    size_t GetCount(UpdateCounter counter) const;
+
+    /**
+     * Fetches the number of updates finished since the last reset.
+     *
+     * @return the update count.
+     */
+    size_t GetUpdateCount() const;
+
+    /**
+     * Writes a line naming the columns written by WriteCsvRow.
+     *
+     * @param file  the file to write to.
+     */
+    static void WriteCsvHeader(std::FILE* file);
+
+    /**
+     * Writes everything recorded since the last reset as one CSV line,
+     * starting w/ the given step.
+     *
+     * @param file  the file to write to.
+     * @param step  the number of steps done so far.
+     */
+    void WriteCsvRow(std::FILE* file, size_t step) const;
+
+    /**
+     * Writes everything recorded since the last reset as one line holding a
+     * JSON object, starting w/ the given step.
+     *
+     * @param file  the file to write to.
+     * @param step  the number of steps done so far.
+     */
+    void WriteJsonLine(std::FILE* file, size_t step) const;
+
+    /**
+     * Fetches the name of a phase as used in written columns.
+     *
+     * @param phase the phase to name.
+     *
+     * @return the name of the phase.
+     */
+    static const char* GetPhaseName(UpdatePhase phase);
+
+    /**
+     * Fetches the name of a counter as used in written columns.
+     *
+     * @param counter   the counter to name.
+     *
+     * @return the name of the counter.
+     */
+    static const char* GetCounterName(UpdateCounter counter);
+
+  private:
+    static const size_t kPhaseCount = (size_t) UpdatePhase::kPhaseCount;
+    static const size_t kCounterCount = (size_t) UpdateCounter::kCounterCount;
+
+    double phase_seconds_[kPhaseCount];
+    size_t counts_[kCounterCount];
+    size_t update_count_;
+};
+
+/**
+ * Adds the time from its construction to its destruction to a phase of a
+ * profiler. Used through IDEALGAS_PROFILE_PHASE.
+ */
+class ScopedPhaseTimer {
+  public:
+    /**
+     * Constructor for a Scoped Phase Timer, starts timing.
+     *
+     * @param profiler  the profiler to add the time to.
+     * @param phase     the phase being timed.
+     */
+    ScopedPhaseTimer(UpdateProfiler& profiler, UpdatePhase phase);
+
+    /**
+     * Destructor for a Scoped Phase Timer, adds the elapsed time.
+     */
+    ~ScopedPhaseTimer();
+
+    ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+  private:
+    UpdateProfiler& profiler_;
+    UpdatePhase phase_;
+    std::chrono::steady_clock::time_point start_time_;
+};
+
+} // namespace idealgas
+
+#define IDEALGAS_PROFILE_CONCAT_INNER(lhs, rhs) lhs##rhs
+#define IDEALGAS_PROFILE_CONCAT(lhs, rhs) IDEALGAS_PROFILE_CONCAT_INNER(lhs, rhs)
+
+#ifdef IDEALGAS_PROFILING
+//times the rest of the enclosing scope as the given phase
+#define IDEALGAS_PROFILE_PHASE(profiler, phase)                              \
+  ::idealgas::ScopedPhaseTimer IDEALGAS_PROFILE_CONCAT(phase_timer_,          \
+                                                       __LINE__)((profiler),  \
+                                                                 (phase))
+#define IDEALGAS_PROFILE_COUNT(profiler, counter, amount)                    \
+  (profiler).AddCount((counter), (amount))
+#define IDEALGAS_PROFILE_FINISH_UPDATE(profiler) (profiler).FinishUpdate()
+#else
+#define IDEALGAS_PROFILE_PHASE(profiler, phase) ((void) 0)
+//amount is not evaluated, sizeof only keeps counted variables from warning
+#define IDEALGAS_PROFILE_COUNT(profiler, counter, amount)                    \
+  ((void) sizeof((amount)))
+#define IDEALGAS_PROFILE_FINISH_UPDATE(profiler) ((void) 0)
+#endif
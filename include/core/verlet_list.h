@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include "core/particle.h"
+#include "core/uniform_grid.h"
+
+namespace idealgas {
+
+using std::vector;
+using idealgas::Particle;
+
+/**
+ * Cached lists of the particles close enough to each particle to possibly
+ * collide soon, so candidate pairs don't have to be found again every update.
+ *
+ * Pairs are listed if they are within their contact distance plus a skin
+ * distance. As long as no particle has moved more than half the skin since
+ * the lists were built, every pair not listed is still too far apart to
+ * touch, so the lists only need rebuilding once some particle has.
+ */
+class VerletList {
+  public:
+    /**
+     * Default constructor for an empty Verlet List, which needs a rebuild.
+     */
+    VerletList() = default;
+
+    /**
+     * Checks if the lists have to be rebuilt before they can be used for the
+     * given particles.
+     *
+     * @param particles     storage of all particles.
+     * @param particle_list storage index of every particle, in list order.
+     * @param skin          the skin distance the lists are wanted w/.
+     *
+     * @return true if the particle list or skin changed since the last
+     *         rebuild, or some particle moved more than half the skin.
+     */
+    bool NeedsRebuild(const vector<Particle>& particles,
+                      const vector<size_t>& particle_list, double skin) const;
+
+    /**
+     * Lists, for every particle, the earlier particles in the particle list
+     * within their contact distance plus the skin.
+     *
+     * @param particles     storage of all particles.
+     * @param particle_list storage index of every particle, in list order.
+     * @param width         the width of the container.
+     * @param height        the height of the container.
+     * @param max_radius    the largest radius of any particle.
+     * @param skin          the extra distance to list pairs within.
+     * @param wraps         if the edges of the container wrap around, so
+     *                      distances are to the closest copy of a particle.
+     */
+    void Rebuild(const vector<Particle>& particles,
+                 const vector<size_t>& particle_list, double width,
+                 double height, double max_radius, double skin,
+                 bool wraps = false);
+
+    /**
+     * Forgets the lists, so the next use rebuilds them.
+     */
+    void Clear();
+
+    /**
+     * Fetches where the neighbors of a particle start in the neighbor array.
+     *
+     * @param index the list position of the particle.
+     *
+     * @return the first slot of the particle's neighbors.
+     */
+    size_t GetNeighborStart(size_t index) const;
+
+    /**
+     * Fetches the list positions of all listed neighbors, grouped by
+     * particle and in increasing order for every particle.
+     *
+     * @return the neighbor array.
+     */
+    const vector<size_t>& GetNeighbors() const;
+
+    /**
+     * Fetches the number of times the lists were rebuilt.
+     *
+     * @return the rebuild count.
+     */
+    size_t GetRebuildCount() const;
+
+  private:
+    double skin_ = 0;
+    size_t rebuild_count_ = 0;
+    bool is_built_ = false;
+    vec2 period_ = vec2(0, 0);  //container size if it wraps around, else 0
+
+    //positions at the last rebuild, by list position
+    vector<float> x_build_positions_;
+    vector<float> y_build_positions_;
+
+    vector<size_t> neighbor_starts_;  //first neighbor slot of each particle
+    vector<size_t> neighbors_;        //earlier neighbors, grouped by particle
+
+    //scratch for rebuilding
+    UniformGrid grid_;
+    vector<size_t> grid_neighbors_;
+};
+
+} // namespace idealgas
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace idealgas {
+
+using std::vector;
+
+/**
+ * A fixed set of threads that run numbered tasks in parallel. The thread that
+ * calls ParallelFor also works on tasks, so a pool of 1 thread runs every task
+ * on the calling thread.
+ */
+class WorkerPool {
+  public:
+    /**
+     * Constructor for a Worker Pool.
+     *
+     * @param thread_count  total number of threads working on tasks,
+     *                      including the calling thread. 0 is treated as 1.
+     */
+    explicit WorkerPool(size_t thread_count);
+
+    /**
+     * Destructor for a Worker Pool, waits for all threads to stop.
+     */
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * Runs the given task once for every task number from 0 up to the task
+     * count, spread over all threads. Returns once every task has finished.
+     *
+     * @param task_count    the number of tasks to run.
+     * @param task          the task to run, given the task number.
+     */
+    void ParallelFor(size_t task_count,
+                     const std::function<void(size_t)>& task);
+
+    /**
+     * Fetches the number of threads working on tasks.
+     *
+     * @return the thread count, including the calling thread.
+     */
+    size_t GetThreadCount() const;
+
+  private:
+    vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable work_ready_;
+    std::condition_variable work_done_;
+
+    //current batch of tasks, changed only while no worker is busy
+    const std::function<void(size_t)>* task_ = nullptr;
+    size_t task_count_ = 0;
+    std::atomic<size_t> next_task_;
+    size_t busy_workers_ = 0;
+    size_t batch_number_ = 0;
+    bool stopping_ = false;
+
+    /**
+     * Waits for batches of tasks and works on them until the pool stops.
+     */
+    void RunWorker();
+
+    /**
+     * Claims and runs tasks from the current batch until none are left.
+     */
+    void RunAvailableTasks();
+};
+
+} // namespace idealgas
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "core/ideal_gas_histogram.h"
+
+namespace idealgas {
+
+namespace visualizer {
+
+using glm::vec2;
+using idealgas::IdealGasHistogram;
+
+/**
+ * Draws an ideal gas speed histogram in a box on the display.
+ */
+class HistogramDisplay {
+  public:
+    /**
+     * Constructor for a display of a histogram.
+     *
+     * @param top_left      coordinates of the top left position of graph.
+     * @param bottom_right  coordinates of the bottom right position of graph.
+     *
+     * @param width         width in pixels of the histogram.
+     * @param height        height in pixels of the histogram.
+     * @param margins       size in pixels of margins used in display.
+     * @param y_interval_size number of pixels for each y axis interval.
+     */
+    HistogramDisplay(const vec2& top_left, const vec2& bottom_right,
+                     size_t width, size_t height, size_t margins,
+                     size_t y_interval_size);
+
+    /**
+     * Draws the given histogram's box, axes and bars.
+     *
+     * @param histogram the histogram to draw.
+     * @param color     the color of the histogram bars.
+     */
+    void DrawHistogram(const IdealGasHistogram& histogram,
+                       const ci::Color& color) const;
+
+  private:
+    //corner positions of histogram on display
+    vec2 top_left_;
+    vec2 bottom_right_;
+
+    //histogram dimension values
+    size_t display_margin_;
+    size_t histogram_width_;
+    size_t histogram_height_;
+    size_t y_interval_pixels_;
+
+    /**
+     * Draws the outline and axes of the histogram on the display.
+     */
+    void DrawHistogramBox() const;
+
+    /**
+     * Draws the bars of the histogram based on the velocities of the particles.
+     *
+     * @param histogram     the histogram to draw the bars of.
+     * @param bottom_left   bottom left corner position of the histogram.
+     */
+    void DrawHistogramBars(const IdealGasHistogram& histogram,
+                           vec2 bottom_left) const;
+};
+
+} // namespace visualizer
+
+} // namespace idealgas
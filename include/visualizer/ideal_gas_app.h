@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include "cinder/app/App.h"
 #include "cinder/app/RendererGl.h"
 #include "cinder/gl/gl.h"
@@ -33,6 +34,10 @@ class IdealGasApp : public ci::app::App {
     const size_t kNumBuckets = 10;
     const size_t kYIntervalPixels = 2;
 
+    //simulation steps per second, stepped on its own thread independent of
+    //the frame rate, SimulationRunner::kUnlimitedSteps runs flat out
+    const double kStepsPerSecond = 60;
+
     //constants for particles
     const size_t kSmallParticlesCount = 200;
     const size_t kSmallParticleMass = 2;
@@ -50,7 +55,8 @@ class IdealGasApp : public ci::app::App {
     const ci::Color kBigParticleColor = "cyan";
 
   private:
-    IdealGasSimulator simulator_;
+    //held by pointer, since simulators can't be copied or moved
+    std::unique_ptr<IdealGasSimulator> simulator_;
 };
 
 } // namespace visualizer
@@ -1,9 +1,17 @@
 #pragma once
 
+#include <functional>
 #include <vector>
 #include <map>
+#include <memory>
 #include "core/particle.h"
 #include "core/particle_group.h"
+#include "core/gas_container.h"
+#include "core/gas_observables.h"
+#include "core/ideal_gas_histogram.h"
+#include "core/simulation_runner.h"
+#include "core/update_profiler.h"
+#include "visualizer/particle_renderer.h"
 #include "cinder/gl/gl.h"
 
 namespace idealgas {
@@ -13,6 +21,12 @@ namespace visualizer {
 using std::vector;
 using std::map;
 using glm::vec2;
+using idealgas::CollisionMode;
+using idealgas::GasContainer;
+using idealgas::GasObservables;
+using idealgas::IdealGasHistogram;
+using idealgas::SimulationRunner;
+using idealgas::UpdateProfiler;
 
 /**
  * A IdealGasSimulator that visualizes the motion of a number of ideal gas
@@ -51,7 +65,7 @@ class IdealGasSimulator {
 
     /**
      * Secondary constructor for an Ideal Gas Simulator with multiple particle
-     * types. Used for testing, given particle groups to simulate.
+     * types, given particle groups to simulate.
      *
      * @param top_left_corner       coordinates of container's top left corner.
      *
@@ -74,15 +88,70 @@ class IdealGasSimulator {
                       size_t display_margin, size_t num_buckets,
                       size_t y_interval);
 
+    //the stepping thread and display groups point into this simulator, so
+    //it's neither copied nor moved
+    IdealGasSimulator(const IdealGasSimulator&) = delete;
+    IdealGasSimulator& operator=(const IdealGasSimulator&) = delete;
+
+    /**
+     * Starts stepping the container on its own thread, so the simulation
+     * runs at its own rate however often frames are drawn. Afterwards the
+     * container is only changed through ChangeContainer.
+     *
+     * @param steps_per_second  the target step rate, or
+     *                          SimulationRunner::kUnlimitedSteps to step as
+     *                          fast as possible.
+     */
+    void StartStepping(double steps_per_second);
+
     /**
-     * Updates the particles' movement after one unit of time.
+     * Updates the particles' movement after one unit of time, then updates
+     * the speed histograms of all groups. Once stepping on its own thread,
+     * picks up the latest particles from that thread instead.
      */
     void Update();
 
     /**
      * Displays the current state of the particles in the Cinder application.
      */
-    void Draw() const;
+    void Draw();
+
+    /**
+     * Changes the container between two steps, eg. to set its collision
+     * mode or thread count, or to read its profiler. Once stepping on its
+     * own thread, the change is queued and made by that thread before its
+     * next step.
+     *
+     * @param change    the function to call w/ the container.
+     */
+    void ChangeContainer(const std::function<void(GasContainer&)>& change);
+
+    /**
+     * Fetches the container of particles being simulated. Only allowed
+     * before stepping on its own thread, since that thread changes the
+     * container as it steps.
+     *
+     * @return the simulated container.
+     * @throws std::logic_error if stepping on its own thread.
+     */
+    const GasContainer& GetContainer() const;
+
+    /**
+     * Fetches the profiler that histogram updates and drawing record their
+     * times into. Kept apart from the container's profiler, which the
+     * stepping thread records into.
+     *
+     * @return the profiler of this simulator.
+     */
+    UpdateProfiler& GetFrameProfiler();
+
+    /**
+     * Fetches the observables the container samples as it updates. Samples
+     * can be pulled while the container steps on its own thread.
+     *
+     * @return the observables of the simulated container.
+     */
+    GasObservables& GetObservables();
 
   private:
     vec2 top_left_corner_;
@@ -96,33 +165,43 @@ class IdealGasSimulator {
     size_t bucket_count_;
     size_t y_interval_pixels_;
 
-    vector<ParticleGroup*> particle_groups_;
+    GasContainer container_;
+
+    //speed histogram of each group, in the same order as the groups
+    vector<IdealGasHistogram> histograms_;
+
+    //draws all particles w/ one instanced call per group
+    ParticleRenderer particle_renderer_;
+    UpdateProfiler frame_profiler_;
+
+    //steps the container on its own thread once started, the particles it
+    //publishes are copied into display groups that are drawn instead
+    std::unique_ptr<SimulationRunner> runner_;
+    vector<ParticleGroup> display_groups_;
+    vector<ParticleGroup*> display_group_list_;
 
     /**
-     * Updates movements of all particles in all groups based on possible
-     * collisions between any particles. Helper method for updating.
+     * Fetches the groups that are drawn, the display groups once stepping
+     * on its own thread, else the container's groups.
      */
-    void HandleAllParticleCollisions();
+    const vector<ParticleGroup*>& GetDrawnGroups() const;
 
     /**
-     * Draws all particles from all groups for the display.
+     * Creates a histogram for every particle group being drawn.
      */
-    void DrawParticles() const;
+    void CreateHistograms();
 
     /**
-     * Draws histograms for all particle groups on the display.
+     * Draws all particles from all groups for the display.
      */
-    void DrawHistograms() const;
+    void DrawParticles();
 
     /**
-     * Creates a list of all particles from all groups in this simulator.
-     * Helper for handling particle collisions.
-     *
-     * @return a vector list of all particles.
+     * Draws histograms for all particle groups on the display.
      */
-    vector<Particle*> ListAllParticles() const;
+    void DrawHistograms() const;
 };
 
 } // namespace visualizer
 
-} // namespace idealgas
\ No newline at end of file
+} // namespace idealgas
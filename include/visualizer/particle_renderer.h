@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include "core/particle_group.h"
+#include "core/particle_instances.h"
+#include "cinder/gl/gl.h"
+
+namespace idealgas {
+
+namespace visualizer {
+
+using std::vector;
+using glm::vec2;
+using idealgas::ParticleInstancePacker;
+
+/**
+ * Draws particles as instanced circles. The centers of all particles are
+ * written into one vertex buffer kept between frames, then every group is
+ * drawn w/ a single instanced call, its color and radius set as uniforms.
+ */
+class ParticleRenderer {
+  public:
+    /**
+     * Default constructor for a Particle Renderer. GL objects are created on
+     * the first draw, once a GL context exists.
+     */
+    ParticleRenderer() = default;
+
+    /**
+     * Draws all particles of the given groups.
+     *
+     * @param groups            the groups of particles to draw.
+     * @param top_left_corner   screen position of the container's top left
+     *                          corner.
+     */
+    void Draw(const vector<ParticleGroup*>& groups,
+              const vec2& top_left_corner);
+
+  private:
+    //number of triangles around every circle
+    static const int kCircleSegments = 24;
+
+    ParticleInstancePacker packer_;
+    ci::gl::GlslProgRef shader_;
+    ci::gl::VboRef instance_buffer_;
+    size_t instance_capacity_ = 0;
+
+    //one batch per group, each reading its own range of the instance buffer
+    vector<ci::gl::BatchRef> group_batches_;
+
+    /**
+     * Compiles the shader that places and colors circle instances.
+     */
+    void CreateShader();
+
+    /**
+     * Makes sure the instance buffer holds at least the given number of
+     * instances, replacing it w/ a bigger one if not.
+     *
+     * @return true if the buffer was replaced, else false.
+     */
+    bool ReserveInstances(size_t instance_count);
+
+    /**
+     * Creates a batch for every group, reading the group's range of the
+     * instance buffer.
+     */
+    void CreateBatches();
+};
+
+} // namespace visualizer
+
+} // namespace idealgas
@@ -0,0 +1,337 @@
+#include "core/checkpoint.h"
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace idealgas {
+
+namespace {
+
+/**
+ * Rounds an offset up to the next multiple of the checkpoint alignment.
+ */
+uint64_t AlignOffset(uint64_t offset) {
+  return (offset + kCheckpointAlignment - 1) / kCheckpointAlignment *
+         kCheckpointAlignment;
+}
+
+/**
+ * Finds the groups of a container, listing groups that appear more than once
+ * only once.
+ */
+vector<ParticleGroup*> ListUniqueGroups(const GasContainer& container) {
+  const vector<ParticleGroup*>& groups = container.GetParticleGroups();
+  vector<ParticleGroup*> unique_groups;
+  for (size_t group_index = 0; group_index < groups.size(); group_index++) {
+    if (FindFirstListing(groups, group_index) == group_index) {
+      unique_groups.push_back(groups[group_index]);
+    }
+  }
+  return unique_groups;
+}
+
+} // namespace
+
+CheckpointWriter::~CheckpointWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  condition_.notify_all();
+  if (write_thread_.joinable()) {
+    write_thread_.join();
+  }
+}
+
+void CheckpointWriter::SaveAsync(const GasContainer& container,
+                                 uint64_t step_count, const string& path) {
+  //lay out groups and their arrays
+  vector<ParticleGroup*> groups = ListUniqueGroups(container);
+  vector<CheckpointGroup> group_records(groups.size());
+  uint64_t offset = AlignOffset(sizeof(CheckpointHeader) +
+                                groups.size() * sizeof(CheckpointGroup));
+  for (size_t index = 0; index < groups.size(); index++) {
+    ParticleGroup* group = groups.at(index);
+    CheckpointGroup& record = group_records.at(index);
+    std::memset(&record, 0, sizeof(record));
+    ci::Color color = group->GetGroupColor();
+    record.particle_count = group->GetGroupSize();
+    record.particle_mass = group->GetParticleMass();
+    record.particle_radius = group->GetParticleRadius();
+    record.color[0] = color.r;
+    record.color[1] = color.g;
+    record.color[2] = color.b;
+    record.max_x_position = group->GetMaxXPosition();
+    record.max_y_position = group->GetMaxYPosition();
+    record.arrays_offset = offset;
+    offset = AlignOffset(offset + 4 * record.particle_count * sizeof(float));
+  }
+
+  CheckpointHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kCheckpointMagic, sizeof(header.magic));
+  header.version = kCheckpointVersion;
+  header.byte_order = kCheckpointByteOrder;
+  header.group_count = groups.size();
+  header.container_width = container.GetContainerWidth();
+  header.container_height = container.GetContainerHeight();
+  header.step_count = step_count;
+  header.file_size = offset;
+
+  //copy everything into the file image, this is all the caller waits for
+  next_contents_.assign(offset, 0);
+  std::memcpy(next_contents_.data(), &header, sizeof(header));
+  if (!group_records.empty()) {
+    std::memcpy(next_contents_.data() + sizeof(header), group_records.data(),
+                group_records.size() * sizeof(CheckpointGroup));
+  }
+  for (size_t index = 0; index < groups.size(); index++) {
+    const CheckpointGroup& record = group_records.at(index);
+    float* arrays = reinterpret_cast<float*>(next_contents_.data() +
+                                             record.arrays_offset);
+    size_t count = record.particle_count;
+    groups.at(index)->CopyParticleArrays(arrays, arrays + count,
+                                         arrays + 2 * count,
+                                         arrays + 3 * count);
+  }
+
+  //images are swapped rather than copied, so three of them are reused
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (save_queued_) {
+      replaced_save_count_++;
+    }
+    queued_contents_.swap(next_contents_);
+    queued_path_ = path;
+    save_queued_ = true;
+    if (!write_thread_.joinable()) {
+      write_thread_ = std::thread(&CheckpointWriter::RunWriter, this);
+    }
+  }
+  condition_.notify_all();
+}
+
+bool CheckpointWriter::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  condition_.wait(lock, [this] { return !save_queued_ && !writing_; });
+  return write_succeeded_;
+}
+
+size_t CheckpointWriter::GetReplacedSaveCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return replaced_save_count_;
+}
+
+void CheckpointWriter::RunWriter() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    condition_.wait(lock, [this] { return save_queued_ || stopping_; });
+    if (!save_queued_) {
+      return;
+    }
+    file_contents_.swap(queued_contents_);
+    string path = queued_path_;
+    save_queued_ = false;
+    writing_ = true;
+
+    lock.unlock();
+    bool written = WriteFile(path);
+    lock.lock();
+    writing_ = false;
+    write_succeeded_ = write_succeeded_ && written;
+    condition_.notify_all();
+  }
+}
+
+bool CheckpointWriter::WriteFile(const string& path) {
+  string temporary_path = path + ".tmp";
+  std::FILE* file = std::fopen(temporary_path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  //the data has to be on disk before the rename is, or a crash could leave
+  //a renamed but empty file in place of the previous checkpoint
+  bool written = std::fwrite(file_contents_.data(), 1, file_contents_.size(),
+                             file) == file_contents_.size();
+  written = written && std::fflush(file) == 0;
+#if defined(_WIN32)
+  written = written && _commit(_fileno(file)) == 0;
+#else
+  written = written && fsync(fileno(file)) == 0;
+#endif
+  written = std::fclose(file) == 0 && written;
+
+#if defined(_WIN32)
+  //rename doesn't replace existing files on windows
+  written = written && MoveFileExA(temporary_path.c_str(), path.c_str(),
+                                   MOVEFILE_REPLACE_EXISTING |
+                                   MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  written = written &&
+            std::rename(temporary_path.c_str(), path.c_str()) == 0;
+  if (written) {
+    //the rename itself only lasts through a crash once its directory does
+    size_t name_start = path.find_last_of('/');
+    string directory = name_start == string::npos ? "." :
+                       path.substr(0, name_start + 1);
+    int directory_file = open(directory.c_str(), O_RDONLY);
+    if (directory_file >= 0) {
+      fsync(directory_file);
+      close(directory_file);
+    }
+  }
+#endif
+  if (!written) {
+    std::remove(temporary_path.c_str());
+  }
+  return written;
+}
+
+MappedCheckpoint::~MappedCheckpoint() {
+  Close();
+}
+
+bool MappedCheckpoint::Open(const string& path) {
+  Close();
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER file_size;
+  HANDLE mapping = nullptr;
+  if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  }
+  CloseHandle(file);
+  if (mapping == nullptr) {
+    return false;
+  }
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (view == nullptr) {
+    return false;
+  }
+  data_ = static_cast<const char*>(view);
+  size_ = (size_t) file_size.QuadPart;
+#else
+  int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    return false;
+  }
+  struct stat file_status;
+  void* view = MAP_FAILED;
+  if (fstat(file, &file_status) == 0 && file_status.st_size > 0) {
+    view = mmap(nullptr, (size_t) file_status.st_size, PROT_READ, MAP_PRIVATE,
+                file, 0);
+  }
+  close(file);
+  if (view == MAP_FAILED) {
+    return false;
+  }
+  data_ = static_cast<const char*>(view);
+  size_ = (size_t) file_status.st_size;
+#endif
+
+  if (!IsValid()) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void MappedCheckpoint::Close() {
+  if (data_ == nullptr) {
+    return;
+  }
+#if defined(_WIN32)
+  UnmapViewOfFile(data_);
+#else
+  munmap(const_cast<char*>(data_), size_);
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
+
+const CheckpointHeader& MappedCheckpoint::GetHeader() const {
+  return *reinterpret_cast<const CheckpointHeader*>(data_);
+}
+
+const CheckpointGroup& MappedCheckpoint::GetGroup(size_t index) const {
+  return reinterpret_cast<const CheckpointGroup*>(
+      data_ + sizeof(CheckpointHeader))[index];
+}
+
+const float* MappedCheckpoint::GetGroupArray(size_t index,
+                                             size_t array) const {
+  const CheckpointGroup& group = GetGroup(index);
+  return reinterpret_cast<const float*>(data_ + group.arrays_offset) +
+         array * group.particle_count;
+}
+
+vector<ParticleGroup*> MappedCheckpoint::CreateGroups() const {
+  vector<ParticleGroup*> groups;
+  for (size_t index = 0; index < GetHeader().group_count; index++) {
+    const CheckpointGroup& record = GetGroup(index);
+    ci::Color color(record.color[0], record.color[1], record.color[2]);
+    ParticleGroup* group = new ParticleGroup(0, record.particle_mass,
+                                             record.particle_radius, color,
+                                             record.max_x_position,
+                                             record.max_y_position, 0.0,
+                                             0, 0);
+    group->AssignParticleArrays(GetGroupArray(index, 0),
+                                GetGroupArray(index, 1),
+                                GetGroupArray(index, 2),
+                                GetGroupArray(index, 3),
+                                record.particle_count);
+    groups.push_back(group);
+  }
+  return groups;
+}
+
+bool MappedCheckpoint::IsValid() const {
+  if (size_ < sizeof(CheckpointHeader)) {
+    return false;
+  }
+  const CheckpointHeader& header = GetHeader();
+  if (std::memcmp(header.magic, kCheckpointMagic, sizeof(header.magic)) != 0 ||
+      header.version != kCheckpointVersion ||
+      header.byte_order != kCheckpointByteOrder ||
+      header.file_size != size_) {
+    return false;
+  }
+
+  //every group's arrays must lie completely inside the file
+  uint64_t groups_end = sizeof(CheckpointHeader) +
+                        header.group_count * sizeof(CheckpointGroup);
+  if (header.group_count > size_ / sizeof(CheckpointGroup) ||
+      groups_end > size_) {
+    return false;
+  }
+  for (size_t index = 0; index < header.group_count; index++) {
+    const CheckpointGroup& group = GetGroup(index);
+    if (group.arrays_offset % kCheckpointAlignment != 0 ||
+        group.arrays_offset < groups_end || group.arrays_offset > size_ ||
+        group.particle_count > (size_ - group.arrays_offset) /
+                               (4 * sizeof(float))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace idealgas
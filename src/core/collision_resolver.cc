@@ -0,0 +1,194 @@
+#include "core/collision_resolver.h"
+#include "core/particle_kernels.h"
+#include "core/particle_utils.h"
+#include <limits>
+
+namespace idealgas {
+
+using idealgas::particlekernels::CollidePairs;
+using idealgas::particlekernels::CollisionArrays;
+using idealgas::particleutils::CollideParticles;
+
+void CollisionResolver::ResolveContacts(const vector<ContactPair>& contacts,
+                                        vector<Particle>& particles,
+                                        const vector<size_t>& particle_list,
+                                        WorkerPool& pool,
+                                        const vec2& period) {
+  resolved_count_ = 0;
+  period_ = period;
+  bool runs_parallel = pool.GetThreadCount() > 1 &&
+                       contacts.size() >= kMinParallelContacts;
+  if (runs_parallel) {
+    BuildChains(contacts, particles.size(), particle_list,
+                pool.GetThreadCount() * kBatchesPerThread);
+  } else {
+    //one batch w/ every contact in order
+    ordered_contacts_.resize(contacts.size());
+    for (size_t contact = 0; contact < contacts.size(); contact++) {
+      ordered_contacts_[contact] = contact;
+    }
+  }
+
+  //the pair kernel has no minimum image offsets, so contacts in containers
+  //whose edges wrap around are resolved one at a time
+  batched_ = period.x == 0 && period.y == 0;
+  if (batched_) {
+    GatherContactParticles(contacts, particles, particle_list);
+  }
+
+  //tasks only capture this, so they fit in std::function w/o allocating
+  contacts_ = &contacts;
+  particles_ = &particles;
+  particle_list_ = &particle_list;
+  if (!runs_parallel) {
+    resolved_count_ = ResolveSlots(0, contacts.size());
+  } else {
+    size_t batch_count = batch_starts_.size() - 1;
+    batch_resolved_counts_.assign(batch_count, 0);
+    pool.ParallelFor(batch_count, [this](size_t batch) {
+      batch_resolved_counts_[batch] =
+          ResolveSlots(chain_starts_.at(batch_starts_.at(batch)),
+                       chain_starts_.at(batch_starts_.at(batch + 1)));
+    });
+    for (size_t batch = 0; batch < batch_count; batch++) {
+      resolved_count_ += batch_resolved_counts_[batch];
+    }
+  }
+
+  if (batched_) {
+    StoreContactVelocities(particles);
+  }
+}
+
+size_t CollisionResolver::GetResolvedCount() const {
+  return resolved_count_;
+}
+
+size_t CollisionResolver::ResolveSlots(size_t first_slot, size_t last_slot) {
+  if (batched_) {
+    //pairs of separate chains share no particles, so the kernel may check
+    //them together, and pairs of one chain stay in order
+    CollisionArrays arrays = {x_positions_.data(), y_positions_.data(),
+                              x_velocities_.data(), y_velocities_.data(),
+                              masses_.data(), radii_.data()};
+    return CollidePairs(arrays, first_particles_.data() + first_slot,
+                        second_particles_.data() + first_slot,
+                        last_slot - first_slot);
+  }
+
+  size_t resolved_count = 0;
+  for (size_t slot = first_slot; slot < last_slot; slot++) {
+    const ContactPair& contact = (*contacts_)[ordered_contacts_[slot]];
+    if (CollideParticles((*particles_)[(*particle_list_)[contact.index]],
+                         (*particles_)[(*particle_list_)[contact.other_index]],
+                         period_)) {
+      resolved_count++;
+    }
+  }
+  return resolved_count;
+}
+
+void CollisionResolver::GatherContactParticles(
+    const vector<ContactPair>& contacts, const vector<Particle>& particles,
+    const vector<size_t>& particle_list) {
+  //arrays are indexed by storage index, but only touching particles are
+  //copied in
+  x_positions_.resize(particles.size());
+  y_positions_.resize(particles.size());
+  x_velocities_.resize(particles.size());
+  y_velocities_.resize(particles.size());
+  masses_.resize(particles.size());
+  radii_.resize(particles.size());
+  first_particles_.resize(contacts.size());
+  second_particles_.resize(contacts.size());
+  for (size_t slot = 0; slot < contacts.size(); slot++) {
+    const ContactPair& contact = contacts[ordered_contacts_[slot]];
+    first_particles_[slot] = particle_list[contact.index];
+    second_particles_[slot] = particle_list[contact.other_index];
+    for (size_t particle: {first_particles_[slot], second_particles_[slot]}) {
+      const Particle& stored = particles[particle];
+      x_positions_[particle] = stored.position.x;
+      y_positions_[particle] = stored.position.y;
+      x_velocities_[particle] = stored.velocity.x;
+      y_velocities_[particle] = stored.velocity.y;
+      masses_[particle] = (float) stored.mass;
+      radii_[particle] = (float) stored.radius;
+    }
+  }
+}
+
+void CollisionResolver::StoreContactVelocities(vector<Particle>& particles) {
+  for (size_t slot = 0; slot < first_particles_.size(); slot++) {
+    for (size_t particle: {first_particles_[slot], second_particles_[slot]}) {
+      particles[particle].velocity =
+          vec2(x_velocities_[particle], y_velocities_[particle]);
+    }
+  }
+}
+
+size_t CollisionResolver::FindChainRoot(size_t particle) {
+  while (chain_parents_[particle] != particle) {
+    chain_parents_[particle] = chain_parents_[chain_parents_[particle]];
+    particle = chain_parents_[particle];
+  }
+  return particle;
+}
+
+void CollisionResolver::BuildChains(const vector<ContactPair>& contacts,
+                                    size_t particle_count,
+                                    const vector<size_t>& particle_list,
+                                    size_t batch_count) {
+  //join particles of every contact into the same chain
+  chain_parents_.resize(particle_count);
+  for (size_t particle = 0; particle < particle_count; particle++) {
+    chain_parents_[particle] = particle;
+  }
+  for (const ContactPair& contact: contacts) {
+    size_t root = FindChainRoot(particle_list[contact.index]);
+    size_t other_root = FindChainRoot(particle_list[contact.other_index]);
+    if (root != other_root) {
+      chain_parents_[root] = other_root;
+    }
+  }
+
+  //number chains in order of their first contact and count their contacts
+  const size_t kNoChain = std::numeric_limits<size_t>::max();
+  chain_numbers_.assign(particle_count, kNoChain);
+  contact_chains_.resize(contacts.size());
+  chain_starts_.assign(1, 0);
+  for (size_t contact = 0; contact < contacts.size(); contact++) {
+    size_t root = FindChainRoot(particle_list[contacts[contact].index]);
+    if (chain_numbers_[root] == kNoChain) {
+      chain_numbers_[root] = chain_starts_.size() - 1;
+      chain_starts_.push_back(0);
+    }
+    contact_chains_[contact] = chain_numbers_[root];
+    chain_starts_[contact_chains_[contact] + 1]++;
+  }
+
+  //group contacts by chain, keeping their order within each chain
+  for (size_t chain = 1; chain < chain_starts_.size(); chain++) {
+    chain_starts_[chain] += chain_starts_[chain - 1];
+  }
+  ordered_contacts_.resize(contacts.size());
+  size_t chain_count = chain_starts_.size() - 1;
+  next_slots_.assign(chain_starts_.begin(), chain_starts_.end() - 1);
+  for (size_t contact = 0; contact < contacts.size(); contact++) {
+    ordered_contacts_[next_slots_[contact_chains_[contact]]++] = contact;
+  }
+
+  //split chains into batches w/ about the same number of contacts each
+  size_t contacts_per_batch = contacts.size() / batch_count + 1;
+  batch_starts_.assign(1, 0);
+  for (size_t chain = 0; chain < chain_count; chain++) {
+    if (chain_starts_[chain + 1] - chain_starts_[batch_starts_.back()] >=
+        contacts_per_batch) {
+      batch_starts_.push_back(chain + 1);
+    }
+  }
+  if (batch_starts_.back() != chain_count) {
+    batch_starts_.push_back(chain_count);
+  }
+}
+
+} // namespace idealgas
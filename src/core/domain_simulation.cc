@@ -0,0 +1,464 @@
+#include "core/domain_simulation.h"
+#include "core/particle_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace idealgas {
+
+using idealgas::particleutils::ParticlesTouching;
+
+namespace {
+
+bool HasEarlierId(const DomainParticle& first, const DomainParticle& second) {
+  return first.id < second.id;
+}
+
+/**
+ * Finds the first particle of the set of touching particles a particle is
+ * in, shortening the path to it on the way.
+ */
+size_t FindChainRoot(vector<size_t>& roots, size_t index) {
+  while (roots[index] != index) {
+    roots[index] = roots[roots[index]];
+    index = roots[index];
+  }
+  return index;
+}
+
+} // namespace
+
+DomainSimulation::DomainSimulation(
+    const map<Particle, size_t>& particle_information, size_t container_width,
+    size_t container_height, uint64_t seed, DomainTransport* transport,
+    size_t thread_count) : transport_(transport) {
+  rank_ = transport_->GetRank();
+  domain_count_ = transport_->GetDomainCount();
+  container_width_ = container_width;
+  container_height_ = container_height;
+  splits_along_y_ = container_height > container_width;
+  strip_length_ = (double) (splits_along_y_ ? container_height :
+                                              container_width) /
+                  domain_count_;
+  outgoing_messages_.resize(domain_count_);
+  incoming_messages_.resize(domain_count_);
+
+  //place particles exactly like a single container, one at a time, and
+  //only keep this strip's, so no domain holds all of them
+  uint32_t next_id = 0;
+  size_t max_radius = 0;
+  for (auto const& entry: particle_information) {
+    uint32_t group_index = (uint32_t) local_groups_.size();
+    ParticleGroup* group = GasContainer::CreateParticleGroup(
+        entry.first, 0, container_width, container_height, seed, group_index);
+    for (size_t index = 0; index < entry.second; index++) {
+      Particle particle = group->PlaceParticle(seed, group_index, index);
+      DomainParticle domain_particle = {next_id++, group_index,
+                                        particle.position.x,
+                                        particle.position.y,
+                                        particle.velocity.x,
+                                        particle.velocity.y};
+      //ids only grow, so owned particles stay sorted by id
+      if (FindOwner(domain_particle) == rank_) {
+        owned_particles_.push_back(domain_particle);
+      }
+    }
+    local_groups_.push_back(group);
+    max_radius = std::max(max_radius, group->GetParticleRadius());
+  }
+  contact_distance_ = particleutils::FindContactDistance(max_radius);
+
+  local_container_ = GasContainer(local_groups_, container_width,
+                                  container_height);
+  local_container_.SetThreadCount(thread_count);
+}
+
+DomainSimulation::~DomainSimulation() {
+  for (ParticleGroup* group: local_groups_) {
+    delete group;
+  }
+}
+
+bool DomainSimulation::Update() {
+  double halo_width = kHaloContactDistances * contact_distance_;
+  while (true) {
+    if (!ExchangeHalos(halo_width)) {
+      return false;
+    }
+    bool all_complete = false;
+    if (!AgreeOnAll(ContactChainsComplete(halo_width), all_complete)) {
+      return false;
+    }
+    if (all_complete) {
+      break;
+    }
+    //every domain retries, so all halos stay the same depth
+    halo_width *= 2.0;
+    halo_retry_count_++;
+  }
+
+  UpdateLocalParticles();
+  return MigrateParticles();
+}
+
+void DomainSimulation::SetCollisionMode(CollisionMode mode) {
+  if (mode == CollisionMode::kVerletList) {
+    mode = CollisionMode::kUniformGrid;
+  }
+  local_container_.SetCollisionMode(mode);
+}
+
+void DomainSimulation::SetThreadCount(size_t thread_count) {
+  local_container_.SetThreadCount(thread_count);
+}
+
+bool DomainSimulation::GatherParticleGroups(vector<ParticleGroup*>& groups) {
+  groups.clear();
+  if (rank_ != 0) {
+    vector<unsigned char>& message = outgoing_messages_[0];
+    message.clear();
+    AppendParticles(owned_particles_.data(), owned_particles_.size(),
+                    message);
+    return transport_->Send(0, message);
+  }
+
+  vector<DomainParticle> all_particles = owned_particles_;
+  for (size_t peer = 1; peer < domain_count_; peer++) {
+    if (!transport_->Receive(peer, incoming_messages_[peer])) {
+      return false;
+    }
+    ReadParticles(incoming_messages_[peer], all_particles);
+  }
+  std::sort(all_particles.begin(), all_particles.end(), HasEarlierId);
+
+  //ids run through each group in order, so every group is one range
+  size_t next_particle = 0;
+  for (size_t group_index = 0; group_index < local_groups_.size();
+       group_index++) {
+    const ParticleGroup* local_group = local_groups_[group_index];
+    group_x_positions_.clear();
+    group_y_positions_.clear();
+    group_x_velocities_.clear();
+    group_y_velocities_.clear();
+    for (; next_particle < all_particles.size() &&
+           all_particles[next_particle].group_index == group_index;
+         next_particle++) {
+      const DomainParticle& particle = all_particles[next_particle];
+      group_x_positions_.push_back(particle.x_position);
+      group_y_positions_.push_back(particle.y_position);
+      group_x_velocities_.push_back(particle.x_velocity);
+      group_y_velocities_.push_back(particle.y_velocity);
+    }
+    ParticleGroup* group = new ParticleGroup(
+        0, local_group->GetParticleMass(), local_group->GetParticleRadius(),
+        local_group->GetGroupColor(), local_group->GetMaxXPosition(),
+        local_group->GetMaxYPosition(), 0, 0, 0);
+    group->AssignParticleArrays(group_x_positions_.data(),
+                                group_y_positions_.data(),
+                                group_x_velocities_.data(),
+                                group_y_velocities_.data(),
+                                group_x_positions_.size());
+    groups.push_back(group);
+  }
+  return true;
+}
+
+const vector<DomainParticle>& DomainSimulation::GetOwnedParticles() const {
+  return owned_particles_;
+}
+
+size_t DomainSimulation::GetHaloRetryCount() const {
+  return halo_retry_count_;
+}
+
+size_t DomainSimulation::GetMigrationCount() const {
+  return migration_count_;
+}
+
+bool DomainSimulation::ExchangeHalos(double halo_width) {
+  for (vector<unsigned char>& message: outgoing_messages_) {
+    message.clear();
+  }
+  //strips are in order, so the strips a particle is near are all next to
+  //each other around its own
+  for (const DomainParticle& particle: owned_particles_) {
+    for (size_t peer = rank_; peer > 0 &&
+         FindDistanceToStrip(particle, peer - 1) <= halo_width; peer--) {
+      AppendParticles(&particle, 1, outgoing_messages_[peer - 1]);
+    }
+    for (size_t peer = rank_ + 1; peer < domain_count_ &&
+         FindDistanceToStrip(particle, peer) <= halo_width; peer++) {
+      AppendParticles(&particle, 1, outgoing_messages_[peer]);
+    }
+  }
+  if (!ExchangeWithAllDomains()) {
+    return false;
+  }
+
+  halo_particles_.clear();
+  for (size_t peer = 0; peer < domain_count_; peer++) {
+    if (peer != rank_) {
+      ReadParticles(incoming_messages_[peer], halo_particles_);
+    }
+  }
+  std::sort(halo_particles_.begin(), halo_particles_.end(), HasEarlierId);
+
+  //list everything in id order, the order of a single container
+  local_particles_.resize(owned_particles_.size() + halo_particles_.size());
+  std::merge(owned_particles_.begin(), owned_particles_.end(),
+             halo_particles_.begin(), halo_particles_.end(),
+             local_particles_.begin(), HasEarlierId);
+  local_owned_.resize(local_particles_.size());
+  for (size_t index = 0; index < local_particles_.size(); index++) {
+    local_owned_[index] = FindOwner(local_particles_[index]) == rank_;
+  }
+  return true;
+}
+
+bool DomainSimulation::ContactChainsComplete(double halo_width) {
+  //a halo this deep holds every particle of the container
+  double split_length = strip_length_ * domain_count_;
+  if (domain_count_ == 1 || halo_width >= 2.0 * split_length) {
+    return true;
+  }
+
+  //a chain from past the halo reaches owned particles through halo
+  //particles, so only they and owned particles close enough to touch them
+  //are joined into chains
+  chain_list_.clear();
+  chain_owned_.clear();
+  chain_frontier_.clear();
+  for (size_t index = 0; index < local_particles_.size(); index++) {
+    const DomainParticle& particle = local_particles_[index];
+    bool owned = local_owned_[index];
+    if (owned && FindDistanceToStripEdge(particle) > contact_distance_) {
+      continue;
+    }
+    //particles are only added while the scratch grows
+    size_t chain_index = chain_list_.size();
+    if (chain_particles_.size() == chain_index) {
+      chain_particles_.emplace_back();
+    }
+    chain_particles_[chain_index].position = vec2(particle.x_position,
+                                                  particle.y_position);
+    chain_particles_[chain_index].radius =
+        local_groups_[particle.group_index]->GetParticleRadius();
+    chain_list_.push_back(chain_index);
+    chain_owned_.push_back(owned);
+    //halo particles this close to the edge may touch particles past it
+    chain_frontier_.push_back(!owned && FindDistanceToStrip(particle, rank_) >
+                                             halo_width - contact_distance_);
+  }
+
+  //positions don't change while colliding, so these are the chains the
+  //update will resolve
+  size_t chain_count = chain_list_.size();
+  chain_roots_.resize(chain_count);
+  for (size_t index = 0; index < chain_count; index++) {
+    chain_roots_[index] = index;
+  }
+  chain_grid_.Rebuild(chain_particles_, chain_list_, container_width_,
+                      container_height_, contact_distance_);
+  for (size_t index = 0; index < chain_count; index++) {
+    chain_grid_.ListEarlierNeighbors(index, neighbors_);
+    for (size_t other_index: neighbors_) {
+      if (ParticlesTouching(chain_particles_[index],
+                            chain_particles_[other_index])) {
+        size_t root = FindChainRoot(chain_roots_, index);
+        size_t other_root = FindChainRoot(chain_roots_, other_index);
+        chain_roots_[std::max(root, other_root)] = std::min(root, other_root);
+      }
+    }
+  }
+
+  frontier_roots_.assign(chain_count, false);
+  for (size_t index = 0; index < chain_count; index++) {
+    if (chain_frontier_[index]) {
+      frontier_roots_[FindChainRoot(chain_roots_, index)] = true;
+    }
+  }
+  for (size_t index = 0; index < chain_count; index++) {
+    if (chain_owned_[index] &&
+        frontier_roots_[FindChainRoot(chain_roots_, index)]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool DomainSimulation::AgreeOnAll(bool complete, bool& all_complete) {
+  for (vector<unsigned char>& message: outgoing_messages_) {
+    message.assign(1, complete ? 1 : 0);
+  }
+  if (!ExchangeWithAllDomains()) {
+    return false;
+  }
+  all_complete = complete;
+  for (size_t peer = 0; peer < domain_count_; peer++) {
+    if (peer != rank_) {
+      all_complete = all_complete && incoming_messages_[peer].size() == 1 &&
+                     incoming_messages_[peer][0] == 1;
+    }
+  }
+  return true;
+}
+
+void DomainSimulation::UpdateLocalParticles() {
+  //local particles are in id order, so each group is too
+  for (size_t group_index = 0; group_index < local_groups_.size();
+       group_index++) {
+    group_x_positions_.clear();
+    group_y_positions_.clear();
+    group_x_velocities_.clear();
+    group_y_velocities_.clear();
+    for (const DomainParticle& particle: local_particles_) {
+      if (particle.group_index == group_index) {
+        group_x_positions_.push_back(particle.x_position);
+        group_y_positions_.push_back(particle.y_position);
+        group_x_velocities_.push_back(particle.x_velocity);
+        group_y_velocities_.push_back(particle.y_velocity);
+      }
+    }
+    local_groups_[group_index]->AssignParticleArrays(
+        group_x_positions_.data(), group_y_positions_.data(),
+        group_x_velocities_.data(), group_y_velocities_.data(),
+        group_x_positions_.size());
+  }
+
+  local_container_.Update();
+
+  //read back the owned particles, halo particles are updated by their owner
+  owned_particles_.clear();
+  group_cursors_.assign(local_groups_.size(), 0);
+  for (size_t index = 0; index < local_particles_.size(); index++) {
+    DomainParticle particle = local_particles_[index];
+    size_t group_index = particle.group_index;
+    size_t group_slot = group_cursors_[group_index]++;
+    if (!local_owned_[index]) {
+      continue;
+    }
+    ParticleGroup* group = local_groups_[group_index];
+    vec2 position = group->GetPositionAt(group_slot);
+    vec2 velocity = group->GetVelocityAt(group_slot);
+    particle.x_position = position.x;
+    particle.y_position = position.y;
+    particle.x_velocity = velocity.x;
+    particle.y_velocity = velocity.y;
+    owned_particles_.push_back(particle);
+  }
+}
+
+bool DomainSimulation::MigrateParticles() {
+  for (vector<unsigned char>& message: outgoing_messages_) {
+    message.clear();
+  }
+  size_t kept_count = 0;
+  for (const DomainParticle& particle: owned_particles_) {
+    size_t owner = FindOwner(particle);
+    if (owner == rank_) {
+      owned_particles_[kept_count++] = particle;
+    } else {
+      AppendParticles(&particle, 1, outgoing_messages_[owner]);
+      migration_count_++;
+    }
+  }
+  owned_particles_.resize(kept_count);
+  if (!ExchangeWithAllDomains()) {
+    return false;
+  }
+
+  for (size_t peer = 0; peer < domain_count_; peer++) {
+    if (peer != rank_) {
+      ReadParticles(incoming_messages_[peer], owned_particles_);
+    }
+  }
+  std::sort(owned_particles_.begin(), owned_particles_.end(), HasEarlierId);
+  return true;
+}
+
+bool DomainSimulation::ExchangeWithAllDomains() {
+  for (size_t peer = 0; peer < domain_count_; peer++) {
+    if (peer == rank_) {
+      continue;
+    }
+    bool traded = peer > rank_ ?
+        transport_->Send(peer, outgoing_messages_[peer]) &&
+            transport_->Receive(peer, incoming_messages_[peer]) :
+        transport_->Receive(peer, incoming_messages_[peer]) &&
+            transport_->Send(peer, outgoing_messages_[peer]);
+    if (!traded) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t DomainSimulation::FindOwner(const DomainParticle& particle) const {
+  double strip = std::floor(FindSplitCoordinate(particle) / strip_length_);
+  if (!(strip > 0)) {
+    return 0;
+  } else if (strip >= domain_count_ - 1) {
+    return domain_count_ - 1;
+  }
+  return (size_t) strip;
+}
+
+double DomainSimulation::FindDistanceToStrip(const DomainParticle& particle,
+                                             size_t domain) const {
+  //the first and last strips reach past the container's edges
+  double coordinate = FindSplitCoordinate(particle);
+  double strip_start = domain * strip_length_;
+  double strip_end = (domain + 1) * strip_length_;
+  if (domain > 0 && coordinate < strip_start) {
+    return strip_start - coordinate;
+  } else if (domain + 1 < domain_count_ && coordinate > strip_end) {
+    return coordinate - strip_end;
+  }
+  return 0;
+}
+
+double DomainSimulation::FindDistanceToStripEdge(
+    const DomainParticle& particle) const {
+  //only edges shared w/ another strip count
+  double coordinate = FindSplitCoordinate(particle);
+  double distance = std::numeric_limits<double>::max();
+  if (rank_ > 0) {
+    distance = std::min(distance, coordinate - rank_ * strip_length_);
+  }
+  if (rank_ + 1 < domain_count_) {
+    distance = std::min(distance, (rank_ + 1) * strip_length_ - coordinate);
+  }
+  return distance;
+}
+
+double DomainSimulation::FindSplitCoordinate(
+    const DomainParticle& particle) const {
+  return splits_along_y_ ? particle.y_position : particle.x_position;
+}
+
+void DomainSimulation::AppendParticles(const DomainParticle* particles,
+                                       size_t count,
+                                       vector<unsigned char>& message) {
+  if (count == 0) {
+    return;
+  }
+  size_t start = message.size();
+  message.resize(start + count * sizeof(DomainParticle));
+  std::memcpy(message.data() + start, particles,
+              count * sizeof(DomainParticle));
+}
+
+void DomainSimulation::ReadParticles(const vector<unsigned char>& message,
+                                     vector<DomainParticle>& particles) {
+  size_t count = message.size() / sizeof(DomainParticle);
+  if (count == 0) {
+    return;
+  }
+  size_t start = particles.size();
+  particles.resize(start + count);
+  std::memcpy(particles.data() + start, message.data(),
+              count * sizeof(DomainParticle));
+}
+
+} // namespace idealgas
@@ -0,0 +1,143 @@
+#include "core/domain_transport.h"
+#include <cstdint>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace idealgas {
+
+namespace {
+
+#if !defined(_WIN32)
+
+#if defined(MSG_NOSIGNAL)
+//a closed peer fails the send instead of killing the process
+const int kSendFlags = MSG_NOSIGNAL;
+#else
+const int kSendFlags = 0;
+#endif
+
+/**
+ * Writes all bytes to a socket, retrying partial and interrupted writes.
+ */
+bool SendAll(int socket, const unsigned char* bytes, size_t size) {
+  while (size > 0) {
+    ssize_t sent = send(socket, bytes, size, kSendFlags);
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    } else if (sent <= 0) {
+      return false;
+    }
+    bytes += sent;
+    size -= (size_t) sent;
+  }
+  return true;
+}
+
+/**
+ * Reads exactly the given number of bytes from a socket.
+ */
+bool ReceiveAll(int socket, unsigned char* bytes, size_t size) {
+  while (size > 0) {
+    ssize_t received = recv(socket, bytes, size, 0);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    } else if (received <= 0) {
+      return false;
+    }
+    bytes += received;
+    size -= (size_t) received;
+  }
+  return true;
+}
+
+#endif
+
+} // namespace
+
+SocketTransport::SocketTransport(size_t rank, size_t domain_count) {
+  rank_ = rank;
+  peer_sockets_.assign(domain_count, -1);
+}
+
+SocketTransport::~SocketTransport() {
+#if !defined(_WIN32)
+  for (int socket: peer_sockets_) {
+    if (socket >= 0) {
+      close(socket);
+    }
+  }
+#endif
+}
+
+bool SocketTransport::CreateLocal(size_t domain_count,
+                                  vector<std::unique_ptr<SocketTransport>>&
+                                      transports) {
+  transports.clear();
+  for (size_t rank = 0; rank < domain_count; rank++) {
+    transports.emplace_back(new SocketTransport(rank, domain_count));
+  }
+#if defined(_WIN32)
+  return domain_count <= 1;
+#else
+  //one connected pair of sockets per pair of domains
+  for (size_t rank = 0; rank < domain_count; rank++) {
+    for (size_t peer = rank + 1; peer < domain_count; peer++) {
+      int sockets[2];
+      if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+        transports.clear();
+        return false;
+      }
+      transports[rank]->peer_sockets_[peer] = sockets[0];
+      transports[peer]->peer_sockets_[rank] = sockets[1];
+    }
+  }
+  return true;
+#endif
+}
+
+size_t SocketTransport::GetRank() const {
+  return rank_;
+}
+
+size_t SocketTransport::GetDomainCount() const {
+  return peer_sockets_.size();
+}
+
+bool SocketTransport::Send(size_t peer, const vector<unsigned char>& message) {
+  if (peer >= peer_sockets_.size() || peer_sockets_[peer] < 0) {
+    return false;
+  }
+#if defined(_WIN32)
+  return false;
+#else
+  //every message starts w/ its size, so it can be read back whole
+  uint64_t size = message.size();
+  return SendAll(peer_sockets_[peer],
+                 reinterpret_cast<const unsigned char*>(&size),
+                 sizeof(size)) &&
+         SendAll(peer_sockets_[peer], message.data(), message.size());
+#endif
+}
+
+bool SocketTransport::Receive(size_t peer, vector<unsigned char>& message) {
+  if (peer >= peer_sockets_.size() || peer_sockets_[peer] < 0) {
+    return false;
+  }
+#if defined(_WIN32)
+  return false;
+#else
+  uint64_t size = 0;
+  if (!ReceiveAll(peer_sockets_[peer], reinterpret_cast<unsigned char*>(&size),
+                  sizeof(size))) {
+    return false;
+  }
+  message.resize((size_t) size);
+  return ReceiveAll(peer_sockets_[peer], message.data(), message.size());
+#endif
+}
+
+} // namespace idealgas
@@ -0,0 +1,134 @@
+#include "core/ensemble_runner.h"
+#include <algorithm>
+#include <chrono>
+
+namespace idealgas {
+
+EnsembleRunner::EnsembleRunner(size_t thread_count)
+    : worker_pool_(thread_count) {
+  for (size_t worker = 0; worker < worker_pool_.GetThreadCount(); worker++) {
+    work_queues_.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+  }
+}
+
+size_t EnsembleRunner::AddEnsemble(const EnsembleSettings& settings) {
+  ensembles_.push_back(settings);
+  return ensembles_.size() - 1;
+}
+
+void EnsembleRunner::Run(
+    const std::function<void(const EnsembleSummary&)>& on_finished) {
+  //deal out ensembles most expensive first, so the long ones start early
+  //and the short ones left at the end even out the threads
+  vector<size_t> ensembles(ensembles_.size());
+  vector<size_t> costs(ensembles_.size(), 0);
+  for (size_t ensemble = 0; ensemble < ensembles_.size(); ensemble++) {
+    ensembles.at(ensemble) = ensemble;
+    for (auto const& entry: ensembles_.at(ensemble).particle_information) {
+      costs.at(ensemble) += entry.second;
+    }
+    costs.at(ensemble) *= ensembles_.at(ensemble).step_count;
+  }
+  std::stable_sort(ensembles.begin(), ensembles.end(),
+                   [&costs](size_t lhs, size_t rhs) {
+                     return costs.at(lhs) > costs.at(rhs);
+                   });
+  for (size_t slot = 0; slot < ensembles.size(); slot++) {
+    work_queues_.at(slot % work_queues_.size())->ensembles.push_back(
+        ensembles.at(slot));
+  }
+
+  on_finished_ = &on_finished;
+  worker_pool_.ParallelFor(work_queues_.size(), [this](size_t worker) {
+    RunQueues(worker);
+  });
+  on_finished_ = nullptr;
+
+  ensembles_.clear();
+}
+
+size_t EnsembleRunner::GetEnsembleCount() const {
+  return ensembles_.size();
+}
+
+void EnsembleRunner::RunQueues(size_t worker) {
+  size_t ensemble = 0;
+  while (TakeEnsemble(worker, ensemble)) {
+    RunEnsemble(ensemble);
+  }
+}
+
+bool EnsembleRunner::TakeEnsemble(size_t worker, size_t& ensemble) {
+  //own work comes from the front of the queue
+  {
+    WorkQueue& queue = *work_queues_.at(worker);
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.ensembles.empty()) {
+      ensemble = queue.ensembles.front();
+      queue.ensembles.pop_front();
+      return true;
+    }
+  }
+
+  //steal from the back of the next queue that still has work, no work is
+  //ever added while running, so finding all queues empty means we're done
+  for (size_t offset = 1; offset < work_queues_.size(); offset++) {
+    WorkQueue& queue = *work_queues_.at((worker + offset) %
+                                        work_queues_.size());
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.ensembles.empty()) {
+      ensemble = queue.ensembles.back();
+      queue.ensembles.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+void EnsembleRunner::RunEnsemble(size_t ensemble) {
+  const EnsembleSettings& settings = ensembles_.at(ensemble);
+  GasContainer container(settings.particle_information,
+                         settings.container_width, settings.container_height,
+                         settings.seed);
+  container.SetCollisionMode(settings.collision_mode);
+  container.SetSteppingMode(settings.stepping_mode);
+
+  EnsembleSummary summary;
+  summary.ensemble = ensemble;
+  summary.step_count = settings.step_count;
+
+  auto start_time = std::chrono::steady_clock::now();
+  for (size_t step = 0; step < summary.step_count; step++) {
+    container.Update();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start_time;
+  summary.seconds = elapsed.count();
+
+  for (ParticleGroup* group: container.GetParticleGroups()) {
+    GroupSummary group_summary;
+    group_summary.particle_mass = group->GetParticleMass();
+    group_summary.particle_radius = group->GetParticleRadius();
+    group_summary.particle_count = group->GetGroupSize();
+
+    double total_speed = 0;
+    double kinetic_energy = 0;
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      vec2 velocity = group->GetVelocityAt(index);
+      total_speed += glm::length(velocity);
+      kinetic_energy += 0.5 * group->GetParticleMass() *
+                        glm::dot(velocity, velocity);
+    }
+    group_summary.mean_speed = group->GetGroupSize() == 0 ? 0 :
+                               total_speed / group->GetGroupSize();
+    group_summary.kinetic_energy = kinetic_energy;
+    summary.groups.push_back(group_summary);
+
+    delete group;
+  }
+
+  std::lock_guard<std::mutex> lock(report_mutex_);
+  (*on_finished_)(summary);
+}
+
+} // namespace idealgas
@@ -0,0 +1,465 @@
+#include "core/event_driven_engine.h"
+#include "core/particle_utils.h"
+#include "core/uniform_grid.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace idealgas {
+
+const size_t EventDrivenEngine::kNoParticle;
+const size_t EventDrivenEngine::kEventsPerParticle;
+
+bool LaterEvent::operator()(const CollisionEvent& lhs,
+                            const CollisionEvent& rhs) const {
+  if (lhs.time != rhs.time) {
+    return lhs.time > rhs.time;
+  }
+  return lhs.sequence > rhs.sequence;
+}
+
+void EventDrivenEngine::Advance(const vector<ParticleGroup*>& groups,
+                                size_t container_width,
+                                size_t container_height, double duration,
+                                bool wraps) {
+  x_period_ = wraps ? (double) container_width : 0.0;
+  y_period_ = wraps ? (double) container_height : 0.0;
+  LoadParticles(groups);
+  BuildGrid(container_width, container_height);
+
+  current_time_ = 0;
+  end_time_ = duration;
+  collision_count_ = 0;
+  particle_collision_count_ = 0;
+  wall_impulse_ = 0;
+  next_sequence_ = 0;
+  events_.clear();
+  for (size_t particle = 0; particle < x_positions_.size(); particle++) {
+    PredictEvents(particle, true);
+  }
+
+  //jump from event to event until the next one is past the end, dropping
+  //stale events once they crowd the heap in long advances
+  size_t compact_size = kEventsPerParticle * x_positions_.size();
+  while (!events_.empty() && events_.front().time <= duration) {
+    std::pop_heap(events_.begin(), events_.end(), LaterEvent());
+    CollisionEvent event = events_.back();
+    events_.pop_back();
+    if (IsEventValid(event)) {
+      current_time_ = event.time;
+      HandleEvent(event);
+    }
+    if (events_.size() > compact_size) {
+      DropInvalidEvents();
+      compact_size = std::max(compact_size, 2 * events_.size());
+    }
+  }
+
+  current_time_ = duration;
+  StoreParticles();
+}
+
+size_t EventDrivenEngine::GetCollisionCount() const {
+  return collision_count_;
+}
+
+size_t EventDrivenEngine::GetParticleCollisionCount() const {
+  return particle_collision_count_;
+}
+
+double EventDrivenEngine::GetWallImpulse() const {
+  return wall_impulse_;
+}
+
+void EventDrivenEngine::LoadParticles(const vector<ParticleGroup*>& groups) {
+  x_positions_.clear();
+  y_positions_.clear();
+  x_velocities_.clear();
+  y_velocities_.clear();
+  masses_.clear();
+  radii_.clear();
+  max_x_positions_.clear();
+  max_y_positions_.clear();
+  source_groups_.clear();
+  source_indices_.clear();
+
+  for (size_t group_index = 0; group_index < groups.size(); group_index++) {
+    ParticleGroup* group = groups.at(group_index);
+    if (FindFirstListing(groups, group_index) < group_index) {
+      continue; //already loaded
+    }
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      vec2 position = group->GetPositionAt(index);
+      vec2 velocity = group->GetVelocityAt(index);
+      x_positions_.push_back(position.x);
+      y_positions_.push_back(position.y);
+      x_velocities_.push_back(velocity.x);
+      y_velocities_.push_back(velocity.y);
+      masses_.push_back((double) group->GetParticleMass());
+      radii_.push_back((double) group->GetParticleRadius());
+      max_x_positions_.push_back(std::max(0.0, group->GetMaxXPosition()));
+      max_y_positions_.push_back(std::max(0.0, group->GetMaxYPosition()));
+      source_groups_.push_back(group);
+      source_indices_.push_back(index);
+    }
+  }
+
+  particle_times_.assign(x_positions_.size(), 0.0);
+  collision_counts_.assign(x_positions_.size(), 0);
+  crossing_times_.assign(x_positions_.size(),
+                         std::numeric_limits<double>::infinity());
+}
+
+void EventDrivenEngine::StoreParticles() {
+  for (size_t particle = 0; particle < x_positions_.size(); particle++) {
+    MoveToCurrentTime(particle);
+    ParticleGroup* group = source_groups_[particle];
+    group->SetPositionAt(source_indices_[particle],
+                         vec2(x_positions_[particle], y_positions_[particle]));
+    group->SetVelocityAt(source_indices_[particle],
+                         vec2(x_velocities_[particle],
+                              y_velocities_[particle]));
+  }
+}
+
+void EventDrivenEngine::BuildGrid(size_t container_width,
+                                  size_t container_height) {
+  double max_radius = 0;
+  for (double radius: radii_) {
+    max_radius = std::max(max_radius, radius);
+  }
+  //in a dilute gas, cells hold about one particle, so particles cross cells
+  //about as often as they pass a neighbor instead of many times in between
+  double cell_size = particleutils::FindContactDistance(max_radius);
+  if (!x_positions_.empty()) {
+    cell_size = std::max(cell_size,
+                         std::sqrt((double) container_width *
+                                   container_height / x_positions_.size()));
+  }
+
+  //every cell is at least a full cell size wide, the last ones may be wider
+  column_count_ = std::max<size_t>(1, (size_t) (container_width / cell_size));
+  row_count_ = std::max<size_t>(1, (size_t) (container_height / cell_size));
+  cell_width_ = x_period_ > 0 ? x_period_ / column_count_ : cell_size;
+  cell_height_ = y_period_ > 0 ? y_period_ / row_count_ : cell_size;
+
+  cell_heads_.assign(column_count_ * row_count_, kNoParticle);
+  particle_columns_.resize(x_positions_.size());
+  particle_rows_.resize(x_positions_.size());
+  next_in_cell_.resize(x_positions_.size());
+  previous_in_cell_.resize(x_positions_.size());
+
+  for (size_t particle = 0; particle < x_positions_.size(); particle++) {
+    size_t column = UniformGrid::FindCellCoordinate(
+        x_positions_[particle], cell_width_, column_count_);
+    size_t row = UniformGrid::FindCellCoordinate(
+        y_positions_[particle], cell_height_, row_count_);
+    AddToCell(particle, column, row);
+  }
+}
+
+void EventDrivenEngine::AddToCell(size_t particle, size_t column, size_t row) {
+  size_t& head = cell_heads_[row * column_count_ + column];
+  particle_columns_[particle] = column;
+  particle_rows_[particle] = row;
+  previous_in_cell_[particle] = kNoParticle;
+  next_in_cell_[particle] = head;
+  if (head != kNoParticle) {
+    previous_in_cell_[head] = particle;
+  }
+  head = particle;
+}
+
+void EventDrivenEngine::MoveToCell(size_t particle, size_t column,
+                                   size_t row) {
+  //unlink particle from its old cell, then add it to the new one
+  size_t next = next_in_cell_[particle];
+  size_t previous = previous_in_cell_[particle];
+  if (next != kNoParticle) {
+    previous_in_cell_[next] = previous;
+  }
+  if (previous != kNoParticle) {
+    next_in_cell_[previous] = next;
+  } else {
+    cell_heads_[particle_rows_[particle] * column_count_ +
+                particle_columns_[particle]] = next;
+  }
+  AddToCell(particle, column, row);
+}
+
+void EventDrivenEngine::MoveToCurrentTime(size_t particle) {
+  double elapsed = current_time_ - particle_times_[particle];
+  x_positions_[particle] += x_velocities_[particle] * elapsed;
+  y_positions_[particle] += y_velocities_[particle] * elapsed;
+  particle_times_[particle] = current_time_;
+}
+
+void EventDrivenEngine::PredictEvents(size_t particle, bool only_earlier) {
+  //particle's position is at its own time, which is the current time
+  double x_position = x_positions_[particle];
+  double y_position = y_positions_[particle];
+  double x_velocity = x_velocities_[particle];
+  double y_velocity = y_velocities_[particle];
+
+  //the next crossing makes every later event of the particle stale, so
+  //only the first crossing and the walls reached by then are scheduled
+  bool wraps = x_period_ > 0;
+  double column_time = FindCrossingTime(x_position, x_velocity,
+                                        particle_columns_[particle],
+                                        column_count_, cell_width_, wraps);
+  double row_time = FindCrossingTime(y_position, y_velocity,
+                                     particle_rows_[particle], row_count_,
+                                     cell_height_, wraps);
+  double crossing_time = std::min(column_time, row_time);
+  if (!wraps) {
+    double x_wall_time = FindWallTime(x_position, x_velocity,
+                                      max_x_positions_[particle]);
+    if (x_wall_time <= crossing_time) {
+      ScheduleEvent(x_wall_time, EventType::kVerticalWall, particle, particle);
+    }
+    double y_wall_time = FindWallTime(y_position, y_velocity,
+                                      max_y_positions_[particle]);
+    if (y_wall_time <= crossing_time) {
+      ScheduleEvent(y_wall_time, EventType::kHorizontalWall, particle,
+                    particle);
+    }
+  }
+  //scheduled before collisions, so a collision at the same time as the
+  //crossing is handled after it
+  if (crossing_time < std::numeric_limits<double>::infinity()) {
+    ScheduleEvent(crossing_time, column_time <= row_time ?
+                                 EventType::kColumnCrossing :
+                                 EventType::kRowCrossing,
+                  particle, particle);
+  }
+  crossing_times_[particle] = crossing_time;
+
+  size_t rows[3];
+  size_t columns[3];
+  size_t neighbor_row_count = UniformGrid::FindNeighborCells(
+      particle_rows_[particle], row_count_, wraps, rows);
+  size_t neighbor_column_count = UniformGrid::FindNeighborCells(
+      particle_columns_[particle], column_count_, wraps, columns);
+
+  for (size_t row_slot = 0; row_slot < neighbor_row_count; row_slot++) {
+    for (size_t column_slot = 0; column_slot < neighbor_column_count;
+         column_slot++) {
+      for (size_t other_particle =
+               cell_heads_[rows[row_slot] * column_count_ +
+                           columns[column_slot]];
+           other_particle != kNoParticle;
+           other_particle = next_in_cell_[other_particle]) {
+        if (other_particle == particle ||
+            (only_earlier && other_particle > particle)) {
+          continue;
+        }
+        PredictParticleCollision(particle, other_particle);
+      }
+    }
+  }
+}
+
+void EventDrivenEngine::PredictParticleCollision(size_t particle,
+                                                 size_t other_particle) {
+  //compare both particles at the current time
+  double elapsed = current_time_ - particle_times_[other_particle];
+  double x_distance = x_positions_[other_particle] +
+                      x_velocities_[other_particle] * elapsed -
+                      x_positions_[particle];
+  double y_distance = y_positions_[other_particle] +
+                      y_velocities_[other_particle] * elapsed -
+                      y_positions_[particle];
+  WrapDistance(x_distance, y_distance);
+  double x_relative_velocity = x_velocities_[other_particle] -
+                               x_velocities_[particle];
+  double y_relative_velocity = y_velocities_[other_particle] -
+                               y_velocities_[particle];
+
+  double velocity_dot_distance = x_relative_velocity * x_distance +
+                                 y_relative_velocity * y_distance;
+  if (velocity_dot_distance >= 0) {
+    return; //not moving towards each other
+  }
+
+  double speed_squared = x_relative_velocity * x_relative_velocity +
+                         y_relative_velocity * y_relative_velocity;
+  double distance_squared = x_distance * x_distance + y_distance * y_distance;
+  double touching_distance = radii_[particle] + radii_[other_particle];
+  double discriminant = velocity_dot_distance * velocity_dot_distance -
+                        speed_squared * (distance_squared -
+                                         touching_distance * touching_distance);
+  if (discriminant < 0) {
+    return; //paths pass by w/o touching
+  }
+
+  //already overlapping particles collide right away, like the fixed stepper
+  double time_until = -(velocity_dot_distance + std::sqrt(discriminant)) /
+                      speed_squared;
+  double time = current_time_ + std::max(0.0, time_until);
+  //a crossing of either particle comes first and makes the collision stale
+  if (time >= std::min(crossing_times_[particle],
+                       crossing_times_[other_particle])) {
+    return;
+  }
+  ScheduleEvent(time, EventType::kParticleCollision, particle,
+                other_particle);
+}
+
+double EventDrivenEngine::FindWallTime(double position, double velocity,
+                                       double max_position) const {
+  double time_until;
+  if (velocity > 0) {
+    time_until = (max_position - position) / velocity;
+  } else if (velocity < 0) {
+    time_until = position / -velocity;
+  } else {
+    return std::numeric_limits<double>::infinity();
+  }
+  return current_time_ + std::max(0.0, time_until);
+}
+
+double EventDrivenEngine::FindCrossingTime(double position, double velocity,
+                                           size_t cell, size_t cell_count,
+                                           double cell_length,
+                                           bool wraps) const {
+  double time_until;
+  if (velocity > 0 && (cell + 1 < cell_count || wraps)) {
+    time_until = ((cell + 1) * cell_length - position) / velocity;
+  } else if (velocity < 0 && (cell > 0 || wraps)) {
+    time_until = (cell * cell_length - position) / velocity;
+  } else {
+    return std::numeric_limits<double>::infinity();
+  }
+  return current_time_ + std::max(0.0, time_until);
+}
+
+void EventDrivenEngine::ScheduleEvent(double time, EventType type,
+                                      size_t particle, size_t other_particle) {
+  if (time > end_time_) {
+    return;
+  }
+  events_.push_back(CollisionEvent{time, next_sequence_++, type, particle,
+                                   other_particle, collision_counts_[particle],
+                                   collision_counts_[other_particle]});
+  std::push_heap(events_.begin(), events_.end(), LaterEvent());
+}
+
+bool EventDrivenEngine::IsEventValid(const CollisionEvent& event) const {
+  return collision_counts_[event.particle] == event.particle_collisions &&
+         collision_counts_[event.other_particle] == event.other_collisions;
+}
+
+void EventDrivenEngine::DropInvalidEvents() {
+  events_.erase(std::remove_if(events_.begin(), events_.end(),
+                               [this](const CollisionEvent& event) {
+                                 return !IsEventValid(event);
+                               }),
+                events_.end());
+  std::make_heap(events_.begin(), events_.end(), LaterEvent());
+}
+
+void EventDrivenEngine::HandleEvent(const CollisionEvent& event) {
+  size_t particle = event.particle;
+  MoveToCurrentTime(particle);
+
+  switch (event.type) {
+    case EventType::kParticleCollision:
+      MoveToCurrentTime(event.other_particle);
+      ResolveParticleCollision(particle, event.other_particle);
+      collision_count_++;
+      particle_collision_count_++;
+      break;
+    case EventType::kVerticalWall:
+      wall_impulse_ += 2.0 * masses_[particle] *
+                       std::fabs(x_velocities_[particle]);
+      x_velocities_[particle] = -x_velocities_[particle];
+      collision_count_++;
+      break;
+    case EventType::kHorizontalWall:
+      wall_impulse_ += 2.0 * masses_[particle] *
+                       std::fabs(y_velocities_[particle]);
+      y_velocities_[particle] = -y_velocities_[particle];
+      collision_count_++;
+      break;
+    case EventType::kColumnCrossing: {
+      size_t column = particle_columns_[particle];
+      CrossCell(x_positions_[particle], x_velocities_[particle], column,
+                column_count_, x_period_);
+      MoveToCell(particle, column, particle_rows_[particle]);
+      break;
+    }
+    case EventType::kRowCrossing: {
+      size_t row = particle_rows_[particle];
+      CrossCell(y_positions_[particle], y_velocities_[particle], row,
+                row_count_, y_period_);
+      MoveToCell(particle, particle_columns_[particle], row);
+      break;
+    }
+  }
+
+  //every other event of these particles was predicted from the old state
+  collision_counts_[particle]++;
+  PredictEvents(particle, false);
+  if (event.type == EventType::kParticleCollision) {
+    collision_counts_[event.other_particle]++;
+    PredictEvents(event.other_particle, false);
+  }
+}
+
+void EventDrivenEngine::ResolveParticleCollision(size_t particle,
+                                                 size_t other_particle) {
+  //same elastic collision as particleutils, but w/o rounding to floats so
+  //particles always end up moving apart
+  double x_distance = x_positions_[particle] - x_positions_[other_particle];
+  double y_distance = y_positions_[particle] - y_positions_[other_particle];
+  WrapDistance(x_distance, y_distance);
+  double x_relative_velocity = x_velocities_[particle] -
+                               x_velocities_[other_particle];
+  double y_relative_velocity = y_velocities_[particle] -
+                               y_velocities_[other_particle];
+  double distance_squared = x_distance * x_distance + y_distance * y_distance;
+  if (distance_squared == 0) {
+    return; //no direction to push particles in
+  }
+
+  double total_mass = masses_[particle] + masses_[other_particle];
+  double impulse = (x_relative_velocity * x_distance +
+                    y_relative_velocity * y_distance) / distance_squared;
+  double multiplier = 2.0 * masses_[other_particle] / total_mass * impulse;
+  double other_multiplier = 2.0 * masses_[particle] / total_mass * impulse;
+
+  x_velocities_[particle] -= x_distance * multiplier;
+  y_velocities_[particle] -= y_distance * multiplier;
+  x_velocities_[other_particle] += x_distance * other_multiplier;
+  y_velocities_[other_particle] += y_distance * other_multiplier;
+}
+
+void EventDrivenEngine::CrossCell(double& position, double velocity,
+                                  size_t& cell, size_t cell_count,
+                                  double period) {
+  if (velocity > 0) {
+    cell++;
+    if (cell == cell_count) {
+      cell = 0;
+      position -= period;
+    }
+  } else {
+    if (cell == 0) {
+      cell = cell_count;
+      position += period;
+    }
+    cell--;
+  }
+}
+
+void EventDrivenEngine::WrapDistance(double& x_distance,
+                                     double& y_distance) const {
+  if (x_period_ > 0) {
+    x_distance -= x_period_ * std::round(x_distance / x_period_);
+  }
+  if (y_period_ > 0) {
+    y_distance -= y_period_ * std::round(y_distance / y_period_);
+  }
+}
+
+} // namespace idealgas
@@ -0,0 +1,595 @@
+#include "core/gas_container.h"
+#include "core/particle_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace idealgas {
+
+using idealgas::particleutils::CollideParticles;
+using idealgas::particleutils::ParticlesTouching;
+
+namespace {
+
+/**
+ * Orders touching pairs the way all pairs checks them, by later particle
+ * then by earlier particle.
+ */
+bool IsEarlierContact(const ContactPair& first, const ContactPair& second) {
+  return first.index < second.index ||
+         (first.index == second.index &&
+          first.other_index < second.other_index);
+}
+
+} // namespace
+
+GasContainer::GasContainer(const map<Particle, size_t>& particle_information,
+                           size_t container_width, size_t container_height,
+                           uint64_t seed, size_t thread_count) {
+  container_width_ = container_width;
+  container_height_ = container_height;
+  SetThreadCount(thread_count);
+
+  for (auto const& entry: particle_information) {
+    particle_groups_.push_back(CreateParticleGroup(entry.first, entry.second,
+                                                   container_width,
+                                                   container_height, seed,
+                                                   particle_groups_.size(),
+                                                   worker_pool_.get()));
+  }
+}
+
+GasContainer::GasContainer(const vector<ParticleGroup*>& groups,
+                           size_t container_width, size_t container_height) {
+  particle_groups_ = groups;
+  container_width_ = container_width;
+  container_height_ = container_height;
+}
+
+ParticleGroup* GasContainer::CreateParticleGroup(const Particle& particle_type,
+                                                 size_t num_particles,
+                                                 size_t container_width,
+                                                 size_t container_height,
+                                                 uint64_t seed,
+                                                 uint64_t group_number,
+                                                 WorkerPool* pool) {
+  size_t mass = particle_type.mass;
+  size_t radius = particle_type.radius;
+
+  double max_x_position = (double) container_width - radius * 2;
+  double max_y_position = (double) container_height - radius * 2;
+  double max_velocity = radius * (1.0 / mass); //v is relatively small
+
+  return new ParticleGroup(num_particles, mass, radius, particle_type.color,
+                           max_x_position, max_y_position, max_velocity, seed,
+                           group_number, pool);
+}
+
+void GasContainer::Update() {
+  SortIfDue();
+  if (stepping_mode_ == SteppingMode::kEventDriven) {
+    AdvanceEventDriven(1.0);
+    return;
+  }
+
+  //update particles colliding
+  HandleAllParticleCollisions();
+
+  //update particles/walls colliding and all particle positions in one pass
+  double wall_impulse = 0;
+  {
+    IDEALGAS_PROFILE_PHASE(*profiler_, UpdatePhase::kWallsAndIntegration);
+    for (ParticleGroup* group: particle_groups_) {
+      if (boundary_mode_ == BoundaryMode::kPeriodic) {
+        group->AdvanceWithWrapping((double) container_width_,
+                                   (double) container_height_);
+      } else {
+        wall_impulse += group->AdvanceWithWallCollisions();
+      }
+    }
+  }
+  observables_->RecordUpdate(particle_groups_, CalculateWallLength(),
+                             wall_impulse, collision_count_, *worker_pool_);
+  IDEALGAS_PROFILE_COUNT(*profiler_, UpdateCounter::kParticlesProcessed,
+                         CountAllParticles());
+  IDEALGAS_PROFILE_FINISH_UPDATE(*profiler_);
+}
+
+void GasContainer::Advance(double duration) {
+  if (stepping_mode_ == SteppingMode::kEventDriven) {
+    if (duration > 0) {
+      SortIfDue();
+      AdvanceEventDriven(duration);
+    }
+    return;
+  }
+
+  size_t update_count = (size_t) std::round(std::max(0.0, duration));
+  for (size_t update = 0; update < update_count; update++) {
+    Update();
+  }
+}
+
+void GasContainer::SortIfDue() {
+  if (sort_interval_ > 0 && ++updates_since_sort_ >= sort_interval_) {
+    SortParticles();
+  }
+}
+
+void GasContainer::AdvanceEventDriven(double duration) {
+  {
+    IDEALGAS_PROFILE_PHASE(*profiler_, UpdatePhase::kEventStepping);
+    event_engine_.Advance(particle_groups_, container_width_,
+                          container_height_, duration,
+                          boundary_mode_ == BoundaryMode::kPeriodic);
+  }
+  observables_->RecordUpdate(particle_groups_, CalculateWallLength(),
+                             event_engine_.GetWallImpulse(),
+                             event_engine_.GetParticleCollisionCount(),
+                             *worker_pool_, duration);
+  IDEALGAS_PROFILE_COUNT(*profiler_, UpdateCounter::kCollisionsResolved,
+                         event_engine_.GetCollisionCount());
+  IDEALGAS_PROFILE_COUNT(*profiler_, UpdateCounter::kParticlesProcessed,
+                         CountAllParticles());
+  IDEALGAS_PROFILE_FINISH_UPDATE(*profiler_);
+}
+
+void GasContainer::SetCollisionMode(CollisionMode mode) {
+  collision_mode_ = mode;
+}
+
+void GasContainer::SetSteppingMode(SteppingMode mode) {
+  stepping_mode_ = mode;
+}
+
+void GasContainer::SetBoundaryMode(BoundaryMode mode) {
+  boundary_mode_ = mode;
+  //listed pairs were found w/ or w/o pairs across the edges
+  verlet_list_.Clear();
+}
+
+void GasContainer::SetVerletSkin(double skin) {
+  verlet_skin_ = skin;
+}
+
+void GasContainer::SetThreadCount(size_t thread_count) {
+  worker_pool_ = std::unique_ptr<WorkerPool>(new WorkerPool(thread_count));
+}
+
+void GasContainer::SetSortInterval(size_t update_count) {
+  sort_interval_ = update_count;
+  updates_since_sort_ = 0;
+}
+
+void GasContainer::SortParticles() {
+  IDEALGAS_PROFILE_PHASE(*profiler_, UpdatePhase::kParticleSorting);
+  sort_orders_.resize(particle_groups_.size());
+  particle_ids_.resize(particle_groups_.size());
+  for (size_t group_index = 0; group_index < particle_groups_.size();
+       group_index++) {
+    ParticleGroup* group = particle_groups_.at(group_index);
+    size_t first_index = FindFirstListing(particle_groups_, group_index);
+    if (first_index < group_index) {
+      //repeated groups were already sorted at their first appearance
+      sort_orders_.at(group_index) = sort_orders_.at(first_index);
+      particle_ids_.at(group_index) = particle_ids_.at(first_index);
+      continue;
+    }
+    group->SortAlongCurve(particle_sorter_, *worker_pool_);
+    const vector<uint32_t>& order = particle_sorter_.GetOrder();
+    sort_orders_.at(group_index) = order;
+
+    //particles added since the last reorder are numbered after the others,
+    //and a group that shrank starts over
+    vector<uint32_t>& ids = particle_ids_.at(group_index);
+    if (ids.size() > order.size()) {
+      ids.clear();
+    }
+    for (size_t index = ids.size(); index < order.size(); index++) {
+      ids.push_back((uint32_t) index);
+    }
+    sorted_ids_.resize(order.size());
+    for (size_t index = 0; index < order.size(); index++) {
+      sorted_ids_[index] = ids[order[index]];
+    }
+    ids.swap(sorted_ids_);
+  }
+
+  //listed pairs and the sweep order are by list position, which now holds
+  //other particles
+  verlet_list_.Clear();
+  sweep_and_prune_.Clear();
+  updates_since_sort_ = 0;
+  sort_count_++;
+}
+
+size_t GasContainer::GetSortCount() const {
+  return sort_count_;
+}
+
+const vector<uint32_t>& GasContainer::GetLastSortOrder(
+    size_t group_index) const {
+  static const vector<uint32_t> kNoOrder;
+  if (group_index >= sort_orders_.size()) {
+    return kNoOrder;
+  }
+  return sort_orders_[group_index];
+}
+
+const vector<uint32_t>& GasContainer::GetParticleIds(
+    size_t group_index) const {
+  static const vector<uint32_t> kNoIds;
+  if (group_index >= particle_ids_.size()) {
+    return kNoIds;
+  }
+  return particle_ids_[group_index];
+}
+
+const vector<ParticleGroup*>& GasContainer::GetParticleGroups() const {
+  return particle_groups_;
+}
+
+size_t GasContainer::GetContainerWidth() const {
+  return container_width_;
+}
+
+size_t GasContainer::GetContainerHeight() const {
+  return container_height_;
+}
+
+UpdateProfiler& GasContainer::GetProfiler() const {
+  return *profiler_;
+}
+
+GasObservables& GasContainer::GetObservables() const {
+  return *observables_;
+}
+
+void GasContainer::HandleAllParticleCollisions() {
+  collision_count_ = 0;
+  //copy particles from all groups into the persistent scratch lists
+  {
+    IDEALGAS_PROFILE_PHASE(*profiler_, UpdatePhase::kParticleCopy);
+    ListAllParticles();
+    CopyAllParticles();
+  }
+
+  if (collision_mode_ == CollisionMode::kAllPairs) {
+    HandleCollisionsWithAllPairs();
+  } else if (collision_mode_ == CollisionMode::kVerletList) {
+    HandleCollisionsWithVerletList();
+  } else if (collision_mode_ == CollisionMode::kHierarchicalGrid) {
+    HandleCollisionsWithHierarchicalGrid();
+  } else if (collision_mode_ == CollisionMode::kSweepAndPrune) {
+    HandleCollisionsWithSweepAndPrune();
+  } else {
+    HandleCollisionsWithGrid();
+  }
+
+  //only velocities change from collisions
+  IDEALGAS_PROFILE_PHASE(*profiler_, UpdatePhase::kParticleCopy);
+  StoreAllVelocities();
+}
+
+void GasContainer::HandleCollisionsWithAllPairs() {
+  //finding and resolving are mixed here, so all of it counts as detection
+  IDEALGAS_PROFILE_PHASE(*profiler_, UpdatePhase::kPairDetection);
+  size_t pairs_tested = 0;
+  size_t collisions_resolved = 0;
+
+  //make bool list to keep track of already updated
+  updated_particles_.assign(all_particles_.size(), false);
+  vec2 period = FindPeriod();
+
+  //go through particle list and handle collisions between any of them
+  for (size_t index = 0; index < all_particles_.size(); index++) {
+    if (updated_particles_.at(index)) {
+      continue;
+    }
+    Particle& first_particle = particle_copies_.at(all_particles_.at(index));
+    for (size_t other_index = 0; other_index < all_particles_.size() &&
+                                 other_index != index; other_index++) {
+      Particle& second_particle =
+          particle_copies_.at(all_particles_.at(other_index));
+      pairs_tested++;
+      if (CollideParticles(first_particle, second_particle, period)) {
+        updated_particles_.at(other_index) = true;
+        collisions_resolved++;
+      }
+    }
+  }
+
+  collision_count_ = collisions_resolved;
+  IDEALGAS_PROFILE_COUNT(*profiler_, UpdateCounter::kPairsTested,
+                         pairs_tested);
+  IDEALGAS_PROFILE_COUNT(*profiler_, UpdateCounter::kCollisionsResolved,
+                         collisions_resolved);
+}
+
+void GasContainer::HandleCollisionsWithGrid() {
+  if (all_particles_.empty()) {
+    return;
+  }
+  //positions don't change while colliding, so touching pairs can be found
+  //in parallel first, then resolved in the same order as all pairs
+  {
+    IDEALGAS_PROFILE_PHASE(*profiler_, UpdatePhase::kPairDetection);
+    collision_grid_.Rebuild(particle_copies_, all_particles_,
+                            container_width_, container_height_,
+                            CalculateGridCellSize(),
+                            boundary_mode_ == BoundaryMode::kPeriodic);
+    FindGridContacts();
+  }
+  ResolveAllContacts();
+}
+
+template <typename CandidateLister>
+void GasContainer::FindContacts(const CandidateLister& list_candidates,
+                                bool sort_contacts) {
+  size_t task_count = (all_particles_.size() + kParticlesPerContactTask - 1) /
+                      kParticlesPerContactTask;
+  task_contacts_.resize(task_count);
+  task_neighbors_.resize(task_count);
+  task_pair_counts_.resize(task_count);
+
+  //the task only captures two pointers, so it fits in std::function w/o
+  //allocating
+  struct ContactSearch {
+    const CandidateLister& list_candidates;
+    bool sort_contacts;
+  } search = {list_candidates, sort_contacts};
+  worker_pool_->ParallelFor(task_count, [this, &search](size_t task) {
+    vector<ContactPair>& found_contacts = task_contacts_[task];
+    vector<size_t>& candidates = task_neighbors_[task];
+    found_contacts.clear();
+    vec2 period = FindPeriod();
+    task_pair_counts_[task] = 0;
+
+    size_t last_slot = std::min(all_particles_.size(),
+                                (task + 1) * kParticlesPerContactTask);
+    for (size_t slot = task * kParticlesPerContactTask; slot < last_slot;
+         slot++) {
+      size_t index = search.list_candidates(slot, candidates);
+      const Particle& first_particle = particle_copies_[all_particles_[index]];
+      task_pair_counts_[task] += candidates.size();
+      for (size_t other_index: candidates) {
+        if (!ParticlesTouching(first_particle,
+                               particle_copies_[all_particles_[other_index]],
+                               period)) {
+          continue;
+        }
+        if (search.sort_contacts) {
+          found_contacts.push_back(ContactPair{
+              std::max(index, other_index), std::min(index, other_index)});
+        } else {
+          found_contacts.push_back(ContactPair{index, other_index});
+        }
+      }
+    }
+  });
+
+  //tasks cover increasing ranges of slots, so unless slots are out of
+  //particle order the joined list stays sorted
+  contacts_.clear();
+  size_t pairs_tested = 0;
+  for (size_t task = 0; task < task_count; task++) {
+    contacts_.insert(contacts_.end(), task_contacts_[task].begin(),
+                     task_contacts_[task].end());
+    pairs_tested += task_pair_counts_[task];
+  }
+  if (sort_contacts) {
+    //pairs are resolved in the same order as all pairs checks them
+    std::sort(contacts_.begin(), contacts_.end(), IsEarlierContact);
+  }
+  IDEALGAS_PROFILE_COUNT(*profiler_, UpdateCounter::kPairsTested,
+                         pairs_tested);
+}
+
+void GasContainer::FindGridContacts() {
+  FindContacts([this](size_t index, vector<size_t>& neighbors) {
+    collision_grid_.ListEarlierNeighbors(index, neighbors);
+    return index;
+  }, false);
+}
+
+void GasContainer::HandleCollisionsWithVerletList() {
+  if (all_particles_.empty()) {
+    return;
+  }
+  {
+    IDEALGAS_PROFILE_PHASE(*profiler_, UpdatePhase::kPairDetection);
+    if (verlet_list_.NeedsRebuild(particle_copies_, all_particles_,
+                                  verlet_skin_)) {
+      verlet_list_.Rebuild(particle_copies_, all_particles_, container_width_,
+                           container_height_, FindMaxRadius(), verlet_skin_,
+                           boundary_mode_ == BoundaryMode::kPeriodic);
+    }
+    FindVerletContacts();
+  }
+  ResolveAllContacts();
+}
+
+void GasContainer::HandleCollisionsWithHierarchicalGrid() {
+  if (all_particles_.empty()) {
+    return;
+  }
+  {
+    IDEALGAS_PROFILE_PHASE(*profiler_, UpdatePhase::kPairDetection);
+    hierarchical_grid_.Rebuild(particle_copies_, all_particles_,
+                               container_width_, container_height_,
+                               boundary_mode_ == BoundaryMode::kPeriodic);
+    FindHierarchicalContacts();
+  }
+  ResolveAllContacts();
+}
+
+void GasContainer::FindHierarchicalContacts() {
+  //pairs across levels are found from the smaller particle, which may come
+  //later or earlier in the list
+  FindContacts([this](size_t index, vector<size_t>& candidates) {
+    hierarchical_grid_.ListCandidates(index, candidates);
+    return index;
+  }, true);
+}
+
+void GasContainer::HandleCollisionsWithSweepAndPrune() {
+  if (all_particles_.empty()) {
+    return;
+  }
+  {
+    IDEALGAS_PROFILE_PHASE(*profiler_, UpdatePhase::kPairDetection);
+    sweep_and_prune_.Update(particle_copies_, all_particles_,
+                            container_width_, container_height_,
+                            boundary_mode_ == BoundaryMode::kPeriodic);
+    FindSweepContacts();
+  }
+  ResolveAllContacts();
+}
+
+void GasContainer::FindSweepContacts() {
+  //slots are in sweep order, each overlap is checked as soon as it's found
+  FindContacts([this](size_t slot, vector<size_t>& overlaps) {
+    sweep_and_prune_.ListOverlaps(slot, overlaps);
+    return sweep_and_prune_.GetParticleAt(slot);
+  }, true);
+}
+
+void GasContainer::ResolveAllContacts() {
+  IDEALGAS_PROFILE_PHASE(*profiler_, UpdatePhase::kCollisionResponse);
+  collision_resolver_.ResolveContacts(contacts_, particle_copies_,
+                                      all_particles_, *worker_pool_,
+                                      FindPeriod());
+  collision_count_ = collision_resolver_.GetResolvedCount();
+  IDEALGAS_PROFILE_COUNT(*profiler_, UpdateCounter::kCollisionsResolved,
+                         collision_resolver_.GetResolvedCount());
+}
+
+void GasContainer::FindVerletContacts() {
+  //only listed pairs can touch, so only they are checked
+  FindContacts([this](size_t index, vector<size_t>& neighbors) {
+    const vector<size_t>& all_neighbors = verlet_list_.GetNeighbors();
+    neighbors.assign(
+        all_neighbors.begin() + verlet_list_.GetNeighborStart(index),
+        all_neighbors.begin() + verlet_list_.GetNeighborStart(index + 1));
+    return index;
+  }, false);
+}
+
+double GasContainer::CalculateGridCellSize() const {
+  return particleutils::FindContactDistance(FindMaxRadius());
+}
+
+vec2 GasContainer::FindPeriod() const {
+  if (boundary_mode_ == BoundaryMode::kPeriodic) {
+    return vec2(container_width_, container_height_);
+  }
+  return vec2(0, 0);
+}
+
+double GasContainer::CalculateWallLength() const {
+  if (boundary_mode_ == BoundaryMode::kPeriodic) {
+    return 0;
+  }
+  return 2.0 * ((double) container_width_ + (double) container_height_);
+}
+
+size_t GasContainer::CountAllParticles() const {
+  size_t particle_count = 0;
+  for (ParticleGroup* group: particle_groups_) {
+    particle_count += group->GetGroupSize();
+  }
+  return particle_count;
+}
+
+size_t GasContainer::FindMaxRadius() const {
+  size_t max_radius = 0;
+  for (ParticleGroup* group: particle_groups_) {
+    max_radius = std::max(max_radius, group->GetParticleRadius());
+  }
+  return max_radius;
+}
+
+void GasContainer::CopyAllParticles() {
+  size_t particle_count = 0;
+  for (size_t group_index = 0; group_index < particle_groups_.size();
+       group_index++) {
+    particle_count = std::max(particle_count, group_offsets_.at(group_index) +
+                              particle_groups_.at(group_index)->GetGroupSize());
+  }
+  particle_copies_.resize(particle_count);
+
+  for (size_t group_index = 0; group_index < particle_groups_.size();
+       group_index++) {
+    ParticleGroup* group = particle_groups_.at(group_index);
+    size_t offset = group_offsets_.at(group_index);
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      //repeated groups just copy over their first appearance's copies
+      Particle& copy = particle_copies_[offset + index];
+      copy.position = group->GetPositionAt(index);
+      copy.velocity = group->GetVelocityAt(index);
+      copy.mass = group->GetParticleMass();
+      copy.radius = group->GetParticleRadius();
+    }
+  }
+}
+
+const vector<size_t>& GasContainer::ListAllParticles() {
+  FindGroupOffsets();
+  all_particles_.clear();
+  for (size_t group_index = 0; group_index < particle_groups_.size();
+       group_index++) {
+    size_t offset = group_offsets_.at(group_index);
+    for (size_t index = 0;
+         index < particle_groups_.at(group_index)->GetGroupSize(); index++) {
+      all_particles_.push_back(offset + index);
+    }
+  }
+  return all_particles_;
+}
+
+void GasContainer::StoreAllVelocities() {
+  for (size_t group_index = 0; group_index < particle_groups_.size();
+       group_index++) {
+    ParticleGroup* group = particle_groups_.at(group_index);
+    size_t offset = group_offsets_.at(group_index);
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      group->SetVelocityAt(index, particle_copies_[offset + index].velocity);
+    }
+  }
+}
+
+void GasContainer::FindGroupOffsets() {
+  group_offsets_.clear();
+  size_t next_offset = 0;
+
+  for (size_t group_index = 0; group_index < particle_groups_.size();
+       group_index++) {
+    ParticleGroup* group = particle_groups_.at(group_index);
+    size_t first_index = FindFirstListing(particle_groups_, group_index);
+    if (first_index < group_index) {
+      //repeated groups share the copies of their first appearance
+      group_offsets_.push_back(group_offsets_.at(first_index));
+    } else {
+      group_offsets_.push_back(next_offset);
+      next_offset += group->GetGroupSize();
+    }
+  }
+}
+
+bool AddGroupDescription(const std::string& description,
+                         map<Particle, size_t>& particle_information) {
+  unsigned long long count = 0;
+  unsigned long long mass = 0;
+  unsigned long long radius = 0;
+  char extra = 0;
+  if (std::sscanf(description.c_str(), "%llu:%llu:%llu%c", &count, &mass,
+                  &radius, &extra) != 3 || mass == 0) {
+    return false;
+  }
+  Particle group_particle(glm::vec2(0,0), glm::vec2(0,0), (size_t) mass,
+                          (size_t) radius, ci::Color(1, 1, 1));
+  particle_information[group_particle] += (size_t) count;
+  return true;
+}
+
+} // namespace idealgas
@@ -0,0 +1,168 @@
+#include "core/gas_observables.h"
+#include <algorithm>
+#include <utility>
+
+namespace idealgas {
+
+void GasObservables::SetSampleInterval(size_t update_count) {
+  //the updating thread owns the totals, so it applies the change itself
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  requested_sample_interval_ = update_count;
+  interval_requested_.store(true, std::memory_order_release);
+}
+
+size_t GasObservables::GetSampleInterval() const {
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  return requested_sample_interval_;
+}
+
+void GasObservables::RecordUpdate(const vector<ParticleGroup*>& groups,
+                                  double wall_length, double wall_impulse,
+                                  size_t collision_count, WorkerPool& pool,
+                                  double duration) {
+  update_count_++;
+  if (interval_requested_.load(std::memory_order_acquire)) {
+    ApplySampleInterval();
+  }
+  if (sample_interval_ == 0) {
+    return;
+  }
+  updates_since_sample_++;
+  time_since_sample_ += duration;
+  wall_impulse_since_sample_ += wall_impulse;
+  collisions_since_sample_ += collision_count;
+  if (updates_since_sample_ >= sample_interval_) {
+    TakeSample(groups, wall_length, pool);
+  }
+}
+
+size_t GasObservables::PullSamples(vector<ObservableSample>& samples) {
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  size_t sample_count = queued_samples_.size();
+  for (ObservableSample& sample: queued_samples_) {
+    samples.push_back(std::move(sample));
+  }
+  queued_samples_.clear();
+  return sample_count;
+}
+
+size_t GasObservables::GetDroppedSampleCount() const {
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  return dropped_sample_count_;
+}
+
+void GasObservables::ApplySampleInterval() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    sample_interval_ = requested_sample_interval_;
+    interval_requested_.store(false, std::memory_order_relaxed);
+  }
+  updates_since_sample_ = 0;
+  time_since_sample_ = 0;
+  wall_impulse_since_sample_ = 0;
+  collisions_since_sample_ = 0;
+}
+
+void GasObservables::TakeSample(const vector<ParticleGroup*>& groups,
+                                double wall_length, WorkerPool& pool) {
+  //split every group into tasks, each summing into its own sums, and only
+  //sum a group listed more than once the first time
+  task_groups_.clear();
+  task_starts_.clear();
+  for (size_t group_index = 0; group_index < groups.size(); group_index++) {
+    if (FindFirstListing(groups, group_index) < group_index) {
+      continue;
+    }
+    for (size_t start = 0; start < groups[group_index]->GetGroupSize();
+         start += kParticlesPerSumTask) {
+      task_groups_.push_back(group_index);
+      task_starts_.push_back(start);
+    }
+  }
+  task_sums_.resize(task_groups_.size());
+  sampled_groups_ = &groups;
+  pool.ParallelFor(task_groups_.size(), [this](size_t task) {
+    const ParticleGroup* group = (*sampled_groups_)[task_groups_[task]];
+    size_t end = std::min(task_starts_[task] + kParticlesPerSumTask,
+                          group->GetGroupSize());
+    task_sums_[task] = group->SumVelocities(task_starts_[task], end);
+  });
+  sampled_groups_ = nullptr;
+
+  //tasks are in group order, so each group's sums are one run of tasks
+  ObservableSample sample;
+  sample.update = update_count_;
+  sample.groups.resize(groups.size());
+  double total_speed = 0;
+  size_t task = 0;
+  for (size_t group_index = 0; group_index < groups.size(); group_index++) {
+    size_t first_index = FindFirstListing(groups, group_index);
+    if (first_index < group_index) {
+      //repeats get the observables of the first listing, but no totals
+      sample.groups[group_index] = sample.groups[first_index];
+      continue;
+    }
+    VelocitySums group_sums;
+    for (; task < task_groups_.size() && task_groups_[task] == group_index;
+         task++) {
+      group_sums.squared_speeds += task_sums_[task].squared_speeds;
+      group_sums.x_velocities += task_sums_[task].x_velocities;
+      group_sums.y_velocities += task_sums_[task].y_velocities;
+      group_sums.speeds += task_sums_[task].speeds;
+    }
+    ParticleObservables& observables = sample.groups[group_index];
+    observables.particle_count = groups[group_index]->GetGroupSize();
+    FinishObservables(group_sums,
+                      (double) groups[group_index]->GetParticleMass(),
+                      observables);
+
+    sample.total.particle_count += observables.particle_count;
+    sample.total.kinetic_energy += observables.kinetic_energy;
+    sample.total.x_momentum += observables.x_momentum;
+    sample.total.y_momentum += observables.y_momentum;
+    total_speed += group_sums.speeds;
+  }
+  if (sample.total.particle_count > 0) {
+    sample.total.temperature = sample.total.kinetic_energy /
+                               sample.total.particle_count;
+    sample.total.mean_speed = total_speed / sample.total.particle_count;
+  }
+
+  sample.has_pressure = wall_length > 0;
+  if (sample.has_pressure && time_since_sample_ > 0) {
+    sample.pressure = wall_impulse_since_sample_ /
+                      (wall_length * time_since_sample_);
+  }
+  if (time_since_sample_ > 0) {
+    sample.collision_rate = collisions_since_sample_ / time_since_sample_;
+  }
+  //every collision ends a free path of both its particles
+  if (collisions_since_sample_ > 0) {
+    sample.mean_free_path = total_speed / (2.0 * sample.collision_rate);
+  }
+  updates_since_sample_ = 0;
+  time_since_sample_ = 0;
+  wall_impulse_since_sample_ = 0;
+  collisions_since_sample_ = 0;
+
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  if (queued_samples_.size() >= kMaxQueuedSamples) {
+    queued_samples_.pop_front();
+    dropped_sample_count_++;
+  }
+  queued_samples_.push_back(std::move(sample));
+}
+
+void GasObservables::FinishObservables(const VelocitySums& sums, double mass,
+                                       ParticleObservables& observables) {
+  observables.kinetic_energy = 0.5 * mass * sums.squared_speeds;
+  observables.x_momentum = mass * sums.x_velocities;
+  observables.y_momentum = mass * sums.y_velocities;
+  if (observables.particle_count > 0) {
+    observables.temperature = observables.kinetic_energy /
+                              observables.particle_count;
+    observables.mean_speed = sums.speeds / observables.particle_count;
+  }
+}
+
+} // namespace idealgas
@@ -0,0 +1,172 @@
+#include "core/hierarchical_grid.h"
+#include "core/particle_utils.h"
+#include "core/uniform_grid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace idealgas {
+
+namespace {
+
+//most cells a level gets per particle in it
+const double kMaxCellsPerParticle = 4.0;
+
+} // namespace
+
+void HierarchicalGrid::Rebuild(const vector<Particle>& particles,
+                               const vector<size_t>& particle_list,
+                               double width, double height, bool wraps) {
+  wraps_ = wraps;
+  size_t particle_count = particle_list.size();
+  particle_levels_.resize(particle_count);
+  particle_cells_.resize(particle_count);
+  x_positions_.resize(particle_count);
+  y_positions_.resize(particle_count);
+  if (particle_count == 0) {
+    level_count_ = 0;
+    return;
+  }
+
+  //smallest cells fit the smallest pair
+  size_t min_radius = particles[particle_list[0]].radius;
+  for (size_t index: particle_list) {
+    min_radius = std::min(min_radius, particles[index].radius);
+  }
+  double base_cell_size = particleutils::FindContactDistance(min_radius);
+
+  //find how many doublings every particle's diameter needs
+  size_t max_doublings = 0;
+  for (size_t index = 0; index < particle_count; index++) {
+    const Particle& particle = particles[particle_list[index]];
+    double needed_size = particleutils::FindContactDistance(particle.radius);
+    size_t doublings = 0;
+    for (double cell_size = base_cell_size; cell_size < needed_size;
+         cell_size *= 2.0) {
+      doublings++;
+    }
+    particle_levels_[index] = doublings;
+    max_doublings = std::max(max_doublings, doublings);
+    x_positions_[index] = particle.position.x;
+    y_positions_[index] = particle.position.y;
+  }
+
+  //only keep levels holding particles, smallest cells first
+  level_numbers_.assign(max_doublings + 1, 0);
+  for (size_t doublings: particle_levels_) {
+    level_numbers_[doublings]++;
+  }
+  level_count_ = 0;
+  for (size_t doublings = 0; doublings <= max_doublings; doublings++) {
+    size_t level_particle_count = level_numbers_[doublings];
+    if (level_particle_count == 0) {
+      continue;
+    }
+    level_numbers_[doublings] = level_count_;
+    if (levels_.size() <= level_count_) {
+      levels_.push_back(GridLevel());
+    }
+    GridLevel& level = levels_[level_count_];
+    //bigger cells are always safe, so sparse levels get bigger cells
+    //instead of clearing many empty cells every rebuild
+    level.cell_size = std::max(
+        base_cell_size * std::pow(2.0, (double) doublings),
+        std::sqrt(width * height /
+                  (kMaxCellsPerParticle * level_particle_count)));
+    if (wraps) {
+      //cells on opposite edges touch, so none may be smaller than the size
+      level.column_count = std::max<size_t>(
+          1, (size_t) (width / level.cell_size));
+      level.row_count = std::max<size_t>(
+          1, (size_t) (height / level.cell_size));
+      level.cell_width = width / level.column_count;
+      level.cell_height = height / level.row_count;
+    } else {
+      level.column_count = std::max<size_t>(
+          1, (size_t) std::ceil(width / level.cell_size));
+      level.row_count = std::max<size_t>(
+          1, (size_t) std::ceil(height / level.cell_size));
+      level.cell_width = level.cell_size;
+      level.cell_height = level.cell_size;
+    }
+    level.cell_starts.assign(level.column_count * level.row_count + 1, 0);
+    level.cell_particles.clear();
+    level_count_++;
+  }
+
+  //find cell of every particle and count particles per cell
+  for (size_t index = 0; index < particle_count; index++) {
+    particle_levels_[index] = level_numbers_[particle_levels_[index]];
+    GridLevel& level = levels_[particle_levels_[index]];
+    size_t column = UniformGrid::FindCellCoordinate(
+        x_positions_[index], level.cell_width, level.column_count);
+    size_t row = UniformGrid::FindCellCoordinate(
+        y_positions_[index], level.cell_height, level.row_count);
+    particle_cells_[index] = row * level.column_count + column;
+    level.cell_starts[particle_cells_[index] + 1]++;
+  }
+
+  //turn counts into starting offsets, then fill cells in index order
+  for (size_t level_index = 0; level_index < level_count_; level_index++) {
+    GridLevel& level = levels_[level_index];
+    for (size_t cell = 1; cell < level.cell_starts.size(); cell++) {
+      level.cell_starts[cell] += level.cell_starts[cell - 1];
+    }
+    level.next_slots.assign(level.cell_starts.begin(),
+                            level.cell_starts.end() - 1);
+    level.cell_particles.resize(level.cell_starts.back());
+  }
+  for (size_t index = 0; index < particle_count; index++) {
+    GridLevel& level = levels_[particle_levels_[index]];
+    level.cell_particles[level.next_slots[particle_cells_[index]]++] = index;
+  }
+}
+
+void HierarchicalGrid::ListCandidates(size_t index,
+                                      vector<size_t>& candidates) const {
+  candidates.clear();
+  size_t own_level = particle_levels_.at(index);
+
+  for (size_t level_index = own_level; level_index < level_count_;
+       level_index++) {
+    const GridLevel& level = levels_[level_index];
+    size_t column = UniformGrid::FindCellCoordinate(
+        x_positions_[index], level.cell_width, level.column_count);
+    size_t row = UniformGrid::FindCellCoordinate(
+        y_positions_[index], level.cell_height, level.row_count);
+
+    size_t rows[3];
+    size_t columns[3];
+    size_t neighbor_row_count = UniformGrid::FindNeighborCells(
+        row, level.row_count, wraps_, rows);
+    size_t neighbor_column_count = UniformGrid::FindNeighborCells(
+        column, level.column_count, wraps_, columns);
+
+    for (size_t row_slot = 0; row_slot < neighbor_row_count; row_slot++) {
+      for (size_t column_slot = 0; column_slot < neighbor_column_count;
+           column_slot++) {
+        size_t cell = rows[row_slot] * level.column_count +
+                      columns[column_slot];
+        for (size_t slot = level.cell_starts[cell];
+             slot < level.cell_starts[cell + 1]; slot++) {
+          //pairs in one level are found from the later particle, cells are
+          //in increasing order, so stop at index
+          if (level_index == own_level &&
+              level.cell_particles[slot] >= index) {
+            break;
+          }
+          candidates.push_back(level.cell_particles[slot]);
+        }
+      }
+    }
+  }
+}
+
+size_t HierarchicalGrid::GetLevelCount() const {
+  return level_count_;
+}
+
+double HierarchicalGrid::GetCellSize(size_t level) const {
+  return levels_.at(level).cell_size;
+}
+
+} // namespace idealgas
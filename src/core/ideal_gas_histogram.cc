@@ -1,39 +1,95 @@
 #include "core/ideal_gas_histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
 namespace idealgas {
 
-IdealGasHistogram::IdealGasHistogram(const vec2 &top_left,
-                                     const vec2 &bottom_right,
-                                     ParticleGroup *particles, size_t width,
-                                     size_t height, size_t margins,
-                                     size_t num_buckets,
-                                     size_t y_interval_size) {
-  top_left_ = top_left;
-  bottom_right_ = bottom_right;
-  display_margin_ = margins;
-  histogram_width_ = width;
-  histogram_height_ = height;
+IdealGasHistogram::IdealGasHistogram(ParticleGroup *particles,
+                                     size_t num_buckets) {
+  if (num_buckets == 0) {
+    throw std::invalid_argument("a histogram needs at least one bucket");
+  }
   bucket_count_ = num_buckets;
-  y_interval_pixels_ = y_interval_size;
+  adaptive_limits_ = true;
   particle_group_ = particles;
 
-  ListSortedParticleSpeeds();
-  CalculateBucketSpeedLimits();
+  //limits start out covering exactly the current speeds
+  ListParticleSpeeds();
+  double min_speed = 0;
+  double max_speed = 0;
+  if (!particle_speeds_.empty()) {
+    min_speed = *std::min_element(particle_speeds_.begin(),
+                                  particle_speeds_.end());
+    max_speed = *std::max_element(particle_speeds_.begin(),
+                                  particle_speeds_.end());
+  }
+  CalculateBucketSpeedLimits(min_speed, max_speed);
+  CountParticlesPerBucket();
+}
 
-  //number of particles for each bucket of histogram starts at 0
-  particles_per_bucket_ = vector<size_t>(bucket_count_, 0);
+IdealGasHistogram::IdealGasHistogram(ParticleGroup *particles,
+                                     size_t num_buckets, double min_speed,
+                                     double max_speed) {
+  if (num_buckets == 0) {
+    throw std::invalid_argument("a histogram needs at least one bucket");
+  }
+  bucket_count_ = num_buckets;
+  adaptive_limits_ = false;
+  particle_group_ = particles;
 
+  ListParticleSpeeds();
+  CalculateBucketSpeedLimits(min_speed, max_speed);
   CountParticlesPerBucket();
 }
 
-IdealGasHistogram::~IdealGasHistogram() {
-  delete particle_group_;
-}
+void IdealGasHistogram::Update() {
+  //a resized group is recounted, but only after the limits cover its speeds
+  bool resized = particle_speeds_.size() != particle_group_->GetGroupSize();
+  if (resized) {
+    particle_speeds_.resize(particle_group_->GetGroupSize());
+  }
+
+  //find new speeds and the range they cover
+  double min_speed = min_speed_;
+  double max_speed = bucket_speed_limits_.back();
+  bool out_of_range = false;
+  for (size_t index = 0; index < particle_speeds_.size(); index++) {
+    double speed = glm::length(particle_group_->GetVelocityAt(index));
+    particle_speeds_[index] = speed;
+    if (speed < min_speed || speed > max_speed) {
+      min_speed = std::min(min_speed, speed);
+      max_speed = std::max(max_speed, speed);
+      out_of_range = true;
+    }
+  }
+
+  if (adaptive_limits_ && out_of_range) {
+    //widen limits w/ some headroom on the sides that grew, then recount
+    double headroom = (max_speed - min_speed) * kAdaptiveHeadroom;
+    if (min_speed < min_speed_) {
+      min_speed = std::max(0.0, min_speed - headroom);
+    }
+    if (max_speed > bucket_speed_limits_.back()) {
+      max_speed += headroom;
+    }
+    CalculateBucketSpeedLimits(min_speed, max_speed);
+    CountParticlesPerBucket();
+    return;
+  } else if (resized) {
+    CountParticlesPerBucket();
+    return;
+  }
 
-void IdealGasHistogram::DrawHistogram() const {
-  DrawHistogramBox();
-  vec2 bottom_left = top_left_ + vec2(0,histogram_height_);
-  DrawHistogramBars(bottom_left);
+  //only move particles whose bucket changed
+  for (size_t index = 0; index < particle_speeds_.size(); index++) {
+    size_t bucket = FindBucket(particle_speeds_[index]);
+    if (bucket != particle_buckets_[index]) {
+      particles_per_bucket_[particle_buckets_[index]]--;
+      particles_per_bucket_[bucket]++;
+      particle_buckets_[index] = bucket;
+    }
+  }
 }
 
 double IdealGasHistogram::GetParticleSpeedAt(size_t index) const {
@@ -48,79 +104,62 @@ size_t IdealGasHistogram::GetNumberParticlesAt(size_t index) const {
   return particles_per_bucket_.at(index);
 }
 
-void IdealGasHistogram::DrawHistogramBox() const {
-  //draw box
-  ci::Rectf histogram_box(top_left_, bottom_right_);
-  ci::gl::color(ci::Color("white"));
-  ci::gl::drawStrokedRect(histogram_box);
-
-  //draw horizontal axis label
-  ci::gl::drawStringCentered("Speed", vec2(bottom_right_.x-(histogram_width_/2),
-                                           bottom_right_.y+display_margin_/10));
-  //draw vertical axis label
-  //method to rotate text from: https://discourse.libcinder.org/t/what-is-the-best-way-to-rotate-rectangles-images/410/2
-  ci::gl::pushModelMatrix();
-  ci::gl::translate(top_left_.x - display_margin_ / 10,
-                    top_left_.y + histogram_height_ / 2);
-  ci::gl::rotate(3 * M_PI / 2);
-  ci::gl::drawStringCentered("Particle Count", vec2(0,0));
-  ci::gl::popModelMatrix();
+size_t IdealGasHistogram::GetBucketCount() const {
+  return bucket_count_;
 }
 
-void IdealGasHistogram::DrawHistogramBars(vec2 bottom_left) const {
-  //draw bars based on particle count for each bucket
-  ci::gl::color(particle_group_->GetGroupColor());
-  int pixel_bucket_size = histogram_width_ / bucket_count_;
-  vec2 current_top_left = vec2(bottom_left.x - pixel_bucket_size, bottom_left.y);
-
-  for (size_t count: particles_per_bucket_) {
-    int bar_height = count * y_interval_pixels_;
-
-    current_top_left = vec2(current_top_left.x + pixel_bucket_size,
-                            bottom_left.y - bar_height);
-    vec2 bottom_right = vec2(current_top_left.x + pixel_bucket_size,
-                             bottom_left.y);
-
-    ci::Rectf bar_box(current_top_left, bottom_right);
-    ci::gl::drawSolidRect(bar_box);
-  }
-}
-
-void IdealGasHistogram::ListSortedParticleSpeeds() {
+void IdealGasHistogram::ListParticleSpeeds() {
+  particle_speeds_.resize(particle_group_->GetGroupSize());
   for (size_t index = 0; index < particle_group_->GetGroupSize(); ++index) {
-    particle_speeds_.push_back(glm::length(particle_group_->
-                                           GetParticleAt(index)->velocity));
+    particle_speeds_[index] = glm::length(particle_group_->
+                                          GetVelocityAt(index));
   }
-  std::sort(particle_speeds_.begin(), particle_speeds_.end());
 }
 
-void IdealGasHistogram::CalculateBucketSpeedLimits() {
+void IdealGasHistogram::CalculateBucketSpeedLimits(double min_speed,
+                                                   double max_speed) {
   //calculate speed range for each bucket
-  double bucket_size = (particle_speeds_.back() - particle_speeds_.front()) /
-                        bucket_count_;
+  min_speed_ = min_speed;
+  bucket_size_ = (max_speed - min_speed) / bucket_count_;
 
   //loop through buckets, calculate upper speed limit for each
+  bucket_speed_limits_.resize(bucket_count_);
   for (size_t index = 0; index < bucket_count_; ++index) {
-    if (index == 0) {
-      bucket_speed_limits_.push_back(particle_speeds_.front() + bucket_size);
-    } else {
-      bucket_speed_limits_.push_back(bucket_speed_limits_.back() + bucket_size);
-    }
+    bucket_speed_limits_[index] = min_speed + bucket_size_ * (index + 1);
   }
+  bucket_speed_limits_.back() = max_speed;
 }
 
 void IdealGasHistogram::CountParticlesPerBucket() {
-  //loop through particles' speeds, checks which bucket each speed belongs in
-  for (double speed: particle_speeds_) {
-    for (size_t index = 0; index < bucket_count_; ++index) {
-      double upper_limit = bucket_speed_limits_.at(index);
-
-      if (speed <= upper_limit) {
-        particles_per_bucket_.at(index)++;
-        break;
-      }
-    }
+  //number of particles for each bucket of histogram starts at 0
+  particles_per_bucket_.assign(bucket_count_, 0);
+  particle_buckets_.resize(particle_speeds_.size());
+
+  for (size_t index = 0; index < particle_speeds_.size(); index++) {
+    size_t bucket = FindBucket(particle_speeds_[index]);
+    particle_buckets_[index] = bucket;
+    particles_per_bucket_[bucket]++;
+  }
+}
+
+size_t IdealGasHistogram::FindBucket(double speed) const {
+  //buckets include their upper limit, so speeds on a limit go to the lower one
+  double position = bucket_size_ > 0 ?
+                    std::ceil((speed - min_speed_) / bucket_size_) - 1 : 0;
+  if (!(position > 0)) {
+    return 0;
+  } else if (position >= bucket_count_ - 1) {
+    return bucket_count_ - 1;
+  }
+
+  //fix off by one rounding, limits are compared directly like before
+  size_t bucket = (size_t) position;
+  if (speed > bucket_speed_limits_[bucket]) {
+    bucket++;
+  } else if (speed <= bucket_speed_limits_[bucket - 1]) {
+    bucket--;
   }
+  return bucket;
 }
 
-} // namespace idealgas
\ No newline at end of file
+} // namespace idealgas
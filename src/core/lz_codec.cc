@@ -0,0 +1,175 @@
+#include "core/lz_codec.h"
+#include <cstdint>
+#include <cstring>
+
+namespace idealgas {
+
+namespace lzcodec {
+
+namespace {
+
+const size_t kMinMatch = 4;
+const size_t kMaxOffset = 65535;
+const size_t kHashBits = 14;
+
+//last bytes of the input are always literals, so matches never read past it
+const size_t kLastLiterals = 5;
+
+uint32_t ReadWord(const unsigned char* bytes) {
+  uint32_t word;
+  std::memcpy(&word, bytes, sizeof(word));
+  return word;
+}
+
+size_t HashWord(uint32_t word) {
+  return (word * 2654435761u) >> (32 - kHashBits);
+}
+
+/**
+ * Writes the rest of a length that didn't fit in a token's 4 bits.
+ */
+void WriteExtraLength(size_t length, vector<unsigned char>& output) {
+  for (; length >= 255; length -= 255) {
+    output.push_back(255);
+  }
+  output.push_back((unsigned char) length);
+}
+
+/**
+ * Writes one sequence of literals, followed by a match unless this is the
+ * last sequence.
+ */
+void WriteSequence(const unsigned char* literals, size_t literal_length,
+                   size_t match_length, size_t offset,
+                   vector<unsigned char>& output) {
+  size_t match_code = match_length >= kMinMatch ? match_length - kMinMatch : 0;
+  unsigned char token = (unsigned char)
+      (((literal_length < 15 ? literal_length : 15) << 4) |
+       (match_code < 15 ? match_code : 15));
+  output.push_back(token);
+  if (literal_length >= 15) {
+    WriteExtraLength(literal_length - 15, output);
+  }
+  output.insert(output.end(), literals, literals + literal_length);
+
+  if (match_length == 0) {
+    return;
+  }
+  output.push_back((unsigned char) (offset & 0xFF));
+  output.push_back((unsigned char) (offset >> 8));
+  if (match_code >= 15) {
+    WriteExtraLength(match_code - 15, output);
+  }
+}
+
+/**
+ * Reads the rest of a length that didn't fit in a token's 4 bits.
+ *
+ * @return false if the input ended first.
+ */
+bool ReadExtraLength(const unsigned char*& input, const unsigned char* end,
+                     size_t& length) {
+  unsigned char next;
+  do {
+    if (input >= end) {
+      return false;
+    }
+    next = *input++;
+    length += next;
+  } while (next == 255);
+  return true;
+}
+
+} // namespace
+
+void Compress(const unsigned char* input, size_t input_size,
+              vector<unsigned char>& output) {
+  output.clear();
+  //positions of recent 4 byte words, offset by 1 so 0 means empty
+  vector<size_t> recent_positions(size_t(1) << kHashBits, 0);
+
+  size_t literal_start = 0;
+  size_t position = 0;
+  while (input_size > kLastLiterals + kMinMatch &&
+         position + kMinMatch + kLastLiterals <= input_size) {
+    uint32_t word = ReadWord(input + position);
+    size_t& recent = recent_positions[HashWord(word)];
+    size_t candidate = recent;
+    recent = position + 1;
+
+    if (candidate == 0 || position - (candidate - 1) > kMaxOffset ||
+        ReadWord(input + candidate - 1) != word) {
+      position++;
+      continue;
+    }
+
+    //extend the match as far as it goes
+    size_t match_start = candidate - 1;
+    size_t match_length = kMinMatch;
+    while (position + match_length + kLastLiterals < input_size &&
+           input[match_start + match_length] ==
+           input[position + match_length]) {
+      match_length++;
+    }
+
+    WriteSequence(input + literal_start, position - literal_start,
+                  match_length, position - match_start, output);
+    position += match_length;
+    literal_start = position;
+  }
+
+  WriteSequence(input + literal_start, input_size - literal_start, 0, 0,
+                output);
+}
+
+bool Decompress(const unsigned char* input, size_t input_size,
+                unsigned char* output, size_t output_size) {
+  const unsigned char* end = input + input_size;
+  size_t written = 0;
+
+  while (input < end) {
+    unsigned char token = *input++;
+    size_t literal_length = token >> 4;
+    if (literal_length == 15 && !ReadExtraLength(input, end, literal_length)) {
+      return false;
+    }
+    if (literal_length > (size_t) (end - input) ||
+        literal_length > output_size - written) {
+      return false;
+    }
+    std::memcpy(output + written, input, literal_length);
+    input += literal_length;
+    written += literal_length;
+
+    if (input == end) {
+      break; //last sequence has no match
+    }
+
+    if (end - input < 2) {
+      return false;
+    }
+    size_t offset = input[0] | (size_t(input[1]) << 8);
+    input += 2;
+    size_t match_length = token & 0x0F;
+    if (match_length == 15 && !ReadExtraLength(input, end, match_length)) {
+      return false;
+    }
+    match_length += kMinMatch;
+    if (offset == 0 || offset > written ||
+        match_length > output_size - written) {
+      return false;
+    }
+
+    //copy byte by byte, since a match may overlap its own output
+    for (size_t index = 0; index < match_length; index++) {
+      output[written + index] = output[written - offset + index];
+    }
+    written += match_length;
+  }
+
+  return written == output_size;
+}
+
+} // namespace lzcodec
+
+} // namespace idealgas
@@ -0,0 +1,138 @@
+#include "core/morton_order.h"
+#include <algorithm>
+
+namespace idealgas {
+
+namespace {
+
+//highest quantized coordinate on either axis
+const double kMaxCell = 65535.0;
+
+/**
+ * Quantizes a coordinate into one of 65536 cells across the container.
+ */
+uint32_t FindCell(float coordinate, double scale) {
+  double cell = coordinate * scale;
+  if (!(cell > 0)) {
+    return 0;
+  }
+  return (uint32_t) std::min(cell, kMaxCell);
+}
+
+/**
+ * Spreads the low 16 bits of a value out to the even bits.
+ */
+uint32_t SpreadBits(uint32_t value) {
+  value &= 0x0000ffff;
+  value = (value | (value << 8)) & 0x00ff00ff;
+  value = (value | (value << 4)) & 0x0f0f0f0f;
+  value = (value | (value << 2)) & 0x33333333;
+  value = (value | (value << 1)) & 0x55555555;
+  return value;
+}
+
+} // namespace
+
+uint32_t MortonSorter::InterleaveBits(uint32_t x_cell, uint32_t y_cell) {
+  return SpreadBits(x_cell) | (SpreadBits(y_cell) << 1);
+}
+
+void MortonSorter::FindOrder(const float* x_positions,
+                             const float* y_positions, size_t count,
+                             double width, double height, WorkerPool& pool) {
+  keys_.resize(count);
+  order_.resize(count);
+  key_scratch_.resize(count);
+  order_scratch_.resize(count);
+
+  sorted_x_positions_ = x_positions;
+  sorted_y_positions_ = y_positions;
+  x_scale_ = width > 0 ? kMaxCell / width : 0;
+  y_scale_ = height > 0 ? kMaxCell / height : 0;
+  task_count_ = (count + kKeysPerSortTask - 1) / kKeysPerSortTask;
+  pool.ParallelFor(task_count_, [this](size_t task) {
+    size_t last_index = std::min(keys_.size(),
+                                 (task + 1) * kKeysPerSortTask);
+    for (size_t index = task * kKeysPerSortTask; index < last_index;
+         index++) {
+      keys_[index] =
+          InterleaveBits(FindCell(sorted_x_positions_[index], x_scale_),
+                         FindCell(sorted_y_positions_[index], y_scale_));
+      order_[index] = (uint32_t) index;
+    }
+  });
+  sorted_x_positions_ = nullptr;
+  sorted_y_positions_ = nullptr;
+
+  for (int shift = 0; shift < 32; shift += kRadixBits) {
+    SortByDigit(shift, pool);
+  }
+}
+
+void MortonSorter::ApplyOrder(vector<float>& values, WorkerPool& pool) {
+  value_scratch_.resize(order_.size());
+  task_count_ = (order_.size() + kKeysPerSortTask - 1) / kKeysPerSortTask;
+  ordered_values_ = &values;
+  pool.ParallelFor(task_count_, [this](size_t task) {
+    size_t last_index = std::min(order_.size(),
+                                 (task + 1) * kKeysPerSortTask);
+    for (size_t index = task * kKeysPerSortTask; index < last_index;
+         index++) {
+      value_scratch_[index] = (*ordered_values_)[order_[index]];
+    }
+  });
+  ordered_values_ = nullptr;
+  values.swap(value_scratch_);
+}
+
+const vector<uint32_t>& MortonSorter::GetOrder() const {
+  return order_;
+}
+
+void MortonSorter::SortByDigit(int shift, WorkerPool& pool) {
+  size_t count = keys_.size();
+  task_count_ = (count + kKeysPerSortTask - 1) / kKeysPerSortTask;
+  task_buckets_.assign(task_count_ * kRadixBuckets, 0);
+  digit_shift_ = shift;
+
+  //count every digit in every task's range of keys
+  pool.ParallelFor(task_count_, [this](size_t task) {
+    size_t* buckets = &task_buckets_[task * kRadixBuckets];
+    size_t last_index = std::min(keys_.size(),
+                                 (task + 1) * kKeysPerSortTask);
+    for (size_t index = task * kKeysPerSortTask; index < last_index;
+         index++) {
+      buckets[(keys_[index] >> digit_shift_) & (kRadixBuckets - 1)]++;
+    }
+  });
+
+  //every digit's keys go after all smaller digits, and within a digit,
+  //after the same digit's keys from earlier tasks, so the sort is stable
+  size_t next_slot = 0;
+  for (size_t bucket = 0; bucket < kRadixBuckets; bucket++) {
+    for (size_t task = 0; task < task_count_; task++) {
+      size_t bucket_count = task_buckets_[task * kRadixBuckets + bucket];
+      task_buckets_[task * kRadixBuckets + bucket] = next_slot;
+      next_slot += bucket_count;
+    }
+  }
+
+  pool.ParallelFor(task_count_, [this](size_t task) {
+    size_t* next_slots = &task_buckets_[task * kRadixBuckets];
+    size_t last_index = std::min(keys_.size(),
+                                 (task + 1) * kKeysPerSortTask);
+    for (size_t index = task * kKeysPerSortTask; index < last_index;
+         index++) {
+      size_t& slot = next_slots[(keys_[index] >> digit_shift_) &
+                                (kRadixBuckets - 1)];
+      key_scratch_[slot] = keys_[index];
+      order_scratch_[slot] = order_[index];
+      slot++;
+    }
+  });
+
+  keys_.swap(key_scratch_);
+  order_.swap(order_scratch_);
+}
+
+} // namespace idealgas
@@ -1,4 +1,5 @@
 #include "core/particle.h"
+#include <cstring>
 
 namespace idealgas {
 
@@ -10,4 +11,29 @@ bool operator<(const Particle& lhs, const Particle& rhs) {
   }
 }
 
-} // namespace idealgas
\ No newline at end of file
+Color FindNamedColor(const std::string& name) {
+  //channels of the SVG colors, in 0-255
+  struct NamedColor {
+    const char* name;
+    unsigned char red;
+    unsigned char green;
+    unsigned char blue;
+  };
+  static const NamedColor kNamedColors[] = {
+      {"black", 0, 0, 0},         {"white", 255, 255, 255},
+      {"red", 255, 0, 0},         {"green", 0, 128, 0},
+      {"blue", 0, 0, 255},        {"cyan", 0, 255, 255},
+      {"magenta", 255, 0, 255},   {"yellow", 255, 255, 0},
+      {"orange", 255, 165, 0},    {"purple", 128, 0, 128},
+      {"gray", 128, 128, 128}};
+
+  for (const NamedColor& color: kNamedColors) {
+    if (std::strcmp(color.name, name.c_str()) == 0) {
+      return Color(color.red / 255.0f, color.green / 255.0f,
+                   color.blue / 255.0f);
+    }
+  }
+  return Color(0, 0, 0);
+}
+
+} // namespace idealgas
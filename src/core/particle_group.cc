@@ -1,72 +1,220 @@
 #include "core/particle_group.h"
-#include "core/particle_utils.h"
+#include "core/particle_kernels.h"
+#include "core/philox.h"
+#include <algorithm>
+#include <cmath>
 
 namespace idealgas {
 
-using idealgas::particleutils::GenerateRandomVelocity;
-using idealgas::particleutils::GenerateRandomPosition;
-
 ParticleGroup::ParticleGroup(size_t num_particles, size_t mass, size_t radius,
                              const ci::Color& color, double max_x_pos,
-                             double max_y_pos, double max_velocity) {
+                             double max_y_pos, double max_velocity,
+                             uint64_t seed, uint64_t group_number,
+                             WorkerPool* pool) {
+  particle_mass_ = mass;
+  particle_radius_ = radius;
   particle_color_ = color;
   max_x_position_ = max_x_pos;
   max_y_position_ = max_y_pos;
   max_velocity_magnitude_ = max_velocity;
 
-  particles_ = new vector<Particle>;
-  vec2 particle_velocity = GenerateRandomVelocity(max_velocity_magnitude_);
+  x_positions_.resize(num_particles);
+  y_positions_.resize(num_particles);
+  x_velocities_.resize(num_particles);
+  y_velocities_.resize(num_particles);
+
+  size_t task_count = (num_particles + kParticlesPerPlacementTask - 1) /
+                      kParticlesPerPlacementTask;
+  auto place_particles = [&](size_t task) {
+    size_t last_index = std::min(num_particles,
+                                 (task + 1) * kParticlesPerPlacementTask);
+    for (size_t index = task * kParticlesPerPlacementTask; index < last_index;
+         index++) {
+      Particle particle = PlaceParticle(seed, group_number, index);
+      x_positions_[index] = particle.position.x;
+      y_positions_[index] = particle.position.y;
+      x_velocities_[index] = particle.velocity.x;
+      y_velocities_[index] = particle.velocity.y;
+    }
+  };
 
-  for (int index = 0; index < num_particles; index++) {
-    vec2 current_random_position = GenerateRandomPosition(max_x_pos, max_y_pos);
-    particles_->push_back(Particle(current_random_position, particle_velocity,
-                                  mass, radius, color));
+  if (pool == nullptr) {
+    for (size_t task = 0; task < task_count; task++) {
+      place_particles(task);
+    }
+  } else {
+    pool->ParallelFor(task_count, place_particles);
   }
 }
 
-ParticleGroup::~ParticleGroup() {
-  delete[] particles_;
-}
+ParticleGroup::~ParticleGroup() = default;
 
 void ParticleGroup::HandlePossibleWallCollisions() {
-  for (Particle& particle: *particles_) {
+  for (size_t index = 0; index < x_positions_.size(); index++) {
+    float& x_velocity = x_velocities_[index];
+    float& y_velocity = y_velocities_[index];
+
     //check for collision w/ horizontal wall (top/bottom side of container)
-    if ((particle.position.y <= 0 && particle.velocity.y < 0) ||
-        (particle.position.y >= max_y_position_ && particle.velocity.y > 0)) {
-      particle.velocity.y = -particle.velocity.y;
+    if ((y_positions_[index] <= 0 && y_velocity < 0) ||
+        (y_positions_[index] >= max_y_position_ && y_velocity > 0)) {
+      y_velocity = -y_velocity;
     }
     //check for collision w/ vertical wall (left/right side of container)
-    if ((particle.position.x <= 0 && particle.velocity.x < 0) ||
-        (particle.position.x >= max_x_position_ && particle.velocity.x > 0)) {
-      particle.velocity.x = -particle.velocity.x;
+    if ((x_positions_[index] <= 0 && x_velocity < 0) ||
+        (x_positions_[index] >= max_x_position_ && x_velocity > 0)) {
+      x_velocity = -x_velocity;
     }
   }
 }
 
 void ParticleGroup::UpdatePositions() {
-  for (Particle& particle: *particles_) {
-    particle.position += particle.velocity;
+  for (size_t index = 0; index < x_positions_.size(); index++) {
+    x_positions_[index] += x_velocities_[index];
+    y_positions_[index] += y_velocities_[index];
+  }
+}
+
+double ParticleGroup::AdvanceWithWallCollisions() {
+  double reflected_speed = particlekernels::ReflectAndAdvance(
+      x_positions_.data(), y_positions_.data(), x_velocities_.data(),
+      y_velocities_.data(), x_positions_.size(), max_x_position_,
+      max_y_position_);
+  //reversing a velocity component changes momentum by twice its size
+  return 2.0 * particle_mass_ * reflected_speed;
+}
+
+void ParticleGroup::AdvanceWithWrapping(double width, double height) {
+  particlekernels::WrapAndAdvance(x_positions_.data(), y_positions_.data(),
+                                  x_velocities_.data(), y_velocities_.data(),
+                                  x_positions_.size(), width, height);
+}
+
+void ParticleGroup::SortAlongCurve(MortonSorter& sorter, WorkerPool& pool) {
+  sorter.FindOrder(x_positions_.data(), y_positions_.data(),
+                   x_positions_.size(), max_x_position_, max_y_position_,
+                   pool);
+  sorter.ApplyOrder(x_positions_, pool);
+  sorter.ApplyOrder(y_positions_, pool);
+  sorter.ApplyOrder(x_velocities_, pool);
+  sorter.ApplyOrder(y_velocities_, pool);
+}
+
+VelocitySums ParticleGroup::SumVelocities(size_t begin, size_t end) const {
+  VelocitySums sums;
+  for (size_t index = begin; index < end; index++) {
+    double x_velocity = x_velocities_[index];
+    double y_velocity = y_velocities_[index];
+    double squared_speed = x_velocity * x_velocity + y_velocity * y_velocity;
+    sums.squared_speeds += squared_speed;
+    sums.x_velocities += x_velocity;
+    sums.y_velocities += y_velocity;
+    sums.speeds += std::sqrt(squared_speed);
   }
+  return sums;
 }
 
 size_t ParticleGroup::GetGroupSize() const {
-  return particles_->size();
+  return x_positions_.size();
 }
 
-Particle* ParticleGroup::GetParticleAt(size_t index) const {
-  return &particles_->at(index);
+ParticleView ParticleGroup::GetParticleAt(size_t index) {
+  return ParticleView(x_positions_.at(index), y_positions_.at(index),
+                      x_velocities_.at(index), y_velocities_.at(index),
+                      particle_mass_, particle_radius_, particle_color_);
+}
+
+vec2 ParticleGroup::GetPositionAt(size_t index) const {
+  return vec2(x_positions_.at(index), y_positions_.at(index));
+}
+
+vec2 ParticleGroup::GetVelocityAt(size_t index) const {
+  return vec2(x_velocities_.at(index), y_velocities_.at(index));
+}
+
+void ParticleGroup::SetPositionAt(size_t index, const vec2& position) {
+  x_positions_.at(index) = position.x;
+  y_positions_.at(index) = position.y;
+}
+
+void ParticleGroup::SetVelocityAt(size_t index, const vec2& velocity) {
+  x_velocities_.at(index) = velocity.x;
+  y_velocities_.at(index) = velocity.y;
+}
+
+void ParticleGroup::CopyParticleArrays(float* x_positions,
+                                       float* y_positions,
+                                       float* x_velocities,
+                                       float* y_velocities) const {
+  std::copy(x_positions_.begin(), x_positions_.end(), x_positions);
+  std::copy(y_positions_.begin(), y_positions_.end(), y_positions);
+  std::copy(x_velocities_.begin(), x_velocities_.end(), x_velocities);
+  std::copy(y_velocities_.begin(), y_velocities_.end(), y_velocities);
+}
+
+void ParticleGroup::AssignParticleArrays(const float* x_positions,
+                                         const float* y_positions,
+                                         const float* x_velocities,
+                                         const float* y_velocities,
+                                         size_t count) {
+  x_positions_.assign(x_positions, x_positions + count);
+  y_positions_.assign(y_positions, y_positions + count);
+  x_velocities_.assign(x_velocities, x_velocities + count);
+  y_velocities_.assign(y_velocities, y_velocities + count);
 }
 
 void ParticleGroup::ClearParticles() {
-  particles_->clear();
+  x_positions_.clear();
+  y_positions_.clear();
+  x_velocities_.clear();
+  y_velocities_.clear();
 }
 
 void ParticleGroup::AddParticle(const Particle &particle) {
-  particles_->push_back(particle);
+  x_positions_.push_back(particle.position.x);
+  y_positions_.push_back(particle.position.y);
+  x_velocities_.push_back(particle.velocity.x);
+  y_velocities_.push_back(particle.velocity.y);
 }
 
 ci::Color ParticleGroup::GetGroupColor() const {
   return particle_color_;
 }
 
-} //namespace idealgas
\ No newline at end of file
+size_t ParticleGroup::GetParticleMass() const {
+  return particle_mass_;
+}
+
+size_t ParticleGroup::GetParticleRadius() const {
+  return particle_radius_;
+}
+
+double ParticleGroup::GetMaxXPosition() const {
+  return max_x_position_;
+}
+
+double ParticleGroup::GetMaxYPosition() const {
+  return max_y_position_;
+}
+
+Particle ParticleGroup::PlaceParticle(uint64_t seed, uint64_t group_number,
+                                      size_t index) const {
+  //one block of random bits per particle, numbered by group and index
+  uint32_t bits[4];
+  philox::GenerateBlock(seed, index, group_number, bits);
+  vec2 position((float) (philox::ToUnitInterval(bits[0]) * max_x_position_),
+                (float) (philox::ToUnitInterval(bits[1]) * max_y_position_));
+  vec2 velocity((float) ((2.0 * philox::ToUnitInterval(bits[2]) - 1.0) *
+                         max_velocity_magnitude_),
+                (float) ((2.0 * philox::ToUnitInterval(bits[3]) - 1.0) *
+                         max_velocity_magnitude_));
+  return Particle(position, velocity, particle_mass_, particle_radius_,
+                  particle_color_);
+}
+
+size_t FindFirstListing(const vector<ParticleGroup*>& groups,
+                        size_t group_index) {
+  return std::find(groups.begin(), groups.begin() + group_index,
+                   groups.at(group_index)) - groups.begin();
+}
+
+} //namespace idealgas
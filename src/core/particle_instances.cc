@@ -0,0 +1,53 @@
+#include "core/particle_instances.h"
+
+namespace idealgas {
+
+bool ParticleInstancePacker::UpdateBatches(
+    const vector<ParticleGroup*>& groups) {
+  bool layout_changed = batches_.size() != groups.size();
+  batches_.resize(groups.size());
+
+  size_t first_instance = 0;
+  for (size_t group = 0; group < groups.size(); group++) {
+    InstanceBatch& batch = batches_[group];
+    size_t instance_count = groups[group]->GetGroupSize();
+    if (batch.first_instance != first_instance ||
+        batch.instance_count != instance_count) {
+      layout_changed = true;
+    }
+    batch.first_instance = first_instance;
+    batch.instance_count = instance_count;
+    batch.radius = (float) groups[group]->GetParticleRadius();
+    batch.color = groups[group]->GetGroupColor();
+    first_instance += instance_count;
+  }
+
+  instance_count_ = first_instance;
+  return layout_changed;
+}
+
+void ParticleInstancePacker::Pack(const vector<ParticleGroup*>& groups,
+                                  const vec2& offset, float* instances) const {
+  for (size_t group = 0; group < batches_.size(); group++) {
+    const InstanceBatch& batch = batches_[group];
+    //positions are top left corners of each particle's bounding box
+    vec2 center_offset = offset + vec2(batch.radius, batch.radius);
+    float* instance = instances + batch.first_instance * kFloatsPerInstance;
+    for (size_t index = 0; index < batch.instance_count; index++) {
+      vec2 center = groups[group]->GetPositionAt(index) + center_offset;
+      instance[0] = center.x;
+      instance[1] = center.y;
+      instance += kFloatsPerInstance;
+    }
+  }
+}
+
+size_t ParticleInstancePacker::GetInstanceCount() const {
+  return instance_count_;
+}
+
+const vector<InstanceBatch>& ParticleInstancePacker::GetBatches() const {
+  return batches_;
+}
+
+} // namespace idealgas
@@ -0,0 +1,584 @@
+#include "core/particle_kernels.h"
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define IDEALGAS_X86_KERNELS 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define IDEALGAS_TARGET_AVX2
+#else
+#define IDEALGAS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace idealgas {
+
+namespace particlekernels {
+
+namespace {
+
+/**
+ * Finds the smallest float that is at least the given wall position, so that
+ * comparing float positions against it matches comparing against the double.
+ */
+float FindWallThreshold(double wall_position) {
+  float threshold = (float) wall_position;
+  if ((double) threshold < wall_position) {
+    threshold = std::nextafter(threshold, std::numeric_limits<float>::max());
+  }
+  return threshold;
+}
+
+float ReflectAndAdvanceAxisScalar(float* positions, float* velocities,
+                                  size_t begin, size_t count, float max) {
+  float reflected_speed = 0;
+  for (size_t index = begin; index < count; index++) {
+    float position = positions[index];
+    float velocity = velocities[index];
+    bool into_wall = (position <= 0 && velocity < 0) ||
+                     (position >= max && velocity > 0);
+    reflected_speed += into_wall ? std::fabs(velocity) : 0.0f;
+    velocity = into_wall ? -velocity : velocity;
+
+    velocities[index] = velocity;
+    positions[index] = position + velocity;
+  }
+  return reflected_speed;
+}
+
+void WrapAndAdvanceAxisScalar(float* positions, const float* velocities,
+                              size_t begin, size_t count, float period) {
+  for (size_t index = begin; index < count; index++) {
+    float position = positions[index] + velocities[index];
+    position -= position >= period ? period : 0.0f;
+    position += position < 0 ? period : 0.0f;
+    positions[index] = position;
+  }
+}
+
+/**
+ * Collides one pair if its particles touch and move towards each other, in
+ * the same operation order as particleutils::CollideParticles.
+ *
+ * @return true if the pair collided, else false.
+ */
+bool CollidePair(const CollisionArrays& particles, size_t first,
+                 size_t second) {
+  float x_offset = particles.x_positions[first] -
+                   particles.x_positions[second];
+  float y_offset = particles.y_positions[first] -
+                   particles.y_positions[second];
+  float squared_distance = x_offset * x_offset + y_offset * y_offset;
+  float contact_distance = particles.radii[first] + particles.radii[second];
+  if (squared_distance > contact_distance * contact_distance ||
+      squared_distance == 0) {
+    return false;
+  }
+  float approach = (particles.x_velocities[first] -
+                    particles.x_velocities[second]) * x_offset +
+                   (particles.y_velocities[first] -
+                    particles.y_velocities[second]) * y_offset;
+  if (approach >= 0) {
+    return false;
+  }
+
+  float projection = approach / squared_distance;
+  float total_mass = particles.masses[first] + particles.masses[second];
+  float first_factor = 2.0f * particles.masses[second] / total_mass *
+                       projection;
+  float second_factor = 2.0f * particles.masses[first] / total_mass *
+                        projection;
+  particles.x_velocities[first] -= first_factor * x_offset;
+  particles.y_velocities[first] -= first_factor * y_offset;
+  particles.x_velocities[second] += second_factor * x_offset;
+  particles.y_velocities[second] += second_factor * y_offset;
+  return true;
+}
+
+size_t CollidePairsScalar(const CollisionArrays& particles,
+                          const size_t* first_particles,
+                          const size_t* second_particles, size_t begin,
+                          size_t pair_count) {
+  size_t collision_count = 0;
+  for (size_t pair = begin; pair < pair_count; pair++) {
+    if (CollidePair(particles, first_particles[pair],
+                    second_particles[pair])) {
+      collision_count++;
+    }
+  }
+  return collision_count;
+}
+
+/**
+ * Checks if a colliding pair in a run of pairs shares a particle w/ any other
+ * pair of the run. Colliding changes velocities, so such a pair could change
+ * whether later pairs of the run collide, and the run has to be collided one
+ * pair after another. Pairs that don't collide change nothing, so they may
+ * share particles freely among themselves.
+ *
+ * @param colliding_pairs   mask of the pairs that collide, found w/ the
+ *                          velocities from before the run.
+ */
+bool CollidingPairsShareParticles(const size_t* first_particles,
+                                  const size_t* second_particles,
+                                  size_t count, int colliding_pairs) {
+  for (size_t pair = 0; pair < count; pair++) {
+    if ((colliding_pairs & (1 << pair)) == 0) {
+      continue;
+    }
+    for (size_t other_pair = 0; other_pair < count; other_pair++) {
+      if (other_pair != pair &&
+          (first_particles[pair] == first_particles[other_pair] ||
+           first_particles[pair] == second_particles[other_pair] ||
+           second_particles[pair] == first_particles[other_pair] ||
+           second_particles[pair] == second_particles[other_pair])) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+#ifdef IDEALGAS_X86_KERNELS
+
+float ReflectAndAdvanceAxisSse(float* positions, float* velocities,
+                               size_t count, float max) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 wall = _mm_set1_ps(max);
+  const __m128 sign_bit = _mm_set1_ps(-0.0f);
+  __m128 reflected_speeds = _mm_setzero_ps();
+
+  size_t index = 0;
+  for (; index + 4 <= count; index += 4) {
+    __m128 position = _mm_loadu_ps(positions + index);
+    __m128 velocity = _mm_loadu_ps(velocities + index);
+
+    //lanes moving into a wall get the sign of their velocity flipped
+    __m128 into_low_wall = _mm_and_ps(_mm_cmple_ps(position, zero),
+                                      _mm_cmplt_ps(velocity, zero));
+    __m128 into_high_wall = _mm_and_ps(_mm_cmpge_ps(position, wall),
+                                       _mm_cmpgt_ps(velocity, zero));
+    __m128 into_wall = _mm_or_ps(into_low_wall, into_high_wall);
+    reflected_speeds = _mm_add_ps(reflected_speeds,
+                                  _mm_and_ps(into_wall,
+                                             _mm_andnot_ps(sign_bit,
+                                                           velocity)));
+    velocity = _mm_xor_ps(velocity, _mm_and_ps(into_wall, sign_bit));
+
+    _mm_storeu_ps(velocities + index, velocity);
+    _mm_storeu_ps(positions + index, _mm_add_ps(position, velocity));
+  }
+
+  alignas(16) float lane_speeds[4];
+  _mm_store_ps(lane_speeds, reflected_speeds);
+  return lane_speeds[0] + lane_speeds[1] + lane_speeds[2] + lane_speeds[3] +
+         ReflectAndAdvanceAxisScalar(positions, velocities, index, count, max);
+}
+
+IDEALGAS_TARGET_AVX2
+float ReflectAndAdvanceAxisAvx2(float* positions, float* velocities,
+                                size_t count, float max) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 wall = _mm256_set1_ps(max);
+  const __m256 sign_bit = _mm256_set1_ps(-0.0f);
+  __m256 reflected_speeds = _mm256_setzero_ps();
+
+  size_t index = 0;
+  for (; index + 8 <= count; index += 8) {
+    __m256 position = _mm256_loadu_ps(positions + index);
+    __m256 velocity = _mm256_loadu_ps(velocities + index);
+
+    //lanes moving into a wall get the sign of their velocity flipped
+    __m256 into_low_wall = _mm256_and_ps(
+        _mm256_cmp_ps(position, zero, _CMP_LE_OQ),
+        _mm256_cmp_ps(velocity, zero, _CMP_LT_OQ));
+    __m256 into_high_wall = _mm256_and_ps(
+        _mm256_cmp_ps(position, wall, _CMP_GE_OQ),
+        _mm256_cmp_ps(velocity, zero, _CMP_GT_OQ));
+    __m256 into_wall = _mm256_or_ps(into_low_wall, into_high_wall);
+    reflected_speeds = _mm256_add_ps(reflected_speeds,
+                                     _mm256_and_ps(into_wall,
+                                                   _mm256_andnot_ps(
+                                                       sign_bit, velocity)));
+    velocity = _mm256_xor_ps(velocity, _mm256_and_ps(into_wall, sign_bit));
+
+    _mm256_storeu_ps(velocities + index, velocity);
+    _mm256_storeu_ps(positions + index, _mm256_add_ps(position, velocity));
+  }
+
+  alignas(32) float lane_speeds[8];
+  _mm256_store_ps(lane_speeds, reflected_speeds);
+  float reflected_speed = 0;
+  for (float lane_speed: lane_speeds) {
+    reflected_speed += lane_speed;
+  }
+  return reflected_speed +
+         ReflectAndAdvanceAxisScalar(positions, velocities, index, count, max);
+}
+
+void WrapAndAdvanceAxisSse(float* positions, const float* velocities,
+                           size_t count, float period) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 length = _mm_set1_ps(period);
+
+  size_t index = 0;
+  for (; index + 4 <= count; index += 4) {
+    __m128 position = _mm_add_ps(_mm_loadu_ps(positions + index),
+                                 _mm_loadu_ps(velocities + index));
+    //lanes past either edge come back in from the other one
+    position = _mm_sub_ps(position,
+                          _mm_and_ps(_mm_cmpge_ps(position, length), length));
+    position = _mm_add_ps(position,
+                          _mm_and_ps(_mm_cmplt_ps(position, zero), length));
+    _mm_storeu_ps(positions + index, position);
+  }
+  WrapAndAdvanceAxisScalar(positions, velocities, index, count, period);
+}
+
+IDEALGAS_TARGET_AVX2
+void WrapAndAdvanceAxisAvx2(float* positions, const float* velocities,
+                            size_t count, float period) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 length = _mm256_set1_ps(period);
+
+  size_t index = 0;
+  for (; index + 8 <= count; index += 8) {
+    __m256 position = _mm256_add_ps(_mm256_loadu_ps(positions + index),
+                                    _mm256_loadu_ps(velocities + index));
+    //lanes past either edge come back in from the other one
+    position = _mm256_sub_ps(
+        position,
+        _mm256_and_ps(_mm256_cmp_ps(position, length, _CMP_GE_OQ), length));
+    position = _mm256_add_ps(
+        position,
+        _mm256_and_ps(_mm256_cmp_ps(position, zero, _CMP_LT_OQ), length));
+    _mm256_storeu_ps(positions + index, position);
+  }
+  WrapAndAdvanceAxisScalar(positions, velocities, index, count, period);
+}
+
+/**
+ * State of the two particles of every pair in a run of pairs, gathered into
+ * lane order for loading into vector registers.
+ */
+template <size_t kLanes>
+struct GatheredPairs {
+  alignas(32) float x_offsets[kLanes];
+  alignas(32) float y_offsets[kLanes];
+  alignas(32) float x_velocity_differences[kLanes];
+  alignas(32) float y_velocity_differences[kLanes];
+  alignas(32) float contact_distances[kLanes];
+  alignas(32) float first_masses[kLanes];
+  alignas(32) float second_masses[kLanes];
+  alignas(32) float first_factors[kLanes];
+  alignas(32) float second_factors[kLanes];
+};
+
+template <size_t kLanes>
+void GatherPairs(const CollisionArrays& particles,
+                 const size_t* first_particles,
+                 const size_t* second_particles,
+                 GatheredPairs<kLanes>& gathered) {
+  for (size_t lane = 0; lane < kLanes; lane++) {
+    size_t first = first_particles[lane];
+    size_t second = second_particles[lane];
+    gathered.x_offsets[lane] = particles.x_positions[first] -
+                               particles.x_positions[second];
+    gathered.y_offsets[lane] = particles.y_positions[first] -
+                               particles.y_positions[second];
+    gathered.x_velocity_differences[lane] = particles.x_velocities[first] -
+                                            particles.x_velocities[second];
+    gathered.y_velocity_differences[lane] = particles.y_velocities[first] -
+                                            particles.y_velocities[second];
+    gathered.contact_distances[lane] = particles.radii[first] +
+                                       particles.radii[second];
+    gathered.first_masses[lane] = particles.masses[first];
+    gathered.second_masses[lane] = particles.masses[second];
+  }
+}
+
+/**
+ * Counts the lanes set in a lane mask.
+ */
+size_t CountLanes(int lane_mask) {
+  size_t lane_count = 0;
+  for (; lane_mask != 0; lane_mask &= lane_mask - 1) {
+    lane_count++;
+  }
+  return lane_count;
+}
+
+/**
+ * Applies the velocity changes found for the colliding lanes of a run of
+ * pairs.
+ */
+template <size_t kLanes>
+void ScatterPairs(const CollisionArrays& particles,
+                  const size_t* first_particles,
+                  const size_t* second_particles,
+                  const GatheredPairs<kLanes>& gathered, int colliding_lanes) {
+  for (size_t lane = 0; lane < kLanes; lane++) {
+    if ((colliding_lanes & (1 << lane)) == 0) {
+      continue;
+    }
+    size_t first = first_particles[lane];
+    size_t second = second_particles[lane];
+    particles.x_velocities[first] -= gathered.first_factors[lane] *
+                                     gathered.x_offsets[lane];
+    particles.y_velocities[first] -= gathered.first_factors[lane] *
+                                     gathered.y_offsets[lane];
+    particles.x_velocities[second] += gathered.second_factors[lane] *
+                                      gathered.x_offsets[lane];
+    particles.y_velocities[second] += gathered.second_factors[lane] *
+                                      gathered.y_offsets[lane];
+  }
+}
+
+size_t CollidePairsSse(const CollisionArrays& particles,
+                       const size_t* first_particles,
+                       const size_t* second_particles, size_t pair_count) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 two = _mm_set1_ps(2.0f);
+  GatheredPairs<4> gathered;
+  size_t collision_count = 0;
+
+  size_t pair = 0;
+  for (; pair + 4 <= pair_count; pair += 4) {
+    GatherPairs(particles, first_particles + pair, second_particles + pair,
+                gathered);
+    __m128 x_offset = _mm_load_ps(gathered.x_offsets);
+    __m128 y_offset = _mm_load_ps(gathered.y_offsets);
+    __m128 squared_distance = _mm_add_ps(_mm_mul_ps(x_offset, x_offset),
+                                         _mm_mul_ps(y_offset, y_offset));
+    __m128 contact_distance = _mm_load_ps(gathered.contact_distances);
+    __m128 approach = _mm_add_ps(
+        _mm_mul_ps(_mm_load_ps(gathered.x_velocity_differences), x_offset),
+        _mm_mul_ps(_mm_load_ps(gathered.y_velocity_differences), y_offset));
+
+    //lanes that touch, aren't on top of each other and move closer collide
+    __m128 colliding = _mm_and_ps(
+        _mm_and_ps(_mm_cmple_ps(squared_distance,
+                                _mm_mul_ps(contact_distance,
+                                           contact_distance)),
+                   _mm_cmpneq_ps(squared_distance, zero)),
+        _mm_cmplt_ps(approach, zero));
+    int colliding_lanes = _mm_movemask_ps(colliding);
+    if (colliding_lanes == 0) {
+      continue;
+    }
+    //pairs sharing a particle w/ a collision depend on it, nothing has
+    //been written yet, so they can still go one at a time
+    if (CollidingPairsShareParticles(first_particles + pair,
+                                     second_particles + pair, 4,
+                                     colliding_lanes)) {
+      collision_count += CollidePairsScalar(particles, first_particles,
+                                            second_particles, pair, pair + 4);
+      continue;
+    }
+
+    __m128 projection = _mm_div_ps(approach, squared_distance);
+    __m128 first_mass = _mm_load_ps(gathered.first_masses);
+    __m128 second_mass = _mm_load_ps(gathered.second_masses);
+    __m128 total_mass = _mm_add_ps(first_mass, second_mass);
+    _mm_store_ps(gathered.first_factors, _mm_mul_ps(_mm_div_ps(
+        _mm_mul_ps(two, second_mass), total_mass), projection));
+    _mm_store_ps(gathered.second_factors, _mm_mul_ps(_mm_div_ps(
+        _mm_mul_ps(two, first_mass), total_mass), projection));
+    ScatterPairs(particles, first_particles + pair, second_particles + pair,
+                 gathered, colliding_lanes);
+    collision_count += CountLanes(colliding_lanes);
+  }
+  return collision_count + CollidePairsScalar(particles, first_particles,
+                                              second_particles, pair,
+                                              pair_count);
+}
+
+IDEALGAS_TARGET_AVX2
+size_t CollidePairsAvx2(const CollisionArrays& particles,
+                        const size_t* first_particles,
+                        const size_t* second_particles, size_t pair_count) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 two = _mm256_set1_ps(2.0f);
+  GatheredPairs<8> gathered;
+  size_t collision_count = 0;
+
+  size_t pair = 0;
+  for (; pair + 8 <= pair_count; pair += 8) {
+    GatherPairs(particles, first_particles + pair, second_particles + pair,
+                gathered);
+    __m256 x_offset = _mm256_load_ps(gathered.x_offsets);
+    __m256 y_offset = _mm256_load_ps(gathered.y_offsets);
+    __m256 squared_distance = _mm256_add_ps(
+        _mm256_mul_ps(x_offset, x_offset), _mm256_mul_ps(y_offset, y_offset));
+    __m256 contact_distance = _mm256_load_ps(gathered.contact_distances);
+    __m256 approach = _mm256_add_ps(
+        _mm256_mul_ps(_mm256_load_ps(gathered.x_velocity_differences),
+                      x_offset),
+        _mm256_mul_ps(_mm256_load_ps(gathered.y_velocity_differences),
+                      y_offset));
+
+    //lanes that touch, aren't on top of each other and move closer collide
+    __m256 colliding = _mm256_and_ps(
+        _mm256_and_ps(
+            _mm256_cmp_ps(squared_distance,
+                          _mm256_mul_ps(contact_distance, contact_distance),
+                          _CMP_LE_OQ),
+            _mm256_cmp_ps(squared_distance, zero, _CMP_NEQ_UQ)),
+        _mm256_cmp_ps(approach, zero, _CMP_LT_OQ));
+    int colliding_lanes = _mm256_movemask_ps(colliding);
+    if (colliding_lanes == 0) {
+      continue;
+    }
+    //pairs sharing a particle w/ a collision depend on it, nothing has
+    //been written yet, so they can still go one at a time
+    if (CollidingPairsShareParticles(first_particles + pair,
+                                     second_particles + pair, 8,
+                                     colliding_lanes)) {
+      collision_count += CollidePairsScalar(particles, first_particles,
+                                            second_particles, pair, pair + 8);
+      continue;
+    }
+
+    __m256 projection = _mm256_div_ps(approach, squared_distance);
+    __m256 first_mass = _mm256_load_ps(gathered.first_masses);
+    __m256 second_mass = _mm256_load_ps(gathered.second_masses);
+    __m256 total_mass = _mm256_add_ps(first_mass, second_mass);
+    _mm256_store_ps(gathered.first_factors, _mm256_mul_ps(_mm256_div_ps(
+        _mm256_mul_ps(two, second_mass), total_mass), projection));
+    _mm256_store_ps(gathered.second_factors, _mm256_mul_ps(_mm256_div_ps(
+        _mm256_mul_ps(two, first_mass), total_mass), projection));
+    ScatterPairs(particles, first_particles + pair, second_particles + pair,
+                 gathered, colliding_lanes);
+    collision_count += CountLanes(colliding_lanes);
+  }
+  return collision_count + CollidePairsScalar(particles, first_particles,
+                                              second_particles, pair,
+                                              pair_count);
+}
+
+bool IsAvx2Supported() {
+#if defined(_MSC_VER)
+  int registers[4];
+  __cpuid(registers, 1);
+  bool os_saves_avx = (registers[2] & (1 << 27)) &&
+                      (_xgetbv(0) & 0x6) == 0x6;
+  __cpuidex(registers, 7, 0);
+  return os_saves_avx && (registers[1] & (1 << 5));
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // IDEALGAS_X86_KERNELS
+
+float ReflectAndAdvanceAxis(KernelLevel level, float* positions,
+                            float* velocities, size_t count, float max) {
+#ifdef IDEALGAS_X86_KERNELS
+  if (level == KernelLevel::kAvx2) {
+    return ReflectAndAdvanceAxisAvx2(positions, velocities, count, max);
+  } else if (level == KernelLevel::kSse) {
+    return ReflectAndAdvanceAxisSse(positions, velocities, count, max);
+  }
+#endif
+  return ReflectAndAdvanceAxisScalar(positions, velocities, 0, count, max);
+}
+
+void WrapAndAdvanceAxis(KernelLevel level, float* positions,
+                        const float* velocities, size_t count, float period) {
+#ifdef IDEALGAS_X86_KERNELS
+  if (level == KernelLevel::kAvx2) {
+    WrapAndAdvanceAxisAvx2(positions, velocities, count, period);
+    return;
+  } else if (level == KernelLevel::kSse) {
+    WrapAndAdvanceAxisSse(positions, velocities, count, period);
+    return;
+  }
+#endif
+  WrapAndAdvanceAxisScalar(positions, velocities, 0, count, period);
+}
+
+size_t CollidePairsAtLevel(KernelLevel level, const CollisionArrays& particles,
+                          const size_t* first_particles,
+                          const size_t* second_particles, size_t pair_count) {
+#ifdef IDEALGAS_X86_KERNELS
+  if (level == KernelLevel::kAvx2) {
+    return CollidePairsAvx2(particles, first_particles, second_particles,
+                            pair_count);
+  } else if (level == KernelLevel::kSse) {
+    return CollidePairsSse(particles, first_particles, second_particles,
+                           pair_count);
+  }
+#endif
+  return CollidePairsScalar(particles, first_particles, second_particles, 0,
+                            pair_count);
+}
+
+} // namespace
+
+KernelLevel FindBestKernelLevel() {
+#ifdef IDEALGAS_X86_KERNELS
+  //SSE2 is always available on x86-64
+  return IsAvx2Supported() ? KernelLevel::kAvx2 : KernelLevel::kSse;
+#else
+  return KernelLevel::kScalar;
+#endif
+}
+
+double ReflectAndAdvance(float* x_positions, float* y_positions,
+                         float* x_velocities, float* y_velocities,
+                         size_t count, double max_x, double max_y) {
+  //processor can't change while running, so only check once
+  static const KernelLevel best_level = FindBestKernelLevel();
+  return ReflectAndAdvance(best_level, x_positions, y_positions, x_velocities,
+                    y_velocities, count, max_x, max_y);
+}
+
+double ReflectAndAdvance(KernelLevel level, float* x_positions,
+                         float* y_positions, float* x_velocities,
+                         float* y_velocities, size_t count, double max_x,
+                         double max_y) {
+  //each axis reflects and moves independently of the other
+  double reflected_speed = ReflectAndAdvanceAxis(level, x_positions,
+                                                 x_velocities, count,
+                                                 FindWallThreshold(max_x));
+  return reflected_speed + ReflectAndAdvanceAxis(level, y_positions,
+                                                 y_velocities, count,
+                                                 FindWallThreshold(max_y));
+}
+
+void WrapAndAdvance(float* x_positions, float* y_positions,
+                    const float* x_velocities, const float* y_velocities,
+                    size_t count, double width, double height) {
+  static const KernelLevel best_level = FindBestKernelLevel();
+  WrapAndAdvance(best_level, x_positions, y_positions, x_velocities,
+                 y_velocities, count, width, height);
+}
+
+void WrapAndAdvance(KernelLevel level, float* x_positions, float* y_positions,
+                    const float* x_velocities, const float* y_velocities,
+                    size_t count, double width, double height) {
+  WrapAndAdvanceAxis(level, x_positions, x_velocities, count, (float) width);
+  WrapAndAdvanceAxis(level, y_positions, y_velocities, count,
+                     (float) height);
+}
+
+size_t CollidePairs(const CollisionArrays& particles,
+                    const size_t* first_particles,
+                    const size_t* second_particles, size_t pair_count) {
+  static const KernelLevel best_level = FindBestKernelLevel();
+  return CollidePairsAtLevel(best_level, particles, first_particles,
+                             second_particles, pair_count);
+}
+
+size_t CollidePairs(KernelLevel level, const CollisionArrays& particles,
+                    const size_t* first_particles,
+                    const size_t* second_particles, size_t pair_count) {
+  return CollidePairsAtLevel(level, particles, first_particles,
+                             second_particles, pair_count);
+}
+
+} // namespace particlekernels
+
+} // namespace idealgas
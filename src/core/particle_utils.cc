@@ -1,49 +1,112 @@
 #include "core/particle_utils.h"
-#include "cinder/gl/gl.h"
+#include <cmath>
 
 namespace idealgas {
 
 namespace particleutils {
 
-double GenerateRandomDouble(double max_value, double min_value) {
-  return min_value + (rand() / (RAND_MAX / (max_value - min_value)));
+namespace {
+
+bool TouchingAtOffset(const Particle& first, const Particle& second,
+                      const vec2& offset) {
+  //compare squared distances, so no square root is needed
+  float contact_distance = (float) (first.radius + second.radius);
+  return dot(offset, offset) <= contact_distance * contact_distance;
 }
 
-vec2 GenerateRandomVelocity(double max_magnitude) {
-  double x_velocity = GenerateRandomDouble(max_magnitude,
-                                           -max_magnitude);
-  double y_velocity = GenerateRandomDouble(max_magnitude,
-                                           -max_magnitude);
-  return vec2(x_velocity, y_velocity);
+bool CollideAtOffset(Particle& first, Particle& second, const vec2& offset) {
+  float squared_distance = dot(offset, offset);
+  float contact_distance = (float) (first.radius + second.radius);
+  if (squared_distance > contact_distance * contact_distance ||
+      squared_distance == 0) {
+    return false;
+  }
+  float approach = dot(first.velocity - second.velocity, offset);
+  if (approach >= 0) {
+    return false;
+  }
+
+  //the offset projection is shared, only the mass ratio differs per side
+  float projection = approach / squared_distance;
+  float total_mass = (float) (first.mass + second.mass);
+  float first_factor = 2.0f * second.mass / total_mass * projection;
+  float second_factor = 2.0f * first.mass / total_mass * projection;
+  first.velocity -= first_factor * offset;
+  second.velocity += second_factor * offset;
+  return true;
 }
 
-vec2 GenerateRandomPosition(double max_x, double max_y) {
-  double x_position = GenerateRandomDouble(max_x, 0.0);
-  double y_position = GenerateRandomDouble(max_y, 0.0);
-  return vec2(x_position, y_position);
+} // namespace
+
+double FindContactDistance(double max_radius) {
+  //colliding particles are at most two radii apart, extra 1 for rounding
+  return 2.0 * max_radius + 1.0;
 }
 
-void HandleParticleCollision(Particle& first, const Particle& second) {
-  vec2 v1 = first.velocity;
-  vec2 v2 = second.velocity;
-  vec2 x1 = first.position;
-  vec2 x2 = second.position;
-  size_t m1 = first.mass;
-  size_t m2 = second.mass;
-
-  //calculate new velocity of first particle
+vec2 FindCollisionVelocity(vec2 v1, vec2 v2, vec2 x1, vec2 x2, size_t m1,
+                           size_t m2) {
+  //squared distance straight from the offset, instead of squaring a length
+  vec2 offset = x1 - x2;
   double multiplier1 = (2.0 * m2 / (m1 + m2)) *
-                       (dot(v1 - v2, x1 - x2) / (length(x1 - x2) * length(x1 - x2)));
-  first.velocity = v1 - (vec2((x1 - x2).x * multiplier1,
-                                         (x1 - x2).y * multiplier1));
+                       (dot(v1 - v2, offset) / dot(offset, offset));
+  return v1 - (vec2(offset.x * multiplier1, offset.y * multiplier1));
+}
+
+void HandleParticleCollision(Particle& first, const Particle& second) {
+  first.velocity = FindCollisionVelocity(first.velocity, second.velocity,
+                                         first.position, second.position,
+                                         first.mass, second.mass);
 }
 
 bool ParticleCollisionExists(const Particle& first, const Particle& second) {
-  double distance = length(first.position - second.position);
   bool are_moving_towards = dot(first.velocity - second.velocity,
                                 first.position - second.position) < 0;
 
-  return distance <= first.radius + second.radius && are_moving_towards;
+  return ParticlesTouching(first, second) && are_moving_towards;
+}
+
+bool ParticlesTouching(const Particle& first, const Particle& second) {
+  return TouchingAtOffset(first, second, first.position - second.position);
+}
+
+bool ParticlesTouching(const Particle& first, const Particle& second,
+                       const vec2& period) {
+  return TouchingAtOffset(first, second,
+                          FindWrappedOffset(first.position, second.position,
+                                            period));
+}
+
+void ResolveParticleCollision(Particle& first, Particle& second) {
+  //both new velocities come from the old ones, so find both before storing
+  vec2 first_velocity = FindCollisionVelocity(first.velocity, second.velocity,
+                                              first.position, second.position,
+                                              first.mass, second.mass);
+  second.velocity = FindCollisionVelocity(second.velocity, first.velocity,
+                                          second.position, first.position,
+                                          second.mass, first.mass);
+  first.velocity = first_velocity;
+}
+
+bool CollideParticles(Particle& first, Particle& second) {
+  return CollideAtOffset(first, second, first.position - second.position);
+}
+
+bool CollideParticles(Particle& first, Particle& second, const vec2& period) {
+  return CollideAtOffset(first, second,
+                         FindWrappedOffset(first.position, second.position,
+                                           period));
+}
+
+vec2 FindWrappedOffset(const vec2& first, const vec2& second,
+                       const vec2& period) {
+  vec2 offset = first - second;
+  if (period.x > 0) {
+    offset.x -= period.x * std::round(offset.x / period.x);
+  }
+  if (period.y > 0) {
+    offset.y -= period.y * std::round(offset.y / period.y);
+  }
+  return offset;
 }
 
 } // namespace particleutils
@@ -0,0 +1,62 @@
+#include "core/philox.h"
+
+namespace idealgas {
+
+namespace philox {
+
+namespace {
+
+//multipliers and key increments of Philox4x32 from Salmon et al. (2011)
+const uint32_t kMultiplier0 = 0xD2511F53;
+const uint32_t kMultiplier1 = 0xCD9E8D57;
+const uint32_t kKeyIncrement0 = 0x9E3779B9;
+const uint32_t kKeyIncrement1 = 0xBB67AE85;
+const int kRoundCount = 10;
+
+/**
+ * Multiplies two words, splitting the product into its high and low words.
+ */
+void MultiplyHighLow(uint32_t lhs, uint32_t rhs, uint32_t& high,
+                     uint32_t& low) {
+  uint64_t product = (uint64_t) lhs * rhs;
+  high = (uint32_t) (product >> 32);
+  low = (uint32_t) product;
+}
+
+} // namespace
+
+void GenerateBlock(uint64_t key, uint64_t counter_low, uint64_t counter_high,
+                   uint32_t output[4]) {
+  uint32_t words[4] = {(uint32_t) counter_low, (uint32_t) (counter_low >> 32),
+                       (uint32_t) counter_high,
+                       (uint32_t) (counter_high >> 32)};
+  uint32_t key0 = (uint32_t) key;
+  uint32_t key1 = (uint32_t) (key >> 32);
+
+  for (int round = 0; round < kRoundCount; round++) {
+    if (round > 0) {
+      key0 += kKeyIncrement0;
+      key1 += kKeyIncrement1;
+    }
+    uint32_t high0, low0, high1, low1;
+    MultiplyHighLow(kMultiplier0, words[0], high0, low0);
+    MultiplyHighLow(kMultiplier1, words[2], high1, low1);
+    uint32_t mixed[4] = {high1 ^ words[1] ^ key0, low1,
+                         high0 ^ words[3] ^ key1, low0};
+    for (int index = 0; index < 4; index++) {
+      words[index] = mixed[index];
+    }
+  }
+
+  for (int index = 0; index < 4; index++) {
+    output[index] = words[index];
+  }
+}
+
+double ToUnitInterval(uint32_t bits) {
+  return bits * (1.0 / 4294967296.0);
+}
+
+} // namespace philox
+
+} // namespace idealgas
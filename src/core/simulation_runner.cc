@@ -0,0 +1,151 @@
+#include "core/simulation_runner.h"
+#include <algorithm>
+#include <chrono>
+
+namespace idealgas {
+
+using std::chrono::steady_clock;
+
+namespace {
+
+//longest a paced thread sleeps before checking if it should stop
+const std::chrono::milliseconds kMaxSleep(10);
+
+} // namespace
+
+constexpr double SimulationRunner::kUnlimitedSteps;
+constexpr double SimulationRunner::kMaxCatchUpSeconds;
+
+SimulationRunner::SimulationRunner(GasContainer* container)
+    : container_(container), is_running_(false), stop_requested_(false),
+      steps_per_second_(kUnlimitedSteps), step_count_(0),
+      has_queued_changes_(false) {
+  snapshots_.Publish(container_->GetParticleGroups(), 0);
+}
+
+SimulationRunner::~SimulationRunner() {
+  Stop();
+}
+
+void SimulationRunner::Start(double steps_per_second) {
+  if (is_running_) {
+    return;
+  }
+  steps_per_second_ = steps_per_second;
+  stop_requested_ = false;
+  is_running_ = true;
+  step_thread_ = std::thread(&SimulationRunner::RunSteps, this);
+}
+
+void SimulationRunner::Stop() {
+  if (!is_running_) {
+    return;
+  }
+  stop_requested_ = true;
+  step_thread_.join();
+
+  //changes queued after the last step are made before handing back
+  std::lock_guard<std::mutex> lock(change_mutex_);
+  is_running_ = false;
+  ApplyQueuedChanges();
+}
+
+void SimulationRunner::SetStepsPerSecond(double steps_per_second) {
+  steps_per_second_ = steps_per_second;
+}
+
+bool SimulationRunner::IsRunning() const {
+  return is_running_;
+}
+
+size_t SimulationRunner::GetStepCount() const {
+  return step_count_;
+}
+
+void SimulationRunner::QueueChange(
+    const std::function<void(GasContainer&)>& change) {
+  std::lock_guard<std::mutex> lock(change_mutex_);
+  if (!is_running_) {
+    change(*container_);
+    return;
+  }
+  queued_changes_.push_back(change);
+  has_queued_changes_ = true;
+}
+
+bool SimulationRunner::ReadLatest(const vector<ParticleGroup*>& groups) {
+  return snapshots_.ReadLatest(groups);
+}
+
+size_t SimulationRunner::GetReadStep() const {
+  return snapshots_.GetReadStep();
+}
+
+void SimulationRunner::RunSteps() {
+  const vector<ParticleGroup*>& groups = container_->GetParticleGroups();
+  double rate = steps_per_second_;
+  steady_clock::time_point pace_start = steady_clock::now();
+  size_t paced_steps = 0;
+  bool latest_published = true;
+
+  while (!stop_requested_) {
+    //changing the rate restarts pacing from now
+    double target_rate = steps_per_second_;
+    if (target_rate != rate) {
+      rate = target_rate;
+      pace_start = steady_clock::now();
+      paced_steps = 0;
+    }
+
+    if (rate > 0) {
+      steady_clock::time_point due_time = pace_start +
+          std::chrono::duration_cast<steady_clock::duration>(
+              std::chrono::duration<double>(paced_steps / rate));
+      steady_clock::time_point now = steady_clock::now();
+      if (due_time > now) {
+        //publish before idling, so every step shows at slow rates
+        if (!latest_published) {
+          snapshots_.Publish(groups, step_count_);
+          latest_published = true;
+        }
+        std::this_thread::sleep_until(std::min(due_time, now + kMaxSleep));
+        continue;
+      }
+      if (now - due_time >
+          std::chrono::duration<double>(kMaxCatchUpSeconds)) {
+        pace_start = now;
+        paced_steps = 0;
+      }
+    }
+
+    if (has_queued_changes_) {
+      std::lock_guard<std::mutex> lock(change_mutex_);
+      ApplyQueuedChanges();
+    }
+    container_->Update();
+    step_count_++;
+    paced_steps++;
+    latest_published = false;
+
+    //only copy particles once the reader took the last copy, so stepping
+    //flat out doesn't spend its time copying snapshots nobody reads
+    if (snapshots_.IsLatestTaken()) {
+      snapshots_.Publish(groups, step_count_);
+      latest_published = true;
+    }
+  }
+
+  if (!latest_published) {
+    snapshots_.Publish(groups, step_count_);
+  }
+}
+
+void SimulationRunner::ApplyQueuedChanges() {
+  for (const std::function<void(GasContainer&)>& change: queued_changes_) {
+    change(*container_);
+  }
+  queued_changes_.clear();
+  has_queued_changes_ = false;
+}
+
+} // namespace idealgas
@@ -0,0 +1,63 @@
+#include "core/snapshot_buffer.h"
+
+namespace idealgas {
+
+SnapshotBuffer::SnapshotBuffer()
+    : shared_state_(2), write_slot_(0), read_slot_(1) {
+}
+
+void SnapshotBuffer::Publish(const vector<ParticleGroup*>& groups,
+                             size_t step) {
+  ParticleSnapshot& snapshot = slots_[write_slot_];
+  snapshot.step = step;
+  snapshot.x_positions.resize(groups.size());
+  snapshot.y_positions.resize(groups.size());
+  snapshot.x_velocities.resize(groups.size());
+  snapshot.y_velocities.resize(groups.size());
+  for (size_t group = 0; group < groups.size(); group++) {
+    size_t group_size = groups[group]->GetGroupSize();
+    snapshot.x_positions[group].resize(group_size);
+    snapshot.y_positions[group].resize(group_size);
+    snapshot.x_velocities[group].resize(group_size);
+    snapshot.y_velocities[group].resize(group_size);
+    groups[group]->CopyParticleArrays(snapshot.x_positions[group].data(),
+                                      snapshot.y_positions[group].data(),
+                                      snapshot.x_velocities[group].data(),
+                                      snapshot.y_velocities[group].data());
+  }
+
+  //release makes the filled slot visible to the reader that acquires it
+  unsigned previous_state = shared_state_.exchange(write_slot_ | kFreshBit,
+                                                   std::memory_order_acq_rel);
+  write_slot_ = previous_state & kSlotMask;
+}
+
+bool SnapshotBuffer::IsLatestTaken() const {
+  return (shared_state_.load(std::memory_order_relaxed) & kFreshBit) == 0;
+}
+
+bool SnapshotBuffer::ReadLatest(const vector<ParticleGroup*>& groups) {
+  if ((shared_state_.load(std::memory_order_relaxed) & kFreshBit) == 0) {
+    return false;
+  }
+  unsigned previous_state = shared_state_.exchange(read_slot_,
+                                                   std::memory_order_acq_rel);
+  read_slot_ = previous_state & kSlotMask;
+
+  const ParticleSnapshot& snapshot = slots_[read_slot_];
+  for (size_t group = 0; group < groups.size() &&
+                         group < snapshot.x_positions.size(); group++) {
+    groups[group]->AssignParticleArrays(snapshot.x_positions[group].data(),
+                                        snapshot.y_positions[group].data(),
+                                        snapshot.x_velocities[group].data(),
+                                        snapshot.y_velocities[group].data(),
+                                        snapshot.x_positions[group].size());
+  }
+  return true;
+}
+
+size_t SnapshotBuffer::GetReadStep() const {
+  return slots_[read_slot_].step;
+}
+
+} // namespace idealgas
@@ -0,0 +1,180 @@
+#include "core/sweep_and_prune.h"
+#include <algorithm>
+
+namespace idealgas {
+
+namespace {
+
+//extra extent on every side, so float rounding in the contact test can
+//never find a touching pair whose extents don't overlap
+const float kRoundingMargin = 0.5f;
+
+} // namespace
+
+void SweepAndPrune::Update(const vector<Particle>& particles,
+                           const vector<size_t>& particle_list, double width,
+                           double height, bool wraps) {
+  size_t particle_count = particle_list.size();
+  bool along_y = height > width;
+  sweep_length_ = wraps ? (float) (along_y ? height : width) : 0.0f;
+  cross_length_ = wraps ? (float) (along_y ? width : height) : 0.0f;
+  bool sort_from_scratch = along_y != sweeps_along_y_ ||
+                           particle_count != sorted_particles_.size();
+  sweeps_along_y_ = along_y;
+  swap_count_ = 0;
+
+  sweep_starts_.resize(particle_count);
+  sweep_ends_.resize(particle_count);
+  cross_starts_.resize(particle_count);
+  cross_ends_.resize(particle_count);
+
+  if (sort_from_scratch) {
+    //extents by list position for now, sorted into slots below
+    sorted_particles_.resize(particle_count);
+    for (size_t index = 0; index < particle_count; index++) {
+      sorted_particles_[index] = index;
+      FindExtents(particles[particle_list[index]], sweep_starts_[index],
+                  sweep_ends_[index], cross_starts_[index],
+                  cross_ends_[index]);
+    }
+    //ties go by list position, so the order only depends on the particles
+    std::sort(sorted_particles_.begin(), sorted_particles_.end(),
+              [this](size_t first, size_t second) {
+      return sweep_starts_[first] < sweep_starts_[second] ||
+             (sweep_starts_[first] == sweep_starts_[second] &&
+              first < second);
+    });
+  }
+
+  max_extent_length_ = 0;
+  for (size_t slot = 0; slot < particle_count; slot++) {
+    FindExtents(particles[particle_list[sorted_particles_[slot]]],
+                sweep_starts_[slot], sweep_ends_[slot], cross_starts_[slot],
+                cross_ends_[slot]);
+    max_extent_length_ = std::max(max_extent_length_,
+                                  sweep_ends_[slot] - sweep_starts_[slot]);
+  }
+
+  //particles only moved a little, so most are still in place
+  for (size_t slot = 1; slot < particle_count; slot++) {
+    if (!(sweep_starts_[slot] < sweep_starts_[slot - 1])) {
+      continue;
+    }
+    size_t particle = sorted_particles_[slot];
+    float sweep_start = sweep_starts_[slot];
+    float sweep_end = sweep_ends_[slot];
+    float cross_start = cross_starts_[slot];
+    float cross_end = cross_ends_[slot];
+
+    size_t target = slot;
+    while (target > 0 && sweep_start < sweep_starts_[target - 1]) {
+      sorted_particles_[target] = sorted_particles_[target - 1];
+      sweep_starts_[target] = sweep_starts_[target - 1];
+      sweep_ends_[target] = sweep_ends_[target - 1];
+      cross_starts_[target] = cross_starts_[target - 1];
+      cross_ends_[target] = cross_ends_[target - 1];
+      target--;
+    }
+    sorted_particles_[target] = particle;
+    sweep_starts_[target] = sweep_start;
+    sweep_ends_[target] = sweep_end;
+    cross_starts_[target] = cross_start;
+    cross_ends_[target] = cross_end;
+    swap_count_ += slot - target;
+  }
+}
+
+void SweepAndPrune::Clear() {
+  sorted_particles_.clear();
+}
+
+void SweepAndPrune::ListOverlaps(size_t slot, vector<size_t>& overlaps) const {
+  overlaps.clear();
+  float sweep_start = sweep_starts_[slot];
+  float sweep_end = sweep_ends_[slot];
+
+  //later particles start later, so stop at the first one starting past end
+  for (size_t other_slot = slot + 1; other_slot < sorted_particles_.size() &&
+                                     sweep_starts_[other_slot] <= sweep_end;
+       other_slot++) {
+    if (CrossExtentsOverlap(slot, other_slot)) {
+      overlaps.push_back(sorted_particles_[other_slot]);
+    }
+  }
+  if (sweep_length_ == 0) {
+    return;
+  }
+
+  //an extent past the far edge comes back in at the near edge, over the
+  //first particles in the order
+  if (sweep_end > sweep_length_) {
+    float wrapped_end = sweep_end - sweep_length_;
+    for (size_t other_slot = 0; other_slot < slot &&
+                                sweep_starts_[other_slot] <= wrapped_end;
+         other_slot++) {
+      if (CrossExtentsOverlap(slot, other_slot)) {
+        overlaps.push_back(sorted_particles_[other_slot]);
+      }
+    }
+  }
+  //an extent past the near edge comes back in at the far edge, over the
+  //last particles in the order, unless they are past the far edge too and
+  //already list the pair themselves
+  if (sweep_start < 0) {
+    float wrapped_start = sweep_start + sweep_length_;
+    for (size_t other_slot = sorted_particles_.size() - 1;
+         other_slot > slot &&
+         sweep_starts_[other_slot] >= wrapped_start - max_extent_length_;
+         other_slot--) {
+      if (sweep_ends_[other_slot] >= wrapped_start &&
+          sweep_ends_[other_slot] <= sweep_length_ &&
+          CrossExtentsOverlap(slot, other_slot)) {
+        overlaps.push_back(sorted_particles_[other_slot]);
+      }
+    }
+  }
+}
+
+size_t SweepAndPrune::GetParticleAt(size_t slot) const {
+  return sorted_particles_.at(slot);
+}
+
+size_t SweepAndPrune::GetParticleCount() const {
+  return sorted_particles_.size();
+}
+
+size_t SweepAndPrune::GetSwapCount() const {
+  return swap_count_;
+}
+
+void SweepAndPrune::FindExtents(const Particle& particle, float& sweep_start,
+                                float& sweep_end, float& cross_start,
+                                float& cross_end) const {
+  float extent = (float) particle.radius + kRoundingMargin;
+  float sweep_position = sweeps_along_y_ ? particle.position.y :
+                                           particle.position.x;
+  float cross_position = sweeps_along_y_ ? particle.position.x :
+                                           particle.position.y;
+  sweep_start = sweep_position - extent;
+  sweep_end = sweep_position + extent;
+  cross_start = cross_position - extent;
+  cross_end = cross_position + extent;
+}
+
+bool SweepAndPrune::CrossExtentsOverlap(size_t slot, size_t other_slot) const {
+  float cross_start = cross_starts_[slot];
+  float cross_end = cross_ends_[slot];
+  float other_start = cross_starts_[other_slot];
+  float other_end = cross_ends_[other_slot];
+  if (other_start <= cross_end && cross_start <= other_end) {
+    return true;
+  } else if (cross_length_ == 0) {
+    return false;
+  }
+
+  //move the other extent a container size over, to this one's side
+  float shift = other_start < cross_start ? cross_length_ : -cross_length_;
+  return other_start + shift <= cross_end && cross_start <= other_end + shift;
+}
+
+} // namespace idealgas
@@ -0,0 +1,421 @@
+#include "core/trajectory.h"
+#include "core/lz_codec.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace idealgas {
+
+namespace {
+
+/**
+ * Splits 4 byte values into 4 planes, all first bytes, then all second
+ * bytes, and so on.
+ */
+void ShuffleBytes(const vector<uint32_t>& values,
+                  vector<unsigned char>& bytes) {
+  bytes.resize(values.size() * sizeof(uint32_t));
+  const unsigned char* value_bytes =
+      reinterpret_cast<const unsigned char*>(values.data());
+  for (size_t plane = 0; plane < sizeof(uint32_t); plane++) {
+    unsigned char* plane_bytes = bytes.data() + plane * values.size();
+    for (size_t index = 0; index < values.size(); index++) {
+      plane_bytes[index] = value_bytes[index * sizeof(uint32_t) + plane];
+    }
+  }
+}
+
+/**
+ * Joins byte planes made by ShuffleBytes back into 4 byte values.
+ */
+void UnshuffleBytes(const vector<unsigned char>& bytes,
+                    vector<uint32_t>& values) {
+  values.resize(bytes.size() / sizeof(uint32_t));
+  unsigned char* value_bytes = reinterpret_cast<unsigned char*>(values.data());
+  for (size_t plane = 0; plane < sizeof(uint32_t); plane++) {
+    const unsigned char* plane_bytes = bytes.data() + plane * values.size();
+    for (size_t index = 0; index < values.size(); index++) {
+      value_bytes[index * sizeof(uint32_t) + plane] = plane_bytes[index];
+    }
+  }
+}
+
+} // namespace
+
+TrajectoryWriter::~TrajectoryWriter() {
+  Close();
+}
+
+bool TrajectoryWriter::Open(const string& path, const GasContainer& container,
+                            size_t frame_interval, size_t queue_capacity) {
+  Close();
+  file_ = std::fopen(path.c_str(), "wb");
+  if (file_ == nullptr) {
+    return false;
+  }
+
+  //describe every group once
+  const vector<ParticleGroup*>& groups = container.GetParticleGroups();
+  vector<TrajectoryGroup> group_records;
+  particle_count_ = 0;
+  for (size_t group_index = 0; group_index < groups.size(); group_index++) {
+    if (FindFirstListing(groups, group_index) < group_index) {
+      continue;
+    }
+    ParticleGroup* group = groups.at(group_index);
+    group_records.push_back(TrajectoryGroup{group->GetGroupSize(),
+                                            group->GetParticleMass(),
+                                            group->GetParticleRadius()});
+    particle_count_ += group->GetGroupSize();
+  }
+
+  frame_interval_ = std::max<size_t>(1, frame_interval);
+  TrajectoryHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kTrajectoryMagic, sizeof(header.magic));
+  header.version = kTrajectoryVersion;
+  header.byte_order = kTrajectoryByteOrder;
+  header.group_count = group_records.size();
+  header.particle_count = particle_count_;
+  header.frame_interval = frame_interval_;
+  header.frames_per_chunk = kFramesPerChunk;
+  write_failed_ = std::fwrite(&header, sizeof(header), 1, file_) != 1;
+  if (!group_records.empty() &&
+      std::fwrite(group_records.data(), sizeof(TrajectoryGroup),
+                  group_records.size(), file_) != group_records.size()) {
+    write_failed_ = true;
+  }
+
+  //all frame memory is set aside up front
+  frame_slots_.assign(std::max<size_t>(1, queue_capacity),
+                      vector<float>(4 * particle_count_));
+  slot_steps_.assign(frame_slots_.size(), 0);
+  first_full_slot_ = 0;
+  full_slot_count_ = 0;
+  dropped_frames_ = 0;
+  closing_ = false;
+  previous_frame_.assign(4 * particle_count_, 0);
+  chunk_values_.clear();
+  chunk_values_.reserve(kFramesPerChunk * 4 * particle_count_);
+  chunk_frame_count_ = 0;
+  frame_index_.clear();
+
+  write_thread_ = std::thread(&TrajectoryWriter::RunWriter, this);
+  return true;
+}
+
+void TrajectoryWriter::RecordStep(const GasContainer& container,
+                                  uint64_t step) {
+  if (file_ == nullptr || step % frame_interval_ != 0) {
+    return;
+  }
+
+  size_t slot;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (full_slot_count_ == frame_slots_.size()) {
+      dropped_frames_++;
+      return;
+    }
+    slot = (first_full_slot_ + full_slot_count_) % frame_slots_.size();
+  }
+
+  //the write thread doesn't touch a slot until it's marked as full
+  float* frame = frame_slots_[slot].data();
+  const vector<ParticleGroup*>& groups = container.GetParticleGroups();
+  size_t offset = 0;
+  for (size_t group_index = 0; group_index < groups.size(); group_index++) {
+    ParticleGroup* group = groups.at(group_index);
+    if (FindFirstListing(groups, group_index) < group_index ||
+        offset + group->GetGroupSize() > particle_count_) {
+      continue;
+    }
+    size_t group_size = group->GetGroupSize();
+    const vector<uint32_t>& ids = container.GetParticleIds(group_index);
+    if (ids.size() != group_size) {
+      group->CopyParticleArrays(frame + offset,
+                                frame + particle_count_ + offset,
+                                frame + 2 * particle_count_ + offset,
+                                frame + 3 * particle_count_ + offset);
+    } else {
+      //put every particle back at its id, where earlier frames have it
+      group_values_.resize(4 * group_size);
+      float* values = group_values_.data();
+      group->CopyParticleArrays(values, values + group_size,
+                                values + 2 * group_size,
+                                values + 3 * group_size);
+      for (size_t column = 0; column < 4; column++) {
+        float* frame_column = frame + column * particle_count_ + offset;
+        const float* value_column = values + column * group_size;
+        for (size_t index = 0; index < group_size; index++) {
+          frame_column[ids[index]] = value_column[index];
+        }
+      }
+    }
+    offset += group_size;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slot_steps_[slot] = step;
+    full_slot_count_++;
+  }
+  frame_ready_.notify_one();
+}
+
+bool TrajectoryWriter::Close() {
+  if (file_ == nullptr) {
+    return !write_failed_;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closing_ = true;
+  }
+  frame_ready_.notify_one();
+  write_thread_.join();
+
+  WriteChunk();
+  TrajectoryFooter footer;
+  std::memset(&footer, 0, sizeof(footer));
+  footer.index_offset = (uint64_t) std::ftell(file_);
+  footer.frame_count = frame_index_.size();
+  std::memcpy(footer.magic, kTrajectoryMagic, sizeof(footer.magic));
+  if (!frame_index_.empty() &&
+      std::fwrite(frame_index_.data(), sizeof(TrajectoryFrameEntry),
+                  frame_index_.size(), file_) != frame_index_.size()) {
+    write_failed_ = true;
+  }
+  if (std::fwrite(&footer, sizeof(footer), 1, file_) != 1) {
+    write_failed_ = true;
+  }
+  if (std::fclose(file_) != 0) {
+    write_failed_ = true;
+  }
+  file_ = nullptr;
+  return !write_failed_;
+}
+
+size_t TrajectoryWriter::GetDroppedFrameCount() const {
+  return dropped_frames_;
+}
+
+void TrajectoryWriter::RunWriter() {
+  while (true) {
+    size_t slot;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      frame_ready_.wait(lock, [this] {
+        return full_slot_count_ > 0 || closing_;
+      });
+      if (full_slot_count_ == 0) {
+        return; //closing and every frame is written
+      }
+      slot = first_full_slot_;
+    }
+
+    EncodeFrame(frame_slots_[slot], slot_steps_[slot]);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    first_full_slot_ = (first_full_slot_ + 1) % frame_slots_.size();
+    full_slot_count_--;
+  }
+}
+
+void TrajectoryWriter::EncodeFrame(const vector<float>& frame, uint64_t step) {
+  frame_index_.push_back(TrajectoryFrameEntry{step, 0, chunk_frame_count_});
+
+  //first frame of a chunk is kept as is, others as differences
+  const uint32_t* frame_bits = reinterpret_cast<const uint32_t*>(frame.data());
+  for (size_t index = 0; index < frame.size(); index++) {
+    uint32_t bits = frame_bits[index];
+    chunk_values_.push_back(chunk_frame_count_ == 0 ? bits :
+                            bits - previous_frame_[index]);
+    previous_frame_[index] = bits;
+  }
+
+  chunk_frame_count_++;
+  if (chunk_frame_count_ == kFramesPerChunk) {
+    WriteChunk();
+  }
+}
+
+void TrajectoryWriter::WriteChunk() {
+  if (chunk_frame_count_ == 0) {
+    return;
+  }
+
+  uint64_t chunk_offset = (uint64_t) std::ftell(file_);
+  for (size_t frame = frame_index_.size() - chunk_frame_count_;
+       frame < frame_index_.size(); frame++) {
+    frame_index_[frame].chunk_offset = chunk_offset;
+  }
+
+  ShuffleBytes(chunk_values_, shuffled_bytes_);
+  lzcodec::Compress(shuffled_bytes_.data(), shuffled_bytes_.size(),
+                    compressed_bytes_);
+  TrajectoryChunk chunk{compressed_bytes_.size(), chunk_frame_count_};
+  if (std::fwrite(&chunk, sizeof(chunk), 1, file_) != 1 ||
+      std::fwrite(compressed_bytes_.data(), 1, compressed_bytes_.size(),
+                  file_) != compressed_bytes_.size()) {
+    write_failed_ = true;
+  }
+
+  chunk_values_.clear();
+  chunk_frame_count_ = 0;
+}
+
+TrajectoryReader::~TrajectoryReader() {
+  if (file_ != nullptr) {
+    std::fclose(file_);
+  }
+}
+
+bool TrajectoryReader::Open(const string& path) {
+  if (file_ != nullptr) {
+    std::fclose(file_);
+  }
+  groups_.clear();
+  frame_index_.clear();
+  chunk_values_.clear();
+  cached_chunk_offset_ = 0;
+  file_size_ = 0;
+
+  file_ = std::fopen(path.c_str(), "rb");
+  if (file_ == nullptr) {
+    return false;
+  }
+
+  if (std::fseek(file_, 0, SEEK_END) != 0) {
+    return false;
+  }
+  long file_size = std::ftell(file_);
+  if (file_size < 0 || std::fseek(file_, 0, SEEK_SET) != 0) {
+    return false;
+  }
+  file_size_ = (uint64_t) file_size;
+
+  if (std::fread(&header_, sizeof(header_), 1, file_) != 1 ||
+      std::memcmp(header_.magic, kTrajectoryMagic, sizeof(header_.magic)) != 0 ||
+      header_.version != kTrajectoryVersion ||
+      header_.byte_order != kTrajectoryByteOrder) {
+    return false;
+  }
+
+  //sizes come from the file, so check them before allocating anything
+  uint64_t max_frame_values = SIZE_MAX / (4 * sizeof(uint32_t));
+  if (header_.group_count > (file_size_ - sizeof(header_)) /
+                            sizeof(TrajectoryGroup) ||
+      header_.frames_per_chunk == 0 ||
+      header_.particle_count > max_frame_values / header_.frames_per_chunk) {
+    return false;
+  }
+  groups_.resize(header_.group_count);
+  if (!groups_.empty() &&
+      std::fread(groups_.data(), sizeof(TrajectoryGroup), groups_.size(),
+                 file_) != groups_.size()) {
+    return false;
+  }
+
+  //footer at the end points to the frame index
+  TrajectoryFooter footer;
+  if (file_size_ < sizeof(header_) + sizeof(footer) ||
+      std::fseek(file_, -(long) sizeof(footer), SEEK_END) != 0 ||
+      std::fread(&footer, sizeof(footer), 1, file_) != 1 ||
+      std::memcmp(footer.magic, kTrajectoryMagic, sizeof(footer.magic)) != 0) {
+    return false;
+  }
+
+  //the frame index must lie completely between the chunks and the footer
+  uint64_t index_space = file_size_ - sizeof(footer);
+  if (footer.index_offset > index_space ||
+      footer.frame_count > (index_space - footer.index_offset) /
+                           sizeof(TrajectoryFrameEntry) ||
+      std::fseek(file_, (long) footer.index_offset, SEEK_SET) != 0) {
+    return false;
+  }
+  frame_index_.resize(footer.frame_count);
+  return frame_index_.empty() ||
+         std::fread(frame_index_.data(), sizeof(TrajectoryFrameEntry),
+                    frame_index_.size(), file_) == frame_index_.size();
+}
+
+const TrajectoryHeader& TrajectoryReader::GetHeader() const {
+  return header_;
+}
+
+const TrajectoryGroup& TrajectoryReader::GetGroup(size_t index) const {
+  return groups_.at(index);
+}
+
+size_t TrajectoryReader::GetFrameCount() const {
+  return frame_index_.size();
+}
+
+uint64_t TrajectoryReader::GetFrameStep(size_t frame) const {
+  return frame_index_.at(frame).step;
+}
+
+bool TrajectoryReader::ReadFrame(size_t frame, vector<float>& x_positions,
+                                 vector<float>& y_positions,
+                                 vector<float>& x_velocities,
+                                 vector<float>& y_velocities) {
+  if (file_ == nullptr || frame >= frame_index_.size()) {
+    return false;
+  }
+  const TrajectoryFrameEntry& entry = frame_index_[frame];
+  if ((chunk_values_.empty() || entry.chunk_offset != cached_chunk_offset_) &&
+      !LoadChunk(entry.chunk_offset)) {
+    return false;
+  }
+
+  size_t particle_count = header_.particle_count;
+  size_t frame_start = entry.frame_in_chunk * 4 * particle_count;
+  if (frame_start + 4 * particle_count > chunk_values_.size()) {
+    return false;
+  }
+  const float* values =
+      reinterpret_cast<const float*>(chunk_values_.data() + frame_start);
+  x_positions.assign(values, values + particle_count);
+  y_positions.assign(values + particle_count, values + 2 * particle_count);
+  x_velocities.assign(values + 2 * particle_count,
+                      values + 3 * particle_count);
+  y_velocities.assign(values + 3 * particle_count,
+                      values + 4 * particle_count);
+  return true;
+}
+
+bool TrajectoryReader::LoadChunk(uint64_t chunk_offset) {
+  chunk_values_.clear();
+  TrajectoryChunk chunk;
+  if (chunk_offset > file_size_ ||
+      file_size_ - chunk_offset < sizeof(chunk) ||
+      std::fseek(file_, (long) chunk_offset, SEEK_SET) != 0 ||
+      std::fread(&chunk, sizeof(chunk), 1, file_) != 1 ||
+      chunk.frame_count > header_.frames_per_chunk ||
+      chunk.compressed_size > file_size_ - chunk_offset - sizeof(chunk)) {
+    return false;
+  }
+  compressed_bytes_.resize(chunk.compressed_size);
+  if (std::fread(compressed_bytes_.data(), 1, compressed_bytes_.size(),
+                 file_) != compressed_bytes_.size()) {
+    return false;
+  }
+
+  size_t frame_size = 4 * header_.particle_count;
+  shuffled_bytes_.resize(chunk.frame_count * frame_size * sizeof(uint32_t));
+  if (!lzcodec::Decompress(compressed_bytes_.data(), compressed_bytes_.size(),
+                           shuffled_bytes_.data(), shuffled_bytes_.size())) {
+    return false;
+  }
+  UnshuffleBytes(shuffled_bytes_, chunk_values_);
+
+  //add up differences so every frame holds its own values
+  for (size_t index = frame_size; index < chunk_values_.size(); index++) {
+    chunk_values_[index] += chunk_values_[index - frame_size];
+  }
+  cached_chunk_offset_ = chunk_offset;
+  return true;
+}
+
+} // namespace idealgas
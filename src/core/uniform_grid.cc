@@ -0,0 +1,106 @@
+#include "core/uniform_grid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace idealgas {
+
+void UniformGrid::Rebuild(const vector<Particle>& particles,
+                          const vector<size_t>& particle_list, double width,
+                          double height, double cell_size, bool wraps) {
+  wraps_ = wraps;
+  if (wraps) {
+    //cells on opposite edges touch, so none may be smaller than cell_size
+    column_count_ = std::max<size_t>(1, (size_t) (width / cell_size));
+    row_count_ = std::max<size_t>(1, (size_t) (height / cell_size));
+    cell_width_ = width / column_count_;
+    cell_height_ = height / row_count_;
+  } else {
+    column_count_ = std::max<size_t>(1, (size_t) std::ceil(width / cell_size));
+    row_count_ = std::max<size_t>(1, (size_t) std::ceil(height / cell_size));
+    cell_width_ = cell_size;
+    cell_height_ = cell_size;
+  }
+
+  //find cell of every particle and count particles per cell
+  particle_cells_.resize(particle_list.size());
+  cell_starts_.assign(column_count_ * row_count_ + 1, 0);
+  for (size_t index = 0; index < particle_list.size(); index++) {
+    const Particle& particle = particles[particle_list[index]];
+    size_t column = FindCellCoordinate(particle.position.x, cell_width_,
+                                       column_count_);
+    size_t row = FindCellCoordinate(particle.position.y, cell_height_,
+                                    row_count_);
+    particle_cells_.at(index) = row * column_count_ + column;
+    cell_starts_.at(particle_cells_.at(index) + 1)++;
+  }
+
+  //turn counts into starting offsets, then fill cells in index order
+  for (size_t cell = 1; cell < cell_starts_.size(); cell++) {
+    cell_starts_.at(cell) += cell_starts_.at(cell - 1);
+  }
+  next_slots_.assign(cell_starts_.begin(), cell_starts_.end() - 1);
+  cell_particles_.resize(particle_list.size());
+  for (size_t index = 0; index < particle_list.size(); index++) {
+    cell_particles_.at(next_slots_.at(particle_cells_.at(index))++) = index;
+  }
+}
+
+void UniformGrid::ListEarlierNeighbors(size_t index,
+                                       vector<size_t>& neighbors) const {
+  neighbors.clear();
+  size_t column = particle_cells_.at(index) % column_count_;
+  size_t row = particle_cells_.at(index) / column_count_;
+
+  size_t rows[3];
+  size_t columns[3];
+  size_t neighbor_row_count = FindNeighborCells(row, row_count_, wraps_,
+                                                rows);
+  size_t neighbor_column_count = FindNeighborCells(column, column_count_,
+                                                   wraps_, columns);
+
+  for (size_t row_slot = 0; row_slot < neighbor_row_count; row_slot++) {
+    for (size_t column_slot = 0; column_slot < neighbor_column_count;
+         column_slot++) {
+      size_t cell = rows[row_slot] * column_count_ + columns[column_slot];
+      //particles in a cell are in increasing order, so stop at index
+      for (size_t slot = cell_starts_.at(cell);
+           slot < cell_starts_.at(cell + 1) && cell_particles_.at(slot) < index;
+           slot++) {
+        neighbors.push_back(cell_particles_.at(slot));
+      }
+    }
+  }
+  std::sort(neighbors.begin(), neighbors.end());
+}
+
+size_t UniformGrid::FindNeighborCells(size_t cell, size_t cell_count,
+                                      bool wraps, size_t neighbor_cells[3]) {
+  //w/ fewer than 3 cells, wrapping around would list a cell twice
+  bool wraps_around = wraps && cell_count > 2;
+  size_t neighbor_count = 0;
+  if (cell > 0) {
+    neighbor_cells[neighbor_count++] = cell - 1;
+  } else if (wraps_around) {
+    neighbor_cells[neighbor_count++] = cell_count - 1;
+  }
+  neighbor_cells[neighbor_count++] = cell;
+  if (cell + 1 < cell_count) {
+    neighbor_cells[neighbor_count++] = cell + 1;
+  } else if (wraps_around) {
+    neighbor_cells[neighbor_count++] = 0;
+  }
+  return neighbor_count;
+}
+
+size_t UniformGrid::FindCellCoordinate(double coordinate, double cell_length,
+                                       size_t cell_count) {
+  double cell = std::floor(coordinate / cell_length);
+  if (!(cell > 0)) {
+    return 0;
+  } else if (cell >= cell_count - 1) {
+    return cell_count - 1;
+  }
+  return (size_t) cell;
+}
+
+} // namespace idealgas
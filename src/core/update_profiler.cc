@@ -0,0 +1,125 @@
+#include "core/update_profiler.h"
+
+namespace idealgas {
+
+UpdateProfiler::UpdateProfiler() {
+  Reset();
+}
+
+void UpdateProfiler::AddPhaseTime(UpdatePhase phase, double seconds) {
+  phase_seconds_[(size_t) phase] += seconds;
+}
+
+void UpdateProfiler::AddCount(UpdateCounter counter, size_t amount) {
+  counts_[(size_t) counter] += amount;
+}
+
+void UpdateProfiler::FinishUpdate() {
+  update_count_++;
+}
+
+void UpdateProfiler::Reset() {
+  for (size_t phase = 0; phase < kPhaseCount; phase++) {
+    phase_seconds_[phase] = 0;
+  }
+  for (size_t counter = 0; counter < kCounterCount; counter++) {
+    counts_[counter] = 0;
+  }
+  update_count_ = 0;
+}
+
+double UpdateProfiler::GetPhaseSeconds(UpdatePhase phase) const {
+  return phase_seconds_[(size_t) phase];
+}
+
+size_t UpdateProfiler::GetCount(UpdateCounter counter) const {
+  return counts_[(size_t) counter];
+}
+
+size_t UpdateProfiler::GetUpdateCount() const {
+  return update_count_;
+}
+
+void UpdateProfiler::WriteCsvHeader(std::FILE* file) {
+  std::fprintf(file, "step,updates");
+  for (size_t phase = 0; phase < kPhaseCount; phase++) {
+    std::fprintf(file, ",%s_seconds", GetPhaseName((UpdatePhase) phase));
+  }
+  for (size_t counter = 0; counter < kCounterCount; counter++) {
+    std::fprintf(file, ",%s", GetCounterName((UpdateCounter) counter));
+  }
+  std::fprintf(file, "\n");
+}
+
+void UpdateProfiler::WriteCsvRow(std::FILE* file, size_t step) const {
+  std::fprintf(file, "%zu,%zu", step, update_count_);
+  for (size_t phase = 0; phase < kPhaseCount; phase++) {
+    std::fprintf(file, ",%.9f", phase_seconds_[phase]);
+  }
+  for (size_t counter = 0; counter < kCounterCount; counter++) {
+    std::fprintf(file, ",%zu", counts_[counter]);
+  }
+  std::fprintf(file, "\n");
+}
+
+void UpdateProfiler::WriteJsonLine(std::FILE* file, size_t step) const {
+  std::fprintf(file, "{\"step\":%zu,\"updates\":%zu", step, update_count_);
+  for (size_t phase = 0; phase < kPhaseCount; phase++) {
+    std::fprintf(file, ",\"%s_seconds\":%.9f",
+                 GetPhaseName((UpdatePhase) phase), phase_seconds_[phase]);
+  }
+  for (size_t counter = 0; counter < kCounterCount; counter++) {
+    std::fprintf(file, ",\"%s\":%zu", GetCounterName((UpdateCounter) counter),
+                 counts_[counter]);
+  }
+  std::fprintf(file, "}\n");
+}
+
+const char* UpdateProfiler::GetPhaseName(UpdatePhase phase) {
+  switch (phase) {
+    case UpdatePhase::kParticleCopy:
+      return "particle_copy";
+    case UpdatePhase::kPairDetection:
+      return "pair_detection";
+    case UpdatePhase::kCollisionResponse:
+      return "collision_response";
+    case UpdatePhase::kWallsAndIntegration:
+      return "walls_and_integration";
+    case UpdatePhase::kEventStepping:
+      return "event_stepping";
+    case UpdatePhase::kParticleSorting:
+      return "particle_sorting";
+    case UpdatePhase::kHistograms:
+      return "histograms";
+    case UpdatePhase::kDrawing:
+      return "drawing";
+    default:
+      return "unknown";
+  }
+}
+
+const char* UpdateProfiler::GetCounterName(UpdateCounter counter) {
+  switch (counter) {
+    case UpdateCounter::kPairsTested:
+      return "pairs_tested";
+    case UpdateCounter::kCollisionsResolved:
+      return "collisions_resolved";
+    case UpdateCounter::kParticlesProcessed:
+      return "particles_processed";
+    default:
+      return "unknown";
+  }
+}
+
+ScopedPhaseTimer::ScopedPhaseTimer(UpdateProfiler& profiler, UpdatePhase phase)
+    : profiler_(profiler), phase_(phase),
+      start_time_(std::chrono::steady_clock::now()) {
+}
+
+ScopedPhaseTimer::~ScopedPhaseTimer() {
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start_time_;
+  profiler_.AddPhaseTime(phase_, elapsed.count());
+}
+
+} // namespace idealgas
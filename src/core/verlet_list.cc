@@ -0,0 +1,100 @@
+#include "core/verlet_list.h"
+#include "core/particle_utils.h"
+
+namespace idealgas {
+
+using idealgas::particleutils::FindWrappedOffset;
+
+namespace {
+
+//extra distance pairs are listed within, so float rounding in the contact
+//test can never find a touching pair that wasn't listed
+const double kRoundingMargin = 0.01;
+
+} // namespace
+
+bool VerletList::NeedsRebuild(const vector<Particle>& particles,
+                              const vector<size_t>& particle_list,
+                              double skin) const {
+  if (!is_built_ || skin != skin_ ||
+      particle_list.size() != x_build_positions_.size()) {
+    return true;
+  }
+
+  //compare squared distances, so no square roots are needed
+  double max_displacement = 0.5 * skin_;
+  double max_squared_displacement = max_displacement * max_displacement;
+  for (size_t index = 0; index < particle_list.size(); index++) {
+    const Particle& particle = particles[particle_list[index]];
+    //particles wrapping around jump across the container, but barely move
+    vec2 displacement = FindWrappedOffset(
+        particle.position,
+        vec2(x_build_positions_[index], y_build_positions_[index]), period_);
+    if ((double) displacement.x * displacement.x +
+        (double) displacement.y * displacement.y > max_squared_displacement) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void VerletList::Rebuild(const vector<Particle>& particles,
+                         const vector<size_t>& particle_list, double width,
+                         double height, double max_radius, double skin,
+                         bool wraps) {
+  skin_ = skin;
+  period_ = wraps ? vec2(width, height) : vec2(0, 0);
+  is_built_ = true;
+  rebuild_count_++;
+
+  x_build_positions_.resize(particle_list.size());
+  y_build_positions_.resize(particle_list.size());
+  for (size_t index = 0; index < particle_list.size(); index++) {
+    const Particle& particle = particles[particle_list[index]];
+    x_build_positions_[index] = particle.position.x;
+    y_build_positions_[index] = particle.position.y;
+  }
+
+  //every listed pair is closer than a grid cell, so neighboring cells
+  //still hold every pair
+  grid_.Rebuild(particles, particle_list, width, height,
+                particleutils::FindContactDistance(max_radius) + skin, wraps);
+
+  neighbor_starts_.resize(particle_list.size() + 1);
+  neighbors_.clear();
+  for (size_t index = 0; index < particle_list.size(); index++) {
+    neighbor_starts_[index] = neighbors_.size();
+    const Particle& particle = particles[particle_list[index]];
+    grid_.ListEarlierNeighbors(index, grid_neighbors_);
+    for (size_t other_index: grid_neighbors_) {
+      const Particle& other_particle = particles[particle_list[other_index]];
+      double list_distance = particle.radius + other_particle.radius + skin +
+                             kRoundingMargin;
+      vec2 offset = FindWrappedOffset(particle.position,
+                                      other_particle.position, period_);
+      if ((double) offset.x * offset.x + (double) offset.y * offset.y <=
+          list_distance * list_distance) {
+        neighbors_.push_back(other_index);
+      }
+    }
+  }
+  neighbor_starts_[particle_list.size()] = neighbors_.size();
+}
+
+void VerletList::Clear() {
+  is_built_ = false;
+}
+
+size_t VerletList::GetNeighborStart(size_t index) const {
+  return neighbor_starts_[index];
+}
+
+const vector<size_t>& VerletList::GetNeighbors() const {
+  return neighbors_;
+}
+
+size_t VerletList::GetRebuildCount() const {
+  return rebuild_count_;
+}
+
+} // namespace idealgas
@@ -0,0 +1,84 @@
+#include "core/worker_pool.h"
+
+namespace idealgas {
+
+WorkerPool::WorkerPool(size_t thread_count) : next_task_(0) {
+  for (size_t index = 1; index < thread_count; index++) {
+    workers_.push_back(std::thread(&WorkerPool::RunWorker, this));
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_ready_.notify_all();
+  for (std::thread& worker: workers_) {
+    worker.join();
+  }
+}
+
+void WorkerPool::ParallelFor(size_t task_count,
+                             const std::function<void(size_t)>& task) {
+  if (workers_.empty() || task_count <= 1) {
+    for (size_t task_number = 0; task_number < task_count; task_number++) {
+      task(task_number);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    task_count_ = task_count;
+    next_task_ = 0;
+    busy_workers_ = workers_.size();
+    batch_number_++;
+  }
+  work_ready_.notify_all();
+
+  RunAvailableTasks();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this] { return busy_workers_ == 0; });
+  task_ = nullptr;
+}
+
+size_t WorkerPool::GetThreadCount() const {
+  return workers_.size() + 1;
+}
+
+void WorkerPool::RunWorker() {
+  size_t finished_batch = 0;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_ready_.wait(lock, [this, finished_batch] {
+        return stopping_ || batch_number_ != finished_batch;
+      });
+      if (stopping_) {
+        return;
+      }
+      finished_batch = batch_number_;
+    }
+
+    RunAvailableTasks();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      busy_workers_--;
+    }
+    work_done_.notify_one();
+  }
+}
+
+void WorkerPool::RunAvailableTasks() {
+  for (size_t task_number = next_task_++; task_number < task_count_;
+       task_number = next_task_++) {
+    (*task_)(task_number);
+  }
+}
+
+} // namespace idealgas
@@ -0,0 +1,67 @@
+#include "visualizer/histogram_display.h"
+
+namespace idealgas {
+
+namespace visualizer {
+
+HistogramDisplay::HistogramDisplay(const vec2& top_left,
+                                   const vec2& bottom_right, size_t width,
+                                   size_t height, size_t margins,
+                                   size_t y_interval_size) {
+  top_left_ = top_left;
+  bottom_right_ = bottom_right;
+  display_margin_ = margins;
+  histogram_width_ = width;
+  histogram_height_ = height;
+  y_interval_pixels_ = y_interval_size;
+}
+
+void HistogramDisplay::DrawHistogram(const IdealGasHistogram& histogram,
+                                     const ci::Color& color) const {
+  DrawHistogramBox();
+  vec2 bottom_left = top_left_ + vec2(0,histogram_height_);
+  ci::gl::color(color);
+  DrawHistogramBars(histogram, bottom_left);
+}
+
+void HistogramDisplay::DrawHistogramBox() const {
+  //draw box
+  ci::Rectf histogram_box(top_left_, bottom_right_);
+  ci::gl::color(ci::Color("white"));
+  ci::gl::drawStrokedRect(histogram_box);
+
+  //draw horizontal axis label
+  ci::gl::drawStringCentered("Speed", vec2(bottom_right_.x-(histogram_width_/2),
+                                           bottom_right_.y+display_margin_/10));
+  //draw vertical axis label
+  //method to rotate text from: https://discourse.libcinder.org/t/what-is-the-best-way-to-rotate-rectangles-images/410/2
+  ci::gl::pushModelMatrix();
+  ci::gl::translate(top_left_.x - display_margin_ / 10,
+                    top_left_.y + histogram_height_ / 2);
+  ci::gl::rotate(3 * M_PI / 2);
+  ci::gl::drawStringCentered("Particle Count", vec2(0,0));
+  ci::gl::popModelMatrix();
+}
+
+void HistogramDisplay::DrawHistogramBars(const IdealGasHistogram& histogram,
+                                         vec2 bottom_left) const {
+  //draw bars based on particle count for each bucket
+  int pixel_bucket_size = histogram_width_ / histogram.GetBucketCount();
+  vec2 current_top_left = vec2(bottom_left.x - pixel_bucket_size, bottom_left.y);
+
+  for (size_t bucket = 0; bucket < histogram.GetBucketCount(); bucket++) {
+    int bar_height = histogram.GetNumberParticlesAt(bucket) * y_interval_pixels_;
+
+    current_top_left = vec2(current_top_left.x + pixel_bucket_size,
+                            bottom_left.y - bar_height);
+    vec2 bottom_right = vec2(current_top_left.x + pixel_bucket_size,
+                             bottom_left.y);
+
+    ci::Rectf bar_box(current_top_left, bottom_right);
+    ci::gl::drawSolidRect(bar_box);
+  }
+}
+
+} // namespace visualizer
+
+} // namespace idealgas
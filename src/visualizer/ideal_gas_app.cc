@@ -26,23 +26,24 @@ IdealGasApp::IdealGasApp() {
   particle_information.insert(std::pair<Particle, size_t>(arbitrary_big_particle,
                                                           kBigParticlesCount));
   //initialize simulator and set up display window
-  simulator_ = IdealGasSimulator(vec2(kMargin, kMargin),
-                                 particle_information, kContainerWidth,
-                                 kContainerHeight, kHistogramWidth,
-                                 kHistogramHeight, kMargin, kNumBuckets,
-                                 kYIntervalPixels);
+  simulator_.reset(new IdealGasSimulator(vec2(kMargin, kMargin),
+                                         particle_information, kContainerWidth,
+                                         kContainerHeight, kHistogramWidth,
+                                         kHistogramHeight, kMargin, kNumBuckets,
+                                         kYIntervalPixels));
+  simulator_->StartStepping(kStepsPerSecond);
   ci::app::setWindowSize((int) kWindowSize, (int) kWindowSize);
 };
 
 void IdealGasApp::update() {
-  simulator_.Update();
+  simulator_->Update();
 }
 
 void IdealGasApp::draw() {
   ci::Color8u background_color(0,0,0); //black
   ci::gl::clear(background_color);
 
-  simulator_.Draw();
+  simulator_->Draw();
 }
 
 } // namespace visualizer
@@ -1,19 +1,17 @@
 #include "visualizer/ideal_gas_simulator.h"
 #include "cinder/gl/gl.h"
-#include "core/particle_utils.h"
 #include "core/ideal_gas_histogram.h"
+#include "core/update_profiler.h"
+#include "visualizer/histogram_display.h"
 #include <math.h>
+#include <stdexcept>
 
 namespace idealgas {
 
 namespace visualizer {
 
 using glm::vec2;
-using glm::length;
-using glm::dot;
 
-using idealgas::particleutils::ParticleCollisionExists;
-using idealgas::particleutils::HandleParticleCollision;
 using idealgas::IdealGasHistogram;
 
 IdealGasSimulator::IdealGasSimulator(const vec2 &top_left_corner,
@@ -21,7 +19,10 @@ IdealGasSimulator::IdealGasSimulator(const vec2 &top_left_corner,
                                      size_t container_width, size_t container_height,
                                      size_t histogram_width, size_t histogram_height,
                                      size_t display_margin, size_t num_buckets,
-                                     size_t y_interval) {
+                                     size_t y_interval) :
+                                     container_(particle_information,
+                                                container_width,
+                                                container_height) {
   top_left_corner_ = top_left_corner;
   container_width_ = container_width;
   container_height_ = container_height;
@@ -30,21 +31,7 @@ IdealGasSimulator::IdealGasSimulator(const vec2 &top_left_corner,
   bucket_count_ = num_buckets;
   y_interval_pixels_ = y_interval;
   display_margin_ = display_margin;
-
-  for (auto const& entry: particle_information) {
-    size_t num_particles = entry.second;
-    size_t mass = entry.first.mass;
-    size_t radius = entry.first.radius;
-    ci::Color color = entry.first.color;
-
-    double max_x_position = (double) container_width - radius * 2;
-    double max_y_position = (double) container_height - radius * 2;
-    double max_velocity = radius * (1.0 / mass); //v is relatively small
-
-    particle_groups_.push_back(new ParticleGroup(num_particles, mass, radius,
-                                                 color, max_x_position,
-                                                 max_y_position, max_velocity));
-  }
+  CreateHistograms();
 }
 
 IdealGasSimulator::IdealGasSimulator(const vec2& top_left_corner,
@@ -52,8 +39,9 @@ IdealGasSimulator::IdealGasSimulator(const vec2& top_left_corner,
                                      size_t container_width, size_t container_height,
                                      size_t histogram_width, size_t histogram_height,
                                      size_t display_margin, size_t num_buckets,
-                                     size_t y_interval) {
-  particle_groups_ = groups;
+                                     size_t y_interval) :
+                                     container_(groups, container_width,
+                                                container_height) {
   top_left_corner_ = top_left_corner;
   container_width_ = container_width;
   container_height_ = container_height;
@@ -62,24 +50,52 @@ IdealGasSimulator::IdealGasSimulator(const vec2& top_left_corner,
   bucket_count_ = num_buckets;
   y_interval_pixels_ = y_interval;
   display_margin_ = display_margin;
+  CreateHistograms();
 }
 
-void IdealGasSimulator::Update() {
-  //update particles/walls colliding
-  for (ParticleGroup* group: particle_groups_) {
-    group->HandlePossibleWallCollisions();
+void IdealGasSimulator::StartStepping(double steps_per_second) {
+  if (runner_) {
+    runner_->SetStepsPerSecond(steps_per_second);
+    return;
+  }
+
+  //display groups have the same types as the container's, and are filled
+  //w/ the runner's first snapshot right away
+  display_groups_.clear();
+  for (ParticleGroup* group: container_.GetParticleGroups()) {
+    display_groups_.push_back(*group);
+  }
+  display_group_list_.clear();
+  for (ParticleGroup& group: display_groups_) {
+    display_group_list_.push_back(&group);
   }
 
-  //update particles colliding
-  HandleAllParticleCollisions();
+  runner_.reset(new SimulationRunner(&container_));
+  runner_->ReadLatest(display_group_list_);
+  CreateHistograms();
+  runner_->Start(steps_per_second);
+}
 
-  //update all particle positions
-  for (ParticleGroup* group: particle_groups_) {
-    group->UpdatePositions();
+void IdealGasSimulator::Update() {
+  if (runner_) {
+    //nothing to do if no steps were taken since the last frame
+    if (!runner_->ReadLatest(display_group_list_)) {
+      return;
+    }
+  } else {
+    container_.Update();
   }
+
+  IDEALGAS_PROFILE_PHASE(frame_profiler_, UpdatePhase::kHistograms);
+  for (IdealGasHistogram& histogram: histograms_) {
+    histogram.Update();
+  }
+  IDEALGAS_PROFILE_FINISH_UPDATE(frame_profiler_);
 }
 
-void IdealGasSimulator::Draw() const {
+void IdealGasSimulator::Draw() {
+  IDEALGAS_PROFILE_PHASE(frame_profiler_, UpdatePhase::kDrawing);
+
   //draw rectangular container for particles
   vec2 pixel_bottom_right = top_left_corner_ +
                             vec2(container_width_, container_height_);
@@ -92,46 +108,40 @@ void IdealGasSimulator::Draw() const {
   DrawHistograms();
 }
 
-void IdealGasSimulator::HandleAllParticleCollisions() {
-  //make list of all particles from all groups
-  vector<Particle*> all_particles = ListAllParticles();
-  //make bool list to keep track of already updated
-  vector<bool> updated_particles(all_particles.size(), false);
+void IdealGasSimulator::ChangeContainer(
+    const std::function<void(GasContainer&)>& change) {
+  if (runner_) {
+    runner_->QueueChange(change);
+  } else {
+    change(container_);
+  }
+}
 
-  //go through particle list and handle collisions between any of them
-  for (size_t index = 0; index < all_particles.size(); index++) {
-    if (updated_particles.at(index)) {
-      continue;
-    }
-    Particle* first_particle = all_particles.at(index);
-    for (size_t other_index = 0; other_index < all_particles.size() &&
-                                 other_index != index; other_index++) {
-      Particle* second_particle = all_particles.at(other_index);
-      if (ParticleCollisionExists(*first_particle, *second_particle)) {
-        Particle& first = *first_particle;
-        Particle& second = *second_particle;
-        Particle temp(first.position, first.velocity, first.mass, first.radius,
-                      first.color);
-
-        HandleParticleCollision(first, second);
-        HandleParticleCollision(second, temp);
-        updated_particles.at(other_index) = true;
-      }
-    }
+const GasContainer& IdealGasSimulator::GetContainer() const {
+  if (runner_) {
+    throw std::logic_error("the container is being stepped on its own "
+                           "thread, change it w/ ChangeContainer");
   }
+  return container_;
 }
 
-void IdealGasSimulator::DrawParticles() const {
-  for (ParticleGroup* group: particle_groups_) {
-    for (size_t index = 0; index < group->GetGroupSize(); index++) {
-      Particle current_particle = *group->GetParticleAt(index);
-      size_t radius = current_particle.radius;
-      vec2 screen_position = current_particle.position + top_left_corner_ +
-                             vec2(radius, radius);
-      ci::gl::color(ci::Color(current_particle.color));
-      ci::gl::drawSolidCircle(screen_position, current_particle.radius);
-    }
+UpdateProfiler& IdealGasSimulator::GetFrameProfiler() {
+  return frame_profiler_;
+}
+
+GasObservables& IdealGasSimulator::GetObservables() {
+  return container_.GetObservables();
+}
+
+const vector<ParticleGroup*>& IdealGasSimulator::GetDrawnGroups() const {
+  if (runner_) {
+    return display_group_list_;
   }
+  return container_.GetParticleGroups();
+}
+
+void IdealGasSimulator::DrawParticles() {
+  particle_renderer_.Draw(GetDrawnGroups(), top_left_corner_);
 }
 
 void IdealGasSimulator::DrawHistograms() const {
@@ -139,31 +149,26 @@ void IdealGasSimulator::DrawHistograms() const {
   vec2 top_left = top_left_corner_ + vec2(container_width_,0) +
                   vec2(display_margin_,0) - vec2(0, histogram_height_ + display_margin_);
 
-  for (ParticleGroup* group: particle_groups_) {
+  const vector<ParticleGroup*>& groups = GetDrawnGroups();
+  for (size_t index = 0; index < groups.size(); index++) {
     top_left = top_left + vec2(0, histogram_height_ + display_margin_);
     bottom_right = top_left + vec2(histogram_width_, histogram_height_);
 
-    IdealGasHistogram* histogram = new IdealGasHistogram(top_left, bottom_right, group,
-                                            histogram_width_, histogram_height_,
-                                            display_margin_, bucket_count_,
-                                            y_interval_pixels_);
-    histogram->DrawHistogram();
+    HistogramDisplay display(top_left, bottom_right, histogram_width_,
+                             histogram_height_, display_margin_,
+                             y_interval_pixels_);
+    display.DrawHistogram(histograms_.at(index),
+                          groups.at(index)->GetGroupColor());
   }
 }
 
-vector<Particle*> IdealGasSimulator::ListAllParticles() const {
-  vector<Particle*> all_particles;
-
-  for (ParticleGroup* group: particle_groups_) {
-    for (size_t index = 0; index < group->GetGroupSize(); index++) {
-      Particle* current_particle = group->GetParticleAt(index);
-      all_particles.push_back(current_particle);
-    }
+void IdealGasSimulator::CreateHistograms() {
+  histograms_.clear();
+  for (ParticleGroup* group: GetDrawnGroups()) {
+    histograms_.push_back(IdealGasHistogram(group, bucket_count_));
   }
-
-  return all_particles;
 }
 
 } // namespace visualizer
 
-} // namespace idealgas
\ No newline at end of file
+} // namespace idealgas
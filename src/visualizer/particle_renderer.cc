@@ -0,0 +1,121 @@
+#include "visualizer/particle_renderer.h"
+#include <algorithm>
+
+namespace idealgas {
+
+namespace visualizer {
+
+using idealgas::InstanceBatch;
+
+namespace {
+
+//scales a unit circle by the group radius and moves it to its instance
+const char* kVertexShader = R"(
+#version 150
+uniform mat4 ciModelViewProjection;
+uniform float uRadius;
+in vec4 ciPosition;
+in vec2 aInstanceCenter;
+void main() {
+  vec2 position = ciPosition.xy * uRadius + aInstanceCenter;
+  gl_Position = ciModelViewProjection * vec4(position, 0.0, 1.0);
+}
+)";
+
+const char* kFragmentShader = R"(
+#version 150
+uniform vec4 uColor;
+out vec4 oColor;
+void main() {
+  oColor = uColor;
+}
+)";
+
+} // namespace
+
+void ParticleRenderer::Draw(const vector<ParticleGroup*>& groups,
+                            const vec2& top_left_corner) {
+  if (!shader_) {
+    CreateShader();
+  }
+
+  bool layout_changed = packer_.UpdateBatches(groups);
+  size_t instance_count = packer_.GetInstanceCount();
+  if (instance_count == 0) {
+    return;
+  }
+  if (ReserveInstances(instance_count) || layout_changed) {
+    CreateBatches();
+  }
+
+  //invalidating lets the driver hand out fresh memory instead of waiting
+  //for last frame's draws to finish reading the buffer
+  size_t byte_count = instance_count *
+                      ParticleInstancePacker::kFloatsPerInstance *
+                      sizeof(float);
+  float* instances = static_cast<float*>(instance_buffer_->mapBufferRange(
+      0, byte_count, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  if (instances == nullptr) {
+    return;
+  }
+  packer_.Pack(groups, top_left_corner, instances);
+  instance_buffer_->unmap();
+
+  const vector<InstanceBatch>& batches = packer_.GetBatches();
+  for (size_t group = 0; group < batches.size(); group++) {
+    if (batches[group].instance_count == 0) {
+      continue;
+    }
+    shader_->uniform("uColor", ci::ColorA(batches[group].color));
+    shader_->uniform("uRadius", batches[group].radius);
+    group_batches_[group]->drawInstanced(
+        (GLsizei) batches[group].instance_count);
+  }
+}
+
+void ParticleRenderer::CreateShader() {
+  shader_ = ci::gl::GlslProg::create(ci::gl::GlslProg::Format()
+                                         .vertex(kVertexShader)
+                                         .fragment(kFragmentShader));
+}
+
+bool ParticleRenderer::ReserveInstances(size_t instance_count) {
+  if (instance_buffer_ && instance_count <= instance_capacity_) {
+    return false;
+  }
+
+  //grow by doubling, so adding particles rarely replaces the buffer
+  instance_capacity_ = std::max(instance_count, 2 * instance_capacity_);
+  instance_buffer_ = ci::gl::Vbo::create(
+      GL_ARRAY_BUFFER,
+      instance_capacity_ * ParticleInstancePacker::kFloatsPerInstance *
+          sizeof(float),
+      nullptr, GL_STREAM_DRAW);
+  return true;
+}
+
+void ParticleRenderer::CreateBatches() {
+  const vector<InstanceBatch>& batches = packer_.GetBatches();
+  group_batches_.clear();
+  for (const InstanceBatch& batch: batches) {
+    //every group reads the instance buffer starting at its first instance,
+    //advancing once per instance instead of once per vertex
+    ci::geom::BufferLayout instance_layout;
+    instance_layout.append(
+        ci::geom::Attrib::CUSTOM_0,
+        (uint8_t) ParticleInstancePacker::kFloatsPerInstance, 0,
+        batch.first_instance * ParticleInstancePacker::kFloatsPerInstance *
+            sizeof(float),
+        1);
+
+    ci::gl::VboMeshRef circle = ci::gl::VboMesh::create(
+        ci::geom::Circle().radius(1).subdivisions(kCircleSegments));
+    circle->appendVbo(instance_layout, instance_buffer_);
+    group_batches_.push_back(ci::gl::Batch::create(
+        circle, shader_, {{ci::geom::Attrib::CUSTOM_0, "aInstanceCenter"}}));
+  }
+}
+
+} // namespace visualizer
+
+} // namespace idealgas
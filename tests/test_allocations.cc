@@ -0,0 +1,97 @@
+#include <catch2/catch.hpp>
+#include "core/gas_container.h"
+#include "core/ideal_gas_histogram.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using idealgas::CollisionMode;
+using idealgas::FindNamedColor;
+using idealgas::GasContainer;
+using idealgas::IdealGasHistogram;
+using idealgas::ParticleGroup;
+using idealgas::SteppingMode;
+using std::vector;
+
+namespace {
+
+//counts every heap allocation made by the test program
+std::atomic<size_t> allocation_count(0);
+
+} // namespace
+
+void* operator new(std::size_t size) {
+  allocation_count++;
+  void* memory = std::malloc(size == 0 ? 1 : size);
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+/**
+ * Counts the heap allocations made while updating the container.
+ *
+ * @param container     the container to update.
+ * @param update_count  the number of updates to make.
+ *
+ * @return the number of allocations made.
+ */
+size_t CountUpdateAllocations(GasContainer& container, size_t update_count) {
+  size_t first_count = allocation_count;
+  for (size_t update = 0; update < update_count; update++) {
+    container.Update();
+  }
+  return allocation_count - first_count;
+}
+
+TEST_CASE("Steady state updates don't allocate") {
+  ParticleGroup small_group(2500,1,2,FindNamedColor("white"),396.0,396.0,2.0,0,0);
+  ParticleGroup big_group(100,5,6,FindNamedColor("red"),388.0,388.0,1.0,0,1);
+  vector<ParticleGroup*> groups = {&small_group, &big_group};
+  GasContainer container(groups,400.0,400.0);
+
+  SECTION("Grid collisions on one thread") {
+    CountUpdateAllocations(container, 20);
+    REQUIRE(CountUpdateAllocations(container, 20) == 0);
+  }
+
+  SECTION("Grid collisions on several threads") {
+    container.SetThreadCount(4);
+    CountUpdateAllocations(container, 20);
+    REQUIRE(CountUpdateAllocations(container, 20) == 0);
+  }
+
+  SECTION("All pairs collisions") {
+    container.SetCollisionMode(CollisionMode::kAllPairs);
+    CountUpdateAllocations(container, 2);
+    REQUIRE(CountUpdateAllocations(container, 2) == 0);
+  }
+
+  SECTION("Event driven stepping") {
+    container.SetSteppingMode(SteppingMode::kEventDriven);
+    CountUpdateAllocations(container, 20);
+    REQUIRE(CountUpdateAllocations(container, 20) == 0);
+  }
+
+  SECTION("Sorted particles") {
+    container.SetThreadCount(4);
+    container.SetSortInterval(5);
+    CountUpdateAllocations(container, 30);
+    REQUIRE(CountUpdateAllocations(container, 30) == 0);
+  }
+
+  SECTION("Histogram updates") {
+    IdealGasHistogram histogram(&small_group, 10);
+    container.Update();
+    histogram.Update();
+    size_t first_count = allocation_count;
+    histogram.Update();
+    REQUIRE(allocation_count - first_count == 0);
+  }
+}
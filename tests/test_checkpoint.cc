@@ -0,0 +1,110 @@
+#include <catch2/catch.hpp>
+#include "core/checkpoint.h"
+#include <cstdio>
+#include <vector>
+
+using idealgas::CheckpointWriter;
+using idealgas::GasContainer;
+using idealgas::MappedCheckpoint;
+using idealgas::ParticleGroup;
+using idealgas::Particle;
+using idealgas::FindNamedColor;
+using glm::vec2;
+using std::vector;
+
+TEST_CASE("Checkpoints restore the saved particles") {
+  ParticleGroup* small_group = new ParticleGroup(0,1,2,ci::Color(1,1,0),196.0,196.0,2.0,0,0);
+  ParticleGroup* big_group = new ParticleGroup(0,5,6,ci::Color(0,1,1),188.0,188.0,1.0,0,0);
+  small_group->AddParticle(Particle(vec2(10.0,20.0), vec2(1.5,-0.5), 1, 2, FindNamedColor("white")));
+  small_group->AddParticle(Particle(vec2(30.0,40.0), vec2(-1.0,0.25), 1, 2, FindNamedColor("white")));
+  big_group->AddParticle(Particle(vec2(100.0,120.0), vec2(0.5,0.5), 5, 6, FindNamedColor("white")));
+  vector<ParticleGroup*> groups = {small_group, big_group};
+  GasContainer container(groups,200.0,200.0);
+
+  const char* path = "test_checkpoint.igc";
+  CheckpointWriter writer;
+  writer.SaveAsync(container, 42, path);
+  REQUIRE(writer.Wait());
+
+  SECTION("Header and groups are read back from the mapped file") {
+    MappedCheckpoint checkpoint;
+    REQUIRE(checkpoint.Open(path));
+    REQUIRE(checkpoint.GetHeader().group_count == 2);
+    REQUIRE(checkpoint.GetHeader().step_count == 42);
+    REQUIRE(checkpoint.GetHeader().container_width == 200);
+    REQUIRE(checkpoint.GetGroup(1).particle_count == 1);
+    REQUIRE(checkpoint.GetGroup(1).particle_radius == 6);
+    REQUIRE(checkpoint.GetGroupArray(0, 0)[1] == 30.0f);
+    REQUIRE(checkpoint.GetGroupArray(0, 3)[1] == 0.25f);
+  }
+
+  SECTION("Restored groups match the saved groups") {
+    MappedCheckpoint checkpoint;
+    REQUIRE(checkpoint.Open(path));
+    vector<ParticleGroup*> restored_groups = checkpoint.CreateGroups();
+    REQUIRE(restored_groups.size() == 2);
+
+    for (size_t group = 0; group < groups.size(); group++) {
+      ParticleGroup* expected = groups[group];
+      ParticleGroup* actual = restored_groups[group];
+      REQUIRE(actual->GetParticleMass() == expected->GetParticleMass());
+      REQUIRE(actual->GetParticleRadius() == expected->GetParticleRadius());
+      REQUIRE(actual->GetGroupColor() == expected->GetGroupColor());
+      REQUIRE(actual->GetMaxXPosition() == expected->GetMaxXPosition());
+      REQUIRE(actual->GetGroupSize() == expected->GetGroupSize());
+      for (size_t index = 0; index < actual->GetGroupSize(); index++) {
+        REQUIRE(actual->GetPositionAt(index) == expected->GetPositionAt(index));
+        REQUIRE(actual->GetVelocityAt(index) == expected->GetVelocityAt(index));
+      }
+      delete actual;
+    }
+  }
+
+  SECTION("Truncated files are rejected") {
+    std::FILE* file = std::fopen(path, "r+b");
+    REQUIRE(file != nullptr);
+    char header[64];
+    REQUIRE(std::fread(header, 1, sizeof(header), file) == sizeof(header));
+    std::fclose(file);
+
+    file = std::fopen(path, "wb");
+    std::fwrite(header, 1, sizeof(header), file);
+    std::fclose(file);
+
+    MappedCheckpoint checkpoint;
+    REQUIRE_FALSE(checkpoint.Open(path));
+  }
+
+  std::remove(path);
+}
+
+TEST_CASE("Checkpoint saves never wait for earlier saves") {
+  ParticleGroup* group = new ParticleGroup(2000,1,2,FindNamedColor("white"),196.0,196.0,2.0,0,0);
+  vector<ParticleGroup*> groups = {group};
+  GasContainer container(groups,200.0,200.0);
+
+  SECTION("Saves made while one is written leave the newest on disk") {
+    const char* path = "test_checkpoint_queued.igc";
+    CheckpointWriter writer;
+    for (uint64_t step = 1; step <= 50; step++) {
+      writer.SaveAsync(container, step, path);
+    }
+    REQUIRE(writer.Wait());
+    REQUIRE(writer.GetReplacedSaveCount() < 50);
+
+    MappedCheckpoint checkpoint;
+    REQUIRE(checkpoint.Open(path));
+    REQUIRE(checkpoint.GetHeader().step_count == 50);
+    checkpoint.Close();
+    REQUIRE(std::fopen("test_checkpoint_queued.igc.tmp", "rb") == nullptr);
+    std::remove(path);
+  }
+
+  SECTION("Failed saves are reported") {
+    CheckpointWriter writer;
+    writer.SaveAsync(container, 1, "missing_directory/checkpoint.igc");
+    REQUIRE_FALSE(writer.Wait());
+  }
+
+  delete group;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "core/gas_container.h"
+#include <cstdint>
+#include <map>
+
+/**
+ * Makes a square container w/ the visualizer's small particles and one
+ * bigger type of particle. The container doesn't own its groups, so tests
+ * free them w/ DeleteGroups once done.
+ *
+ * @param small_count   the number of small particles.
+ * @param big_mass      the mass of the bigger particles.
+ * @param big_radius    the radius of the bigger particles.
+ * @param big_count     the number of bigger particles.
+ * @param side          the width and height of the container.
+ * @param seed          the seed particles are placed w/.
+ *
+ * @return the new container.
+ */
+inline idealgas::GasContainer CreateTestContainer(size_t small_count,
+                                                  size_t big_mass,
+                                                  size_t big_radius,
+                                                  size_t big_count,
+                                                  size_t side,
+                                                  uint64_t seed) {
+  std::map<idealgas::Particle, size_t> particle_information;
+  particle_information[idealgas::Particle(
+      glm::vec2(0,0), glm::vec2(0,0), 2, 5,
+      idealgas::FindNamedColor("yellow"))] = small_count;
+  particle_information[idealgas::Particle(
+      glm::vec2(0,0), glm::vec2(0,0), big_mass, big_radius,
+      idealgas::FindNamedColor("cyan"))] = big_count;
+  return idealgas::GasContainer(particle_information, side, side, seed);
+}
+
+/**
+ * Frees the particle groups of a test container, like EnsembleRunner does
+ * after a run.
+ *
+ * @param container the container whose groups to free.
+ */
+inline void DeleteGroups(const idealgas::GasContainer& container) {
+  for (idealgas::ParticleGroup* group: container.GetParticleGroups()) {
+    delete group;
+  }
+}
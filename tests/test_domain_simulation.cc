@@ -0,0 +1,163 @@
+#include <catch2/catch.hpp>
+#include "core/domain_simulation.h"
+#include "core/domain_transport.h"
+#include "core/gas_container.h"
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using idealgas::DomainSimulation;
+using idealgas::FindNamedColor;
+using idealgas::GasContainer;
+using idealgas::Particle;
+using idealgas::ParticleGroup;
+using idealgas::SocketTransport;
+using glm::vec2;
+using std::map;
+using std::vector;
+
+namespace {
+
+/**
+ * Results of running every domain of a split simulation on its own thread.
+ */
+struct DomainRun {
+  bool succeeded = true;
+  vector<ParticleGroup*> groups;    //gathered on rank 0
+  size_t halo_retry_count = 0;
+  size_t migration_count = 0;
+};
+
+DomainRun RunDomains(const map<Particle, size_t>& particle_information,
+                     size_t width, size_t height, size_t domain_count,
+                     size_t step_count) {
+  vector<std::unique_ptr<SocketTransport>> transports;
+  DomainRun run;
+  run.succeeded = SocketTransport::CreateLocal(domain_count, transports);
+  if (!run.succeeded) {
+    return run;
+  }
+
+  vector<char> succeeded(domain_count, true);
+  vector<size_t> migration_counts(domain_count, 0);
+  vector<std::thread> threads;
+  for (size_t rank = 0; rank < domain_count; rank++) {
+    threads.emplace_back([&, rank]() {
+      DomainSimulation domain(particle_information, width, height, 7,
+                              transports[rank].get());
+      for (size_t step = 0; step < step_count && succeeded[rank]; step++) {
+        succeeded[rank] = domain.Update();
+      }
+      vector<ParticleGroup*> groups;
+      succeeded[rank] = succeeded[rank] &&
+                        domain.GatherParticleGroups(groups);
+      migration_counts[rank] = domain.GetMigrationCount();
+      if (rank == 0) {
+        run.groups = groups;
+        run.halo_retry_count = domain.GetHaloRetryCount();
+      }
+    });
+  }
+  for (std::thread& thread: threads) {
+    thread.join();
+  }
+  for (size_t rank = 0; rank < domain_count; rank++) {
+    run.succeeded = run.succeeded && succeeded[rank];
+    run.migration_count += migration_counts[rank];
+  }
+  return run;
+}
+
+/**
+ * Checks domains ended w/ exactly the particles of a single container.
+ */
+void RequireSameAsContainer(const DomainRun& run,
+                            const GasContainer& container) {
+  REQUIRE(run.succeeded);
+  const vector<ParticleGroup*>& expected_groups =
+      container.GetParticleGroups();
+  REQUIRE(run.groups.size() == expected_groups.size());
+  for (size_t group = 0; group < run.groups.size(); group++) {
+    ParticleGroup* expected = expected_groups[group];
+    ParticleGroup* actual = run.groups[group];
+    REQUIRE(actual->GetGroupSize() == expected->GetGroupSize());
+    for (size_t index = 0; index < actual->GetGroupSize(); index++) {
+      REQUIRE(actual->GetPositionAt(index) == expected->GetPositionAt(index));
+      REQUIRE(actual->GetVelocityAt(index) == expected->GetVelocityAt(index));
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("Socket transports carry messages between domains") {
+  vector<std::unique_ptr<SocketTransport>> transports;
+  REQUIRE(SocketTransport::CreateLocal(3, transports));
+  REQUIRE(transports.size() == 3);
+  REQUIRE(transports[2]->GetRank() == 2);
+  REQUIRE(transports[2]->GetDomainCount() == 3);
+
+  SECTION("Messages arrive whole and in order") {
+    REQUIRE(transports[0]->Send(2, {1, 2, 3}));
+    REQUIRE(transports[0]->Send(2, {}));
+    vector<unsigned char> message;
+    REQUIRE(transports[2]->Receive(0, message));
+    REQUIRE(message == vector<unsigned char>({1, 2, 3}));
+    REQUIRE(transports[2]->Receive(0, message));
+    REQUIRE(message.empty());
+  }
+
+  SECTION("Domains can't send to themselves") {
+    REQUIRE_FALSE(transports[1]->Send(1, {1}));
+  }
+
+  SECTION("Closed domains fail to receive") {
+    transports[1].reset();
+    vector<unsigned char> message;
+    REQUIRE_FALSE(transports[0]->Receive(1, message));
+  }
+}
+
+TEST_CASE("Domain simulations match a single container") {
+  //crowded w/ mixed sizes, so many collisions happen across strip edges
+  map<Particle, size_t> particle_information = {
+      {Particle(vec2(0,0), vec2(0,0), 1, 2, FindNamedColor("white")), 600},
+      {Particle(vec2(0,0), vec2(0,0), 5, 6, FindNamedColor("red")), 60}};
+
+  SECTION("Wide containers are split along x") {
+    GasContainer container(particle_information, 240, 160, 7);
+    for (size_t step = 0; step < 100; step++) {
+      container.Update();
+    }
+    DomainRun two_domains = RunDomains(particle_information, 240, 160, 2,
+                                       100);
+    RequireSameAsContainer(two_domains, container);
+    REQUIRE(two_domains.migration_count > 0);
+    DomainRun four_domains = RunDomains(particle_information, 240, 160, 4,
+                                        100);
+    RequireSameAsContainer(four_domains, container);
+  }
+
+  SECTION("Tall containers are split along y") {
+    GasContainer container(particle_information, 160, 240, 7);
+    for (size_t step = 0; step < 100; step++) {
+      container.Update();
+    }
+    DomainRun run = RunDomains(particle_information, 160, 240, 3, 100);
+    RequireSameAsContainer(run, container);
+    REQUIRE(run.migration_count > 0);
+  }
+
+  SECTION("Long chains of touching particles deepen the halo") {
+    map<Particle, size_t> packed_information = {
+        {Particle(vec2(0,0), vec2(0,0), 1, 2, FindNamedColor("white")), 1200}};
+    GasContainer container(packed_information, 120, 120, 7);
+    for (size_t step = 0; step < 20; step++) {
+      container.Update();
+    }
+    DomainRun run = RunDomains(packed_information, 120, 120, 4, 20);
+    RequireSameAsContainer(run, container);
+    REQUIRE(run.halo_retry_count > 0);
+  }
+}
@@ -0,0 +1,71 @@
+#include <catch2/catch.hpp>
+#include "core/ensemble_runner.h"
+#include <vector>
+
+using idealgas::EnsembleRunner;
+using idealgas::EnsembleSettings;
+using idealgas::EnsembleSummary;
+using idealgas::FindNamedColor;
+using idealgas::Particle;
+using glm::vec2;
+using std::vector;
+
+/**
+ * Runs the same set of ensembles of different sizes on the given number of
+ * threads.
+ *
+ * @return the summaries of all ensembles, by ensemble index.
+ */
+vector<EnsembleSummary> RunEnsembles(size_t thread_count) {
+  EnsembleRunner runner(thread_count);
+  for (size_t ensemble = 0; ensemble < 12; ensemble++) {
+    EnsembleSettings settings;
+    settings.particle_information[Particle(vec2(0,0), vec2(0,0), 1, 2,
+                                           FindNamedColor("white"))] = 20 + 15 * ensemble;
+    settings.particle_information[Particle(vec2(0,0), vec2(0,0), 4, 5,
+                                           FindNamedColor("red"))] = 10;
+    settings.container_width = 200;
+    settings.container_height = 200;
+    settings.step_count = 50 + 10 * (ensemble % 3);
+    settings.seed = ensemble;
+    REQUIRE(runner.AddEnsemble(settings) == ensemble);
+  }
+
+  vector<EnsembleSummary> summaries(runner.GetEnsembleCount());
+  vector<size_t> report_counts(runner.GetEnsembleCount(), 0);
+  runner.Run([&](const EnsembleSummary& summary) {
+    summaries.at(summary.ensemble) = summary;
+    report_counts.at(summary.ensemble)++;
+  });
+
+  REQUIRE(runner.GetEnsembleCount() == 0);
+  for (size_t report_count: report_counts) {
+    REQUIRE(report_count == 1);
+  }
+  return summaries;
+}
+
+TEST_CASE("Ensemble runner reports every ensemble once") {
+  vector<EnsembleSummary> summaries = RunEnsembles(1);
+
+  REQUIRE(summaries.at(3).step_count == 50);
+  REQUIRE(summaries.at(4).step_count == 60);
+  REQUIRE(summaries.at(5).groups.size() == 2);
+  REQUIRE(summaries.at(5).groups.at(0).particle_count == 95);
+  REQUIRE(summaries.at(5).groups.at(1).particle_mass == 4);
+  REQUIRE(summaries.at(5).groups.at(1).particle_radius == 5);
+}
+
+TEST_CASE("Ensemble results don't depend on the thread count") {
+  vector<EnsembleSummary> one_thread = RunEnsembles(1);
+  vector<EnsembleSummary> four_threads = RunEnsembles(4);
+
+  for (size_t ensemble = 0; ensemble < one_thread.size(); ensemble++) {
+    for (size_t group = 0; group < 2; group++) {
+      REQUIRE(four_threads.at(ensemble).groups.at(group).mean_speed ==
+              one_thread.at(ensemble).groups.at(group).mean_speed);
+      REQUIRE(four_threads.at(ensemble).groups.at(group).kinetic_energy ==
+              one_thread.at(ensemble).groups.at(group).kinetic_energy);
+    }
+  }
+}
@@ -0,0 +1,226 @@
+#include <catch2/catch.hpp>
+#include "core/event_driven_engine.h"
+#include "core/gas_container.h"
+#include "core/gas_observables.h"
+#include <vector>
+
+using idealgas::BoundaryMode;
+using idealgas::EventDrivenEngine;
+using idealgas::GasContainer;
+using idealgas::ObservableSample;
+using idealgas::SteppingMode;
+using idealgas::ParticleGroup;
+using idealgas::Particle;
+using idealgas::FindNamedColor;
+using glm::vec2;
+using std::vector;
+
+/**
+ * Adds up the kinetic energy of every particle in the given groups.
+ */
+double FindKineticEnergy(const vector<ParticleGroup*>& groups) {
+  double energy = 0;
+  for (ParticleGroup* group: groups) {
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      vec2 velocity = group->GetVelocityAt(index);
+      energy += 0.5 * group->GetParticleMass() * dot(velocity, velocity);
+    }
+  }
+  return energy;
+}
+
+TEST_CASE("Event driven engine handles particle collisions") {
+  ParticleGroup* group = new ParticleGroup(0,1,1,FindNamedColor("white"),100.0,100.0,2.0,0,0);
+  vector<ParticleGroup*> groups = {group};
+  EventDrivenEngine engine;
+
+  SECTION("Head on collision swaps velocities of equal masses") {
+    group->AddParticle(Particle(vec2(40.0,50.0), vec2(1.0,0.0), 1, 1, FindNamedColor("white")));
+    group->AddParticle(Particle(vec2(44.0,50.0), vec2(-1.0,0.0), 1, 1, FindNamedColor("white")));
+    engine.Advance(groups, 100, 100, 1.5);
+
+    //particles touch at time 1, then move apart for half a unit
+    REQUIRE(engine.GetCollisionCount() == 1);
+    REQUIRE(group->GetVelocityAt(0).x == Approx(-1.0));
+    REQUIRE(group->GetVelocityAt(1).x == Approx(1.0));
+    REQUIRE(group->GetPositionAt(0).x == Approx(40.5));
+    REQUIRE(group->GetPositionAt(1).x == Approx(43.5));
+  }
+
+  SECTION("Fast particles can't pass through each other") {
+    //fixed steps would move these past each other w/o ever touching
+    group->AddParticle(Particle(vec2(40.0,50.0), vec2(7.0,0.0), 1, 1, FindNamedColor("white")));
+    group->AddParticle(Particle(vec2(50.0,50.0), vec2(-7.0,0.0), 1, 1, FindNamedColor("white")));
+    engine.Advance(groups, 100, 100, 1.0);
+
+    REQUIRE(engine.GetCollisionCount() == 1);
+    REQUIRE(group->GetVelocityAt(0).x == Approx(-7.0));
+    REQUIRE(group->GetVelocityAt(1).x == Approx(7.0));
+    REQUIRE(group->GetPositionAt(0).x < group->GetPositionAt(1).x);
+  }
+
+  SECTION("Particles passing by each other don't collide") {
+    group->AddParticle(Particle(vec2(40.0,50.0), vec2(1.0,0.0), 1, 1, FindNamedColor("white")));
+    group->AddParticle(Particle(vec2(44.0,60.0), vec2(-1.0,0.0), 1, 1, FindNamedColor("white")));
+    engine.Advance(groups, 100, 100, 5.0);
+
+    REQUIRE(engine.GetCollisionCount() == 0);
+    REQUIRE(group->GetPositionAt(0).x == Approx(45.0));
+    REQUIRE(group->GetPositionAt(1).x == Approx(39.0));
+  }
+}
+
+TEST_CASE("Event driven engine handles wall collisions") {
+  ParticleGroup* group = new ParticleGroup(0,1,1,FindNamedColor("white"),100.0,100.0,2.0,0,0);
+  vector<ParticleGroup*> groups = {group};
+  EventDrivenEngine engine;
+
+  SECTION("Particle bounces off the wall at the exact time it's reached") {
+    group->AddParticle(Particle(vec2(98.0,50.0), vec2(4.0,0.0), 1, 1, FindNamedColor("white")));
+    engine.Advance(groups, 102, 102, 1.0);
+
+    REQUIRE(engine.GetCollisionCount() == 1);
+    REQUIRE(group->GetVelocityAt(0).x == Approx(-4.0));
+    REQUIRE(group->GetPositionAt(0).x == Approx(98.0));
+  }
+
+  SECTION("Particle bounces off two walls in one corner") {
+    group->AddParticle(Particle(vec2(1.0,1.0), vec2(-2.0,-2.0), 1, 1, FindNamedColor("white")));
+    engine.Advance(groups, 102, 102, 1.0);
+
+    REQUIRE(engine.GetCollisionCount() == 2);
+    REQUIRE(group->GetVelocityAt(0) == vec2(2.0,2.0));
+    REQUIRE(group->GetPositionAt(0).x == Approx(1.0));
+    REQUIRE(group->GetPositionAt(0).y == Approx(1.0));
+  }
+}
+
+TEST_CASE("Event driven engine wraps particles around periodic edges") {
+  ParticleGroup* group = new ParticleGroup(0,1,1,FindNamedColor("white"),100.0,100.0,2.0,0,0);
+  vector<ParticleGroup*> groups = {group};
+  EventDrivenEngine engine;
+
+  SECTION("Particles pass through edges w/o bouncing") {
+    group->AddParticle(Particle(vec2(98.0,1.0), vec2(4.0,-2.0), 1, 1, FindNamedColor("white")));
+    engine.Advance(groups, 100, 100, 1.0, true);
+
+    REQUIRE(engine.GetCollisionCount() == 0);
+    REQUIRE(group->GetVelocityAt(0) == vec2(4.0,-2.0));
+    REQUIRE(group->GetPositionAt(0).x == Approx(2.0));
+    REQUIRE(group->GetPositionAt(0).y == Approx(99.0));
+  }
+
+  SECTION("Particles collide across an edge") {
+    group->AddParticle(Particle(vec2(2.0,50.0), vec2(-1.0,0.0), 1, 1, FindNamedColor("white")));
+    group->AddParticle(Particle(vec2(98.0,50.0), vec2(1.0,0.0), 1, 1, FindNamedColor("white")));
+    engine.Advance(groups, 100, 100, 1.5, true);
+
+    //particles are 4 apart across the edge, so touch at time 1
+    REQUIRE(engine.GetCollisionCount() == 1);
+    REQUIRE(group->GetVelocityAt(0).x == Approx(1.0));
+    REQUIRE(group->GetVelocityAt(1).x == Approx(-1.0));
+    REQUIRE(group->GetPositionAt(0).x == Approx(1.5));
+    REQUIRE(group->GetPositionAt(1).x == Approx(98.5));
+  }
+}
+
+TEST_CASE("Event driven stepping w/ periodic edges keeps energy") {
+  ParticleGroup* small_group = new ParticleGroup(300,1,2,FindNamedColor("white"),196.0,196.0,2.0,0,0);
+  ParticleGroup* big_group = new ParticleGroup(40,5,6,FindNamedColor("red"),188.0,188.0,1.0,0,1);
+  vector<ParticleGroup*> groups = {small_group, big_group};
+  double starting_energy = FindKineticEnergy(groups);
+
+  GasContainer container(groups,200.0,200.0);
+  container.SetSteppingMode(SteppingMode::kEventDriven);
+  container.SetBoundaryMode(BoundaryMode::kPeriodic);
+  for (size_t step = 0; step < 50; step++) {
+    container.Update();
+  }
+
+  REQUIRE(FindKineticEnergy(groups) == Approx(starting_energy).epsilon(0.001));
+  for (ParticleGroup* group: groups) {
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      vec2 position = group->GetPositionAt(index);
+      REQUIRE(position.x >= 0.0f);
+      REQUIRE(position.y >= 0.0f);
+      REQUIRE(position.x <= 200.0f);
+      REQUIRE(position.y <= 200.0f);
+    }
+  }
+}
+
+TEST_CASE("Containers advance any time at once") {
+  ParticleGroup* group = new ParticleGroup(0,1,1,FindNamedColor("white"),100.0,100.0,2.0,0,0);
+  group->AddParticle(Particle(vec2(40.0,50.0), vec2(1.0,0.0), 1, 1, FindNamedColor("white")));
+  group->AddParticle(Particle(vec2(60.0,50.0), vec2(-1.0,0.0), 1, 1, FindNamedColor("white")));
+  group->AddParticle(Particle(vec2(90.0,20.0), vec2(2.5,0.5), 1, 1, FindNamedColor("white")));
+  vector<ParticleGroup*> groups = {group};
+  GasContainer container(groups,102.0,102.0);
+
+  SECTION("Event driven stepping handles every collision in one call") {
+    container.SetSteppingMode(SteppingMode::kEventDriven);
+    container.GetObservables().SetSampleInterval(1);
+    container.Advance(12.5);
+
+    //the pair touches at time 9, the last particle reaches the wall at 4
+    REQUIRE(group->GetVelocityAt(0).x == Approx(-1.0));
+    REQUIRE(group->GetVelocityAt(1).x == Approx(1.0));
+    REQUIRE(group->GetPositionAt(0).x == Approx(45.5));
+    REQUIRE(group->GetPositionAt(1).x == Approx(54.5));
+    REQUIRE(group->GetVelocityAt(2).x == Approx(-2.5));
+    REQUIRE(group->GetPositionAt(2).x == Approx(78.75));
+    REQUIRE(group->GetPositionAt(2).y == Approx(26.25));
+
+    vector<ObservableSample> samples;
+    REQUIRE(container.GetObservables().PullSamples(samples) == 1);
+    REQUIRE(samples[0].collision_rate == Approx(1.0 / 12.5));
+  }
+
+  SECTION("Fixed stepping rounds to whole updates") {
+    ParticleGroup* expected_group = new ParticleGroup(0,1,1,FindNamedColor("white"),100.0,100.0,2.0,0,0);
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      expected_group->AddParticle(*group->GetParticleAt(index));
+    }
+    vector<ParticleGroup*> expected_groups = {expected_group};
+    GasContainer expected_container(expected_groups,102.0,102.0);
+    for (size_t update = 0; update < 12; update++) {
+      expected_container.Update();
+    }
+    container.Advance(12.4);
+
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      REQUIRE(group->GetPositionAt(index) ==
+              expected_group->GetPositionAt(index));
+      REQUIRE(group->GetVelocityAt(index) ==
+              expected_group->GetVelocityAt(index));
+    }
+    delete expected_group;
+  }
+  delete group;
+}
+
+TEST_CASE("Event driven stepping keeps particles in the container") {
+  //crowded container w/ mixed sizes so many collisions happen every update
+  ParticleGroup* small_group = new ParticleGroup(300,1,2,FindNamedColor("white"),196.0,196.0,2.0,0,2);
+  ParticleGroup* big_group = new ParticleGroup(40,5,6,FindNamedColor("red"),188.0,188.0,1.0,0,3);
+  vector<ParticleGroup*> groups = {small_group, big_group};
+  double starting_energy = FindKineticEnergy(groups);
+
+  GasContainer container(groups,200.0,200.0);
+  container.SetSteppingMode(SteppingMode::kEventDriven);
+  for (size_t step = 0; step < 50; step++) {
+    container.Update();
+  }
+
+  //elastic collisions keep energy the same, up to float rounding
+  REQUIRE(FindKineticEnergy(groups) == Approx(starting_energy).epsilon(0.001));
+  for (ParticleGroup* group: groups) {
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      vec2 position = group->GetPositionAt(index);
+      REQUIRE(position.x >= -0.001f);
+      REQUIRE(position.y >= -0.001f);
+      REQUIRE(position.x <= group->GetMaxXPosition() + 0.001);
+      REQUIRE(position.y <= group->GetMaxYPosition() + 0.001);
+    }
+  }
+}
@@ -0,0 +1,203 @@
+#include <catch2/catch.hpp>
+#include "core/gas_container.h"
+#include "core/gas_observables.h"
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <thread>
+#include <vector>
+
+using idealgas::BoundaryMode;
+using idealgas::GasContainer;
+using idealgas::ObservableSample;
+using idealgas::SteppingMode;
+using idealgas::ParticleGroup;
+using idealgas::Particle;
+using idealgas::FindNamedColor;
+using glm::vec2;
+using std::map;
+using std::vector;
+
+/**
+ * Updates a container a number of times, then pulls every sample taken.
+ */
+vector<ObservableSample> RunAndPull(GasContainer& container,
+                                    size_t update_count) {
+  for (size_t update = 0; update < update_count; update++) {
+    container.Update();
+  }
+  vector<ObservableSample> samples;
+  container.GetObservables().PullSamples(samples);
+  return samples;
+}
+
+TEST_CASE("Observables are sampled at the set interval") {
+  ParticleGroup* heavy = new ParticleGroup(0,2,1,FindNamedColor("white"),100.0,100.0,5.0,0,0);
+  ParticleGroup* light = new ParticleGroup(0,1,1,FindNamedColor("red"),100.0,100.0,5.0,0,0);
+  heavy->AddParticle(Particle(vec2(20.0,20.0), vec2(1.0,0.0), 2, 1, FindNamedColor("white")));
+  heavy->AddParticle(Particle(vec2(60.0,60.0), vec2(0.0,-2.0), 2, 1, FindNamedColor("white")));
+  light->AddParticle(Particle(vec2(50.0,20.0), vec2(3.0,4.0), 1, 1, FindNamedColor("red")));
+  vector<ParticleGroup*> groups = {heavy, light};
+  GasContainer container(groups, 100, 100);
+
+  SECTION("Nothing is sampled by default") {
+    REQUIRE(container.GetObservables().GetSampleInterval() == 0);
+    REQUIRE(RunAndPull(container, 4).empty());
+  }
+
+  SECTION("Samples hold the state of every group and all particles") {
+    container.GetObservables().SetSampleInterval(2);
+    vector<ObservableSample> samples = RunAndPull(container, 5);
+    REQUIRE(samples.size() == 2);
+    REQUIRE(samples[0].update == 2);
+    REQUIRE(samples[1].update == 4);
+
+    const ObservableSample& sample = samples[1];
+    REQUIRE(sample.groups.size() == 2);
+    REQUIRE(sample.groups[0].particle_count == 2);
+    REQUIRE(sample.groups[0].kinetic_energy == Approx(5.0));
+    REQUIRE(sample.groups[0].temperature == Approx(2.5));
+    REQUIRE(sample.groups[0].x_momentum == Approx(2.0));
+    REQUIRE(sample.groups[0].y_momentum == Approx(-4.0));
+    REQUIRE(sample.groups[0].mean_speed == Approx(1.5));
+    REQUIRE(sample.groups[1].kinetic_energy == Approx(12.5));
+    REQUIRE(sample.groups[1].mean_speed == Approx(5.0));
+
+    REQUIRE(sample.total.particle_count == 3);
+    REQUIRE(sample.total.kinetic_energy == Approx(17.5));
+    REQUIRE(sample.total.temperature == Approx(17.5 / 3));
+    REQUIRE(sample.total.x_momentum == Approx(5.0));
+    REQUIRE(sample.total.y_momentum == Approx(0.0));
+    REQUIRE(sample.total.mean_speed == Approx(8.0 / 3));
+
+    //nothing hit a wall or another particle
+    REQUIRE(sample.has_pressure);
+    REQUIRE(sample.pressure == 0);
+    REQUIRE(sample.collision_rate == 0);
+    REQUIRE(sample.mean_free_path == 0);
+  }
+
+  SECTION("Groups listed more than once are only counted once") {
+    idealgas::GasObservables observables;
+    idealgas::WorkerPool pool(2);
+    vector<ParticleGroup*> repeated_groups = {heavy, light, heavy};
+    observables.SetSampleInterval(1);
+    observables.RecordUpdate(repeated_groups, 400.0, 0, 0, pool, 1.0);
+    vector<ObservableSample> samples;
+    REQUIRE(observables.PullSamples(samples) == 1);
+
+    const ObservableSample& sample = samples[0];
+    REQUIRE(sample.groups.size() == 3);
+    REQUIRE(sample.groups[2].particle_count == 2);
+    REQUIRE(sample.groups[2].kinetic_energy == Approx(5.0));
+    REQUIRE(sample.total.particle_count == 3);
+    REQUIRE(sample.total.kinetic_energy == Approx(17.5));
+    REQUIRE(sample.total.mean_speed == Approx(8.0 / 3));
+  }
+
+  SECTION("Pulling empties the queue") {
+    container.GetObservables().SetSampleInterval(1);
+    REQUIRE(RunAndPull(container, 3).size() == 3);
+    vector<ObservableSample> samples;
+    REQUIRE(container.GetObservables().PullSamples(samples) == 0);
+    REQUIRE(samples.empty());
+    REQUIRE(container.GetObservables().GetDroppedSampleCount() == 0);
+  }
+
+  SECTION("Intervals can be set while another thread updates") {
+    std::atomic<bool> updating(true);
+    std::thread update_thread([&container, &updating] {
+      for (size_t update = 0; update < 2000; update++) {
+        container.Update();
+      }
+      updating = false;
+    });
+    for (size_t interval = 1; updating; interval = interval % 5 + 1) {
+      container.GetObservables().SetSampleInterval(interval);
+      vector<ObservableSample> samples;
+      container.GetObservables().PullSamples(samples);
+    }
+    update_thread.join();
+
+    //the last interval set is used by the next update
+    container.GetObservables().SetSampleInterval(3);
+    REQUIRE(container.GetObservables().GetSampleInterval() == 3);
+    vector<ObservableSample> samples;
+    container.GetObservables().PullSamples(samples);
+    samples = RunAndPull(container, 6);
+    REQUIRE(samples.size() == 2);
+    REQUIRE(samples[1].update - samples[0].update == 3);
+  }
+}
+
+TEST_CASE("Pressure comes from impulses walls give particles") {
+  ParticleGroup* group = new ParticleGroup(0,3,1,FindNamedColor("white"),100.0,100.0,5.0,0,0);
+  group->AddParticle(Particle(vec2(99.5,50.0), vec2(2.0,0.0), 3, 1, FindNamedColor("white")));
+  vector<ParticleGroup*> groups = {group};
+  GasContainer container(groups, 100, 100);
+  container.GetObservables().SetSampleInterval(4);
+
+  vector<ObservableSample> samples = RunAndPull(container, 4);
+  REQUIRE(samples.size() == 1);
+  //one bounce reverses a momentum of 6, spread over 4 updates and 400 pixels
+  //of wall
+  REQUIRE(samples[0].has_pressure);
+  REQUIRE(samples[0].pressure == Approx(12.0 / (400.0 * 4)));
+  REQUIRE(group->GetVelocityAt(0).x == Approx(-2.0));
+
+  //periodic edges have no walls to push against
+  container.SetBoundaryMode(BoundaryMode::kPeriodic);
+  samples = RunAndPull(container, 4);
+  REQUIRE(samples.size() == 1);
+  REQUIRE_FALSE(samples[0].has_pressure);
+  REQUIRE(samples[0].pressure == 0);
+}
+
+TEST_CASE("Collision rate and mean free path come from particle collisions") {
+  ParticleGroup* group = new ParticleGroup(0,1,1,FindNamedColor("white"),100.0,100.0,5.0,0,0);
+  group->AddParticle(Particle(vec2(40.0,50.0), vec2(1.0,0.0), 1, 1, FindNamedColor("white")));
+  group->AddParticle(Particle(vec2(43.0,50.0), vec2(-1.0,0.0), 1, 1, FindNamedColor("white")));
+  vector<ParticleGroup*> groups = {group};
+  GasContainer container(groups, 100, 100);
+  container.GetObservables().SetSampleInterval(4);
+
+  SECTION("Fixed steps count resolved collisions") {
+    vector<ObservableSample> samples = RunAndPull(container, 4);
+    REQUIRE(samples.size() == 1);
+    REQUIRE(samples[0].collision_rate == Approx(0.25));
+    //each particle moves 4 pixels per collision
+    REQUIRE(samples[0].mean_free_path == Approx(4.0));
+  }
+
+  SECTION("Event driven steps count collision events") {
+    container.SetSteppingMode(SteppingMode::kEventDriven);
+    vector<ObservableSample> samples = RunAndPull(container, 4);
+    REQUIRE(samples.size() == 1);
+    REQUIRE(samples[0].collision_rate == Approx(0.25));
+    REQUIRE(samples[0].mean_free_path == Approx(4.0));
+  }
+}
+
+TEST_CASE("Observables summed by many threads match a direct sum") {
+  map<Particle, size_t> particle_information = {
+      {Particle(vec2(0,0), vec2(0,0), 1, 1, FindNamedColor("white")), 9000},
+      {Particle(vec2(0,0), vec2(0,0), 4, 2, FindNamedColor("red")), 3000}};
+  GasContainer container(particle_information, 1200, 1200, 3, 3);
+  container.GetObservables().SetSampleInterval(1);
+
+  vector<ObservableSample> samples = RunAndPull(container, 1);
+  REQUIRE(samples.size() == 1);
+  double kinetic_energy = 0;
+  double x_momentum = 0;
+  for (ParticleGroup* group: container.GetParticleGroups()) {
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      vec2 velocity = group->GetVelocityAt(index);
+      kinetic_energy += 0.5 * group->GetParticleMass() * dot(velocity, velocity);
+      x_momentum += group->GetParticleMass() * velocity.x;
+    }
+  }
+  REQUIRE(samples[0].total.particle_count == 12000);
+  REQUIRE(samples[0].total.kinetic_energy == Approx(kinetic_energy));
+  REQUIRE(samples[0].total.x_momentum ==
+          Approx(x_momentum).margin(1e-6 * kinetic_energy));
+}
@@ -0,0 +1,55 @@
+#include <catch2/catch.hpp>
+#include "core/hierarchical_grid.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using idealgas::FindNamedColor;
+using idealgas::HierarchicalGrid;
+using idealgas::Particle;
+using glm::vec2;
+using std::vector;
+
+TEST_CASE("Hierarchical grids place particles by radius") {
+  vector<Particle> particles = {
+      Particle(vec2(1.0,1.0), vec2(0,0), 1, 1, FindNamedColor("white")),
+      Particle(vec2(7.0,1.0), vec2(0,0), 1, 1, FindNamedColor("white")),
+      Particle(vec2(10.0,10.0), vec2(0,0), 1, 1, FindNamedColor("white")),
+      Particle(vec2(2.0,2.0), vec2(0,0), 1, 20, FindNamedColor("white")),
+      Particle(vec2(10.0,2.0), vec2(0,0), 1, 20, FindNamedColor("white")),
+      Particle(vec2(8.0,1.0), vec2(0,0), 1, 1, FindNamedColor("white"))};
+  vector<size_t> particle_list = {0, 1, 2, 3, 4, 5};
+  HierarchicalGrid grid;
+
+  SECTION("Crowded levels use the smallest cells that fit") {
+    grid.Rebuild(particles, particle_list, 12.0, 12.0);
+    //cells of 3 for radius 1, doubled until 41 fits radius 20
+    REQUIRE(grid.GetLevelCount() == 2);
+    REQUIRE(grid.GetCellSize(0) == 3.0);
+    REQUIRE(grid.GetCellSize(1) == 48.0);
+  }
+
+  SECTION("Sparse levels get bigger cells") {
+    grid.Rebuild(particles, particle_list, 200.0, 200.0);
+    REQUIRE(grid.GetLevelCount() == 2);
+    REQUIRE(grid.GetCellSize(0) == Approx(std::sqrt(200.0 * 200.0 / 16)));
+    REQUIRE(grid.GetCellSize(1) == Approx(std::sqrt(200.0 * 200.0 / 8)));
+  }
+
+  SECTION("Small particles find earlier small neighbors and big particles") {
+    grid.Rebuild(particles, particle_list, 12.0, 12.0);
+    vector<size_t> candidates;
+    grid.ListCandidates(5, candidates);
+    std::sort(candidates.begin(), candidates.end());
+    REQUIRE(candidates == vector<size_t>({1, 3, 4}));
+  }
+
+  SECTION("Big particles only find earlier big neighbors") {
+    grid.Rebuild(particles, particle_list, 12.0, 12.0);
+    vector<size_t> candidates;
+    grid.ListCandidates(3, candidates);
+    REQUIRE(candidates.empty());
+    grid.ListCandidates(4, candidates);
+    REQUIRE(candidates == vector<size_t>({3}));
+  }
+}
@@ -2,33 +2,32 @@
 #include "core/ideal_gas_histogram.h"
 #include "core/particle.h"
 
+using idealgas::FindNamedColor;
 using idealgas::IdealGasHistogram;
 using idealgas::Particle;
+using glm::vec2;
 
 TEST_CASE("Histogram functions correctly") {
   //initiate particle group and histogram to test
-  ParticleGroup* test_group = new ParticleGroup(0, 1, 4, "white", 100.0,100.0,1.0);
+  ParticleGroup* test_group = new ParticleGroup(0, 1, 4, FindNamedColor("white"), 100.0,100.0,1.0, 0, 0);
 
-  Particle first_particle(vec2(50.0,50.0), vec2(0.0,1.0), 1, 4, "white"); //speed = 1
-  Particle second_particle(vec2(30.0,30.0), vec2(2.0,0.0), 1, 4, "white");//speed = 2
-  Particle third_particle(vec2(10.0,10.0), vec2(0.0,-3.0), 1, 4, "white");//speed = 3
-  Particle fourth_particle(vec2(70.0,70.0), vec2(0.5,0.0), 1, 4, "white");//speed = 0.5
+  Particle first_particle(vec2(50.0,50.0), vec2(0.0,1.0), 1, 4, FindNamedColor("white")); //speed = 1
+  Particle second_particle(vec2(30.0,30.0), vec2(2.0,0.0), 1, 4, FindNamedColor("white"));//speed = 2
+  Particle third_particle(vec2(10.0,10.0), vec2(0.0,-3.0), 1, 4, FindNamedColor("white"));//speed = 3
+  Particle fourth_particle(vec2(70.0,70.0), vec2(0.5,0.0), 1, 4, FindNamedColor("white"));//speed = 0.5
 
   test_group->AddParticle(first_particle);
   test_group->AddParticle(second_particle);
   test_group->AddParticle(third_particle);
   test_group->AddParticle(fourth_particle);
 
-  IdealGasHistogram* test_histogram = new IdealGasHistogram(vec2(0.0,0.0),
-                                                            vec2(100.0,100.0),
-                                                            test_group,250,200,
-                                                            50,4,2);
+  IdealGasHistogram* test_histogram = new IdealGasHistogram(test_group,4);
 
-  SECTION("Constructor produces properly sorted list of particle speeds") {
-    for (int index = 1; index < 4; index++) {
-      REQUIRE(test_histogram->GetParticleSpeedAt(index) >=
-              test_histogram->GetParticleSpeedAt(index-1));
-    }
+  SECTION("Constructor finds the speed of every particle") {
+    REQUIRE(test_histogram->GetParticleSpeedAt(0) == Approx(1.0));
+    REQUIRE(test_histogram->GetParticleSpeedAt(1) == Approx(2.0));
+    REQUIRE(test_histogram->GetParticleSpeedAt(2) == Approx(3.0));
+    REQUIRE(test_histogram->GetParticleSpeedAt(3) == Approx(0.5));
   }
 
   SECTION("Calculated histogram bucket intervals are correct") {
@@ -44,4 +43,71 @@ TEST_CASE("Histogram functions correctly") {
     REQUIRE(test_histogram->GetNumberParticlesAt(2) == 1);
     REQUIRE(test_histogram->GetNumberParticlesAt(3) == 1);
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Histogram updates as particle speeds change") {
+  ParticleGroup* test_group = new ParticleGroup(0, 1, 4, FindNamedColor("white"), 100.0,100.0,1.0, 0, 0);
+  test_group->AddParticle(Particle(vec2(50.0,50.0), vec2(0.0,1.0), 1, 4, FindNamedColor("white")));
+  test_group->AddParticle(Particle(vec2(30.0,30.0), vec2(2.0,0.0), 1, 4, FindNamedColor("white")));
+  test_group->AddParticle(Particle(vec2(10.0,10.0), vec2(0.0,-3.0), 1, 4, FindNamedColor("white")));
+  test_group->AddParticle(Particle(vec2(70.0,70.0), vec2(0.5,0.0), 1, 4, FindNamedColor("white")));
+
+  SECTION("Particles move between buckets when their speed changes") {
+    IdealGasHistogram test_histogram(test_group,4);
+    test_group->SetVelocityAt(0, vec2(0.0,2.5)); //1st to 4th bucket
+    test_histogram.Update();
+
+    REQUIRE(test_histogram.GetNumberParticlesAt(0) == 1);
+    REQUIRE(test_histogram.GetNumberParticlesAt(1) == 0);
+    REQUIRE(test_histogram.GetNumberParticlesAt(2) == 1);
+    REQUIRE(test_histogram.GetNumberParticlesAt(3) == 2);
+    REQUIRE(test_histogram.GetBucketLimitAt(3) == Approx(3.0));
+  }
+
+  SECTION("Adaptive limits widen to cover new speeds") {
+    IdealGasHistogram test_histogram(test_group,4);
+    test_group->SetVelocityAt(0, vec2(0.0,5.0));
+    test_histogram.Update();
+
+    REQUIRE(test_histogram.GetBucketLimitAt(3) >= 5.0);
+    size_t total_count = 0;
+    for (size_t bucket = 0; bucket < 4; bucket++) {
+      total_count += test_histogram.GetNumberParticlesAt(bucket);
+    }
+    REQUIRE(total_count == 4);
+    REQUIRE(test_histogram.GetNumberParticlesAt(3) == 1);
+  }
+
+  SECTION("Fixed limits count speeds outside them in the end buckets") {
+    IdealGasHistogram test_histogram(test_group,4,1.0,2.0);
+    REQUIRE(test_histogram.GetBucketLimitAt(0) == Approx(1.25));
+    REQUIRE(test_histogram.GetNumberParticlesAt(0) == 2); //0.5 and 1
+    REQUIRE(test_histogram.GetNumberParticlesAt(3) == 2); //2 and 3
+
+    test_group->SetVelocityAt(2, vec2(1.5,0.0));
+    test_histogram.Update();
+    REQUIRE(test_histogram.GetBucketLimitAt(3) == Approx(2.0));
+    REQUIRE(test_histogram.GetNumberParticlesAt(1) == 1);
+    REQUIRE(test_histogram.GetNumberParticlesAt(3) == 1);
+  }
+
+  SECTION("Adaptive limits cover particles added to the group") {
+    IdealGasHistogram test_histogram(test_group,4);
+    test_group->AddParticle(Particle(vec2(20.0,20.0), vec2(6.0,0.0), 1, 4, FindNamedColor("white")));
+    test_histogram.Update();
+
+    REQUIRE(test_histogram.GetBucketLimitAt(3) >= 6.0);
+    REQUIRE(test_histogram.GetParticleSpeedAt(4) == Approx(6.0));
+    size_t total_count = 0;
+    for (size_t bucket = 0; bucket < 4; bucket++) {
+      total_count += test_histogram.GetNumberParticlesAt(bucket);
+    }
+    REQUIRE(total_count == 5);
+    REQUIRE(test_histogram.GetNumberParticlesAt(3) == 1);
+  }
+
+  SECTION("Histograms w/o buckets are rejected") {
+    REQUIRE_THROWS_AS(IdealGasHistogram(test_group,0), std::invalid_argument);
+    REQUIRE_THROWS_AS(IdealGasHistogram(test_group,0,1.0,2.0), std::invalid_argument);
+  }
+}
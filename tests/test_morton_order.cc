@@ -0,0 +1,165 @@
+#include <catch2/catch.hpp>
+#include "core/gas_container.h"
+#include "core/morton_order.h"
+#include "core/philox.h"
+#include "test_containers.h"
+#include <algorithm>
+#include <vector>
+
+using glm::vec2;
+using idealgas::CollisionMode;
+using idealgas::FindNamedColor;
+using idealgas::GasContainer;
+using idealgas::MortonSorter;
+using idealgas::Particle;
+using idealgas::ParticleGroup;
+using idealgas::WorkerPool;
+using std::vector;
+
+namespace {
+
+/**
+ * Makes a container w/ the visualizer's small and mid particles.
+ */
+GasContainer CreateSortedContainer() {
+  return CreateTestContainer(300, 5, 10, 100, 400, 11);
+}
+
+} // namespace
+
+TEST_CASE("Morton keys interleave x and y bits") {
+  REQUIRE(MortonSorter::InterleaveBits(0, 0) == 0);
+  REQUIRE(MortonSorter::InterleaveBits(1, 0) == 1);
+  REQUIRE(MortonSorter::InterleaveBits(0, 1) == 2);
+  REQUIRE(MortonSorter::InterleaveBits(3, 5) == 0x27);
+  REQUIRE(MortonSorter::InterleaveBits(0xffff, 0xffff) == 0xffffffff);
+}
+
+TEST_CASE("Morton order sorts keys stably for any number of threads") {
+  //enough particles for several sort tasks, many sharing a key
+  vector<float> x_positions;
+  vector<float> y_positions;
+  uint32_t random_block[4];
+  for (uint32_t index = 0; index < 50000; index++) {
+    idealgas::philox::GenerateBlock(3, index, 0, random_block);
+    x_positions.push_back((float) (idealgas::philox::ToUnitInterval(
+                                       random_block[0]) * 100.0));
+    y_positions.push_back((float) (random_block[1] % 4));
+  }
+  //outside of the container counts as its closest border
+  x_positions[7] = -5.0f;
+  y_positions[8] = 250.0f;
+
+  vector<vector<uint32_t>> orders;
+  for (size_t thread_count: {1, 4}) {
+    WorkerPool pool(thread_count);
+    MortonSorter sorter;
+    sorter.FindOrder(x_positions.data(), y_positions.data(),
+                     x_positions.size(), 100.0, 200.0, pool);
+    orders.push_back(sorter.GetOrder());
+
+    //every particle is listed once
+    vector<uint32_t> sorted_order = sorter.GetOrder();
+    std::sort(sorted_order.begin(), sorted_order.end());
+    for (uint32_t index = 0; index < sorted_order.size(); index++) {
+      REQUIRE(sorted_order[index] == index);
+    }
+
+    //values follow their particles into the order
+    vector<float> values = x_positions;
+    sorter.ApplyOrder(values, pool);
+    for (size_t index = 0; index < values.size(); index++) {
+      REQUIRE(values[index] == x_positions[sorter.GetOrder()[index]]);
+    }
+  }
+
+  //keys found the same way, sorted by the standard library for reference
+  vector<uint32_t> keys;
+  vector<uint32_t> expected_order;
+  for (uint32_t index = 0; index < x_positions.size(); index++) {
+    uint32_t x_cell = (uint32_t) std::min(
+        65535.0, std::max(0.0, x_positions[index] * (65535.0 / 100.0)));
+    uint32_t y_cell = (uint32_t) std::min(
+        65535.0, std::max(0.0, y_positions[index] * (65535.0 / 200.0)));
+    keys.push_back(MortonSorter::InterleaveBits(x_cell, y_cell));
+    expected_order.push_back(index);
+  }
+  std::stable_sort(expected_order.begin(), expected_order.end(),
+                   [&](uint32_t first, uint32_t second) {
+    return keys[first] < keys[second];
+  });
+  for (const vector<uint32_t>& order: orders) {
+    REQUIRE(order == expected_order);
+  }
+}
+
+TEST_CASE("Sorting a group keeps every particle's state together") {
+  ParticleGroup group(0, 1, 1, FindNamedColor("white"), 100.0, 100.0, 1.0, 0, 0);
+  group.AddParticle(Particle(vec2(90.0,90.0), vec2(1.0,2.0), 1, 1, FindNamedColor("white")));
+  group.AddParticle(Particle(vec2(10.0,90.0), vec2(3.0,4.0), 1, 1, FindNamedColor("white")));
+  group.AddParticle(Particle(vec2(90.0,10.0), vec2(5.0,6.0), 1, 1, FindNamedColor("white")));
+  group.AddParticle(Particle(vec2(10.0,10.0), vec2(7.0,8.0), 1, 1, FindNamedColor("white")));
+  WorkerPool pool(1);
+  MortonSorter sorter;
+  group.SortAlongCurve(sorter, pool);
+
+  //quadrants in Z order: top left, top right, bottom left, bottom right
+  REQUIRE(sorter.GetOrder() == vector<uint32_t>({3, 2, 1, 0}));
+  REQUIRE(group.GetPositionAt(0) == vec2(10.0,10.0));
+  REQUIRE(group.GetVelocityAt(0) == vec2(7.0,8.0));
+  REQUIRE(group.GetPositionAt(1) == vec2(90.0,10.0));
+  REQUIRE(group.GetVelocityAt(1) == vec2(5.0,6.0));
+  REQUIRE(group.GetPositionAt(3) == vec2(90.0,90.0));
+  REQUIRE(group.GetVelocityAt(3) == vec2(1.0,2.0));
+}
+
+TEST_CASE("Containers reorder particles at the sort interval") {
+  GasContainer container = CreateSortedContainer();
+  container.SetSortInterval(5);
+
+  SECTION("Particles are only reordered every interval") {
+    for (size_t update = 0; update < 12; update++) {
+      container.Update();
+    }
+    REQUIRE(container.GetSortCount() == 2);
+    REQUIRE(container.GetLastSortOrder(0).size() ==
+            container.GetParticleGroups()[0]->GetGroupSize());
+    REQUIRE(container.GetLastSortOrder(5).empty());
+  }
+
+  SECTION("The last order leads back to each particle's old index") {
+    vector<vec2> old_positions;
+    ParticleGroup* group = container.GetParticleGroups()[1];
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      old_positions.push_back(group->GetPositionAt(index));
+    }
+    container.SortParticles();
+    const vector<uint32_t>& order = container.GetLastSortOrder(1);
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      REQUIRE(group->GetPositionAt(index) == old_positions[order[index]]);
+    }
+  }
+
+  SECTION("Reordered Verlet lists match the grid") {
+    GasContainer grid_container = CreateSortedContainer();
+    grid_container.SetSortInterval(5);
+    container.SetCollisionMode(CollisionMode::kVerletList);
+    for (size_t update = 0; update < 30; update++) {
+      container.Update();
+      grid_container.Update();
+    }
+    for (size_t group = 0; group < 2; group++) {
+      ParticleGroup* verlet_group = container.GetParticleGroups()[group];
+      ParticleGroup* grid_group = grid_container.GetParticleGroups()[group];
+      for (size_t index = 0; index < grid_group->GetGroupSize(); index++) {
+        REQUIRE(verlet_group->GetPositionAt(index) ==
+                grid_group->GetPositionAt(index));
+        REQUIRE(verlet_group->GetVelocityAt(index) ==
+                grid_group->GetVelocityAt(index));
+      }
+    }
+    DeleteGroups(grid_container);
+  }
+
+  DeleteGroups(container);
+}
@@ -1,12 +1,14 @@
 #include <catch2/catch.hpp>
 #include "core/particle_group.h"
-#include "cinder/gl/gl.h"
+#include "glm/glm.hpp"
+#include <cmath>
 
+using idealgas::FindNamedColor;
 using idealgas::Particle;
 using idealgas::ParticleGroup;
 using glm::vec2;
 
-ParticleGroup* test_group = new ParticleGroup(2, 1, 1, "white", 100.0,100.0,1.0);
+ParticleGroup* test_group = new ParticleGroup(2, 1, 1, FindNamedColor("white"), 100.0,100.0,1.0, 0, 0);
 
 bool AreVectorsEqual(const vec2& first, const vec2& second) {
   return (double) first.x == Approx((double) second.x).epsilon(0.1) &&
@@ -29,8 +31,8 @@ TEST_CASE("Group of particles properly constructed based on given arguments") {
 }
 
 TEST_CASE("ParticleGroup updates all positions correctly based on velocities") {
-  Particle test_particle(vec2(50.0,50.0), vec2(0.4,0.5), 1, 1, "white");
-  Particle no_velocity_particle(vec2(20.0,20.0), vec2(0.0,0.0), 1, 1, "white");
+  Particle test_particle(vec2(50.0,50.0), vec2(0.4,0.5), 1, 1, FindNamedColor("white"));
+  Particle no_velocity_particle(vec2(20.0,20.0), vec2(0.0,0.0), 1, 1, FindNamedColor("white"));
 
   test_group->ClearParticles(); //clear particle(s) from previous test(s)
   test_group->AddParticle(test_particle);
@@ -51,7 +53,7 @@ TEST_CASE("ParticleGroup updates all positions correctly based on velocities") {
 TEST_CASE("Particles colliding into walls update velocities appropriately") {
   SECTION("Touching top wall") {
     SECTION("Moving away from wall does not collide") {
-      Particle test_particle(vec2(50.0,0.0), vec2(0.4,0.5), 1, 1, "white");
+      Particle test_particle(vec2(50.0,0.0), vec2(0.4,0.5), 1, 1, FindNamedColor("white"));
       test_group->ClearParticles(); //clear particle(s) from previous test(s)
       test_group->AddParticle(test_particle);
       test_group->HandlePossibleWallCollisions();
@@ -62,7 +64,7 @@ TEST_CASE("Particles colliding into walls update velocities appropriately") {
     }
 
     SECTION("Colliding w/ wall negates y component of velocity") {
-      Particle test_particle(vec2(50.0,0.0), vec2(0.4,-0.5), 1, 1, "white");
+      Particle test_particle(vec2(50.0,0.0), vec2(0.4,-0.5), 1, 1, FindNamedColor("white"));
       test_group->ClearParticles(); //clear particle(s) from previous test(s)
       test_group->AddParticle(test_particle);
       test_group->HandlePossibleWallCollisions();
@@ -75,7 +77,7 @@ TEST_CASE("Particles colliding into walls update velocities appropriately") {
 
   SECTION("Touching bottom wall") {
     SECTION("Moving away from wall does not collide") {
-      Particle test_particle(vec2(50.0,198.0), vec2(0.4,-0.5), 1, 1, "white");
+      Particle test_particle(vec2(50.0,198.0), vec2(0.4,-0.5), 1, 1, FindNamedColor("white"));
       test_group->ClearParticles(); //clear particle(s) from previous test(s)
       test_group->AddParticle(test_particle);
       test_group->HandlePossibleWallCollisions();
@@ -86,7 +88,7 @@ TEST_CASE("Particles colliding into walls update velocities appropriately") {
     }
 
     SECTION("Colliding w/ wall negates y component of velocity") {
-      Particle test_particle(vec2(50.0,198.0), vec2(0.4,0.5), 1, 1, "white");
+      Particle test_particle(vec2(50.0,198.0), vec2(0.4,0.5), 1, 1, FindNamedColor("white"));
       test_group->ClearParticles(); //clear particle(s) from previous test(s)
       test_group->AddParticle(test_particle);
       test_group->HandlePossibleWallCollisions();
@@ -99,7 +101,7 @@ TEST_CASE("Particles colliding into walls update velocities appropriately") {
 
   SECTION("Touching left wall") {
     SECTION("Moving away from wall does not collide") {
-      Particle test_particle(vec2(0.0,50.0), vec2(0.4,0.5), 1, 1, "white");
+      Particle test_particle(vec2(0.0,50.0), vec2(0.4,0.5), 1, 1, FindNamedColor("white"));
       test_group->ClearParticles(); //clear particle(s) from previous test(s)
       test_group->AddParticle(test_particle);
       test_group->HandlePossibleWallCollisions();
@@ -110,7 +112,7 @@ TEST_CASE("Particles colliding into walls update velocities appropriately") {
     }
 
     SECTION("Colliding w/ wall negates x component of velocity") {
-      Particle test_particle(vec2(0.0,50.0), vec2(-0.4,0.5), 1, 1, "white");
+      Particle test_particle(vec2(0.0,50.0), vec2(-0.4,0.5), 1, 1, FindNamedColor("white"));
       test_group->ClearParticles(); //clear particle(s) from previous test(s)
       test_group->AddParticle(test_particle);
       test_group->HandlePossibleWallCollisions();
@@ -123,7 +125,7 @@ TEST_CASE("Particles colliding into walls update velocities appropriately") {
 
   SECTION("Touching right wall") {
     SECTION("Moving away from wall does not collide") {
-      Particle test_particle(vec2(198.0,50.0), vec2(-0.4,0.5), 1, 1, "white");
+      Particle test_particle(vec2(198.0,50.0), vec2(-0.4,0.5), 1, 1, FindNamedColor("white"));
       test_group->ClearParticles(); //clear particle(s) from previous test(s)
       test_group->AddParticle(test_particle);
       test_group->HandlePossibleWallCollisions();
@@ -134,7 +136,7 @@ TEST_CASE("Particles colliding into walls update velocities appropriately") {
     }
 
     SECTION("Colliding w/ wall negates x component of velocity") {
-      Particle test_particle(vec2(198.0,50.0), vec2(0.4,0.5), 1, 1, "white");
+      Particle test_particle(vec2(198.0,50.0), vec2(0.4,0.5), 1, 1, FindNamedColor("white"));
       test_group->ClearParticles(); //clear particle(s) from previous test(s)
       test_group->AddParticle(test_particle);
       test_group->HandlePossibleWallCollisions();
@@ -144,4 +146,45 @@ TEST_CASE("Particles colliding into walls update velocities appropriately") {
                               vec2(-0.4,0.5)));
     }
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Seeded groups are reproducible for any thread count") {
+  ParticleGroup group(40000, 1, 1, FindNamedColor("white"), 100.0, 200.0, 3.0, 7, 2);
+  idealgas::WorkerPool pool(4);
+  ParticleGroup parallel_group(40000, 1, 1, FindNamedColor("white"), 100.0, 200.0, 3.0, 7, 2,
+                               &pool);
+
+  SECTION("Particles match when placed w/ several threads") {
+    for (size_t index = 0; index < group.GetGroupSize(); index++) {
+      REQUIRE(parallel_group.GetPositionAt(index) == group.GetPositionAt(index));
+      REQUIRE(parallel_group.GetVelocityAt(index) == group.GetVelocityAt(index));
+    }
+  }
+
+  SECTION("Particles are w/in limits and have their own velocities") {
+    for (size_t index = 0; index < group.GetGroupSize(); index++) {
+      vec2 position = group.GetPositionAt(index);
+      vec2 velocity = group.GetVelocityAt(index);
+      REQUIRE((position.x >= 0 && position.x <= 100.0));
+      REQUIRE((position.y >= 0 && position.y <= 200.0));
+      REQUIRE((std::abs(velocity.x) <= 3.0 && std::abs(velocity.y) <= 3.0));
+    }
+    REQUIRE_FALSE(group.GetVelocityAt(0) == group.GetVelocityAt(1));
+  }
+
+  SECTION("Other seeds and group numbers give other particles") {
+    ParticleGroup other_seed(1, 1, 1, FindNamedColor("white"), 100.0, 200.0, 3.0, 8, 2);
+    ParticleGroup other_number(1, 1, 1, FindNamedColor("white"), 100.0, 200.0, 3.0, 7, 3);
+    REQUIRE_FALSE(other_seed.GetPositionAt(0) == group.GetPositionAt(0));
+    REQUIRE_FALSE(other_number.GetPositionAt(0) == group.GetPositionAt(0));
+  }
+
+  SECTION("Particles placed one at a time match the group") {
+    ParticleGroup empty_group(0, 1, 1, FindNamedColor("white"), 100.0, 200.0, 3.0, 7, 2);
+    for (size_t index = 0; index < group.GetGroupSize(); index += 997) {
+      idealgas::Particle particle = empty_group.PlaceParticle(7, 2, index);
+      REQUIRE(particle.position == group.GetPositionAt(index));
+      REQUIRE(particle.velocity == group.GetVelocityAt(index));
+    }
+  }
+}
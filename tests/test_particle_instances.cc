@@ -0,0 +1,58 @@
+#include "core/particle_instances.h"
+#include <catch2/catch.hpp>
+#include <vector>
+
+using glm::vec2;
+using idealgas::FindNamedColor;
+using idealgas::InstanceBatch;
+using idealgas::Particle;
+using idealgas::ParticleGroup;
+using idealgas::ParticleInstancePacker;
+using std::vector;
+
+TEST_CASE("Particle instances are packed group after group") {
+  ParticleGroup small_group(0, 1, 2, FindNamedColor("yellow"), 100.0, 100.0, 1.0, 0, 0);
+  small_group.AddParticle(Particle(vec2(10.0,20.0), vec2(1.0,0), 1, 2,
+                                   FindNamedColor("yellow")));
+  small_group.AddParticle(Particle(vec2(30.0,40.0), vec2(0,1.0), 1, 2,
+                                   FindNamedColor("yellow")));
+  ParticleGroup big_group(0, 5, 10, FindNamedColor("cyan"), 100.0, 100.0, 1.0, 0, 0);
+  big_group.AddParticle(Particle(vec2(50.0,60.0), vec2(0,0), 5, 10, FindNamedColor("cyan")));
+  vector<ParticleGroup*> groups = {&small_group, &big_group};
+
+  ParticleInstancePacker packer;
+  REQUIRE(packer.UpdateBatches(groups));
+
+  SECTION("Every group gets its own range of instances") {
+    const vector<InstanceBatch>& batches = packer.GetBatches();
+    REQUIRE(packer.GetInstanceCount() == 3);
+    REQUIRE(batches.size() == 2);
+    REQUIRE(batches.at(0).first_instance == 0);
+    REQUIRE(batches.at(0).instance_count == 2);
+    REQUIRE(batches.at(0).radius == 2.0f);
+    REQUIRE(batches.at(1).first_instance == 2);
+    REQUIRE(batches.at(1).instance_count == 1);
+    REQUIRE(batches.at(1).radius == 10.0f);
+    REQUIRE(batches.at(1).color == FindNamedColor("cyan"));
+  }
+
+  SECTION("Instances are particle centers on the screen") {
+    vector<float> instances(packer.GetInstanceCount() *
+                            ParticleInstancePacker::kFloatsPerInstance);
+    packer.Pack(groups, vec2(100.0,200.0), instances.data());
+    vector<float> expected = {112.0f, 222.0f, 132.0f, 242.0f,
+                              160.0f, 270.0f};
+    REQUIRE(instances == expected);
+  }
+
+  SECTION("Layout only changes when group sizes do") {
+    REQUIRE_FALSE(packer.UpdateBatches(groups));
+    small_group.SetPositionAt(0, vec2(0,0));
+    REQUIRE_FALSE(packer.UpdateBatches(groups));
+    small_group.AddParticle(Particle(vec2(5.0,5.0), vec2(0,0), 1, 2,
+                                     FindNamedColor("yellow")));
+    REQUIRE(packer.UpdateBatches(groups));
+    REQUIRE(packer.GetBatches().at(1).first_instance == 3);
+    REQUIRE(packer.GetInstanceCount() == 4);
+  }
+}
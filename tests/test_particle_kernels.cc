@@ -0,0 +1,287 @@
+#include <catch2/catch.hpp>
+#include "core/particle_kernels.h"
+#include "core/particle_group.h"
+#include "core/particle_utils.h"
+#include "core/philox.h"
+#include <cmath>
+#include <vector>
+
+using idealgas::ParticleGroup;
+using idealgas::Particle;
+using idealgas::particlekernels::CollidePairs;
+using idealgas::particlekernels::CollisionArrays;
+using idealgas::particlekernels::KernelLevel;
+using idealgas::particlekernels::FindBestKernelLevel;
+using idealgas::particlekernels::ReflectAndAdvance;
+using idealgas::particlekernels::WrapAndAdvance;
+using idealgas::particleutils::CollideParticles;
+using idealgas::particleutils::ParticleCollisionExists;
+using idealgas::particleutils::ResolveParticleCollision;
+using idealgas::FindNamedColor;
+using glm::vec2;
+using std::vector;
+
+/**
+ * Positions and velocities of a small set of particles to run kernels on.
+ */
+struct KernelInput {
+  vector<float> x_positions;
+  vector<float> y_positions;
+  vector<float> x_velocities;
+  vector<float> y_velocities;
+};
+
+/**
+ * Makes an input w/ particles on, inside, and past every wall, moving in
+ * every direction. Count is not a multiple of 8 so leftover lanes are used.
+ */
+KernelInput MakeKernelInput() {
+  KernelInput input;
+  float coordinates[] = {-1.5f, 0.0f, 0.25f, 50.0f, 99.5f, 100.0f, 101.0f};
+  float velocities[] = {-0.75f, 0.0f, 0.5f};
+
+  for (float x: coordinates) {
+    for (float y: coordinates) {
+      for (float x_velocity: velocities) {
+        input.x_positions.push_back(x);
+        input.y_positions.push_back(y);
+        input.x_velocities.push_back(x_velocity);
+        input.y_velocities.push_back(-x_velocity);
+      }
+    }
+  }
+  return input;
+}
+
+double RunKernel(KernelLevel level, KernelInput& input) {
+  return ReflectAndAdvance(level, input.x_positions.data(), input.y_positions.data(),
+                    input.x_velocities.data(), input.y_velocities.data(),
+                    input.x_positions.size(), 100.0, 100.0);
+}
+
+TEST_CASE("Vectorized kernels match the scalar kernel") {
+  KernelInput expected = MakeKernelInput();
+  double expected_reflected_speed = RunKernel(KernelLevel::kScalar, expected);
+  REQUIRE(expected_reflected_speed > 0);
+
+  vector<KernelLevel> levels = {KernelLevel::kScalar};
+  if (FindBestKernelLevel() != KernelLevel::kScalar) {
+    levels.push_back(KernelLevel::kSse);
+  }
+  if (FindBestKernelLevel() == KernelLevel::kAvx2) {
+    levels.push_back(KernelLevel::kAvx2);
+  }
+
+  for (KernelLevel level: levels) {
+    KernelInput actual = MakeKernelInput();
+    double reflected_speed = RunKernel(level, actual);
+
+    REQUIRE(reflected_speed == Approx(expected_reflected_speed));
+
+    REQUIRE(actual.x_positions == expected.x_positions);
+    REQUIRE(actual.y_positions == expected.y_positions);
+    REQUIRE(actual.x_velocities == expected.x_velocities);
+    REQUIRE(actual.y_velocities == expected.y_velocities);
+  }
+}
+
+TEST_CASE("Fused advance matches separate wall collisions and position updates") {
+  KernelInput input = MakeKernelInput();
+  ParticleGroup separate_group(0, 1, 1, FindNamedColor("white"), 100.0, 100.0, 1.0, 0, 0);
+  ParticleGroup fused_group(0, 1, 1, FindNamedColor("white"), 100.0, 100.0, 1.0, 0, 0);
+  for (size_t index = 0; index < input.x_positions.size(); index++) {
+    Particle particle(vec2(input.x_positions[index], input.y_positions[index]),
+                      vec2(input.x_velocities[index], input.y_velocities[index]),
+                      1, 1, FindNamedColor("white"));
+    separate_group.AddParticle(particle);
+    fused_group.AddParticle(particle);
+  }
+
+  vector<vec2> velocities;
+  for (size_t index = 0; index < input.x_positions.size(); index++) {
+    velocities.push_back(separate_group.GetVelocityAt(index));
+  }
+  separate_group.HandlePossibleWallCollisions();
+  separate_group.UpdatePositions();
+  double impulse = fused_group.AdvanceWithWallCollisions();
+
+  //walls give back twice every reversed velocity component, times the mass
+  double expected_impulse = 0;
+  for (size_t index = 0; index < input.x_positions.size(); index++) {
+    vec2 reflected_velocity = separate_group.GetVelocityAt(index);
+    if (reflected_velocity.x != velocities[index].x) {
+      expected_impulse += 2.0 * std::abs(velocities[index].x);
+    }
+    if (reflected_velocity.y != velocities[index].y) {
+      expected_impulse += 2.0 * std::abs(velocities[index].y);
+    }
+  }
+  REQUIRE(expected_impulse > 0);
+  REQUIRE(impulse == Approx(expected_impulse));
+
+  for (size_t index = 0; index < input.x_positions.size(); index++) {
+    REQUIRE(fused_group.GetPositionAt(index) ==
+            separate_group.GetPositionAt(index));
+    REQUIRE(fused_group.GetVelocityAt(index) ==
+            separate_group.GetVelocityAt(index));
+  }
+}
+
+TEST_CASE("Vectorized wrapping kernels match the scalar kernel") {
+  KernelInput expected = MakeKernelInput();
+  WrapAndAdvance(KernelLevel::kScalar, expected.x_positions.data(),
+                 expected.y_positions.data(), expected.x_velocities.data(),
+                 expected.y_velocities.data(), expected.x_positions.size(),
+                 100.0, 100.0);
+
+  //every particle ends up inside the container w/ its velocity unchanged
+  KernelInput input = MakeKernelInput();
+  for (size_t index = 0; index < expected.x_positions.size(); index++) {
+    REQUIRE(expected.x_positions[index] >= 0.0f);
+    REQUIRE(expected.x_positions[index] < 100.0f);
+    REQUIRE(expected.y_positions[index] >= 0.0f);
+    REQUIRE(expected.y_positions[index] < 100.0f);
+  }
+  REQUIRE(expected.x_velocities == input.x_velocities);
+  REQUIRE(expected.y_velocities == input.y_velocities);
+  REQUIRE(expected.x_positions[0] == Approx(97.75));
+
+  vector<KernelLevel> levels;
+  if (FindBestKernelLevel() != KernelLevel::kScalar) {
+    levels.push_back(KernelLevel::kSse);
+  }
+  if (FindBestKernelLevel() == KernelLevel::kAvx2) {
+    levels.push_back(KernelLevel::kAvx2);
+  }
+
+  for (KernelLevel level: levels) {
+    KernelInput actual = MakeKernelInput();
+    WrapAndAdvance(level, actual.x_positions.data(), actual.y_positions.data(),
+                   actual.x_velocities.data(), actual.y_velocities.data(),
+                   actual.x_positions.size(), 100.0, 100.0);
+    REQUIRE(actual.x_positions == expected.x_positions);
+    REQUIRE(actual.y_positions == expected.y_positions);
+  }
+}
+
+/**
+ * Makes particles of two types crowded into a small box, placed and moving
+ * at random, so many pairs touch.
+ */
+vector<Particle> MakeCrowdedParticles(size_t count) {
+  vector<Particle> particles;
+  uint32_t random_block[4];
+  for (size_t index = 0; index < count; index++) {
+    idealgas::philox::GenerateBlock(3, index, 0, random_block);
+    vec2 position(60.0 * idealgas::philox::ToUnitInterval(random_block[0]),
+                  60.0 * idealgas::philox::ToUnitInterval(random_block[1]));
+    vec2 velocity(
+        4.0 * idealgas::philox::ToUnitInterval(random_block[2]) - 2.0,
+        4.0 * idealgas::philox::ToUnitInterval(random_block[3]) - 2.0);
+    if (index % 3 == 0) {
+      particles.push_back(Particle(position, velocity, 5, 10, FindNamedColor("magenta")));
+    } else {
+      particles.push_back(Particle(position, velocity, 2, 5, FindNamedColor("yellow")));
+    }
+  }
+  return particles;
+}
+
+TEST_CASE("Fused pair collisions match checking and resolving separately") {
+  vector<Particle> particles = MakeCrowdedParticles(60);
+  size_t collision_count = 0;
+  for (size_t index = 0; index < particles.size(); index++) {
+    for (size_t other_index = 0; other_index < index; other_index++) {
+      Particle separate_first = particles[index];
+      Particle separate_second = particles[other_index];
+      Particle fused_first = particles[index];
+      Particle fused_second = particles[other_index];
+
+      bool colliding = ParticleCollisionExists(separate_first,
+                                               separate_second);
+      if (colliding) {
+        ResolveParticleCollision(separate_first, separate_second);
+        collision_count++;
+      }
+      REQUIRE(CollideParticles(fused_first, fused_second) == colliding);
+      REQUIRE(fused_first.velocity.x ==
+              Approx(separate_first.velocity.x).margin(0.0001));
+      REQUIRE(fused_first.velocity.y ==
+              Approx(separate_first.velocity.y).margin(0.0001));
+      REQUIRE(fused_second.velocity.x ==
+              Approx(separate_second.velocity.x).margin(0.0001));
+      REQUIRE(fused_second.velocity.y ==
+              Approx(separate_second.velocity.y).margin(0.0001));
+    }
+  }
+  //make sure the crowd actually tested collisions
+  REQUIRE(collision_count > 20);
+}
+
+TEST_CASE("Batched pair collisions match colliding pairs in order") {
+  vector<Particle> particles = MakeCrowdedParticles(60);
+  vector<size_t> first_particles;
+  vector<size_t> second_particles;
+
+  SECTION("Pairs w/ shared particles") {
+    for (size_t index = 0; index < particles.size(); index++) {
+      for (size_t other_index = 0; other_index < index; other_index++) {
+        first_particles.push_back(index);
+        second_particles.push_back(other_index);
+      }
+    }
+  }
+
+  SECTION("Runs of pairs w/o shared particles") {
+    for (size_t offset = 1; offset < particles.size() / 2; offset++) {
+      for (size_t index = 0; index + offset < particles.size();
+           index += 2 * offset) {
+        first_particles.push_back(index + offset);
+        second_particles.push_back(index);
+      }
+    }
+  }
+
+  //one pair at a time w/ the fused particle kernel
+  vector<Particle> expected = particles;
+  size_t expected_collisions = 0;
+  for (size_t pair = 0; pair < first_particles.size(); pair++) {
+    if (CollideParticles(expected[first_particles[pair]],
+                         expected[second_particles[pair]])) {
+      expected_collisions++;
+    }
+  }
+  REQUIRE(expected_collisions > 0);
+
+  vector<KernelLevel> levels = {KernelLevel::kScalar};
+  if (FindBestKernelLevel() != KernelLevel::kScalar) {
+    levels.push_back(KernelLevel::kSse);
+  }
+  if (FindBestKernelLevel() == KernelLevel::kAvx2) {
+    levels.push_back(KernelLevel::kAvx2);
+  }
+
+  for (KernelLevel level: levels) {
+    vector<float> x_positions, y_positions, x_velocities, y_velocities;
+    vector<float> masses, radii;
+    for (const Particle& particle: particles) {
+      x_positions.push_back(particle.position.x);
+      y_positions.push_back(particle.position.y);
+      x_velocities.push_back(particle.velocity.x);
+      y_velocities.push_back(particle.velocity.y);
+      masses.push_back((float) particle.mass);
+      radii.push_back((float) particle.radius);
+    }
+    CollisionArrays arrays = {x_positions.data(), y_positions.data(),
+                              x_velocities.data(), y_velocities.data(),
+                              masses.data(), radii.data()};
+
+    REQUIRE(CollidePairs(level, arrays, first_particles.data(),
+                         second_particles.data(), first_particles.size()) ==
+            expected_collisions);
+    for (size_t index = 0; index < particles.size(); index++) {
+      REQUIRE(x_velocities[index] == expected[index].velocity.x);
+      REQUIRE(y_velocities[index] == expected[index].velocity.y);
+    }
+  }
+}
@@ -0,0 +1,41 @@
+#include <catch2/catch.hpp>
+#include "core/philox.h"
+#include <cstdint>
+
+using idealgas::philox::GenerateBlock;
+using idealgas::philox::ToUnitInterval;
+
+TEST_CASE("Philox matches the reference generator") {
+  uint32_t output[4];
+
+  SECTION("Zero key and counter") {
+    GenerateBlock(0, 0, 0, output);
+    REQUIRE(output[0] == 0x6627e8d5);
+    REQUIRE(output[1] == 0xe169c58d);
+    REQUIRE(output[2] == 0xbc57ac4c);
+    REQUIRE(output[3] == 0x9b00dbd8);
+  }
+
+  SECTION("All bits set in key and counter") {
+    GenerateBlock(~uint64_t(0), ~uint64_t(0), ~uint64_t(0), output);
+    REQUIRE(output[0] == 0x408f276d);
+    REQUIRE(output[1] == 0x41c83b0e);
+    REQUIRE(output[2] == 0xa20bc7c6);
+    REQUIRE(output[3] == 0x6d5451fd);
+  }
+
+  SECTION("Digits of pi as key and counter") {
+    GenerateBlock(0x299f31d0a4093822, 0x85a308d3243f6a88, 0x0370734413198a2e,
+                  output);
+    REQUIRE(output[0] == 0xd16cfe09);
+    REQUIRE(output[1] == 0x94fdcceb);
+    REQUIRE(output[2] == 0x5001e420);
+    REQUIRE(output[3] == 0x24126ea1);
+  }
+}
+
+TEST_CASE("Random bits turn into doubles in [0, 1)") {
+  REQUIRE(ToUnitInterval(0) == 0.0);
+  REQUIRE(ToUnitInterval(0x80000000) == 0.5);
+  REQUIRE(ToUnitInterval(0xffffffff) < 1.0);
+}
@@ -0,0 +1,309 @@
+#include "core/precise_gas_container.h"
+#include "core/precise_particle.h"
+#include "core/particle_utils.h"
+#include "core/philox.h"
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using glm::vec2;
+using idealgas::FindNamedColor;
+using idealgas::FixedPoint32Precision;
+using idealgas::Float32Precision;
+using idealgas::Float64Precision;
+using idealgas::Particle;
+using idealgas::ParticleGroup;
+using idealgas::PreciseGasContainer;
+using idealgas::PreciseParticle;
+using std::vector;
+
+namespace particleutils = idealgas::particleutils;
+
+TEST_CASE("Fixed point numbers round and saturate the same everywhere") {
+  typedef FixedPoint32Precision Fixed;
+
+  SECTION("Converting from double rounds to the nearest step") {
+    REQUIRE(Fixed::FromDouble(1.5) == 98304);
+    REQUIRE(Fixed::FromDouble(-1.5) == -98304);
+    REQUIRE(Fixed::ToDouble(Fixed::FromDouble(0.1)) == Approx(0.1)
+            .margin(1.0 / 65536));
+  }
+
+  SECTION("Products and quotients truncate towards zero") {
+    REQUIRE(Fixed::Multiply(Fixed::FromDouble(1.5), Fixed::FromDouble(-2.0))
+            == Fixed::FromDouble(-3.0));
+    REQUIRE(Fixed::Divide(Fixed::FromDouble(1.0), Fixed::FromDouble(3.0))
+            == 21845);
+    REQUIRE(Fixed::Divide(Fixed::FromDouble(-1.0), Fixed::FromDouble(3.0))
+            == -21845);
+  }
+
+  SECTION("Quotients too large to represent saturate") {
+    REQUIRE(Fixed::Divide(Fixed::FromDouble(30000.0), 1) ==
+            std::numeric_limits<int32_t>::max());
+    REQUIRE(Fixed::Divide(Fixed::FromDouble(-30000.0), 1) ==
+            std::numeric_limits<int32_t>::min());
+  }
+
+  SECTION("Conversions and products too large to represent saturate") {
+    REQUIRE(Fixed::FromDouble(1e12) == std::numeric_limits<int32_t>::max());
+    REQUIRE(Fixed::FromDouble(-1e12) == std::numeric_limits<int32_t>::min());
+    REQUIRE(Fixed::FromDouble(std::nan("")) == 0);
+    REQUIRE(Fixed::Multiply(Fixed::FromDouble(300.0), Fixed::FromDouble(300.0))
+            == std::numeric_limits<int32_t>::max());
+    REQUIRE(Fixed::Multiply(Fixed::FromDouble(-300.0), Fixed::FromDouble(300.0))
+            == std::numeric_limits<int32_t>::min());
+  }
+
+  SECTION("Sums and differences too large to represent saturate") {
+    REQUIRE(Fixed::Add(Fixed::FromDouble(1.5), Fixed::FromDouble(-2.0)) ==
+            Fixed::FromDouble(-0.5));
+    REQUIRE(Fixed::Add(Fixed::FromDouble(30000.0), Fixed::FromDouble(30000.0))
+            == std::numeric_limits<int32_t>::max());
+    REQUIRE(Fixed::Subtract(Fixed::FromDouble(-30000.0),
+                            Fixed::FromDouble(30000.0)) ==
+            std::numeric_limits<int32_t>::min());
+    REQUIRE(Fixed::Subtract(0, std::numeric_limits<int32_t>::min()) ==
+            std::numeric_limits<int32_t>::max());
+  }
+
+  SECTION("Particles moving past the largest position saturate") {
+    PreciseParticle<Fixed> particle = PreciseParticle<Fixed>::FromParticle(
+        Particle(vec2(32767.5,0), vec2(0.9,0), 1, 1, FindNamedColor("white")));
+    particleutils::ReflectAndAdvance(&particle, 1,
+                                     std::numeric_limits<int32_t>::max(),
+                                     std::numeric_limits<int32_t>::max());
+    REQUIRE(particle.x_position == std::numeric_limits<int32_t>::max());
+  }
+
+  SECTION("Touching is exact even when squares don't fit in a scalar") {
+    //300 squared is far beyond the 32768 a scalar holds
+    PreciseParticle<Fixed> first = PreciseParticle<Fixed>::FromParticle(
+        Particle(vec2(0,0), vec2(0,0), 1, 200, FindNamedColor("white")));
+    PreciseParticle<Fixed> second = first;
+    second.x_position = Fixed::FromDouble(300.0);
+    second.y_position = Fixed::FromDouble(200.0);
+    REQUIRE(particleutils::ParticlesTouching(first, second));
+    second.y_position = Fixed::FromDouble(265.0);
+    REQUIRE_FALSE(particleutils::ParticlesTouching(first, second));
+  }
+
+  SECTION("Wide quotients keep 32 fraction bits and narrow w/ saturation") {
+    //380 * 190 and 190 squared both have 32 fraction bits
+    int64_t numerator = Fixed::MultiplyWide(Fixed::FromDouble(380.0),
+                                            Fixed::FromDouble(190.0));
+    int64_t denominator = Fixed::MultiplyWide(Fixed::FromDouble(190.0),
+                                              Fixed::FromDouble(190.0));
+    int64_t quotient = Fixed::DivideWide(-numerator, denominator);
+    REQUIRE(quotient == -((int64_t) 2 << 32));
+    REQUIRE(Fixed::NarrowProduct(quotient, Fixed::FromDouble(1.5)) ==
+            Fixed::FromDouble(-3.0));
+    REQUIRE(Fixed::NarrowProduct(quotient, Fixed::FromDouble(30000.0)) ==
+            std::numeric_limits<int32_t>::min());
+    REQUIRE(Fixed::DivideWide(numerator, 1) ==
+            std::numeric_limits<int64_t>::max());
+  }
+}
+
+/**
+ * Sums the kinetic energy of precise particles in doubles.
+ */
+template <typename Precision>
+double SumKineticEnergy(const vector<PreciseParticle<Precision>>& particles) {
+  double energy = 0;
+  for (const PreciseParticle<Precision>& particle: particles) {
+    double x_velocity = Precision::ToDouble(particle.x_velocity);
+    double y_velocity = Precision::ToDouble(particle.y_velocity);
+    energy += 0.5 * Precision::ToDouble(particle.mass) *
+              (x_velocity * x_velocity + y_velocity * y_velocity);
+  }
+  return energy;
+}
+
+TEMPLATE_TEST_CASE("Precise particles collide like particles", "",
+                   Float32Precision, Float64Precision, FixedPoint32Precision) {
+  typedef PreciseParticle<TestType> Precise;
+
+  SECTION("Equal masses colliding head on swap velocities") {
+    Precise first = Precise::FromParticle(
+        Particle(vec2(50.0,50.0), vec2(1.0,0), 1, 1, FindNamedColor("white")));
+    Precise second = Precise::FromParticle(
+        Particle(vec2(51.5,50.0), vec2(-1.0,0), 1, 1, FindNamedColor("white")));
+    REQUIRE(particleutils::ParticleCollisionExists(first, second));
+    particleutils::ResolveParticleCollision(first, second);
+    REQUIRE(TestType::ToDouble(first.x_velocity) ==
+            Approx(-1.0).margin(0.001));
+    REQUIRE(TestType::ToDouble(second.x_velocity) ==
+            Approx(1.0).margin(0.001));
+    REQUIRE(TestType::ToDouble(first.y_velocity) ==
+            Approx(0.0).margin(0.001));
+  }
+
+  SECTION("Large particles keep their speed and momentum") {
+    //190 squared is far beyond the 32768 a fixed point scalar holds
+    Precise first = Precise::FromParticle(
+        Particle(vec2(200.0,200.0), vec2(1.0,0), 1, 100, FindNamedColor("white")));
+    Precise second = Precise::FromParticle(
+        Particle(vec2(390.0,200.0), vec2(-1.0,0), 1, 100, FindNamedColor("white")));
+    particleutils::ResolveParticleCollision(first, second);
+    REQUIRE(TestType::ToDouble(first.x_velocity) ==
+            Approx(-1.0).margin(0.001));
+    REQUIRE(TestType::ToDouble(second.x_velocity) ==
+            Approx(1.0).margin(0.001));
+
+    //glancing blow between unequal masses
+    first = Precise::FromParticle(
+        Particle(vec2(200.0,200.0), vec2(1.5,0.5), 2, 100, FindNamedColor("white")));
+    second = Precise::FromParticle(
+        Particle(vec2(350.0,310.0), vec2(-1.0,-0.75), 3, 90, FindNamedColor("white")));
+    vector<Precise> particles = {first, second};
+    double energy = SumKineticEnergy(particles);
+    particleutils::ResolveParticleCollision(particles[0], particles[1]);
+    REQUIRE(SumKineticEnergy(particles) == Approx(energy).margin(0.001));
+    REQUIRE(2 * TestType::ToDouble(particles[0].x_velocity) +
+            3 * TestType::ToDouble(particles[1].x_velocity) ==
+            Approx(2 * 1.5 + 3 * -1.0).margin(0.001));
+    REQUIRE(2 * TestType::ToDouble(particles[0].y_velocity) +
+            3 * TestType::ToDouble(particles[1].y_velocity) ==
+            Approx(2 * 0.5 + 3 * -0.75).margin(0.001));
+  }
+
+  SECTION("Particles moving apart or far away don't collide") {
+    Precise first = Precise::FromParticle(
+        Particle(vec2(50.0,50.0), vec2(-1.0,0), 1, 1, FindNamedColor("white")));
+    Precise second = Precise::FromParticle(
+        Particle(vec2(51.5,50.0), vec2(1.0,0), 1, 1, FindNamedColor("white")));
+    Precise far = Precise::FromParticle(
+        Particle(vec2(30000.0,-30000.0), vec2(-1.0,1.0), 1, 1, FindNamedColor("white")));
+    REQUIRE(particleutils::ParticlesTouching(first, second));
+    REQUIRE_FALSE(particleutils::ParticleCollisionExists(first, second));
+    REQUIRE_FALSE(particleutils::ParticlesTouching(first, far));
+  }
+
+  SECTION("Velocities match the float particle kernels") {
+    uint32_t random_block[4];
+    for (uint32_t pair = 0; pair < 100; pair++) {
+      idealgas::philox::GenerateBlock(5, pair, 0, random_block);
+      double angle = 6.28 * idealgas::philox::ToUnitInterval(random_block[0]);
+      double distance = 6.0 + 8.0 * idealgas::philox::ToUnitInterval(
+                                        random_block[1]);
+      Particle first(vec2(100.0,100.0), vec2(1.5,-0.5), 5, 10, FindNamedColor("white"));
+      Particle second(vec2(100.0 + distance * std::cos(angle),
+                           100.0 + distance * std::sin(angle)),
+                      vec2(-0.25,2.0), 2, 5, FindNamedColor("white"));
+      Precise precise_first = Precise::FromParticle(first);
+      Precise precise_second = Precise::FromParticle(second);
+
+      REQUIRE(particleutils::ParticleCollisionExists(first, second) ==
+              particleutils::ParticleCollisionExists(precise_first,
+                                                     precise_second));
+      particleutils::ResolveParticleCollision(first, second);
+      particleutils::ResolveParticleCollision(precise_first, precise_second);
+      REQUIRE(TestType::ToDouble(precise_first.x_velocity) ==
+              Approx(first.velocity.x).margin(0.001));
+      REQUIRE(TestType::ToDouble(precise_first.y_velocity) ==
+              Approx(first.velocity.y).margin(0.001));
+      REQUIRE(TestType::ToDouble(precise_second.x_velocity) ==
+              Approx(second.velocity.x).margin(0.001));
+      REQUIRE(TestType::ToDouble(precise_second.y_velocity) ==
+              Approx(second.velocity.y).margin(0.001));
+    }
+  }
+
+  SECTION("Particles moving into a wall bounce before moving") {
+    vector<Precise> particles = {
+        Precise::FromParticle(Particle(vec2(0,50.0), vec2(-1.0,0.5), 1, 1,
+                                       FindNamedColor("white"))),
+        Precise::FromParticle(Particle(vec2(50.0,99.0), vec2(1.0,2.0), 1, 1,
+                                       FindNamedColor("white")))};
+    particleutils::ReflectAndAdvance(particles.data(), particles.size(),
+                                     TestType::FromDouble(99.0),
+                                     TestType::FromDouble(99.0));
+    REQUIRE(TestType::ToDouble(particles[0].x_position) ==
+            Approx(1.0).margin(0.001));
+    REQUIRE(TestType::ToDouble(particles[0].y_position) ==
+            Approx(50.5).margin(0.001));
+    REQUIRE(TestType::ToDouble(particles[1].x_position) ==
+            Approx(51.0).margin(0.001));
+    REQUIRE(TestType::ToDouble(particles[1].y_position) ==
+            Approx(97.0).margin(0.001));
+  }
+}
+
+TEMPLATE_TEST_CASE("Precise gas containers step particles", "",
+                   Float32Precision, Float64Precision, FixedPoint32Precision) {
+  typedef PreciseParticle<TestType> Precise;
+
+  SECTION("Equal masses colliding head on swap velocities") {
+    ParticleGroup group(0,1,1,FindNamedColor("white"),98.0,98.0,1.0,0,0);
+    group.AddParticle(Particle(vec2(50.0,50.0), vec2(1.0,0), 1, 1,
+                               FindNamedColor("white")));
+    group.AddParticle(Particle(vec2(51.5,50.0), vec2(-1.0,0), 1, 1,
+                               FindNamedColor("white")));
+    vector<ParticleGroup*> groups = {&group};
+    PreciseGasContainer<TestType> container(groups);
+    container.Update();
+    container.StoreInGroups(groups);
+    REQUIRE(group.GetVelocityAt(0).x == Approx(-1.0).margin(0.001));
+    REQUIRE(group.GetVelocityAt(1).x == Approx(1.0).margin(0.001));
+    REQUIRE(group.GetPositionAt(0).x == Approx(49.0).margin(0.001));
+    REQUIRE(group.GetPositionAt(1).x == Approx(52.5).margin(0.001));
+  }
+
+  SECTION("Touching pairs are resolved in order of particle index") {
+    //in x order, the pair of particles 1 and 2 would be resolved first
+    ParticleGroup group(0,1,1,FindNamedColor("white"),98.0,98.0,1.0,0,0);
+    group.AddParticle(Particle(vec2(53.0,50.0), vec2(-1.0,0), 1, 1,
+                               FindNamedColor("white")));
+    group.AddParticle(Particle(vec2(51.5,50.0), vec2(0,0), 1, 1,
+                               FindNamedColor("white")));
+    group.AddParticle(Particle(vec2(50.0,50.0), vec2(1.0,0), 1, 1,
+                               FindNamedColor("white")));
+    vector<ParticleGroup*> groups = {&group};
+    PreciseGasContainer<TestType> container(groups);
+    container.Update();
+    container.StoreInGroups(groups);
+    REQUIRE(group.GetVelocityAt(0).x == Approx(0).margin(0.001));
+    REQUIRE(group.GetVelocityAt(1).x == Approx(1.0).margin(0.001));
+    REQUIRE(group.GetVelocityAt(2).x == Approx(-1.0).margin(0.001));
+  }
+
+  SECTION("Particles stay inside the walls and keep their energy") {
+    ParticleGroup* small_group = new ParticleGroup(150,1,2,FindNamedColor("white"),196.0,196.0,2.0,0,0);
+    ParticleGroup* big_group = new ParticleGroup(20,5,6,FindNamedColor("red"),188.0,188.0,1.0,0,1);
+    vector<ParticleGroup*> groups = {small_group, big_group, small_group};
+    PreciseGasContainer<TestType> container(groups);
+    REQUIRE(container.GetParticles().size() == 170);
+
+    double start_energy = SumKineticEnergy(container.GetParticles());
+    for (size_t step = 0; step < 200; step++) {
+      container.Update();
+    }
+    REQUIRE(SumKineticEnergy(container.GetParticles()) ==
+            Approx(start_energy).epsilon(0.01));
+    for (const Precise& particle: container.GetParticles()) {
+      REQUIRE(TestType::ToDouble(particle.x_position) >= -10.0);
+      REQUIRE(TestType::ToDouble(particle.x_position) <= 206.0);
+      REQUIRE(TestType::ToDouble(particle.y_position) >= -10.0);
+      REQUIRE(TestType::ToDouble(particle.y_position) <= 206.0);
+    }
+
+    //stepping the same particles again gives the same bits
+    container.StoreInGroups(groups);
+    PreciseGasContainer<TestType> first_copy(groups);
+    PreciseGasContainer<TestType> second_copy(groups);
+    for (size_t step = 0; step < 50; step++) {
+      first_copy.Update();
+      second_copy.Update();
+    }
+    for (size_t index = 0; index < 170; index++) {
+      REQUIRE(first_copy.GetParticles()[index].x_position ==
+              second_copy.GetParticles()[index].x_position);
+      REQUIRE(first_copy.GetParticles()[index].y_velocity ==
+              second_copy.GetParticles()[index].y_velocity);
+    }
+    delete small_group;
+    delete big_group;
+  }
+}
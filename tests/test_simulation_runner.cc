@@ -0,0 +1,210 @@
+#include "core/simulation_runner.h"
+#include "core/snapshot_buffer.h"
+#include "test_containers.h"
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using glm::vec2;
+using idealgas::FindNamedColor;
+using idealgas::GasContainer;
+using idealgas::Particle;
+using idealgas::ParticleGroup;
+using idealgas::SimulationRunner;
+using idealgas::SnapshotBuffer;
+using std::vector;
+
+namespace {
+
+/**
+ * Makes a container w/ the visualizer's small and big particles.
+ */
+GasContainer CreateRunnerContainer() {
+  return CreateTestContainer(100, 15, 15, 10, 300, 7);
+}
+
+/**
+ * Makes empty groups w/ the same types as the container's groups.
+ */
+vector<ParticleGroup> CreateDisplayGroups(const GasContainer& container) {
+  vector<ParticleGroup> display_groups;
+  for (ParticleGroup* group: container.GetParticleGroups()) {
+    display_groups.push_back(ParticleGroup(
+        0, group->GetParticleMass(), group->GetParticleRadius(),
+        group->GetGroupColor(), group->GetMaxXPosition(),
+        group->GetMaxYPosition(), 1.0, 0, 0));
+  }
+  return display_groups;
+}
+
+bool AreGroupsEqual(const vector<ParticleGroup*>& first,
+                    const vector<ParticleGroup*>& second) {
+  if (first.size() != second.size()) {
+    return false;
+  }
+  for (size_t group = 0; group < first.size(); group++) {
+    if (first[group]->GetGroupSize() != second[group]->GetGroupSize()) {
+      return false;
+    }
+    for (size_t index = 0; index < first[group]->GetGroupSize(); index++) {
+      if (first[group]->GetPositionAt(index) !=
+              second[group]->GetPositionAt(index) ||
+          first[group]->GetVelocityAt(index) !=
+              second[group]->GetVelocityAt(index)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+TEST_CASE("Snapshot buffer hands the latest snapshot to the reader") {
+  ParticleGroup group(0, 1, 1, FindNamedColor("white"), 100.0, 100.0, 1.0, 0, 0);
+  group.AddParticle(Particle(vec2(1.0,2.0), vec2(3.0,4.0), 1, 1, FindNamedColor("white")));
+  vector<ParticleGroup*> groups = {&group};
+  ParticleGroup read_group(0, 1, 1, FindNamedColor("white"), 100.0, 100.0, 1.0, 0, 0);
+  vector<ParticleGroup*> read_groups = {&read_group};
+  SnapshotBuffer snapshots;
+
+  SECTION("Nothing is read before anything is published") {
+    REQUIRE(snapshots.IsLatestTaken());
+    REQUIRE_FALSE(snapshots.ReadLatest(read_groups));
+    REQUIRE(read_group.GetGroupSize() == 0);
+  }
+
+  SECTION("A published snapshot is read once") {
+    snapshots.Publish(groups, 1);
+    REQUIRE_FALSE(snapshots.IsLatestTaken());
+    REQUIRE(snapshots.ReadLatest(read_groups));
+    REQUIRE(snapshots.IsLatestTaken());
+    REQUIRE(snapshots.GetReadStep() == 1);
+    REQUIRE(AreGroupsEqual(groups, read_groups));
+    REQUIRE_FALSE(snapshots.ReadLatest(read_groups));
+  }
+
+  SECTION("Only the newest of several snapshots is read") {
+    snapshots.Publish(groups, 1);
+    group.SetPositionAt(0, vec2(5.0,6.0));
+    snapshots.Publish(groups, 2);
+    group.SetPositionAt(0, vec2(7.0,8.0));
+    snapshots.Publish(groups, 3);
+    REQUIRE(snapshots.ReadLatest(read_groups));
+    REQUIRE(snapshots.GetReadStep() == 3);
+    REQUIRE(read_group.GetPositionAt(0) == vec2(7.0,8.0));
+  }
+
+  SECTION("Publishing while the reader holds a snapshot leaves it intact") {
+    snapshots.Publish(groups, 1);
+    REQUIRE(snapshots.ReadLatest(read_groups));
+    for (size_t step = 2; step < 10; step++) {
+      group.SetPositionAt(0, vec2((float) step, 0));
+      snapshots.Publish(groups, step);
+    }
+    REQUIRE(snapshots.GetReadStep() == 1);
+    REQUIRE(snapshots.ReadLatest(read_groups));
+    REQUIRE(snapshots.GetReadStep() == 9);
+    REQUIRE(read_group.GetPositionAt(0) == vec2(9.0,0));
+  }
+}
+
+TEST_CASE("Simulation runner steps a container on its own thread") {
+  GasContainer container = CreateRunnerContainer();
+  vector<ParticleGroup> display_groups = CreateDisplayGroups(container);
+  vector<ParticleGroup*> display_group_list;
+  for (ParticleGroup& group: display_groups) {
+    display_group_list.push_back(&group);
+  }
+
+  SECTION("The starting particles can be read before stepping") {
+    SimulationRunner runner(&container);
+    REQUIRE(runner.ReadLatest(display_group_list));
+    REQUIRE(runner.GetReadStep() == 0);
+    REQUIRE(AreGroupsEqual(display_group_list,
+                           container.GetParticleGroups()));
+  }
+
+  SECTION("Stepping flat out matches stepping in place") {
+    SimulationRunner runner(&container);
+    runner.Start(SimulationRunner::kUnlimitedSteps);
+    REQUIRE(runner.IsRunning());
+    while (runner.GetStepCount() < 50) {
+      runner.ReadLatest(display_group_list);
+      std::this_thread::yield();
+    }
+    runner.Stop();
+    REQUIRE_FALSE(runner.IsRunning());
+
+    //the last step is always published when stopping
+    REQUIRE(runner.ReadLatest(display_group_list));
+    REQUIRE(runner.GetReadStep() == runner.GetStepCount());
+    REQUIRE(AreGroupsEqual(display_group_list,
+                           container.GetParticleGroups()));
+
+    GasContainer reference_container = CreateRunnerContainer();
+    for (size_t step = 0; step < runner.GetStepCount(); step++) {
+      reference_container.Update();
+    }
+    REQUIRE(AreGroupsEqual(display_group_list,
+                           reference_container.GetParticleGroups()));
+    DeleteGroups(reference_container);
+  }
+
+  SECTION("Queued changes are made between steps") {
+    SimulationRunner runner(&container);
+    runner.Start(SimulationRunner::kUnlimitedSteps);
+    while (runner.GetStepCount() < 10) {
+      std::this_thread::yield();
+    }
+    //written by the stepping thread
+    std::atomic<size_t> changed_step(0);
+    std::atomic<bool> is_changed(false);
+    runner.QueueChange([&](GasContainer& stepped) {
+      changed_step = runner.GetStepCount();
+      stepped.SetSortInterval(1);
+      is_changed = true;
+    });
+    while (!is_changed || runner.GetStepCount() < changed_step + 20) {
+      std::this_thread::yield();
+    }
+    runner.Stop();
+    REQUIRE(changed_step >= 10);
+
+    //reordering particles from the step the change was made at gives the
+    //same particles as a container changed at that step in place
+    GasContainer reference_container = CreateRunnerContainer();
+    for (size_t step = 0; step < runner.GetStepCount(); step++) {
+      if (step == changed_step) {
+        reference_container.SetSortInterval(1);
+      }
+      reference_container.Update();
+    }
+    REQUIRE(container.GetSortCount() == reference_container.GetSortCount());
+    REQUIRE(AreGroupsEqual(container.GetParticleGroups(),
+                           reference_container.GetParticleGroups()));
+    DeleteGroups(reference_container);
+  }
+
+  SECTION("Changes are made right away when not running") {
+    SimulationRunner runner(&container);
+    bool changed = false;
+    runner.QueueChange([&changed](GasContainer&) {
+      changed = true;
+    });
+    REQUIRE(changed);
+  }
+
+  SECTION("Paced stepping keeps close to the target rate") {
+    SimulationRunner runner(&container);
+    runner.Start(100);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    runner.Stop();
+    REQUIRE(runner.GetStepCount() >= 10);
+    REQUIRE(runner.GetStepCount() <= 60);
+  }
+
+  DeleteGroups(container);
+}
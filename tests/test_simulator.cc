@@ -1,18 +1,25 @@
-#include "visualizer/ideal_gas_simulator.h"
+#include "core/gas_container.h"
 #include "core/particle.h"
-#include "cinder/gl/gl.h"
+#include "glm/glm.hpp"
+#include "test_containers.h"
 #include <catch2/catch.hpp>
+#include <map>
 #include <vector>
 
 using glm::vec2;
-using idealgas::visualizer::IdealGasSimulator;
+using idealgas::AddGroupDescription;
+using idealgas::GasContainer;
+using idealgas::BoundaryMode;
+using idealgas::CollisionMode;
 using idealgas::ParticleGroup;
 using idealgas::Particle;
+using idealgas::FindNamedColor;
+using std::map;
 using std::vector;
 
 //set up particle group for testing
 vector<ParticleGroup*> test_groups;
-ParticleGroup* first_group = new ParticleGroup(0,1,1,"white",100.0,100.0,2.0);
+ParticleGroup* first_group = new ParticleGroup(0,1,1,FindNamedColor("white"),100.0,100.0,2.0,0,0);
 
 bool AreVelocitiesEqual(const vec2& first, const vec2& second) {
   return (double) first.x == Approx((double) second.x).epsilon(0.1) &&
@@ -21,17 +28,16 @@ bool AreVelocitiesEqual(const vec2& first, const vec2& second) {
 
 TEST_CASE("Particles collisions handled correctly by simulator") {
   test_groups.push_back(first_group);
-  Particle test_particle(vec2(50.0,50.0), vec2(1.0,1.0), 1, 1, "white");
+  Particle test_particle(vec2(50.0,50.0), vec2(1.0,1.0), 1, 1, FindNamedColor("white"));
 
   SECTION("Collisions between same type particles handled correctly") {
     SECTION("Particles moving away from each other do not collide") {
-      IdealGasSimulator test_simulator(vec2(0,0),test_groups,500.0,500.0,100.0,
-                                       100.0,50.0,10,2);
+      GasContainer test_container(test_groups,500.0,500.0);
       Particle same_non_colliding_particle(vec2(48.0,50.0), vec2(-1.0,-1.0),
-                                                1, 1, "white");
+                                                1, 1, FindNamedColor("white"));
       first_group->AddParticle(test_particle);
       first_group->AddParticle(same_non_colliding_particle);
-      test_simulator.Update();
+      test_container.Update();
 
       //check velocities do NOT change
       REQUIRE(AreVelocitiesEqual(first_group->GetParticleAt(0)->velocity,
@@ -41,13 +47,12 @@ TEST_CASE("Particles collisions handled correctly by simulator") {
     }
 
     SECTION("Particles colliding correctly change velocity") {
-      IdealGasSimulator test_simulator(vec2(0,0),test_groups,500.0,500.0,100.0,
-                                       100.0,50.0,10,2);
-      Particle same_colliding_particle(vec2(52.0,50.0), vec2(-1.0,-1.0), 1, 1, "white");
+      GasContainer test_container(test_groups,500.0,500.0);
+      Particle same_colliding_particle(vec2(52.0,50.0), vec2(-1.0,-1.0), 1, 1, FindNamedColor("white"));
       first_group->ClearParticles();
       first_group->AddParticle(test_particle);
       first_group->AddParticle(same_colliding_particle);
-      test_simulator.Update();
+      test_container.Update();
 
       //check velocities update correctly
       REQUIRE(AreVelocitiesEqual(first_group->GetParticleAt(0)->velocity,
@@ -57,11 +62,10 @@ TEST_CASE("Particles collisions handled correctly by simulator") {
     }
 
     SECTION("Pairs of particles collide correctly with >2 particles in box") {
-      IdealGasSimulator test_simulator(vec2(0,0),test_groups,500.0,500.0,100.0,
-                                       100.0,50.0,10,2);
-      Particle extra_particle(vec2(30.0,30.0), vec2(0.5,1.5), 1, 1, "white");
+      GasContainer test_container(test_groups,500.0,500.0);
+      Particle extra_particle(vec2(30.0,30.0), vec2(0.5,1.5), 1, 1, FindNamedColor("white"));
       first_group->AddParticle(extra_particle);
-      test_simulator.Update();
+      test_container.Update();
 
       //check only colliding particle velocities update
       REQUIRE(AreVelocitiesEqual(first_group->GetParticleAt(0)->velocity,
@@ -74,18 +78,17 @@ TEST_CASE("Particles collisions handled correctly by simulator") {
   }
 
   SECTION("Collisions between different type particles handled correctly") {
-    ParticleGroup* second_group = new ParticleGroup(0,2,2,"red",100.0,100.0,2.0);
+    ParticleGroup* second_group = new ParticleGroup(0,2,2,FindNamedColor("red"),100.0,100.0,2.0,0,0);
     test_groups.push_back(second_group);
 
     SECTION("Different particles moving away from each other don't collide") {
-      IdealGasSimulator test_simulator(vec2(0,0),test_groups,500.0,500.0,100.0,
-                                       100.0,50.0,10,2);
+      GasContainer test_container(test_groups,500.0,500.0);
       Particle different_non_colliding_particle(vec2(47.0,50.0),vec2(-1.0,-1.0),
-                                                2, 2, "red");
+                                                2, 2, FindNamedColor("red"));
       first_group->ClearParticles();
       first_group->AddParticle(test_particle);
       second_group->AddParticle(different_non_colliding_particle);
-      test_simulator.Update();
+      test_container.Update();
 
       //check velocities do NOT change
       REQUIRE(AreVelocitiesEqual(first_group->GetParticleAt(0)->velocity,
@@ -95,15 +98,14 @@ TEST_CASE("Particles collisions handled correctly by simulator") {
     }
 
     SECTION("Different particles update correctly after colliding") {
-      IdealGasSimulator test_simulator(vec2(0,0),test_groups,500.0,500.0,100.0,
-                                       100.0,50.0,10,2);
+      GasContainer test_container(test_groups,500.0,500.0);
       Particle different_colliding_particle(vec2(53.0,50.0),vec2(-1.0,-1.0),
-                                                2, 2, "red");
+                                                2, 2, FindNamedColor("red"));
       first_group->ClearParticles();
       first_group->AddParticle(test_particle);
       second_group->ClearParticles();
       second_group->AddParticle(different_colliding_particle);
-      test_simulator.Update();
+      test_container.Update();
 
       //check velocities update correctly
       REQUIRE(AreVelocitiesEqual(first_group->GetParticleAt(0)->velocity,
@@ -112,19 +114,18 @@ TEST_CASE("Particles collisions handled correctly by simulator") {
                               vec2(0.33,-1.0)));
     }
 
-    ParticleGroup* third_group = new ParticleGroup(0,5,3,"green",100.0,100.0,2.0);
+    ParticleGroup* third_group = new ParticleGroup(0,5,3,FindNamedColor("green"),100.0,100.0,2.0,0,0);
     test_groups.push_back(third_group);
 
     SECTION("Different particles collide properly w/ multiple different groups") {
-      IdealGasSimulator test_simulator(vec2(0,0),test_groups,500.0,500.0,100.0,
-                                       100.0,50.0,10,2);
-      Particle different_colliding_particle(vec2(53.0,50.0),vec2(-1.0,-1.0),2,2,"red");
-      Particle extra_particle(vec2(4.0,5.0),vec2(-1.0,-1.0),5, 3, "green");
+      GasContainer test_container(test_groups,500.0,500.0);
+      Particle different_colliding_particle(vec2(53.0,50.0),vec2(-1.0,-1.0),2,2,FindNamedColor("red"));
+      Particle extra_particle(vec2(4.0,5.0),vec2(-1.0,-1.0),5, 3, FindNamedColor("green"));
       first_group->ClearParticles();
       first_group->AddParticle(test_particle);
       second_group->AddParticle(different_colliding_particle);
       third_group->AddParticle(extra_particle);
-      test_simulator.Update();
+      test_container.Update();
 
       //check only colliding particle velocities update
       REQUIRE(AreVelocitiesEqual(first_group->GetParticleAt(0)->velocity,
@@ -135,4 +136,279 @@ TEST_CASE("Particles collisions handled correctly by simulator") {
                               vec2(-1.0,-1.0)));
     }
   }
-}
\ No newline at end of file
+}
+
+/**
+ * Copies all particles of a group into a new group with the same attributes.
+ */
+ParticleGroup* CopyParticleGroup(ParticleGroup* group, double max_x_position,
+                                 double max_y_position) {
+  ParticleGroup* copy = new ParticleGroup(0, group->GetParticleMass(),
+                                          group->GetParticleRadius(),
+                                          group->GetGroupColor(),
+                                          max_x_position, max_y_position,
+                                          2.0, 0, 0);
+  for (size_t index = 0; index < group->GetGroupSize(); index++) {
+    copy->AddParticle(*group->GetParticleAt(index));
+  }
+  return copy;
+}
+
+ParticleGroup* CopyParticleGroup(ParticleGroup* group, double max_position) {
+  return CopyParticleGroup(group, max_position, max_position);
+}
+
+/**
+ * Checks every particle in two lists of groups is in exactly the same state.
+ */
+void RequireSameParticles(const vector<ParticleGroup*>& expected_groups,
+                          const vector<ParticleGroup*>& actual_groups) {
+  for (size_t group = 0; group < actual_groups.size(); group++) {
+    ParticleGroup* expected = expected_groups[group];
+    ParticleGroup* actual = actual_groups[group];
+    REQUIRE(actual->GetGroupSize() == expected->GetGroupSize());
+    for (size_t index = 0; index < actual->GetGroupSize(); index++) {
+      REQUIRE(actual->GetPositionAt(index) == expected->GetPositionAt(index));
+      REQUIRE(actual->GetVelocityAt(index) == expected->GetVelocityAt(index));
+    }
+  }
+}
+
+TEST_CASE("Collision modes match all pairs collisions") {
+  //crowded container w/ radii 20 times apart, 3 times as tall as wide, so
+  //many collisions happen every update, grid levels differ and the sweep
+  //runs along y
+  ParticleGroup* small_group = new ParticleGroup(400,1,1,FindNamedColor("white"),120.0,360.0,2.0,0,0);
+  ParticleGroup* mid_group = new ParticleGroup(40,5,6,FindNamedColor("red"),120.0,360.0,1.0,0,1);
+  ParticleGroup* big_group = new ParticleGroup(3,20,20,FindNamedColor("blue"),120.0,360.0,0.5,0,2);
+  vector<ParticleGroup*> reference_groups = {
+      CopyParticleGroup(small_group, 120.0, 360.0),
+      CopyParticleGroup(mid_group, 120.0, 360.0),
+      CopyParticleGroup(big_group, 120.0, 360.0)};
+  vector<ParticleGroup*> mode_groups = {small_group, mid_group, big_group};
+
+  GasContainer reference_container(reference_groups,120.0,360.0);
+  reference_container.SetCollisionMode(CollisionMode::kAllPairs);
+  GasContainer mode_container(mode_groups,120.0,360.0);
+
+  SECTION("Uniform grid") {
+    mode_container.SetCollisionMode(CollisionMode::kUniformGrid);
+  }
+
+  SECTION("Verlet lists") {
+    mode_container.SetCollisionMode(CollisionMode::kVerletList);
+
+    //switch skins midway, so lists get rebuilt for a new skin too
+    for (size_t step = 0; step < 50; step++) {
+      reference_container.Update();
+      mode_container.Update();
+    }
+    mode_container.SetVerletSkin(1.5);
+  }
+
+  SECTION("Hierarchical grid") {
+    mode_container.SetCollisionMode(CollisionMode::kHierarchicalGrid);
+  }
+
+  SECTION("Sweep and prune") {
+    mode_container.SetCollisionMode(CollisionMode::kSweepAndPrune);
+  }
+
+  for (size_t step = 0; step < 100; step++) {
+    reference_container.Update();
+    mode_container.Update();
+  }
+
+  //check every particle ends up in exactly the same state
+  RequireSameParticles(reference_groups, mode_groups);
+  DeleteGroups(reference_container);
+  DeleteGroups(mode_container);
+}
+
+TEST_CASE("Multithreaded collisions match single threaded collisions") {
+  //enough touching particles that collisions are split between threads
+  ParticleGroup* small_group = new ParticleGroup(6000,1,2,FindNamedColor("white"),500.0,500.0,2.0,0,9);
+  ParticleGroup* big_group = new ParticleGroup(400,5,6,FindNamedColor("red"),500.0,500.0,1.0,0,10);
+  vector<ParticleGroup*> single_thread_groups = {
+      CopyParticleGroup(small_group, 500.0),
+      CopyParticleGroup(big_group, 500.0)};
+  vector<ParticleGroup*> multithread_groups = {small_group, big_group};
+
+  GasContainer single_thread_container(single_thread_groups,500.0,500.0);
+  single_thread_container.SetThreadCount(1);
+  GasContainer multithread_container(multithread_groups,500.0,500.0);
+  multithread_container.SetThreadCount(4);
+
+  SECTION("Uniform grid") {
+    for (size_t step = 0; step < 30; step++) {
+      single_thread_container.Update();
+      multithread_container.Update();
+    }
+    RequireSameParticles(single_thread_groups, multithread_groups);
+  }
+
+  SECTION("Verlet lists") {
+    single_thread_container.SetCollisionMode(CollisionMode::kVerletList);
+    multithread_container.SetCollisionMode(CollisionMode::kVerletList);
+    for (size_t step = 0; step < 30; step++) {
+      single_thread_container.Update();
+      multithread_container.Update();
+    }
+    RequireSameParticles(single_thread_groups, multithread_groups);
+  }
+
+  SECTION("Sweep and prune") {
+    single_thread_container.SetCollisionMode(CollisionMode::kSweepAndPrune);
+    multithread_container.SetCollisionMode(CollisionMode::kSweepAndPrune);
+    for (size_t step = 0; step < 30; step++) {
+      single_thread_container.Update();
+      multithread_container.Update();
+    }
+    RequireSameParticles(single_thread_groups, multithread_groups);
+  }
+
+  SECTION("Hierarchical grid") {
+    single_thread_container.SetCollisionMode(
+        CollisionMode::kHierarchicalGrid);
+    multithread_container.SetCollisionMode(CollisionMode::kHierarchicalGrid);
+    for (size_t step = 0; step < 30; step++) {
+      single_thread_container.Update();
+      multithread_container.Update();
+    }
+    RequireSameParticles(single_thread_groups, multithread_groups);
+  }
+
+  DeleteGroups(single_thread_container);
+  DeleteGroups(multithread_container);
+}
+
+/**
+ * Adds up the momentum of every particle in the given groups.
+ */
+vec2 FindMomentum(const vector<ParticleGroup*>& groups) {
+  vec2 momentum(0, 0);
+  for (ParticleGroup* group: groups) {
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      momentum += (float) group->GetParticleMass() *
+                  group->GetVelocityAt(index);
+    }
+  }
+  return momentum;
+}
+
+TEST_CASE("Periodic boundaries wrap particles around the container") {
+  ParticleGroup* group = new ParticleGroup(0,1,2,FindNamedColor("white"),100.0,100.0,2.0,0,0);
+  vector<ParticleGroup*> groups = {group};
+  GasContainer container(groups,100.0,100.0);
+  container.SetBoundaryMode(BoundaryMode::kPeriodic);
+
+  SECTION("Particles leave through one side and come back through the other") {
+    group->AddParticle(Particle(vec2(99.0,0.5), vec2(2.0,-1.0), 1, 2, FindNamedColor("white")));
+    container.Update();
+    REQUIRE(group->GetVelocityAt(0) == vec2(2.0,-1.0));
+    REQUIRE(group->GetPositionAt(0).x == Approx(1.0));
+    REQUIRE(group->GetPositionAt(0).y == Approx(99.5));
+  }
+
+  SECTION("Particles collide across the edges") {
+    group->AddParticle(Particle(vec2(1.0,50.0), vec2(-1.0,0.0), 1, 2, FindNamedColor("white")));
+    group->AddParticle(Particle(vec2(98.0,50.0), vec2(1.0,0.0), 1, 2, FindNamedColor("white")));
+    container.Update();
+    REQUIRE(AreVelocitiesEqual(group->GetVelocityAt(0), vec2(1.0,0.0)));
+    REQUIRE(AreVelocitiesEqual(group->GetVelocityAt(1), vec2(-1.0,0.0)));
+  }
+
+  SECTION("Particles collide across a corner") {
+    group->AddParticle(Particle(vec2(1.0,1.0), vec2(-1.0,-1.0), 1, 2, FindNamedColor("white")));
+    group->AddParticle(Particle(vec2(99.0,99.0), vec2(1.0,1.0), 1, 2, FindNamedColor("white")));
+    container.Update();
+    REQUIRE(AreVelocitiesEqual(group->GetVelocityAt(0), vec2(1.0,1.0)));
+    REQUIRE(AreVelocitiesEqual(group->GetVelocityAt(1), vec2(-1.0,-1.0)));
+  }
+}
+
+TEST_CASE("Periodic collisions match all pairs collisions in every mode") {
+  //radii 20 times apart and a container 3 times as tall as wide, so grid
+  //levels differ and the sweep runs along y, crossing both edges
+  ParticleGroup* small_group = new ParticleGroup(400,1,1,FindNamedColor("white"),120.0,360.0,2.0,0,11);
+  ParticleGroup* mid_group = new ParticleGroup(40,5,6,FindNamedColor("red"),120.0,360.0,1.5,0,12);
+  ParticleGroup* big_group = new ParticleGroup(3,20,20,FindNamedColor("blue"),120.0,360.0,1.0,0,13);
+  vector<ParticleGroup*> reference_groups = {
+      CopyParticleGroup(small_group, 120.0, 360.0),
+      CopyParticleGroup(mid_group, 120.0, 360.0),
+      CopyParticleGroup(big_group, 120.0, 360.0)};
+  vector<ParticleGroup*> mode_groups = {small_group, mid_group, big_group};
+  vec2 starting_momentum = FindMomentum(reference_groups);
+
+  GasContainer reference_container(reference_groups,120.0,360.0);
+  reference_container.SetCollisionMode(CollisionMode::kAllPairs);
+  reference_container.SetBoundaryMode(BoundaryMode::kPeriodic);
+  GasContainer mode_container(mode_groups,120.0,360.0);
+  mode_container.SetBoundaryMode(BoundaryMode::kPeriodic);
+
+  SECTION("Uniform grid") {
+    mode_container.SetCollisionMode(CollisionMode::kUniformGrid);
+  }
+
+  SECTION("Verlet lists") {
+    mode_container.SetCollisionMode(CollisionMode::kVerletList);
+  }
+
+  SECTION("Hierarchical grid") {
+    mode_container.SetCollisionMode(CollisionMode::kHierarchicalGrid);
+  }
+
+  SECTION("Sweep and prune") {
+    mode_container.SetCollisionMode(CollisionMode::kSweepAndPrune);
+  }
+
+  SECTION("Several threads") {
+    mode_container.SetThreadCount(3);
+  }
+
+  for (size_t step = 0; step < 150; step++) {
+    reference_container.Update();
+    mode_container.Update();
+  }
+  RequireSameParticles(reference_groups, mode_groups);
+
+  //w/o walls, nothing changes the total momentum
+  vec2 momentum = FindMomentum(reference_groups);
+  REQUIRE(momentum.x == Approx(starting_momentum.x).margin(0.01));
+  REQUIRE(momentum.y == Approx(starting_momentum.y).margin(0.01));
+  for (ParticleGroup* group: reference_groups) {
+    for (size_t index = 0; index < group->GetGroupSize(); index++) {
+      vec2 position = group->GetPositionAt(index);
+      REQUIRE(position.x >= 0);
+      REQUIRE(position.x <= 120.0);
+      REQUIRE(position.y >= 0);
+      REQUIRE(position.y <= 360.0);
+    }
+  }
+  DeleteGroups(reference_container);
+  DeleteGroups(mode_container);
+}
+
+TEST_CASE("Group descriptions are read as COUNT:MASS:RADIUS") {
+  map<Particle, size_t> particle_information;
+
+  SECTION("Groups w/ the same mass and radius add up their counts") {
+    REQUIRE(AddGroupDescription("200:2:5", particle_information));
+    REQUIRE(AddGroupDescription("30:15:15", particle_information));
+    REQUIRE(AddGroupDescription("50:2:5", particle_information));
+    REQUIRE(particle_information.size() == 2);
+
+    Particle small_particle(vec2(0,0), vec2(0,0), 2, 5, FindNamedColor("white"));
+    Particle big_particle(vec2(0,0), vec2(0,0), 15, 15, FindNamedColor("white"));
+    REQUIRE(particle_information[small_particle] == 250);
+    REQUIRE(particle_information[big_particle] == 30);
+  }
+
+  SECTION("Malformed descriptions are rejected") {
+    REQUIRE_FALSE(AddGroupDescription("200:2", particle_information));
+    REQUIRE_FALSE(AddGroupDescription("200:2:5x", particle_information));
+    REQUIRE_FALSE(AddGroupDescription("200:0:5", particle_information));
+    REQUIRE_FALSE(AddGroupDescription("", particle_information));
+    REQUIRE(particle_information.empty());
+  }
+}
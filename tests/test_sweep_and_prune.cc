@@ -0,0 +1,88 @@
+#include <catch2/catch.hpp>
+#include "core/sweep_and_prune.h"
+#include <vector>
+
+using idealgas::FindNamedColor;
+using idealgas::Particle;
+using idealgas::SweepAndPrune;
+using glm::vec2;
+using std::vector;
+
+TEST_CASE("Sweep and prune keeps particles sorted between updates") {
+  vector<Particle> particles = {
+      Particle(vec2(40.0,10.0), vec2(0,0), 1, 2, FindNamedColor("white")),
+      Particle(vec2(10.0,10.0), vec2(0,0), 1, 2, FindNamedColor("white")),
+      Particle(vec2(14.0,12.0), vec2(0,0), 1, 2, FindNamedColor("white")),
+      Particle(vec2(16.0,40.0), vec2(0,0), 1, 2, FindNamedColor("white"))};
+  vector<size_t> particle_list = {0, 1, 2, 3};
+  SweepAndPrune sweep_and_prune;
+  sweep_and_prune.Update(particles, particle_list, 100.0, 50.0);
+
+  SECTION("Particles are sorted along the longer axis") {
+    REQUIRE(sweep_and_prune.GetParticleCount() == 4);
+    REQUIRE(sweep_and_prune.GetParticleAt(0) == 1);
+    REQUIRE(sweep_and_prune.GetParticleAt(1) == 2);
+    REQUIRE(sweep_and_prune.GetParticleAt(2) == 3);
+    REQUIRE(sweep_and_prune.GetParticleAt(3) == 0);
+  }
+
+  SECTION("Only extents overlapping on both axes are listed") {
+    vector<size_t> overlaps;
+    sweep_and_prune.ListOverlaps(0, overlaps);
+    REQUIRE(overlaps == vector<size_t>({2}));
+    sweep_and_prune.ListOverlaps(1, overlaps);
+    REQUIRE(overlaps.empty());
+  }
+
+  SECTION("Small moves are repaired in place") {
+    particles.at(3).position = vec2(12.0,40.0);
+    sweep_and_prune.Update(particles, particle_list, 100.0, 50.0);
+    REQUIRE(sweep_and_prune.GetSwapCount() == 1);
+    REQUIRE(sweep_and_prune.GetParticleAt(1) == 3);
+    REQUIRE(sweep_and_prune.GetParticleAt(2) == 2);
+  }
+
+  SECTION("Tall containers sweep along y") {
+    sweep_and_prune.Update(particles, particle_list, 50.0, 100.0);
+    REQUIRE(sweep_and_prune.GetSwapCount() == 0);
+    REQUIRE(sweep_and_prune.GetParticleAt(0) == 0);
+    REQUIRE(sweep_and_prune.GetParticleAt(1) == 1);
+    REQUIRE(sweep_and_prune.GetParticleAt(2) == 2);
+    REQUIRE(sweep_and_prune.GetParticleAt(3) == 3);
+  }
+}
+
+TEST_CASE("Sweep and prune lists overlaps across wrapping edges") {
+  vector<Particle> particles = {
+      Particle(vec2(99.0,10.0), vec2(0,0), 1, 2, FindNamedColor("white")),
+      Particle(vec2(50.0,1.0), vec2(0,0), 1, 2, FindNamedColor("white")),
+      Particle(vec2(1.0,12.0), vec2(0,0), 1, 2, FindNamedColor("white")),
+      Particle(vec2(51.0,48.0), vec2(0,0), 1, 2, FindNamedColor("white"))};
+  vector<size_t> particle_list = {0, 1, 2, 3};
+  SweepAndPrune sweep_and_prune;
+
+  SECTION("Edges don't wrap by default") {
+    sweep_and_prune.Update(particles, particle_list, 100.0, 50.0);
+    for (size_t slot = 0; slot < 4; slot++) {
+      vector<size_t> overlaps;
+      sweep_and_prune.ListOverlaps(slot, overlaps);
+      REQUIRE(overlaps.empty());
+    }
+  }
+
+  SECTION("Every pair touching across an edge is listed exactly once") {
+    sweep_and_prune.Update(particles, particle_list, 100.0, 50.0, true);
+    //0 and 2 touch across the x edge, 1 and 3 across the y edge
+    size_t pair_count = 0;
+    for (size_t slot = 0; slot < 4; slot++) {
+      vector<size_t> overlaps;
+      sweep_and_prune.ListOverlaps(slot, overlaps);
+      size_t first = sweep_and_prune.GetParticleAt(slot);
+      for (size_t second: overlaps) {
+        REQUIRE(first + second == (first % 2 == 0 ? 2 : 4));
+        pair_count++;
+      }
+    }
+    REQUIRE(pair_count == 2);
+  }
+}
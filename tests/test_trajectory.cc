@@ -0,0 +1,222 @@
+#include <catch2/catch.hpp>
+#include "core/lz_codec.h"
+#include "core/trajectory.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using idealgas::FindNamedColor;
+using idealgas::GasContainer;
+using idealgas::ParticleGroup;
+using idealgas::TrajectoryReader;
+using idealgas::TrajectoryWriter;
+using idealgas::lzcodec::Compress;
+using idealgas::lzcodec::Decompress;
+using std::vector;
+
+/**
+ * Compresses then decompresses bytes, checking they come back unchanged.
+ */
+void RequireRoundTrip(const vector<unsigned char>& input) {
+  vector<unsigned char> compressed;
+  Compress(input.data(), input.size(), compressed);
+  vector<unsigned char> output(input.size());
+  REQUIRE(Decompress(compressed.data(), compressed.size(), output.data(),
+                     output.size()));
+  REQUIRE(output == input);
+}
+
+TEST_CASE("LZ codec restores compressed bytes") {
+  SECTION("Empty and tiny inputs round trip") {
+    RequireRoundTrip(vector<unsigned char>());
+    RequireRoundTrip(vector<unsigned char>{1, 2, 3});
+  }
+
+  SECTION("Repetitive input round trips and shrinks") {
+    vector<unsigned char> input;
+    for (size_t index = 0; index < 100000; index++) {
+      input.push_back((unsigned char) (index % 7 == 0 ? index : 0));
+    }
+    RequireRoundTrip(input);
+
+    vector<unsigned char> compressed;
+    Compress(input.data(), input.size(), compressed);
+    REQUIRE(compressed.size() < input.size() / 4);
+  }
+
+  SECTION("Random input round trips") {
+    std::srand(3);
+    vector<unsigned char> input;
+    for (size_t index = 0; index < 70000; index++) {
+      input.push_back((unsigned char) (std::rand() % 256));
+    }
+    RequireRoundTrip(input);
+  }
+
+  SECTION("Damaged input is rejected") {
+    vector<unsigned char> input(1000, 42);
+    vector<unsigned char> compressed;
+    Compress(input.data(), input.size(), compressed);
+    vector<unsigned char> output(input.size());
+    REQUIRE_FALSE(Decompress(compressed.data(), compressed.size() - 1,
+                             output.data(), output.size()));
+  }
+}
+
+TEST_CASE("Trajectory frames are read back exactly") {
+  ParticleGroup* small_group = new ParticleGroup(200,1,2,FindNamedColor("white"),196.0,196.0,2.0,0,0);
+  ParticleGroup* big_group = new ParticleGroup(30,5,6,FindNamedColor("red"),188.0,188.0,1.0,0,1);
+  vector<ParticleGroup*> groups = {small_group, big_group};
+  GasContainer container(groups,200.0,200.0);
+
+  //keep every recorded frame to compare against
+  const char* path = "test_trajectory.igt";
+  TrajectoryWriter writer;
+  REQUIRE(writer.Open(path, container, 3, 1000));
+  vector<vector<float>> expected_x_positions;
+  vector<vector<float>> expected_y_velocities;
+  for (size_t step = 1; step <= 100; step++) {
+    container.Update();
+    writer.RecordStep(container, step);
+    if (step % 3 == 0) {
+      vector<float> x_positions;
+      vector<float> y_velocities;
+      for (ParticleGroup* group: groups) {
+        for (size_t index = 0; index < group->GetGroupSize(); index++) {
+          x_positions.push_back(group->GetPositionAt(index).x);
+          y_velocities.push_back(group->GetVelocityAt(index).y);
+        }
+      }
+      expected_x_positions.push_back(x_positions);
+      expected_y_velocities.push_back(y_velocities);
+    }
+  }
+  REQUIRE(writer.Close());
+  REQUIRE(writer.GetDroppedFrameCount() == 0);
+
+  TrajectoryReader reader;
+  REQUIRE(reader.Open(path));
+  REQUIRE(reader.GetHeader().particle_count == 230);
+  REQUIRE(reader.GetGroup(1).particle_radius == 6);
+  REQUIRE(reader.GetFrameCount() == 33);
+
+  //read frames out of order, so chunks have to be looked up
+  vector<float> x_positions, y_positions, x_velocities, y_velocities;
+  for (size_t frame: {32, 0, 17, 16, 15, 5}) {
+    REQUIRE(reader.ReadFrame(frame, x_positions, y_positions, x_velocities,
+                             y_velocities));
+    REQUIRE(reader.GetFrameStep(frame) == 3 * (frame + 1));
+    REQUIRE(x_positions == expected_x_positions[frame]);
+    REQUIRE(y_velocities == expected_y_velocities[frame]);
+  }
+  REQUIRE_FALSE(reader.ReadFrame(33, x_positions, y_positions, x_velocities,
+                                 y_velocities));
+  std::remove(path);
+}
+
+TEST_CASE("Trajectory frames keep particles in place through reordering") {
+  ParticleGroup* group = new ParticleGroup(300,1,2,FindNamedColor("white"),196.0,196.0,2.0,0,2);
+  vector<ParticleGroup*> groups = {group};
+  GasContainer container(groups,200.0,200.0);
+  container.SetSortInterval(1);
+
+  const char* path = "test_trajectory_sorted.igt";
+  TrajectoryWriter writer;
+  REQUIRE(writer.Open(path, container, 1, 1000));
+  vector<vector<float>> expected_x_positions;
+  for (size_t step = 1; step <= 40; step++) {
+    container.Update();
+    writer.RecordStep(container, step);
+
+    //every particle is written at its id, not at its current index
+    const vector<uint32_t>& ids = container.GetParticleIds(0);
+    REQUIRE(ids.size() == group->GetGroupSize());
+    vector<float> x_positions(ids.size());
+    for (size_t index = 0; index < ids.size(); index++) {
+      x_positions.at(ids[index]) = group->GetPositionAt(index).x;
+    }
+    expected_x_positions.push_back(x_positions);
+  }
+  REQUIRE(writer.Close());
+  REQUIRE(container.GetSortCount() == 40);
+
+  TrajectoryReader reader;
+  REQUIRE(reader.Open(path));
+  REQUIRE(reader.GetFrameCount() == 40);
+  vector<float> x_positions, y_positions, x_velocities, y_velocities;
+  vector<float> last_x_positions, last_y_positions;
+  for (size_t frame = 0; frame < 40; frame++) {
+    REQUIRE(reader.ReadFrame(frame, x_positions, y_positions, x_velocities,
+                             y_velocities));
+    REQUIRE(x_positions == expected_x_positions[frame]);
+
+    //a particle only moves a little between frames
+    for (size_t index = 0; frame > 0 && index < x_positions.size(); index++) {
+      REQUIRE(std::abs(x_positions[index] - last_x_positions[index]) < 20);
+      REQUIRE(std::abs(y_positions[index] - last_y_positions[index]) < 20);
+    }
+    last_x_positions = x_positions;
+    last_y_positions = y_positions;
+  }
+  std::remove(path);
+  delete group;
+}
+
+/**
+ * Overwrites 8 bytes of a file at the given offset, from its end if the
+ * offset is negative.
+ */
+void OverwriteValue(const char* path, long offset, uint64_t value) {
+  std::FILE* file = std::fopen(path, "r+b");
+  REQUIRE(file != nullptr);
+  REQUIRE(std::fseek(file, offset, offset < 0 ? SEEK_END : SEEK_SET) == 0);
+  REQUIRE(std::fwrite(&value, sizeof(value), 1, file) == 1);
+  REQUIRE(std::fclose(file) == 0);
+}
+
+TEST_CASE("Trajectory files w/ sizes that don't fit are rejected") {
+  ParticleGroup* group = new ParticleGroup(50,1,2,FindNamedColor("white"),196.0,196.0,2.0,0,3);
+  vector<ParticleGroup*> groups = {group};
+  GasContainer container(groups,200.0,200.0);
+
+  const char* path = "test_trajectory_corrupt.igt";
+  TrajectoryWriter writer;
+  REQUIRE(writer.Open(path, container, 1, 1000));
+  for (size_t step = 1; step <= 5; step++) {
+    container.Update();
+    writer.RecordStep(container, step);
+  }
+  REQUIRE(writer.Close());
+  const uint64_t huge = UINT64_MAX / 2;
+  vector<float> x_positions, y_positions, x_velocities, y_velocities;
+
+  SECTION("Frame count past the end of the file") {
+    OverwriteValue(path, -(long) sizeof(idealgas::TrajectoryFooter) +
+                   offsetof(idealgas::TrajectoryFooter, frame_count), huge);
+    TrajectoryReader reader;
+    REQUIRE_FALSE(reader.Open(path));
+  }
+
+  SECTION("Particle count too big for a chunk") {
+    OverwriteValue(path, offsetof(idealgas::TrajectoryHeader, particle_count),
+                   huge);
+    TrajectoryReader reader;
+    REQUIRE_FALSE(reader.Open(path));
+  }
+
+  SECTION("Compressed chunk past the end of the file") {
+    //the first chunk starts right after the group records
+    OverwriteValue(path, sizeof(idealgas::TrajectoryHeader) +
+                   sizeof(idealgas::TrajectoryGroup) +
+                   offsetof(idealgas::TrajectoryChunk, compressed_size), huge);
+    TrajectoryReader reader;
+    REQUIRE(reader.Open(path));
+    REQUIRE_FALSE(reader.ReadFrame(0, x_positions, y_positions, x_velocities,
+                                   y_velocities));
+  }
+  std::remove(path);
+  delete group;
+}
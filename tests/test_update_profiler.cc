@@ -0,0 +1,127 @@
+#include "core/gas_container.h"
+#include "core/update_profiler.h"
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using glm::vec2;
+using idealgas::CollisionMode;
+using idealgas::FindNamedColor;
+using idealgas::GasContainer;
+using idealgas::Particle;
+using idealgas::ParticleGroup;
+using idealgas::SteppingMode;
+using idealgas::UpdateCounter;
+using idealgas::UpdatePhase;
+using idealgas::UpdateProfiler;
+using std::vector;
+
+TEST_CASE("Update profiler sums phase times and counts until reset") {
+  UpdateProfiler profiler;
+  profiler.AddPhaseTime(UpdatePhase::kPairDetection, 0.25);
+  profiler.AddPhaseTime(UpdatePhase::kPairDetection, 0.5);
+  profiler.AddCount(UpdateCounter::kPairsTested, 3);
+  profiler.AddCount(UpdateCounter::kPairsTested, 4);
+  profiler.FinishUpdate();
+
+  SECTION("Times and counts add up") {
+    REQUIRE(profiler.GetPhaseSeconds(UpdatePhase::kPairDetection) == 0.75);
+    REQUIRE(profiler.GetPhaseSeconds(UpdatePhase::kDrawing) == 0);
+    REQUIRE(profiler.GetCount(UpdateCounter::kPairsTested) == 7);
+    REQUIRE(profiler.GetCount(UpdateCounter::kCollisionsResolved) == 0);
+    REQUIRE(profiler.GetUpdateCount() == 1);
+  }
+
+  SECTION("Reset forgets everything") {
+    profiler.Reset();
+    REQUIRE(profiler.GetPhaseSeconds(UpdatePhase::kPairDetection) == 0);
+    REQUIRE(profiler.GetCount(UpdateCounter::kPairsTested) == 0);
+    REQUIRE(profiler.GetUpdateCount() == 0);
+  }
+
+  SECTION("CSV rows have a column for every header") {
+    char header[512] = {};
+    char row[512] = {};
+    std::FILE* file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    UpdateProfiler::WriteCsvHeader(file);
+    profiler.WriteCsvRow(file, 10);
+    std::rewind(file);
+    REQUIRE(std::fgets(header, sizeof(header), file) != nullptr);
+    REQUIRE(std::fgets(row, sizeof(row), file) != nullptr);
+    std::fclose(file);
+
+    size_t header_commas = 0;
+    size_t row_commas = 0;
+    for (size_t index = 0; index < std::strlen(header); index++) {
+      header_commas += header[index] == ',';
+    }
+    for (size_t index = 0; index < std::strlen(row); index++) {
+      row_commas += row[index] == ',';
+    }
+    REQUIRE(header_commas == row_commas);
+    REQUIRE(std::strncmp(row, "10,1,", 5) == 0);
+    REQUIRE(std::strstr(header, "pairs_tested") != nullptr);
+  }
+}
+
+TEST_CASE("Gas container records the work done by updates") {
+  //two touching particles moving towards each other, one far away
+  ParticleGroup group(0, 1, 1, FindNamedColor("white"), 100.0, 100.0, 2.0, 0, 0);
+  group.AddParticle(Particle(vec2(50.0,50.0), vec2(1.0,0), 1, 1, FindNamedColor("white")));
+  group.AddParticle(Particle(vec2(51.0,50.0), vec2(-1.0,0), 1, 1, FindNamedColor("white")));
+  group.AddParticle(Particle(vec2(200.0,200.0), vec2(1.0,1.0), 1, 1, FindNamedColor("white")));
+  vector<ParticleGroup*> groups = {&group};
+  GasContainer container(groups, 300, 300);
+  UpdateProfiler& profiler = container.GetProfiler();
+
+#ifdef IDEALGAS_PROFILING
+  SECTION("Grid updates only test pairs in neighboring cells") {
+    container.Update();
+    REQUIRE(profiler.GetUpdateCount() == 1);
+    REQUIRE(profiler.GetCount(UpdateCounter::kPairsTested) == 1);
+    REQUIRE(profiler.GetCount(UpdateCounter::kCollisionsResolved) == 1);
+    REQUIRE(profiler.GetCount(UpdateCounter::kParticlesProcessed) == 3);
+    REQUIRE(profiler.GetPhaseSeconds(UpdatePhase::kPairDetection) > 0);
+    REQUIRE(profiler.GetPhaseSeconds(UpdatePhase::kEventStepping) == 0);
+  }
+
+  SECTION("All pairs updates test every earlier particle") {
+    container.SetCollisionMode(CollisionMode::kAllPairs);
+    container.Update();
+    REQUIRE(profiler.GetCount(UpdateCounter::kPairsTested) == 3);
+    REQUIRE(profiler.GetCount(UpdateCounter::kCollisionsResolved) == 1);
+  }
+
+  SECTION("Verlet list updates test listed pairs") {
+    container.SetCollisionMode(CollisionMode::kVerletList);
+    container.Update();
+    REQUIRE(profiler.GetCount(UpdateCounter::kPairsTested) == 1);
+    REQUIRE(profiler.GetCount(UpdateCounter::kCollisionsResolved) == 1);
+  }
+
+  SECTION("Event driven updates are timed as a whole") {
+    container.SetSteppingMode(SteppingMode::kEventDriven);
+    container.Update();
+    REQUIRE(profiler.GetUpdateCount() == 1);
+    REQUIRE(profiler.GetCount(UpdateCounter::kCollisionsResolved) >= 1);
+    REQUIRE(profiler.GetPhaseSeconds(UpdatePhase::kEventStepping) > 0);
+    REQUIRE(profiler.GetPhaseSeconds(UpdatePhase::kPairDetection) == 0);
+  }
+
+  SECTION("Counts keep adding up over updates") {
+    container.Update();
+    container.Update();
+    REQUIRE(profiler.GetUpdateCount() == 2);
+    REQUIRE(profiler.GetCount(UpdateCounter::kParticlesProcessed) == 6);
+  }
+#else
+  SECTION("Nothing is recorded w/o profiling") {
+    container.Update();
+    REQUIRE(profiler.GetUpdateCount() == 0);
+    REQUIRE(profiler.GetCount(UpdateCounter::kPairsTested) == 0);
+    REQUIRE(profiler.GetPhaseSeconds(UpdatePhase::kPairDetection) == 0);
+  }
+#endif
+}
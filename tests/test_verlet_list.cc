@@ -0,0 +1,51 @@
+#include <catch2/catch.hpp>
+#include "core/verlet_list.h"
+#include <vector>
+
+using idealgas::FindNamedColor;
+using idealgas::Particle;
+using idealgas::VerletList;
+using glm::vec2;
+using std::vector;
+
+TEST_CASE("Verlet lists only rebuild once particles move far enough") {
+  vector<Particle> particles = {
+      Particle(vec2(10.0,10.0), vec2(0,0), 1, 2, FindNamedColor("white")),
+      Particle(vec2(16.0,10.0), vec2(0,0), 1, 2, FindNamedColor("white")),
+      Particle(vec2(30.0,10.0), vec2(0,0), 1, 2, FindNamedColor("white")),
+      Particle(vec2(10.0,40.0), vec2(0,0), 1, 2, FindNamedColor("white"))};
+  vector<size_t> particle_list = {0, 1, 2, 3};
+  VerletList verlet_list;
+  REQUIRE(verlet_list.NeedsRebuild(particles, particle_list, 4.0));
+  verlet_list.Rebuild(particles, particle_list, 100.0, 100.0, 2.0, 4.0);
+
+  SECTION("Only pairs w/in contact distance plus skin are listed") {
+    //particles 0 and 1 are 6 apart, w/in 2 + 2 + 4, the rest are too far
+    REQUIRE(verlet_list.GetNeighborStart(1) == 0);
+    REQUIRE(verlet_list.GetNeighborStart(2) == 1);
+    REQUIRE(verlet_list.GetNeighbors().at(0) == 0);
+    REQUIRE(verlet_list.GetNeighborStart(4) == 1);
+  }
+
+  SECTION("Moving less than half the skin keeps the lists") {
+    particles.at(2).position = vec2(28.5,10.0);
+    REQUIRE_FALSE(verlet_list.NeedsRebuild(particles, particle_list, 4.0));
+  }
+
+  SECTION("Moving more than half the skin needs a rebuild") {
+    particles.at(2).position = vec2(30.0,12.5);
+    REQUIRE(verlet_list.NeedsRebuild(particles, particle_list, 4.0));
+  }
+
+  SECTION("Changing the skin or the particle list needs a rebuild") {
+    REQUIRE(verlet_list.NeedsRebuild(particles, particle_list, 3.0));
+    particle_list.pop_back();
+    REQUIRE(verlet_list.NeedsRebuild(particles, particle_list, 4.0));
+  }
+
+  SECTION("Cleared lists need a rebuild") {
+    verlet_list.Clear();
+    REQUIRE(verlet_list.NeedsRebuild(particles, particle_list, 4.0));
+    REQUIRE(verlet_list.GetRebuildCount() == 1);
+  }
+}